@@ -66,6 +66,7 @@
 #include <86box/bugger.h>
 #include <86box/postcard.h>
 #include <86box/unittester.h>
+#include <86box/bench.h>
 #include <86box/isamem.h>
 #include <86box/isartc.h>
 #include <86box/lpt.h>
@@ -100,8 +101,12 @@
 #include <86box/version.h>
 #include <86box/gdbstub.h>
 #include <86box/machine_status.h>
+#include <86box/machine_counters.h>
+#include <86box/savestate.h>
+#include <86box/replay.h>
 #include <86box/apm.h>
 #include <86box/acpi.h>
+#include <minitrace/minitrace.h>
 
 // Disable c99-designator to avoid the warnings about int ng
 #ifdef __clang__
@@ -125,6 +130,8 @@ int tracing_on = 0;
 /* Commandline options. */
 int dump_on_exit        = 0; /* (O) dump regs on exit */
 int start_in_fullscreen = 0; /* (O) start in fullscreen */
+int fast_forward        = 0; /* (O) run as fast as the host allows */
+int perf_stats          = 0; /* (O) show the performance counters */
 #ifdef _WIN32
 int force_debug = 0; /* (O) force debug output */
 #endif
@@ -194,6 +201,8 @@ int      time_sync                              = 0;              /* (C) enable
 int      confirm_reset                          = 1;              /* (C) enable reset confirmation */
 int      confirm_exit                           = 1;              /* (C) enable exit confirmation */
 int      confirm_save                           = 1;              /* (C) enable save confirmation */
+int      pace_to_audio                          = 0;              /* (C) keep pacing in step with the
+                                                                         audio output */
 int      enable_discord                         = 0;              /* (C) enable Discord integration */
 int      pit_mode                               = -1;             /* (C) force setting PIT mode */
 int      fm_driver                              = 0;              /* (C) select FM sound driver */
@@ -238,6 +247,13 @@ int efscrnsz_y = SCREEN_RES_Y;
 
 static wchar_t mouse_msg[3][200];
 
+static char *savestate_exit_fn = NULL;
+
+/* Emulated frames run and host time taken since fast-forward was turned on.
+   Only the emulation thread touches these, or pc_close() once it has stopped. */
+static uint32_t ff_frames     = 0;
+static uint32_t ff_start_time = 0;
+
 static volatile atomic_int do_pause_ack = 0;
 static volatile atomic_int pause_ack = 0;
 
@@ -522,6 +538,7 @@ usage:
             printf("\nUsage: 86box [options] [cfg-file]\n\n");
             printf("Valid options are:\n\n");
             printf("-? or --help            - show this information\n");
+            printf("-B or --loadstate path  - restore the machine state snapshot 'path'\n");
             printf("-C or --config path     - set 'path' to be config file\n");
 #ifdef _WIN32
             printf("-D or --debug           - force debug output logging\n");
@@ -529,6 +546,7 @@ usage:
 #if 0
             printf("-E or --nographic       - forces the old behavior\n");
 #endif
+            printf("-A or --fastforward     - start in fast-forward mode\n");
             printf("-F or --fullscreen      - start in fullscreen mode\n");
             printf("-G or --lang langid     - start with specified language (e.g. en-US, or system)\n");
 #ifdef _WIN32
@@ -542,15 +560,22 @@ usage:
             printf("-L or --logfile path    - set 'path' to be the logfile\n");
             printf("-M or --missing         - dump missing machines and video cards\n");
             printf("-N or --noconfirm       - do not ask for confirmation on quit\n");
+            printf("-O or --record path     - record the session's input to 'path' for replaying\n");
             printf("-P or --vmpath path     - set 'path' to be root for vm\n");
+            printf("-Q or --checkpoint s,p  - save a snapshot every s seconds to p-NNNN.86s\n");
             printf("-R or --rompath path    - set 'path' to be ROM path\n");
-#ifndef USE_SDL_UI
+#if !defined(USE_SDL_UI) && !defined(USE_HEADLESS)
             printf("-S or --settings        - show only the settings dialog\n");
 #endif
+            printf("-U or --replay path     - replay the session recorded to 'path'\n");
             printf("-V or --vmname name     - overrides the name of the running VM\n");
+            printf("-W or --savestate path  - save a machine state snapshot to 'path' on exit\n");
             printf("-X or --clear what      - clears the 'what' (cmos/flash/both)\n");
             printf("-Y or --donothing       - do not show any UI or run the emulation\n");
             printf("-Z or --lastvmpath      - the last parameter is VM path rather than config\n");
+            printf("--benchmark s[,p]       - run s emulated seconds unthrottled and write a report to p\n");
+            printf("--forcestate path       - restore 'path' even if it lacks the state of some devices\n");
+            printf("--perfstats             - show the performance counters in the title bar\n");
             printf("\nA config file can be specified. If none is, the default file will be used.\n");
             return 0;
         } else if (!strcasecmp(argv[c], "--lastvmpath") || !strcasecmp(argv[c], "-Z")) {
@@ -568,6 +593,8 @@ usage:
 #endif
         } else if (!strcasecmp(argv[c], "--fullscreen") || !strcasecmp(argv[c], "-F")) {
             start_in_fullscreen = 1;
+        } else if (!strcasecmp(argv[c], "--fastforward") || !strcasecmp(argv[c], "-A")) {
+            fast_forward = 1;
         } else if (!strcasecmp(argv[c], "--logfile") || !strcasecmp(argv[c], "-L")) {
             if ((c + 1) == argc)
                 goto usage;
@@ -584,6 +611,45 @@ usage:
 
             rpath = argv[++c];
             rom_add_path(rpath);
+        } else if (!strcasecmp(argv[c], "--loadstate") || !strcasecmp(argv[c], "-B")) {
+            if ((c + 1) == argc)
+                goto usage;
+
+            savestate_request_load(argv[++c], 0);
+        } else if (!strcasecmp(argv[c], "--forcestate")) {
+            if ((c + 1) == argc)
+                goto usage;
+
+            savestate_request_load(argv[++c], 1);
+        } else if (!strcasecmp(argv[c], "--savestate") || !strcasecmp(argv[c], "-W")) {
+            if ((c + 1) == argc)
+                goto usage;
+
+            savestate_exit_fn = argv[++c];
+        } else if (!strcasecmp(argv[c], "--record") || !strcasecmp(argv[c], "-O")) {
+            if ((c + 1) == argc)
+                goto usage;
+
+            replay_set_record(argv[++c]);
+        } else if (!strcasecmp(argv[c], "--replay") || !strcasecmp(argv[c], "-U")) {
+            if ((c + 1) == argc)
+                goto usage;
+
+            replay_set_play(argv[++c]);
+        } else if (!strcasecmp(argv[c], "--checkpoint") || !strcasecmp(argv[c], "-Q")) {
+            if ((c + 1) == argc || (strchr(argv[c + 1], ',') == NULL) || (atoi(argv[c + 1]) <= 0))
+                goto usage;
+
+            c++;
+            savestate_checkpoint_start(strchr(argv[c], ',') + 1, (uint32_t) atoi(argv[c]) * 1000);
+        } else if (!strcasecmp(argv[c], "--perfstats")) {
+            perf_stats              = 1;
+            machine_counters_timers = 1;
+        } else if (!strcasecmp(argv[c], "--benchmark")) {
+            if (((c + 1) == argc) || !bench_set(argv[c + 1]))
+                goto usage;
+
+            c++;
         } else if (!strcasecmp(argv[c], "--config") || !strcasecmp(argv[c], "-C")) {
             if ((c + 1) == argc || plat_dir_check(argv[c + 1]))
                 goto usage;
@@ -613,7 +679,7 @@ usage:
                 goto usage;
 
             strcpy(vm_name, argv[++c]);
-#ifndef USE_SDL_UI
+#if !defined(USE_SDL_UI) && !defined(USE_HEADLESS)
         } else if (!strcasecmp(argv[c], "--settings") || !strcasecmp(argv[c], "-S")) {
             settings_only = 1;
 #endif
@@ -1002,6 +1068,8 @@ pc_init_modules(void)
     atfullspeed = 0;
 
     random_init();
+    replay_init();
+    bench_init();
 
     mem_init();
 
@@ -1301,6 +1369,23 @@ pc_reset_hard(void)
     hard_reset_pending = 1;
 }
 
+/* Logs the speed-up of a fast-forward run once it is over. Every frame runs
+   10 ms of emulated time, so it is easily worked out. */
+static void
+pc_fast_forward_done(void)
+{
+    uint32_t elapsed;
+
+    if (!ff_frames)
+        return;
+
+    elapsed = plat_get_ticks() - ff_start_time;
+    if (elapsed > 0)
+        pclog("Fast-forward ran %u ms of emulated time at %.2fx\n",
+              ff_frames * 10, ((double) ff_frames * 10.0) / (double) elapsed);
+    ff_frames = 0;
+}
+
 void
 pc_close(UNUSED(thread_t *ptr))
 {
@@ -1313,6 +1398,14 @@ pc_close(UNUSED(thread_t *ptr))
     /* Terminate the UI thread. */
     is_quit = 1;
 
+    if (savestate_exit_fn != NULL)
+        savestate_save(savestate_exit_fn);
+
+    replay_close();
+
+    pc_set_fast_forward(0);
+    pc_fast_forward_done();
+
     nvr_save();
 
     config_save();
@@ -1381,19 +1474,38 @@ ack_pause(void)
 void
 pc_run(void)
 {
-    int     mouse_msg_idx;
-    wchar_t temp[200];
+    int      mouse_msg_idx;
+    wchar_t  temp[400];
+    size_t   len;
+    uint64_t exec_start;
 
     /* Trigger a hard reset if one is pending. */
-    if (hard_reset_pending) {
+    if (replay_hard_reset(hard_reset_pending)) {
         hard_reset_pending = 0;
         pc_reset_hard_close();
         pc_reset_hard_init();
     }
 
+    /* Feed in the host input recorded or replayed at this point. */
+    replay_process();
+
+    /* Take or restore a snapshot if one was asked for. */
+    savestate_process();
+
+    /* Stop once a benchmark has run for long enough. */
+    if (bench_process())
+        return;
+
+    MTR_BEGIN("emu", "pc_run");
+
     /* Run a block of code. */
     startblit();
+    MTR_BEGIN("cpu", "cpu_exec");
+    exec_start = plat_get_nano_ticks();
     cpu_exec((int32_t) cpu_s->rspeed / 100);
+    machine_counters.cpu_ns += plat_get_nano_ticks() - exec_start;
+    machine_counters.slices++;
+    MTR_END("cpu", "cpu_exec");
     ack_pause();
 #ifdef USE_GDBSTUB /* avoid a KBC FIFO overflow when CPU emulation is stalled */
     if (gdbstub_step == GDBSTUB_EXEC) {
@@ -1408,6 +1520,10 @@ pc_run(void)
 
     /* Done with this frame, update statistics. */
     framecount++;
+    if (!fast_forward)
+        pc_fast_forward_done();
+    else if (!ff_frames++)
+        ff_start_time = plat_get_ticks();
     if (++framecountx >= 100) {
         framecountx = 0;
         frames      = 0;
@@ -1416,6 +1532,14 @@ pc_run(void)
     if (title_update) {
         mouse_msg_idx = ((mouse_type == MOUSE_TYPE_NONE) || (mouse_input_mode >= 1)) ? 2 : !!mouse_capture;
         swprintf(temp, sizeof_w(temp), mouse_msg[mouse_msg_idx], fps);
+        if (perf_stats) {
+            len = wcslen(temp);
+            swprintf(temp + len, sizeof_w(temp) - len,
+                     L" - %.1f MIPS, CPU %.0f%%, timers %.0f%%, audio %.0f%%, render %.0f%%, blit wait %.0f%%, blocks %.0f%% hit, %llu underruns",
+                     machine_rates.mips, machine_rates.cpu, machine_rates.timers, machine_rates.audio,
+                     machine_rates.render, machine_rates.blit_wait, machine_rates.block_hit,
+                     (unsigned long long) machine_rates.audio_underruns);
+        }
 #ifdef __APPLE__
         /* Needed due to modifying the UI on the non-main thread is a big no-no. */
         dispatch_async_f(dispatch_get_main_queue(), wcsdup((const wchar_t *) temp), _ui_window_title);
@@ -1424,6 +1548,16 @@ pc_run(void)
 #endif
         title_update = 0;
     }
+
+    MTR_END("emu", "pc_run");
+}
+
+/* Can be called from any thread. The emulation thread notices the change on
+   its next frame and does the bookkeeping. */
+void
+pc_set_fast_forward(int on)
+{
+    fast_forward = !!on;
 }
 
 /* Handler for the 1-second timer to refresh the window title. */
@@ -1433,6 +1567,8 @@ pc_onesec(void)
     fps        = framecount;
     framecount = 0;
 
+    machine_counters_update();
+
     title_update = 1;
 }
 
@@ -0,0 +1,260 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Whole-system benchmark.
+ *
+ *          Runs the configured machine unthrottled for a given number
+ *          of emulated seconds, or until the guest asks the unit tester
+ *          to exit, then writes a JSON report and powers off.
+ *
+ *          To make runs comparable, everything the machine would take
+ *          from the host is pinned down: random numbers come from a
+ *          fixed seed, the RTC is set from a fixed date and the NVR is
+ *          not saved, so every run starts from the same CMOS contents.
+ *          Disk images written to by the guest and host input, such as
+ *          network traffic, are not; benchmark guests should avoid both.
+ *
+ *          The counts in the report only depend on the emulated machine
+ *          and are expected to be identical from run to run; the host
+ *          times are what is being measured.
+ *
+ *
+ *
+ */
+#ifdef _WIN32
+#    include <windows.h>
+#else
+#    include <sys/resource.h>
+#    include <sys/time.h>
+#endif
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#define HAVE_STDARG_H
+#include <86box/86box.h>
+#include "cpu.h"
+#include <86box/machine.h>
+#include <86box/plat.h>
+#include <86box/random.h>
+#include <86box/replay.h>
+#include <86box/sound.h>
+#include <86box/video.h>
+#include <86box/bench.h>
+
+/* Each call to pc_run() emulates 10 ms. */
+#define BENCH_SLICES_PER_SEC 100
+
+typedef struct bench_counts_t {
+    uint64_t wall_ns;
+    uint64_t cpu_ns;
+    uint64_t ins_interp;
+    uint64_t ins_recomp;
+    uint64_t blocks_run;
+    uint64_t blocks_compiled;
+    uint64_t blocks_marked;
+    uint64_t frames;
+    uint64_t audio_buffers;
+} bench_counts_t;
+
+int bench_active = 0;
+
+static uint32_t       bench_seconds = 0;
+static char          *bench_fn      = NULL;
+static uint64_t       bench_slices;
+static int            bench_started;
+static int            bench_done;
+static int            bench_exit_code = -1;
+static bench_counts_t bench_start;
+
+/* Process CPU time of all threads, as the renderer and audio count too. */
+static uint64_t
+bench_cpu_time_ns(void)
+{
+#ifdef _WIN32
+    FILETIME       created;
+    FILETIME       exited;
+    FILETIME       kernel;
+    FILETIME       user;
+    ULARGE_INTEGER k;
+    ULARGE_INTEGER u;
+
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+        return 0;
+
+    k.LowPart  = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart  = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+
+    return (k.QuadPart + u.QuadPart) * 100ULL;
+#else
+    struct rusage ru;
+
+    if (getrusage(RUSAGE_SELF, &ru) != 0)
+        return 0;
+
+    return ((uint64_t) (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000000ULL) +
+           ((uint64_t) (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000ULL);
+#endif
+}
+
+static void
+bench_get_counts(bench_counts_t *bc)
+{
+    bc->wall_ns         = plat_get_nano_ticks();
+    bc->cpu_ns          = bench_cpu_time_ns();
+    bc->ins_interp      = cpu_ins_interp;
+    bc->ins_recomp      = cpu_ins_recomp;
+    bc->blocks_run      = cpu_blocks_run;
+    bc->blocks_compiled = cpu_blocks_compiled;
+    bc->blocks_marked   = cpu_blocks_marked;
+    bc->frames          = video_blit_count;
+    bc->audio_buffers   = sound_buffer_count;
+}
+
+static void
+bench_put_string(FILE *fp, const char *str)
+{
+    fputc('"', fp);
+    for (; *str != '\0'; str++) {
+        if ((*str == '"') || (*str == '\\'))
+            fprintf(fp, "\\%c", *str);
+        else if ((uint8_t) *str < 0x20)
+            fprintf(fp, "\\u%04x", (uint8_t) *str);
+        else
+            fputc(*str, fp);
+    }
+    fputc('"', fp);
+}
+
+static void
+bench_report(void)
+{
+    bench_counts_t end;
+    FILE          *fp;
+    double         emu_secs  = (double) bench_slices / BENCH_SLICES_PER_SEC;
+    double         wall_secs;
+    double         cpu_secs;
+    uint64_t       ins;
+
+    bench_get_counts(&end);
+    wall_secs = (double) (end.wall_ns - bench_start.wall_ns) / 1000000000.0;
+    cpu_secs  = (double) (end.cpu_ns - bench_start.cpu_ns) / 1000000000.0;
+    ins       = (end.ins_interp - bench_start.ins_interp) + (end.ins_recomp - bench_start.ins_recomp);
+
+    fp = stdout;
+    if (bench_fn != NULL) {
+        fp = plat_fopen(bench_fn, "w");
+        if (fp == NULL) {
+            pclog("BENCH: Unable to create \"%s\"\n", bench_fn);
+            fp = stdout;
+        }
+    }
+
+    fprintf(fp, "{\n  \"config\": ");
+    bench_put_string(fp, cfg_path);
+    fprintf(fp, ",\n  \"machine\": ");
+    bench_put_string(fp, machine_get_internal_name());
+    fprintf(fp, ",\n  \"cpu\": ");
+    bench_put_string(fp, cpu_f->internal_name);
+    fprintf(fp, ",\n  \"cpu_speed\": %u,\n", cpu_s->rspeed);
+    fprintf(fp, "  \"emulated_seconds\": %.2f,\n", emu_secs);
+    if (bench_exit_code >= 0)
+        fprintf(fp, "  \"guest_exit_code\": %i,\n", bench_exit_code);
+    else
+        fprintf(fp, "  \"guest_exit_code\": null,\n");
+    fprintf(fp, "  \"instructions\": %llu,\n", (unsigned long long) ins);
+    fprintf(fp, "  \"emulated_mips\": %.3f,\n", (emu_secs > 0.0) ? ((double) ins / emu_secs / 1000000.0) : 0.0);
+    fprintf(fp, "  \"frames\": %llu,\n", (unsigned long long) (end.frames - bench_start.frames));
+    fprintf(fp, "  \"audio_buffers\": %llu,\n", (unsigned long long) (end.audio_buffers - bench_start.audio_buffers));
+    fprintf(fp, "  \"dynarec\": {\n");
+    fprintf(fp, "    \"enabled\": %s,\n", cpu_use_dynarec ? "true" : "false");
+    fprintf(fp, "    \"interpreted_instructions\": %llu,\n", (unsigned long long) (end.ins_interp - bench_start.ins_interp));
+    fprintf(fp, "    \"compiled_instructions\": %llu,\n", (unsigned long long) (end.ins_recomp - bench_start.ins_recomp));
+    fprintf(fp, "    \"blocks_run\": %llu,\n", (unsigned long long) (end.blocks_run - bench_start.blocks_run));
+    fprintf(fp, "    \"blocks_compiled\": %llu,\n", (unsigned long long) (end.blocks_compiled - bench_start.blocks_compiled));
+    fprintf(fp, "    \"blocks_marked\": %llu\n", (unsigned long long) (end.blocks_marked - bench_start.blocks_marked));
+    fprintf(fp, "  },\n");
+    fprintf(fp, "  \"host_seconds\": %.3f,\n", wall_secs);
+    fprintf(fp, "  \"host_cpu_seconds\": %.3f,\n", cpu_secs);
+    fprintf(fp, "  \"host_cpu_per_emulated_second\": %.4f,\n", (emu_secs > 0.0) ? (cpu_secs / emu_secs) : 0.0);
+    fprintf(fp, "  \"speed_percent\": %.1f\n", (wall_secs > 0.0) ? (emu_secs * 100.0 / wall_secs) : 0.0);
+    fprintf(fp, "}\n");
+
+    if (fp != stdout)
+        fclose(fp);
+    else
+        fflush(fp);
+}
+
+int
+bench_set(const char *arg)
+{
+    const char *p = strchr(arg, ',');
+
+    if (atoi(arg) <= 0)
+        return 0;
+
+    bench_seconds = (uint32_t) atoi(arg);
+    if ((p != NULL) && (p[1] != '\0'))
+        bench_fn = strdup(p + 1);
+
+    return 1;
+}
+
+void
+bench_init(void)
+{
+    if (bench_seconds == 0)
+        return;
+
+    /* A replay brings its own seed. */
+    if (replay_mode == REPLAY_NONE)
+        random_set_seed(BENCH_SEED);
+
+    bench_active = 1;
+    pclog("BENCH: Running for %u emulated seconds\n", bench_seconds);
+}
+
+int
+bench_process(void)
+{
+    if (!bench_active)
+        return 0;
+
+    if (bench_done)
+        return 1;
+
+    if (!bench_started) {
+        bench_get_counts(&bench_start);
+        bench_started = 1;
+    }
+
+    if ((bench_slices >= ((uint64_t) bench_seconds * BENCH_SLICES_PER_SEC)) || (bench_exit_code >= 0)) {
+        bench_done = 1;
+        bench_report();
+        plat_power_off();
+        return 1;
+    }
+
+    bench_slices++;
+    return 0;
+}
+
+int
+bench_guest_exit(uint8_t code)
+{
+    if (!bench_active)
+        return 0;
+
+    bench_exit_code = code;
+    return 1;
+}
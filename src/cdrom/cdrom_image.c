@@ -34,6 +34,7 @@
 #include <86box/cdrom_image_backend.h>
 #include <86box/cdrom.h>
 #include <86box/cdrom_image.h>
+#include <minitrace/minitrace.h>
 
 #ifdef ENABLE_CDROM_IMAGE_LOG
 int cdrom_image_do_log = ENABLE_CDROM_IMAGE_LOG;
@@ -183,21 +184,30 @@ static int
 image_read_sector(struct cdrom *dev, int type, uint8_t *b, uint32_t lba)
 {
     cd_img_t *img = (cd_img_t *) dev->image;
+    int       ret;
 
+    MTR_BEGIN_I("cdrom", "image_read_sector", "lba", lba);
     switch (type) {
         case CD_READ_DATA:
-            return cdi_read_sector(img, b, 0, lba);
+            ret = cdi_read_sector(img, b, 0, lba);
+            break;
         case CD_READ_AUDIO:
-            return cdi_read_sector(img, b, 1, lba);
+            ret = cdi_read_sector(img, b, 1, lba);
+            break;
         case CD_READ_RAW:
             if (cdi_get_sector_size(img, lba) == 2352)
-                return cdi_read_sector(img, b, 1, lba);
+                ret = cdi_read_sector(img, b, 1, lba);
             else
-                return cdi_read_sector_sub(img, b, lba);
+                ret = cdi_read_sector_sub(img, b, lba);
+            break;
         default:
             cdrom_image_log("CD-ROM %i: Unknown CD read type\n", dev->id);
-            return 0;
+            ret = 0;
+            break;
     }
+    MTR_END("cdrom", "image_read_sector");
+
+    return ret;
 }
 
 static int
@@ -323,8 +323,10 @@ mem_write_emsb(uint32_t addr, uint8_t val, void *priv)
 
     addr = addr - page->virt + page->phys;
 
-    if (addr < (mem_size << 10))
+    if (addr < (mem_size << 10)) {
         ram[addr] = val;
+        mem_dirty_mark(addr);
+    }
 
     ct_82c100_log("mem_write_emsb(%08X = %08X, %02X)\n", old_addr, addr, val);
 }
@@ -339,8 +341,11 @@ mem_write_emsw(uint32_t addr, uint16_t val, void *priv)
 
     addr = addr - page->virt + page->phys;
 
-    if (addr < (mem_size << 10))
+    if (addr < (mem_size << 10)) {
         *(uint16_t *) &ram[addr] = val;
+        mem_dirty_mark(addr);
+        mem_dirty_mark(addr + 1);
+    }
 
     ct_82c100_log("mem_write_emsw(%08X = %08X, %04X)\n", old_addr, addr, val);
 }
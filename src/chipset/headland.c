@@ -554,8 +554,10 @@ mem_write_b(uint32_t addr, uint8_t val, void *priv)
     headland_t    *dev = mr->headland;
 
     addr = get_addr(dev, addr, mr);
-    if (addr < (mem_size << 10))
+    if (addr < (mem_size << 10)) {
         ram[addr] = val;
+        mem_dirty_mark(addr);
+    }
 }
 
 static void
@@ -565,8 +567,11 @@ mem_write_w(uint32_t addr, uint16_t val, void *priv)
     headland_t    *dev = mr->headland;
 
     addr = get_addr(dev, addr, mr);
-    if (addr < (mem_size << 10))
+    if (addr < (mem_size << 10)) {
         *(uint16_t *) &ram[addr] = val;
+        mem_dirty_mark(addr);
+        mem_dirty_mark(addr + 1);
+    }
 }
 
 static void
@@ -576,8 +581,11 @@ mem_write_l(uint32_t addr, uint32_t val, void *priv)
     headland_t    *dev = mr->headland;
 
     addr = get_addr(dev, addr, mr);
-    if (addr < (mem_size << 10))
+    if (addr < (mem_size << 10)) {
         *(uint32_t *) &ram[addr] = val;
+        mem_dirty_mark(addr);
+        mem_dirty_mark(addr + 3);
+    }
 }
 
 static void
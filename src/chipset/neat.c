@@ -277,6 +277,7 @@ ems_writeb(uint32_t addr, uint8_t val, void *priv)
 
     /* Write the data. */
     *(uint8_t *) (dev->ems[(addr & 0xffff) >> 14].addr + (addr & 0x3fff)) = val;
+    mem_dirty_mark_host(dev->ems[(addr & 0xffff) >> 14].addr + (addr & 0x3fff));
 }
 
 /* Write one word to paged RAM. */
@@ -287,6 +288,8 @@ ems_writew(uint32_t addr, uint16_t val, void *priv)
 
     /* Write the data. */
     *(uint16_t *) (dev->ems[(addr & 0xffff) >> 14].addr + (addr & 0x3fff)) = val;
+    mem_dirty_mark_host(dev->ems[(addr & 0xffff) >> 14].addr + (addr & 0x3fff));
+    mem_dirty_mark_host(dev->ems[(addr & 0xffff) >> 14].addr + (addr & 0x3fff) + 1);
 }
 
 /* Re-calculate the active-page physical address. */
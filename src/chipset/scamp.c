@@ -209,6 +209,7 @@ ram_mirrored_256k_in_4mi_write(uint32_t addr, uint8_t val, void *priv)
     }
 
     ram[addr + dev->ram_phys_base[bank]] = val;
+    mem_dirty_mark(addr + dev->ram_phys_base[bank]);
 }
 
 /*Read/write handlers for interleaved memory banks. We must keep CPU and ram array
@@ -273,6 +274,7 @@ ram_mirrored_interleaved_write(uint32_t addr, uint8_t val, void *priv)
     }
 
     ram[addr + dev->ram_phys_base[bank]] = val;
+    mem_dirty_mark(addr + dev->ram_phys_base[bank]);
 }
 
 static uint8_t
@@ -311,6 +313,7 @@ ram_mirrored_write(uint32_t addr, uint8_t val, void *priv)
     addr   = byte | (column << 1) | (row << dev->row_phys_shift[bank]);
 
     ram[addr + dev->ram_phys_base[bank]] = val;
+    mem_dirty_mark(addr + dev->ram_phys_base[bank]);
 }
 
 static void
@@ -591,6 +594,7 @@ scamp_ems_write(uint32_t addr, uint8_t val, void *priv)
 
     addr      = (addr & 0x3fff) | dev->mappings[segment];
     ram[addr] = val;
+    mem_dirty_mark(addr);
 }
 
 static void
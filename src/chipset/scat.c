@@ -1329,8 +1329,10 @@ mem_write_scatb(uint32_t addr, uint8_t val, void *priv)
             return;
     }
 
-    if (addr < ((uint32_t) mem_size << 10))
+    if (addr < ((uint32_t) mem_size << 10)) {
         ram[addr] = val;
+        mem_dirty_mark(addr);
+    }
 }
 
 static void
@@ -1348,8 +1350,11 @@ mem_write_scatw(uint32_t addr, uint16_t val, void *priv)
             return;
     }
 
-    if (addr < ((uint32_t) mem_size << 10))
+    if (addr < ((uint32_t) mem_size << 10)) {
         *(uint16_t *) &ram[addr] = val;
+        mem_dirty_mark(addr);
+        mem_dirty_mark(addr + 1);
+    }
 }
 
 static void
@@ -1367,8 +1372,11 @@ mem_write_scatl(uint32_t addr, uint32_t val, void *priv)
             return;
     }
 
-    if (addr < ((uint32_t) mem_size << 10))
+    if (addr < ((uint32_t) mem_size << 10)) {
         *(uint32_t *) &ram[addr] = val;
+        mem_dirty_mark(addr);
+        mem_dirty_mark(addr + 3);
+    }
 }
 
 static void
@@ -136,6 +136,12 @@ load_general(void)
     video_grayscale  = ini_section_get_int(cat, "video_grayscale", 0);
     video_graytype   = ini_section_get_int(cat, "video_graytype", 0);
 
+    video_dirty_lines   = !!ini_section_get_int(cat, "video_dirty_lines", 0);
+    video_render_thread = !!ini_section_get_int(cat, "video_render_thread", 0);
+    video_frameskip     = ini_section_get_int(cat, "video_frameskip", 0);
+    if (video_frameskip < 0)
+        video_frameskip = 0;
+
     rctrl_is_lalt = ini_section_get_int(cat, "rctrl_is_lalt", 0);
     update_icons  = ini_section_get_int(cat, "update_icons", 1);
 
@@ -175,6 +181,8 @@ load_general(void)
     confirm_exit  = ini_section_get_int(cat, "confirm_exit", 1);
     confirm_save  = ini_section_get_int(cat, "confirm_save", 1);
 
+    pace_to_audio = ini_section_get_int(cat, "pace_to_audio", 0);
+
     p = ini_section_get_string(cat, "language", NULL);
     if (p != NULL)
         lang_id = plat_language_code(p);
@@ -1720,6 +1728,21 @@ save_general(void)
     else
         ini_section_set_int(cat, "video_graytype", video_graytype);
 
+    if (video_dirty_lines == 0)
+        ini_section_delete_var(cat, "video_dirty_lines");
+    else
+        ini_section_set_int(cat, "video_dirty_lines", video_dirty_lines);
+
+    if (video_render_thread == 0)
+        ini_section_delete_var(cat, "video_render_thread");
+    else
+        ini_section_set_int(cat, "video_render_thread", video_render_thread);
+
+    if (video_frameskip == 0)
+        ini_section_delete_var(cat, "video_frameskip");
+    else
+        ini_section_set_int(cat, "video_frameskip", video_frameskip);
+
     if (rctrl_is_lalt == 0)
         ini_section_delete_var(cat, "rctrl_is_lalt");
     else
@@ -1776,6 +1799,11 @@ save_general(void)
     else
         ini_section_delete_var(cat, "confirm_save");
 
+    if (pace_to_audio != 0)
+        ini_section_set_int(cat, "pace_to_audio", pace_to_audio);
+    else
+        ini_section_delete_var(cat, "pace_to_audio");
+
     if (mouse_sensitivity != 1.0)
         ini_section_set_double(cat, "mouse_sensitivity", mouse_sensitivity);
     else
@@ -16,6 +16,7 @@
 #include "x86seg_common.h"
 #include "x87.h"
 #include <86box/nmi.h>
+#include <86box/io.h>
 #include <86box/mem.h>
 #include <86box/smram.h>
 #include <86box/pic.h>
@@ -1573,6 +1574,54 @@ checkio(uint32_t port, int mask)
     return mask;
 }
 
+/* Move a run of REP INS/OUTS elements between a port's block handler and guest
+   RAM in one go. Only the part of the run that lies in the current page and
+   within the segment is moved, so that a page fault on the next page is raised
+   by the regular per-element path with the registers already updated. Returns
+   the number of elements moved, or 0 if the caller has to do a single element
+   the regular way. */
+uint32_t
+rep_io_block(int out, uint16_t port, x86seg *seg, uint32_t offset, int addr_size, int width, uint32_t count)
+{
+    uint32_t  addr;
+    uint32_t  n;
+    uint64_t  limit;
+    uintptr_t lookup;
+
+    if ((count < 2) || (cpu_state.flags & D_FLAG) || (seg->base == 0xffffffff))
+        return 0;
+
+    /* Let the regular path do the I/O permission bitmap checks. */
+    if ((msw & 1) && ((CPL > IOPL) || (cpu_state.eflags & VM_FLAG)))
+        return 0;
+
+    addr = seg->base + offset;
+    if (addr & (width - 1))
+        return 0;
+
+    /* Only pages that the TLB maps straight to RAM with no code on them. */
+    lookup = out ? readlookup2[addr >> 12] : writelookup2[addr >> 12];
+    if (lookup == (uintptr_t) LOOKUP_INV)
+        return 0;
+
+    n = (0x1000 - (addr & 0xfff)) / width;
+    if (n > count)
+        n = count;
+
+    limit = (addr_size == 2) ? 0xffff : 0xffffffff;
+    if (seg->limit_high < limit)
+        limit = seg->limit_high;
+    if (((uint64_t) offset + ((uint64_t) n * width) - 1) > limit)
+        n = (uint32_t) ((limit - offset + 1) / width);
+    if (n < 2)
+        return 0;
+
+    if (out)
+        return io_outblock(port, (uint8_t *) (lookup + addr), width, n);
+
+    return io_inblock(port, (uint8_t *) (lookup + addr), width, n);
+}
+
 #ifdef OLD_DIVEXCP
 #    define divexcp()                                                                       \
         {                                                                                   \
@@ -129,6 +129,8 @@
 
 int checkio(uint32_t port, int mask);
 
+uint32_t rep_io_block(int out, uint16_t port, x86seg *seg, uint32_t offset, int addr_size, int width, uint32_t count);
+
 #define check_io_perm(port, size)                                    \
     if (msw & 1 && ((CPL > IOPL) || (cpu_state.eflags & VM_FLAG))) { \
         int tempi = checkio(port, (1 << size) - 1);                  \
@@ -29,6 +29,7 @@
 #include <86box/fdc.h>
 #include <86box/machine.h>
 #include <86box/gdbstub.h>
+#include <minitrace/minitrace.h>
 #ifdef USE_DYNAREC
 #    include "codegen.h"
 #    ifdef USE_NEW_DYNAREC
@@ -299,6 +300,7 @@ exec386_dynarec_int(void)
             trap = cpu_state.flags & T_FLAG;
 
             cpu_state.pc++;
+            cpu_ins_interp++;
             x86_opcodes[(opcode | cpu_state.op32) & 0x3ff](fetchdat);
         }
 
@@ -473,6 +475,8 @@ exec386_dynarec_dyn(void)
 #    ifndef USE_NEW_DYNAREC
         codeblock_hash[hash] = block;
 #    endif
+        cpu_blocks_run++;
+        cpu_ins_recomp += block->ins;
         inrecomp = 1;
         code();
 #    ifdef USE_ACYCS
@@ -500,8 +504,10 @@ exec386_dynarec_dyn(void)
             pthread_jit_write_protect_np(0);
         }
 #    endif
+        MTR_BEGIN_I("cpu", "block_compile", "phys", phys_addr);
         codegen_block_start_recompile(block);
         codegen_in_recompile = 1;
+        cpu_blocks_compiled++;
 
         while (!cpu_block_end) {
 #    ifndef USE_NEW_DYNAREC
@@ -525,6 +531,7 @@ exec386_dynarec_dyn(void)
                 fetchdat >>= 8;
 
                 cpu_state.pc++;
+                cpu_ins_interp++;
 
                 codegen_generate_call(opcode, x86_opcodes[(opcode | cpu_state.op32) & 0x3ff], fetchdat, cpu_state.pc, cpu_state.pc - 1);
 
@@ -581,6 +588,7 @@ exec386_dynarec_dyn(void)
             codegen_reset();
 
         codegen_in_recompile = 0;
+        MTR_END("cpu", "block_compile");
 #    if defined(__APPLE__) && defined(__aarch64__)
         if (__builtin_available(macOS 11.0, *)) {
             pthread_jit_write_protect_np(1);
@@ -599,6 +607,7 @@ exec386_dynarec_dyn(void)
         x86_was_reset = 0;
 
         codegen_block_init(phys_addr);
+        cpu_blocks_marked++;
 
         while (!cpu_block_end) {
 #    ifndef USE_NEW_DYNAREC
@@ -624,6 +633,7 @@ exec386_dynarec_dyn(void)
                 fetchdat >>= 8;
 
                 cpu_state.pc++;
+                cpu_ins_interp++;
 
                 x86_opcodes[(opcode | cpu_state.op32) & 0x3ff](fetchdat);
 
@@ -702,8 +712,21 @@ exec386_dynarec(int32_t cycs)
     cycles_main += cycs;
     while (cycles_main > 0) {
         int32_t cycles_start;
+        int32_t cyc_slice = cyc_period;
+
+        /* With no interrupt, NMI or SMI pending, nothing can need attention
+           before the next timer deadline, so run up to it (bounded by what
+           is left of this call) in one slice. Blocks still check for events
+           as they end, so anything raised during the slice is taken at the
+           next block boundary just as before. */
+        if (!smi_line && !(nmi && nmi_enable && nmi_mask) && !((cpu_state.flags & I_FLAG) && pic.int_pending)) {
+            int32_t to_target = (int32_t) (timer_target - (uint32_t) tsc);
+
+            if (to_target > cyc_slice)
+                cyc_slice = (to_target < cycles_main) ? to_target : cycles_main;
+        }
 
-        cycles += cyc_period;
+        cycles += cyc_slice;
         cycles_start = cycles;
 
         while (cycles > 0) {
@@ -854,6 +877,7 @@ exec386(int32_t cycs)
                 trap = cpu_state.flags & T_FLAG;
 
                 cpu_state.pc++;
+                cpu_ins_interp++;
                 x86_opcodes[(opcode | cpu_state.op32) & 0x3ff](fetchdat);
                 if (x86_was_reset)
                     break;
@@ -1683,6 +1683,7 @@ execx86(int cycs)
         clock_start();
 
         if (!repeating) {
+            cpu_ins_interp++;
             cpu_state.oldpc = cpu_state.pc;
             opcode          = pfq_fetchb();
             handled         = 0;
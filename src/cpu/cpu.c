@@ -33,11 +33,13 @@
 #include <86box/machine.h>
 #include <86box/io.h>
 #include "x86_ops.h"
+#include "x86.h"
 #include "x86seg_common.h"
 #include <86box/mem.h>
 #include <86box/nmi.h>
 #include <86box/pic.h>
 #include <86box/pci.h>
+#include <86box/savestate.h>
 #include <86box/gdbstub.h>
 #include <86box/plat_fallthrough.h>
 #include <86box/plat_unused.h>
@@ -247,6 +249,14 @@ uint64_t cpu_CR4_mask;
 uint64_t tsc    = 0;
 uint64_t pmc[2] = { 0, 0 };
 
+/* Work done since startup, for the benchmark report. Compiled blocks count
+   every instruction they were built from, even when they exit early. */
+uint64_t cpu_ins_interp      = 0;
+uint64_t cpu_ins_recomp      = 0;
+uint64_t cpu_blocks_run      = 0;
+uint64_t cpu_blocks_compiled = 0;
+uint64_t cpu_blocks_marked   = 0;
+
 double cpu_dmulti;
 double cpu_busspeed;
 
@@ -3665,3 +3675,88 @@ cpu_update_waitstates(void)
     if (cpu_s->rspeed <= 8000000)
         cpu_rom_prefetch_cycles = cpu_mem_prefetch_cycles;
 }
+
+void
+cpu_save(savestate_t *state)
+{
+    savestate_write(state, &cpu_state, sizeof(cpu_state));
+    savestate_write(state, &fpu_state, sizeof(fpu_state));
+    savestate_write(state, &msr, sizeof(msr));
+
+    savestate_write_u32(state, cr2);
+    savestate_write_u32(state, cr3);
+    savestate_write_u32(state, cr4);
+    savestate_write(state, dr, sizeof(dr));
+    savestate_write(state, &gdt, sizeof(x86seg));
+    savestate_write(state, &ldt, sizeof(x86seg));
+    savestate_write(state, &idt, sizeof(x86seg));
+    savestate_write(state, &tr, sizeof(x86seg));
+
+    savestate_write_u32(state, cpu_cur_status);
+    savestate_write_u32(state, use32);
+    savestate_write_u8(state, stack32);
+    savestate_write_u8(state, nmi);
+    savestate_write_u8(state, nmi_mask);
+    savestate_write_u8(state, nmi_enable);
+    /* in_smm, smbase and smi_line live in cpu_state; the rest of SMM is here. */
+    savestate_write_u8(state, smi_latched);
+    savestate_write_u8(state, smm_in_hlt);
+    savestate_write_u8(state, smi_block);
+    savestate_write_u8(state, unmask_a20_in_smm);
+    savestate_write_u8(state, in_sys);
+
+    /* Caches and the other model-specific state the guest can see. */
+    savestate_write_u8(state, cpu_cache_int_enabled);
+    savestate_write_u8(state, cpu_cache_ext_enabled);
+    savestate_write(state, _cache, sizeof(_cache));
+    savestate_write_u32(state, cache_index);
+    savestate_write(state, &cyrix, sizeof(cyrix));
+    savestate_write(state, pmc, sizeof(pmc));
+    savestate_write_u16(state, cpu_fast_off_count);
+    savestate_write_u16(state, cpu_fast_off_val);
+    savestate_write_u32(state, cpu_fast_off_flags);
+}
+
+void
+cpu_load(savestate_t *state)
+{
+    savestate_read(state, &cpu_state, sizeof(cpu_state));
+    savestate_read(state, &fpu_state, sizeof(fpu_state));
+    savestate_read(state, &msr, sizeof(msr));
+    cpu_state.ea_seg = &cpu_state.seg_ds;
+
+    cr2 = savestate_read_u32(state);
+    cr3 = savestate_read_u32(state);
+    cr4 = savestate_read_u32(state);
+    savestate_read(state, dr, sizeof(dr));
+    savestate_read(state, &gdt, sizeof(x86seg));
+    savestate_read(state, &ldt, sizeof(x86seg));
+    savestate_read(state, &idt, sizeof(x86seg));
+    savestate_read(state, &tr, sizeof(x86seg));
+
+    cpu_cur_status    = savestate_read_u32(state);
+    use32             = savestate_read_u32(state);
+    stack32           = savestate_read_u8(state);
+    nmi               = savestate_read_u8(state);
+    nmi_mask          = savestate_read_u8(state);
+    nmi_enable        = savestate_read_u8(state);
+    smi_latched       = savestate_read_u8(state);
+    smm_in_hlt        = savestate_read_u8(state);
+    smi_block         = savestate_read_u8(state);
+    unmask_a20_in_smm = savestate_read_u8(state);
+    in_sys            = savestate_read_u8(state);
+
+    cpu_cache_int_enabled = savestate_read_u8(state);
+    cpu_cache_ext_enabled = savestate_read_u8(state);
+    savestate_read(state, _cache, sizeof(_cache));
+    cache_index = savestate_read_u32(state);
+    savestate_read(state, &cyrix, sizeof(cyrix));
+    savestate_read(state, pmc, sizeof(pmc));
+    cpu_fast_off_count = savestate_read_u16(state);
+    cpu_fast_off_val   = savestate_read_u16(state);
+    cpu_fast_off_flags = savestate_read_u32(state);
+
+    /* The TLB and translated code are rebuilt from the restored state. */
+    cpu_update_waitstates();
+    flushmmucache();
+}
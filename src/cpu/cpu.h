@@ -608,6 +608,11 @@ extern double   isa_timing;
 extern double   pci_timing;
 extern double   agp_timing;
 extern uint64_t pmc[2];
+extern uint64_t cpu_ins_interp;
+extern uint64_t cpu_ins_recomp;
+extern uint64_t cpu_blocks_run;
+extern uint64_t cpu_blocks_compiled;
+extern uint64_t cpu_blocks_marked;
 extern uint16_t temp_seg_data[4];
 extern uint16_t cs_msr;
 extern uint32_t esp_msr;
@@ -722,6 +727,10 @@ extern int cpu_has_feature(int feature);
 extern char *cpu_current_pc(char *bufp);
 
 extern void cpu_update_waitstates(void);
+#ifdef EMU_SAVESTATE_H
+extern void cpu_save(savestate_t *state);
+extern void cpu_load(savestate_t *state);
+#endif
 extern void cpu_set(void);
 extern void cpu_close(void);
 extern void cpu_set_isa_speed(int speed);
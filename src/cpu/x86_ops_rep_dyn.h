@@ -5,25 +5,30 @@
                                                                                                                   \
         if (CNT_REG > 0) {                                                                                        \
             uint8_t temp;                                                                                         \
+            uint32_t blk;                                                                                         \
                                                                                                                   \
             SEG_CHECK_WRITE(&cpu_state.seg_es);                                                                   \
             check_io_perm(DX, 1);                                                                                 \
             CHECK_WRITE(&cpu_state.seg_es, DEST_REG, DEST_REG);                                                   \
-            high_page = 0;                                                                                        \
-            do_mmut_wb(es, DEST_REG, &addr64);                                                                    \
-            if (cpu_state.abrt)                                                                                   \
-                return 1;                                                                                         \
-            temp = inb(DX);                                                                                       \
-            writememb_n(es, DEST_REG, addr64, temp);                                                              \
-            if (cpu_state.abrt)                                                                                   \
-                return 1;                                                                                         \
+            blk = rep_io_block(0, DX, &cpu_state.seg_es, DEST_REG, sizeof(DEST_REG), 1, CNT_REG);                 \
+            if (!blk) {                                                                                           \
+                high_page = 0;                                                                                    \
+                do_mmut_wb(es, DEST_REG, &addr64);                                                                \
+                if (cpu_state.abrt)                                                                               \
+                    return 1;                                                                                     \
+                temp = inb(DX);                                                                                   \
+                writememb_n(es, DEST_REG, addr64, temp);                                                          \
+                if (cpu_state.abrt)                                                                               \
+                    return 1;                                                                                     \
+                blk = 1;                                                                                          \
+            }                                                                                                     \
                                                                                                                   \
             if (cpu_state.flags & D_FLAG)                                                                         \
-                DEST_REG--;                                                                                       \
+                DEST_REG -= blk;                                                                                  \
             else                                                                                                  \
-                DEST_REG++;                                                                                       \
-            CNT_REG--;                                                                                            \
-            cycles -= 15;                                                                                         \
+                DEST_REG += blk;                                                                                  \
+            CNT_REG -= blk;                                                                                       \
+            cycles -= 15 * blk;                                                                                   \
         }                                                                                                         \
         if (CNT_REG > 0) {                                                                                        \
             CPU_BLOCK_END();                                                                                      \
@@ -38,25 +43,30 @@
                                                                                                                   \
         if (CNT_REG > 0) {                                                                                        \
             uint16_t temp;                                                                                        \
+            uint32_t blk;                                                                                         \
                                                                                                                   \
             SEG_CHECK_WRITE(&cpu_state.seg_es);                                                                   \
             check_io_perm(DX, 2);                                                                                 \
             CHECK_WRITE(&cpu_state.seg_es, DEST_REG, DEST_REG + 1UL);                                             \
-            high_page = 0;                                                                                        \
-            do_mmut_ww(es, DEST_REG, addr64a);                                                                    \
-            if (cpu_state.abrt)                                                                                   \
-                return 1;                                                                                         \
-            temp = inw(DX);                                                                                       \
-            writememw_n(es, DEST_REG, addr64a, temp);                                                             \
-            if (cpu_state.abrt)                                                                                   \
-                return 1;                                                                                         \
+            blk = rep_io_block(0, DX, &cpu_state.seg_es, DEST_REG, sizeof(DEST_REG), 2, CNT_REG);                 \
+            if (!blk) {                                                                                           \
+                high_page = 0;                                                                                    \
+                do_mmut_ww(es, DEST_REG, addr64a);                                                                \
+                if (cpu_state.abrt)                                                                               \
+                    return 1;                                                                                     \
+                temp = inw(DX);                                                                                   \
+                writememw_n(es, DEST_REG, addr64a, temp);                                                         \
+                if (cpu_state.abrt)                                                                               \
+                    return 1;                                                                                     \
+                blk = 1;                                                                                          \
+            }                                                                                                     \
                                                                                                                   \
             if (cpu_state.flags & D_FLAG)                                                                         \
-                DEST_REG -= 2;                                                                                    \
+                DEST_REG -= 2 * blk;                                                                              \
             else                                                                                                  \
-                DEST_REG += 2;                                                                                    \
-            CNT_REG--;                                                                                            \
-            cycles -= 15;                                                                                         \
+                DEST_REG += 2 * blk;                                                                              \
+            CNT_REG -= blk;                                                                                       \
+            cycles -= 15 * blk;                                                                                   \
         }                                                                                                         \
         if (CNT_REG > 0) {                                                                                        \
             CPU_BLOCK_END();                                                                                      \
@@ -71,25 +81,30 @@
                                                                                                                   \
         if (CNT_REG > 0) {                                                                                        \
             uint32_t temp;                                                                                        \
+            uint32_t blk;                                                                                         \
                                                                                                                   \
             SEG_CHECK_WRITE(&cpu_state.seg_es);                                                                   \
             check_io_perm(DX, 4);                                                                                 \
             CHECK_WRITE(&cpu_state.seg_es, DEST_REG, DEST_REG + 3UL);                                             \
-            high_page = 0;                                                                                        \
-            do_mmut_wl(es, DEST_REG, addr64a);                                                                    \
-            if (cpu_state.abrt)                                                                                   \
-                return 1;                                                                                         \
-            temp = inl(DX);                                                                                       \
-            writememl_n(es, DEST_REG, addr64a, temp);                                                             \
-            if (cpu_state.abrt)                                                                                   \
-                return 1;                                                                                         \
+            blk = rep_io_block(0, DX, &cpu_state.seg_es, DEST_REG, sizeof(DEST_REG), 4, CNT_REG);                 \
+            if (!blk) {                                                                                           \
+                high_page = 0;                                                                                    \
+                do_mmut_wl(es, DEST_REG, addr64a);                                                                \
+                if (cpu_state.abrt)                                                                               \
+                    return 1;                                                                                     \
+                temp = inl(DX);                                                                                   \
+                writememl_n(es, DEST_REG, addr64a, temp);                                                         \
+                if (cpu_state.abrt)                                                                               \
+                    return 1;                                                                                     \
+                blk = 1;                                                                                          \
+            }                                                                                                     \
                                                                                                                   \
             if (cpu_state.flags & D_FLAG)                                                                         \
-                DEST_REG -= 4;                                                                                    \
+                DEST_REG -= 4 * blk;                                                                              \
             else                                                                                                  \
-                DEST_REG += 4;                                                                                    \
-            CNT_REG--;                                                                                            \
-            cycles -= 15;                                                                                         \
+                DEST_REG += 4 * blk;                                                                              \
+            CNT_REG -= blk;                                                                                       \
+            cycles -= 15 * blk;                                                                                   \
         }                                                                                                         \
         if (CNT_REG > 0) {                                                                                        \
             CPU_BLOCK_END();                                                                                      \
@@ -103,19 +118,24 @@
     {                                                                                                             \
         if (CNT_REG > 0) {                                                                                        \
             uint8_t temp;                                                                                         \
+            uint32_t blk;                                                                                         \
             SEG_CHECK_READ(cpu_state.ea_seg);                                                                     \
             CHECK_READ(cpu_state.ea_seg, SRC_REG, SRC_REG);                                                       \
-            temp = readmemb(cpu_state.ea_seg->base, SRC_REG);                                                     \
-            if (cpu_state.abrt)                                                                                   \
-                return 1;                                                                                         \
-            check_io_perm(DX, 1);                                                                                 \
-            outb(DX, temp);                                                                                       \
+            blk = rep_io_block(1, DX, cpu_state.ea_seg, SRC_REG, sizeof(SRC_REG), 1, CNT_REG);                    \
+            if (!blk) {                                                                                           \
+                temp = readmemb(cpu_state.ea_seg->base, SRC_REG);                                                 \
+                if (cpu_state.abrt)                                                                               \
+                    return 1;                                                                                     \
+                check_io_perm(DX, 1);                                                                             \
+                outb(DX, temp);                                                                                   \
+                blk = 1;                                                                                          \
+            }                                                                                                     \
             if (cpu_state.flags & D_FLAG)                                                                         \
-                SRC_REG--;                                                                                        \
+                SRC_REG -= blk;                                                                                   \
             else                                                                                                  \
-                SRC_REG++;                                                                                        \
-            CNT_REG--;                                                                                            \
-            cycles -= 14;                                                                                         \
+                SRC_REG += blk;                                                                                   \
+            CNT_REG -= blk;                                                                                       \
+            cycles -= 14 * blk;                                                                                   \
         }                                                                                                         \
         if (CNT_REG > 0) {                                                                                        \
             CPU_BLOCK_END();                                                                                      \
@@ -128,19 +148,24 @@
     {                                                                                                             \
         if (CNT_REG > 0) {                                                                                        \
             uint16_t temp;                                                                                        \
+            uint32_t blk;                                                                                         \
             SEG_CHECK_READ(cpu_state.ea_seg);                                                                     \
             CHECK_READ(cpu_state.ea_seg, SRC_REG, SRC_REG + 1UL);                                                 \
-            temp = readmemw(cpu_state.ea_seg->base, SRC_REG);                                                     \
-            if (cpu_state.abrt)                                                                                   \
-                return 1;                                                                                         \
-            check_io_perm(DX, 2);                                                                                 \
-            outw(DX, temp);                                                                                       \
+            blk = rep_io_block(1, DX, cpu_state.ea_seg, SRC_REG, sizeof(SRC_REG), 2, CNT_REG);                    \
+            if (!blk) {                                                                                           \
+                temp = readmemw(cpu_state.ea_seg->base, SRC_REG);                                                 \
+                if (cpu_state.abrt)                                                                               \
+                    return 1;                                                                                     \
+                check_io_perm(DX, 2);                                                                             \
+                outw(DX, temp);                                                                                   \
+                blk = 1;                                                                                          \
+            }                                                                                                     \
             if (cpu_state.flags & D_FLAG)                                                                         \
-                SRC_REG -= 2;                                                                                     \
+                SRC_REG -= 2 * blk;                                                                               \
             else                                                                                                  \
-                SRC_REG += 2;                                                                                     \
-            CNT_REG--;                                                                                            \
-            cycles -= 14;                                                                                         \
+                SRC_REG += 2 * blk;                                                                               \
+            CNT_REG -= blk;                                                                                       \
+            cycles -= 14 * blk;                                                                                   \
         }                                                                                                         \
         if (CNT_REG > 0) {                                                                                        \
             CPU_BLOCK_END();                                                                                      \
@@ -153,19 +178,24 @@
     {                                                                                                             \
         if (CNT_REG > 0) {                                                                                        \
             uint32_t temp;                                                                                        \
+            uint32_t blk;                                                                                         \
             SEG_CHECK_READ(cpu_state.ea_seg);                                                                     \
             CHECK_READ(cpu_state.ea_seg, SRC_REG, SRC_REG + 3UL);                                                 \
-            temp = readmeml(cpu_state.ea_seg->base, SRC_REG);                                                     \
-            if (cpu_state.abrt)                                                                                   \
-                return 1;                                                                                         \
-            check_io_perm(DX, 4);                                                                                 \
-            outl(DX, temp);                                                                                       \
+            blk = rep_io_block(1, DX, cpu_state.ea_seg, SRC_REG, sizeof(SRC_REG), 4, CNT_REG);                    \
+            if (!blk) {                                                                                           \
+                temp = readmeml(cpu_state.ea_seg->base, SRC_REG);                                                 \
+                if (cpu_state.abrt)                                                                               \
+                    return 1;                                                                                     \
+                check_io_perm(DX, 4);                                                                             \
+                outl(DX, temp);                                                                                   \
+                blk = 1;                                                                                          \
+            }                                                                                                     \
             if (cpu_state.flags & D_FLAG)                                                                         \
-                SRC_REG -= 4;                                                                                     \
+                SRC_REG -= 4 * blk;                                                                               \
             else                                                                                                  \
-                SRC_REG += 4;                                                                                     \
-            CNT_REG--;                                                                                            \
-            cycles -= 14;                                                                                         \
+                SRC_REG += 4 * blk;                                                                               \
+            CNT_REG -= blk;                                                                                       \
+            cycles -= 14 * blk;                                                                                   \
         }                                                                                                         \
         if (CNT_REG > 0) {                                                                                        \
             CPU_BLOCK_END();                                                                                      \
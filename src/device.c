@@ -54,6 +54,7 @@
 #include <86box/machine.h>
 #include <86box/mem.h>
 #include <86box/rom.h>
+#include <86box/savestate.h>
 #include <86box/sound.h>
 
 #define DEVICE_MAX 256 /* max # of devices */
@@ -330,6 +331,80 @@ device_reset_all(uint32_t match_flags)
     }
 }
 
+/* Number of devices a snapshot taken now would have no state for. */
+int
+device_save_missing(void)
+{
+    int ret = 0;
+
+    for (uint16_t c = 0; c < DEVICE_MAX; c++) {
+        if ((devices[c] != NULL) && (devices[c]->save == NULL))
+            ret++;
+    }
+
+    return ret;
+}
+
+/* Devices without snapshot hooks keep whatever state they have when a
+   snapshot is loaded, so they are listed in it, for a forced load to warn
+   about. */
+void
+device_save_all(savestate_t *state)
+{
+    for (uint16_t c = 0; c < DEVICE_MAX; c++) {
+        if (devices[c] == NULL)
+            continue;
+
+        if (devices[c]->save == NULL) {
+            pclog("SAVESTATE: Device \"%s\" has no snapshot support, its state is not saved\n", devices[c]->name);
+            savestate_chunk_begin(state, SAVESTATE_TAG('D', 'E', 'V', 'S'));
+            savestate_write_u16(state, c);
+            savestate_write_string(state, devices[c]->internal_name);
+            savestate_chunk_end(state);
+            continue;
+        }
+
+        savestate_chunk_begin(state, SAVESTATE_TAG('D', 'E', 'V', ' '));
+        savestate_write_u16(state, c);
+        savestate_write_string(state, devices[c]->internal_name);
+        devices[c]->save(device_priv[c], state);
+        savestate_chunk_end(state);
+    }
+}
+
+/* Restore the device chunk that is currently open. The slot must hold the same
+   device it did when the snapshot was taken, which holds for a machine with
+   the same configuration. */
+int
+device_load_one(savestate_t *state)
+{
+    char     name[256];
+    uint16_t c = savestate_read_u16(state);
+
+    savestate_read_string(state, name, sizeof(name));
+
+    if ((c >= DEVICE_MAX) || (devices[c] == NULL) || (devices[c]->load == NULL) ||
+        (devices[c]->internal_name == NULL) || strcmp(devices[c]->internal_name, name)) {
+        device_log("Snapshot device \"%s\" in slot %i does not match this machine\n", name, c);
+        return 1;
+    }
+
+    return devices[c]->load(device_priv[c], state);
+}
+
+/* Warn about a device the snapshot could not save the state of. */
+void
+device_load_skipped(savestate_t *state)
+{
+    char     name[256];
+    uint16_t c = savestate_read_u16(state);
+
+    savestate_read_string(state, name, sizeof(name));
+
+    pclog("SAVESTATE: Device \"%s\" in slot %i has no snapshot support, it keeps its current state\n",
+          ((c < DEVICE_MAX) && (devices[c] != NULL)) ? devices[c]->name : name, c);
+}
+
 void *
 device_find_first_priv(uint32_t match_flags)
 {
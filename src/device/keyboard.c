@@ -25,6 +25,7 @@
 #include <86box/86box.h>
 #include <86box/machine.h>
 #include <86box/keyboard.h>
+#include <86box/replay.h>
 
 #include "cpu.h"
 
@@ -247,7 +248,17 @@ keyboard_input(int down, uint16_t scan)
     /* pclog("Received scan code: %03X (%s)\n", scan & 0x1ff, down ? "down" : "up"); */
     recv_key[scan & 0x1ff] = down;
 
-    key_process(scan & 0x1ff, down);
+    /* While a session is recorded or replayed, the keystroke reaches the
+       machine from the emulation thread, at a point that can be repeated. */
+    if (!replay_key_input(down, scan & 0x1ff))
+        key_process(scan & 0x1ff, down);
+}
+
+/* Handle a keystroke recorded or replayed by replay_process(). */
+void
+keyboard_input_replayed(int down, uint16_t scan)
+{
+    key_process(scan, down);
 }
 
 static uint8_t
@@ -35,6 +35,7 @@
 #include <86box/video.h>
 #include <86box/plat.h>
 #include <86box/plat_unused.h>
+#include <86box/replay.h>
 
 typedef struct mouse_t {
     const device_t *device;
@@ -107,6 +108,13 @@ static _Atomic double  mouse_y;
 static atomic_int      mouse_z;
 static atomic_int      mouse_buttons;
 
+/* While a session is recorded or replayed, host input collects here and only
+   reaches the emulated mouse through mouse_input_take()/mouse_input_put(). */
+static _Atomic double  mouse_pend_x;
+static _Atomic double  mouse_pend_y;
+static atomic_int      mouse_pend_z;
+static atomic_int      mouse_pend_buttons;
+
 static int             mouse_delta_b;
 static int             mouse_old_b;
 
@@ -419,25 +427,25 @@ atomic_double_add(_Atomic double *var, double val)
 void
 mouse_scale_fx(double x)
 {
-    atomic_double_add(&mouse_x, ((double) x) * mouse_sensitivity);
+    atomic_double_add(replay_mode ? &mouse_pend_x : &mouse_x, ((double) x) * mouse_sensitivity);
 }
 
 void
 mouse_scale_fy(double y)
 {
-    atomic_double_add(&mouse_y, ((double) y) * mouse_sensitivity);
+    atomic_double_add(replay_mode ? &mouse_pend_y : &mouse_y, ((double) y) * mouse_sensitivity);
 }
 
 void
 mouse_scale_x(int x)
 {
-    atomic_double_add(&mouse_x, ((double) x) * mouse_sensitivity);
+    atomic_double_add(replay_mode ? &mouse_pend_x : &mouse_x, ((double) x) * mouse_sensitivity);
 }
 
 void
 mouse_scale_y(int y)
 {
-    atomic_double_add(&mouse_y, ((double) y) * mouse_sensitivity);
+    atomic_double_add(replay_mode ? &mouse_pend_y : &mouse_y, ((double) y) * mouse_sensitivity);
 }
 
 void
@@ -466,7 +474,7 @@ mouse_scale_axis(int axis, int val)
 void
 mouse_set_z(int z)
 {
-    atomic_fetch_add(&mouse_z, z);
+    atomic_fetch_add(replay_mode ? &mouse_pend_z : &mouse_z, z);
 }
 
 void
@@ -498,7 +506,7 @@ mouse_subtract_z(int *delta_z, int min, int max, int invert)
 void
 mouse_set_buttons_ex(int b)
 {
-    atomic_store(&mouse_buttons, b);
+    atomic_store(replay_mode ? &mouse_pend_buttons : &mouse_buttons, b);
 }
 
 int
@@ -507,6 +515,26 @@ mouse_get_buttons_ex(void)
     return atomic_load(&mouse_buttons);
 }
 
+/* Collects the host input gathered since the last call. */
+void
+mouse_input_take(double *x, double *y, int *z, int *b)
+{
+    *x = atomic_exchange(&mouse_pend_x, 0.0);
+    *y = atomic_exchange(&mouse_pend_y, 0.0);
+    *z = atomic_exchange(&mouse_pend_z, 0);
+    *b = atomic_load(&mouse_pend_buttons);
+}
+
+/* Hands recorded or replayed input to the emulated mouse. */
+void
+mouse_input_put(double x, double y, int z, int b)
+{
+    atomic_double_add(&mouse_x, x);
+    atomic_double_add(&mouse_y, y);
+    atomic_fetch_add(&mouse_z, z);
+    atomic_store(&mouse_buttons, b);
+}
+
 void
 mouse_set_sample_rate(double new_rate)
 {
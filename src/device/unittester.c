@@ -30,6 +30,7 @@
 #include <86box/plat.h>
 #include <86box/unittester.h>
 #include <86box/video.h>
+#include <86box/bench.h>
 
 enum fsm1_value {
     UT_FSM1_WAIT_8,
@@ -295,7 +296,10 @@ unittester_write(uint16_t port, uint8_t val, UNUSED(void *priv))
                     unittester_log("[UT] Exit received - code = %02X\n", unittester.exit_code);
 
                     /* CHECK: Do we actually exit? */
-                    if (unittester_exit_enabled) {
+                    if (bench_guest_exit(unittester.exit_code)) {
+                        /* A benchmark ends here instead, and reports the code. */
+                        unittester_log("[UT] Ending the benchmark with code %02X\n", unittester.exit_code);
+                    } else if (unittester_exit_enabled) {
                         /* Yes - call exit! */
                         /* Clamp exit code */
                         if (unittester.exit_code > 0x7F)
@@ -2076,6 +2076,96 @@ ide_readl(uint16_t addr, void *priv)
     return ret;
 }
 
+/* Number of data bytes that can be moved before the transfer reaches a sector or DRQ block boundary. */
+static int
+ide_data_room(ide_t *ide, int write)
+{
+    const scsi_common_t *dev = ide->sc;
+    int                  room;
+
+    if ((ide->type == IDE_NONE) || (ide->type & IDE_SHADOW) || !ide->buffer || (ide->tf->pos & 1))
+        return 0;
+
+    if (ide->command == WIN_PACKETCMD) {
+        if ((ide->type != IDE_ATAPI) || !dev || !dev->temp_buffer ||
+            (dev->packet_status != (write ? PHASE_DATA_OUT : PHASE_DATA_IN)))
+            return 0;
+
+        room = (int) dev->packet_len - (int) ide->tf->pos;
+        if (((int) dev->max_transfer_len - dev->request_pos) < room)
+            room = (int) dev->max_transfer_len - dev->request_pos;
+    } else
+        room = 512 - (int) ide->tf->pos;
+
+    return (room > 0) ? room : 0;
+}
+
+/* Block equivalent of len / 2 consecutive ide_read_data() or ide_write_data() calls. */
+static int
+ide_data_block(ide_t *ide, uint8_t *buf, int len, int width, int write)
+{
+    uint8_t *bufferb;
+    uint16_t val;
+    int      room = ide_data_room(ide, write);
+    int      n    = (len < room) ? len : room;
+    int      bulk;
+
+    n &= ~(width - 1);
+    if (n < 2)
+        return 0;
+
+    /* Leave the word that completes the transfer to the regular path, which
+       takes care of the end of sector or DRQ block. */
+    bulk = (n == room) ? (n - 2) : n;
+
+    if (ide->command == WIN_PACKETCMD)
+        bufferb = ide->sc->temp_buffer;
+    else
+        bufferb = (uint8_t *) ide->buffer;
+
+    if (write)
+        memcpy(bufferb + ide->tf->pos, buf, bulk);
+    else
+        memcpy(buf, bufferb + ide->tf->pos, bulk);
+    ide->tf->pos += bulk;
+    if (ide->command == WIN_PACKETCMD)
+        ide->sc->request_pos += bulk;
+
+    if (bulk < n) {
+        if (write)
+            ide_write_data(ide, buf[bulk] | (buf[bulk + 1] << 8), 2);
+        else {
+            val           = ide_read_data(ide, 2);
+            buf[bulk]     = val & 0xff;
+            buf[bulk + 1] = val >> 8;
+        }
+    }
+
+    return n;
+}
+
+int
+ide_readblk(uint16_t addr, uint8_t *buf, int width, int count, void *priv)
+{
+    const ide_board_t *dev = (ide_board_t *) priv;
+
+    if (((addr & 0x7) != 0x0) || (width == 1) || ((width == 4) && !dev->bit32))
+        return 0;
+
+    return ide_data_block(ide_drives[dev->cur_dev], buf, count * width, width, 0) / width;
+}
+
+int
+ide_writeblk(uint16_t addr, const uint8_t *buf, int width, int count, void *priv)
+{
+    const ide_board_t *dev = (ide_board_t *) priv;
+
+    if (((addr & 0x7) != 0x0) || (width == 1) || ((width == 4) && !dev->bit32))
+        return 0;
+
+    return ide_data_block(ide_drives[dev->cur_dev], (uint8_t *) buf, count * width, width, 1) / width;
+}
+
 static void
 ide_board_callback(void *priv)
 {
@@ -2598,6 +2688,10 @@ ide_handlers(uint8_t board, int set)
                        ide_readb, ide_readw, ide_readl,
                        ide_writeb, ide_writew, ide_writel,
                        ide_boards[board]);
+            if (set)
+                io_setblockhandler(ide_boards[board]->base[0], 1,
+                                   ide_readblk, ide_writeblk,
+                                   ide_boards[board]);
         }
 
         if (ide_boards[board]->base[1]) {
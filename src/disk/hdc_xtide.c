@@ -129,6 +129,49 @@ xtide_read(uint16_t port, void *priv)
     return (tempw & 0xff);
 }
 
+/* Each byte of a string read from the data port is the low half of an IDE data word. */
+static int
+xtide_readblk(uint16_t port, uint8_t *buf, int width, int count, void *priv)
+{
+    xtide_t *xtide = (xtide_t *) priv;
+    uint8_t  words[1024];
+    int      n;
+
+    if (((port & 0xf) != 0x0) || (width != 1))
+        return 0;
+
+    if (count > 512)
+        count = 512;
+
+    n = ide_readblk(0x0, words, 2, count, xtide->ide_board);
+    for (int i = 0; i < n; i++)
+        buf[i] = words[i << 1];
+    if (n)
+        xtide->data_high = words[(n << 1) - 1];
+
+    return n;
+}
+
+static int
+xtide_writeblk(uint16_t port, const uint8_t *buf, int width, int count, void *priv)
+{
+    xtide_t *xtide = (xtide_t *) priv;
+    uint8_t  words[1024];
+
+    if (((port & 0xf) != 0x0) || (width != 1))
+        return 0;
+
+    if (count > 512)
+        count = 512;
+
+    for (int i = 0; i < count; i++) {
+        words[i << 1]       = buf[i];
+        words[(i << 1) + 1] = xtide->data_high;
+    }
+
+    return ide_writeblk(0x0, words, 2, count, xtide->ide_board);
+}
+
 static void *
 xtide_init(const device_t *info)
 {
@@ -149,6 +192,8 @@ xtide_init(const device_t *info)
     io_sethandler(0x0300, 16,
                   xtide_read, NULL, NULL,
                   xtide_write, NULL, NULL, xtide);
+    io_setblockhandler(0x0300, 1,
+                       xtide_readblk, xtide_writeblk, xtide);
 
     return xtide;
 }
@@ -212,6 +257,8 @@ xtide_acculogic_init(UNUSED(const device_t *info))
     io_sethandler(0x0360, 16,
                   xtide_read, NULL, NULL,
                   xtide_write, NULL, NULL, xtide);
+    io_setblockhandler(0x0360, 1,
+                       xtide_readblk, xtide_writeblk, xtide);
 
     return xtide;
 }
@@ -34,6 +34,7 @@
 #include <86box/hdd.h>
 #include "minivhd/minivhd.h"
 #include "minivhd/internal.h"
+#include <minitrace/minitrace.h>
 
 #define HDD_IMAGE_RAW 0
 #define HDD_IMAGE_HDI 1
@@ -506,18 +507,21 @@ hdd_image_read(uint8_t id, uint32_t sector, uint32_t count, uint8_t *buffer)
     int    non_transferred_sectors;
     size_t num_read;
 
+    MTR_BEGIN_I("disk", "hdd_image_read", "count", count);
     if (hdd_images[id].type == HDD_IMAGE_VHD) {
         non_transferred_sectors = mvhd_read_sectors(hdd_images[id].vhd, sector, count, buffer);
         hdd_images[id].pos      = sector + count - non_transferred_sectors - 1;
     } else {
         if (fseeko64(hdd_images[id].file, ((uint64_t) (sector) << 9LL) + hdd_images[id].base, SEEK_SET) == -1) {
             fatal("Hard disk image %i: Read error during seek\n", id);
+            MTR_END("disk", "hdd_image_read");
             return;
         }
 
         num_read           = fread(buffer, 512, count, hdd_images[id].file);
         hdd_images[id].pos = sector + num_read;
     }
+    MTR_END("disk", "hdd_image_read");
 }
 
 uint32_t
@@ -554,18 +558,21 @@ hdd_image_write(uint8_t id, uint32_t sector, uint32_t count, uint8_t *buffer)
     int    non_transferred_sectors;
     size_t num_write;
 
+    MTR_BEGIN_I("disk", "hdd_image_write", "count", count);
     if (hdd_images[id].type == HDD_IMAGE_VHD) {
         non_transferred_sectors = mvhd_write_sectors(hdd_images[id].vhd, sector, count, buffer);
         hdd_images[id].pos      = sector + count - non_transferred_sectors - 1;
     } else {
         if (fseeko64(hdd_images[id].file, ((uint64_t) (sector) << 9LL) + hdd_images[id].base, SEEK_SET) == -1) {
             fatal("Hard disk image %i: Write error during seek\n", id);
+            MTR_END("disk", "hdd_image_write");
             return;
         }
 
         num_write          = fwrite(buffer, 512, count, hdd_images[id].file);
         hdd_images[id].pos = sector + num_write;
     }
+    MTR_END("disk", "hdd_image_write");
 }
 
 int
@@ -28,6 +28,7 @@
 #include <86box/machine.h>
 #include <86box/mca.h>
 #include <86box/mem.h>
+#include <86box/savestate.h>
 #include <86box/io.h>
 #include <86box/pic.h>
 #include <86box/dma.h>
@@ -1093,6 +1094,45 @@ dma_reset(void)
     dma_at = is286;
 }
 
+void
+dma_save(savestate_t *state)
+{
+    savestate_write(state, dma, sizeof(dma));
+    savestate_write_u8(state, dma_e);
+    savestate_write_u8(state, dma_m);
+    savestate_write(state, dmaregs, sizeof(dmaregs));
+    savestate_write_u8(state, dma_wp[0]);
+    savestate_write_u8(state, dma_wp[1]);
+    savestate_write_u8(state, dma_stat);
+    savestate_write_u8(state, dma_stat_rq);
+    savestate_write_u8(state, dma_stat_rq_pc);
+    savestate_write(state, dma_command, sizeof(dma_command));
+    savestate_write_u8(state, dma_req_is_soft);
+    savestate_write_u32(state, dma_ps2.xfr_command);
+    savestate_write_u32(state, dma_ps2.xfr_channel);
+    savestate_write_u32(state, dma_ps2.byte_ptr);
+}
+
+void
+dma_load(savestate_t *state)
+{
+    savestate_read(state, dma, sizeof(dma));
+    dma_e = savestate_read_u8(state);
+    dma_m = savestate_read_u8(state);
+    savestate_read(state, dmaregs, sizeof(dmaregs));
+    dma_wp[0]       = savestate_read_u8(state);
+    dma_wp[1]       = savestate_read_u8(state);
+    dma_stat        = savestate_read_u8(state);
+    dma_stat_rq     = savestate_read_u8(state);
+    dma_stat_rq_pc  = savestate_read_u8(state);
+    savestate_read(state, dma_command, sizeof(dma_command));
+    dma_req_is_soft = savestate_read_u8(state);
+
+    dma_ps2.xfr_command = (int) savestate_read_u32(state);
+    dma_ps2.xfr_channel = (int) savestate_read_u32(state);
+    dma_ps2.byte_ptr    = (int) savestate_read_u32(state);
+}
+
 void
 dma_remove_sg(void)
 {
@@ -79,6 +79,8 @@ extern uint32_t lang_sys; /* (-) system language code */
 
 extern int dump_on_exit;        /* (O) dump regs on exit*/
 extern int start_in_fullscreen; /* (O) start in fullscreen */
+extern int fast_forward;        /* (O) run as fast as the host allows */
+extern int perf_stats;          /* (O) show the performance counters */
 #ifdef _WIN32
 extern int force_debug; /* (O) force debug output */
 #endif
@@ -143,6 +145,7 @@ extern int      hdd_format_type;            /* (C) hard disk file format */
 extern int      confirm_reset;              /* (C) enable reset confirmation */
 extern int      confirm_exit;               /* (C) enable exit confirmation */
 extern int      confirm_save;               /* (C) enable save confirmation */
+extern int      pace_to_audio;              /* (C) keep pacing in step with the audio output */
 extern int      enable_discord;             /* (C) enable Discord integration */
 
 extern int    fixed_size_x;
@@ -198,6 +201,7 @@ extern void pc_reset_hard_close(void);
 extern void pc_reset_hard_init(void);
 extern void pc_reset_hard(void);
 extern void pc_full_speed(void);
+extern void pc_set_fast_forward(int on);
 extern void pc_speed_changed(void);
 extern void pc_send_cad(void);
 extern void pc_send_cae(void);
@@ -0,0 +1,41 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          Definitions for the whole-system benchmark.
+ *
+ *
+ *
+ */
+#ifndef EMU_BENCH_H
+#define EMU_BENCH_H
+
+/* The host clock the RTC is set from during a benchmark, 2000-01-01. */
+#define BENCH_HOST_TIME 946684800LL
+#define BENCH_SEED      0x86b0c5edUL
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int bench_active;
+
+/* Set from the command line, "seconds[,report path]". */
+extern int bench_set(const char *arg);
+
+extern void bench_init(void);
+
+/* Called by the emulation thread before every block of code it runs,
+   returns non-zero once the benchmark is over. */
+extern int bench_process(void);
+
+/* The guest asked the unit tester to exit. */
+extern int bench_guest_exit(uint8_t code);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*EMU_BENCH_H*/
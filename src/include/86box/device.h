@@ -164,6 +164,8 @@ typedef struct _device_config_ {
     const device_config_bios_t      bios[32];
 } device_config_t;
 
+struct _savestate_;
+
 typedef struct _device_ {
     const char *name;
     const char *internal_name;
@@ -184,6 +186,10 @@ typedef struct _device_ {
     void (*force_redraw)(void *priv);
 
     const device_config_t *config;
+
+    /* Optional machine state snapshot hooks; load returns non-zero on error. */
+    void (*save)(void *priv, struct _savestate_ *state);
+    int (*load)(void *priv, struct _savestate_ *state);
 } device_t;
 
 typedef struct device_context_t {
@@ -219,6 +225,10 @@ extern void  device_cadd_inst_ex(const device_t *dev, const device_t *cd, void *
 extern void  device_cadd_inst_ex_parameters(const device_t *dev, const device_t *cd, void *priv, int inst, void *params);
 extern void  device_close_all(void);
 extern void  device_reset_all(uint32_t match_flags);
+extern int   device_save_missing(void);
+extern void  device_save_all(struct _savestate_ *state);
+extern int   device_load_one(struct _savestate_ *state);
+extern void  device_load_skipped(struct _savestate_ *state);
 extern void *device_find_first_priv(uint32_t match_flags);
 extern void *device_get_priv(const device_t *dev);
 extern int   device_available(const device_t *dev);
@@ -84,6 +84,10 @@ extern void dma_init(void);
 extern void dma16_init(void);
 extern void ps2_dma_init(void);
 extern void dma_reset(void);
+#ifdef EMU_SAVESTATE_H
+extern void dma_save(savestate_t *state);
+extern void dma_load(savestate_t *state);
+#endif
 extern int  dma_mode(int channel);
 
 extern void    readdma0(void);
@@ -196,6 +196,8 @@ extern void     ide_writeb(uint16_t addr, uint8_t val, void *priv);
 extern uint8_t  ide_readb(uint16_t addr, void *priv);
 extern uint8_t  ide_read_alt_status(uint16_t addr, void *priv);
 extern uint16_t ide_readw(uint16_t addr, void *priv);
+extern int      ide_readblk(uint16_t addr, uint8_t *buf, int width, int count, void *priv);
+extern int      ide_writeblk(uint16_t addr, const uint8_t *buf, int width, int count, void *priv);
 
 extern void ide_set_bus_master(int board,
                                int (*dma)(uint8_t *data, int transfer_length, int out, void *priv),
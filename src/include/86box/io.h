@@ -103,6 +103,14 @@ extern void io_handler_interleaved(int set, uint16_t base, int size,
                                    void (*outl)(uint16_t addr, uint32_t val, void *priv),
                                    void *priv);
 
+extern void io_setblockhandler(uint16_t base, int size,
+                               int (*inblk)(uint16_t addr, uint8_t *buf, int width, int count, void *priv),
+                               int (*outblk)(uint16_t addr, const uint8_t *buf, int width, int count, void *priv),
+                               void *priv);
+
+extern int io_inblock(uint16_t port, uint8_t *buf, int width, int count);
+extern int io_outblock(uint16_t port, const uint8_t *buf, int width, int count);
+
 extern uint8_t  inb(uint16_t port);
 extern void     outb(uint16_t port, uint8_t val);
 extern uint16_t inw(uint16_t port);
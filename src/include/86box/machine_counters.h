@@ -0,0 +1,88 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Definitions for the live performance counters.
+ *
+ *          Every front end shows them in the window title with
+ *          --perfstats. Only the headless front end answers queries
+ *          for them from outside, with the "counters" command of its
+ *          control socket; the Qt and SDL front ends have no socket.
+ *
+ *
+ *
+ */
+#ifndef EMU_MACHINE_COUNTERS_H
+#define EMU_MACHINE_COUNTERS_H
+
+/* Running totals since startup, kept by the parts of the emulator they
+   account for. Sample them twice and look at the difference for rates. */
+typedef struct machine_counters_t {
+    uint64_t sample_ns;       /* host time the sample was taken at */
+    uint64_t slices;          /* 10 ms slices emulated */
+    uint64_t ins;             /* instructions executed */
+    uint64_t blocks_run;      /* dynarec blocks run from the code cache */
+    uint64_t blocks_compiled; /* dynarec blocks compiled or marked for it */
+    uint64_t frames;          /* frames blitted */
+    uint64_t frames_skipped;  /* frames not drawn to catch up */
+    uint64_t audio_buffers;   /* sound buffers mixed */
+    uint64_t audio_underruns; /* times the host audio device ran dry */
+    uint64_t late;            /* slices the pacer started late */
+    uint64_t dropped;         /* slices the pacer gave up on */
+    uint64_t timer_calls;     /* timer callbacks run */
+
+    /* Host time spent in each part. CPU time includes the timer callbacks
+       and sound mixing, which run from within the CPU loop. */
+    uint64_t cpu_ns;
+    uint64_t timer_ns; /* only while machine_counters_timers is set */
+    uint64_t audio_ns;
+    uint64_t render_ns;    /* on the blit threads, see video_get_render_ns() */
+    uint64_t blit_wait_ns; /* emulation handing frames to the blit thread */
+} machine_counters_t;
+
+/* What two samples of the counters work out to. Times are in percent of
+   the host time between the samples. */
+typedef struct machine_rates_t {
+    double   mips;
+    double   speed; /* emulated time in percent of host time */
+    double   cpu;
+    double   timers;
+    double   audio;
+    double   render;
+    double   blit_wait;
+    double   block_hit; /* percent of dynarec blocks run without compiling */
+    double   fps;
+    double   timer_calls; /* per second */
+    uint64_t audio_underruns;
+    uint64_t late;
+    uint64_t dropped;
+} machine_rates_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern machine_counters_t machine_counters;
+/* The rates over the last second. */
+extern machine_rates_t machine_rates;
+
+/* Timing the timer callbacks costs two clock reads every time the timers
+   are processed, so it is only done when asked for. */
+extern int machine_counters_timers;
+
+extern void machine_counters_sample(machine_counters_t *mc);
+extern void machine_counters_rates(const machine_counters_t *prev, const machine_counters_t *cur,
+                                   machine_rates_t *rates);
+
+/* Called once a second to work out machine_rates. */
+extern void machine_counters_update(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*EMU_MACHINE_COUNTERS_H*/
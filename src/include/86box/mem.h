@@ -444,6 +444,14 @@ extern void mem_debug_check_addr(uint32_t addr, int write);
 
 extern void mem_a20_init(void);
 extern void mem_a20_recalc(void);
+extern void mem_dirty_mark(uint32_t phys);
+extern void mem_dirty_mark_host(const uint8_t *p);
+extern int  mem_dirty_test(uint32_t page);
+extern void mem_dirty_clear(void);
+#ifdef EMU_SAVESTATE_H
+extern void mem_save(savestate_t *state);
+extern int  mem_load(savestate_t *state);
+#endif
 
 extern void mem_init(void);
 extern void mem_close(void);
@@ -99,6 +99,8 @@ extern void            mouse_clear_z(void);
 extern void            mouse_subtract_z(int *delta_z, int min, int max, int invert);
 extern void            mouse_set_buttons_ex(int b);
 extern int             mouse_get_buttons_ex(void);
+extern void            mouse_input_take(double *x, double *y, int *z, int *b);
+extern void            mouse_input_put(double x, double y, int z, int b);
 extern void            mouse_set_sample_rate(double new_rate);
 extern void            mouse_set_buttons(int buttons);
 extern void            mouse_get_abs_coords(double *x_abs, double *y_abs);
@@ -198,6 +198,10 @@ extern int network_tx_pop(netcard_t *card, netpkt_t *out_pkt);
 extern int network_tx_popv(netcard_t *card, netpkt_t *pkt_vec, int vec_size);
 extern int network_rx_put(netcard_t *card, uint8_t *bufp, int len);
 extern int network_rx_put_pkt(netcard_t *card, netpkt_t *pkt);
+
+extern void network_queue_init(netqueue_t *queue);
+extern int  network_queue_put(netqueue_t *queue, uint8_t *data, int len);
+extern void network_queue_clear(netqueue_t *queue);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,57 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Definitions for the emulation thread pacing scheduler.
+ *
+ *
+ *
+ */
+#ifndef EMU_PACER_H
+#define EMU_PACER_H
+
+/* Each call to pc_run() emulates 10 ms. */
+#define PACER_SLICE_NS   10000000ULL
+/* A slice starting later than this after its deadline counts as late. */
+#define PACER_LATE_NS    2000000ULL
+/* Late slices run back to back for at most this long, the rest is dropped. */
+#define PACER_CATCHUP_NS 50000000ULL
+
+typedef struct pacer_stats_t {
+    uint64_t slices;        /* slices run */
+    uint64_t late;          /* slices started late */
+    uint64_t dropped;       /* slices given up on to catch up */
+    uint64_t late_max_ns;   /* worst lateness seen */
+    uint64_t late_total_ns; /* total lateness of the late slices */
+} pacer_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern void pacer_init(uint64_t period_ns);
+extern void pacer_reset(void);
+
+/* Returns 1 when the next slice is due, otherwise sleeps towards its
+   deadline and returns 0 so the caller can look after other things. */
+extern int pacer_wait(int free_run);
+
+/* Report how far ahead (positive) or behind (negative) of a host clock,
+   such as the audio output, the emulation currently is. */
+extern void pacer_sync(int64_t offset_ns);
+
+/* How late the current slice started, 0 if it was on time. */
+extern uint64_t pacer_get_lag(void);
+
+extern void pacer_get_stats(pacer_stats_t *stats);
+extern void pacer_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*EMU_PACER_H*/
@@ -80,6 +80,10 @@ extern void pic_init(void);
 extern void pic_init_pcjr(void);
 extern void pic2_init(void);
 extern void pic_reset(void);
+#ifdef EMU_SAVESTATE_H
+extern void pic_save(savestate_t *state);
+extern void pic_load(savestate_t *state);
+#endif
 
 extern uint8_t pic_read_icw(uint8_t pic_id, uint8_t icw);
 extern uint8_t pic_read_ocw(uint8_t pic_id, uint8_t ocw);
@@ -131,7 +131,9 @@ extern void     plat_munmap(void *ptr, size_t size);
 extern uint64_t plat_timer_read(void);
 extern uint32_t plat_get_ticks(void);
 extern uint32_t plat_get_micro_ticks(void);
+extern uint64_t plat_get_nano_ticks(void);
 extern void     plat_delay_ms(uint32_t count);
+extern void     plat_delay_ns(uint64_t count);
 extern void     plat_pause(int p);
 extern void     plat_mouse_capture(int on);
 extern int      plat_vidapi(char *name);
@@ -0,0 +1,50 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Definitions for the session record/replay module.
+ *
+ *
+ *
+ */
+#ifndef EMU_REPLAY_H
+#define EMU_REPLAY_H
+
+enum {
+    REPLAY_NONE = 0,
+    REPLAY_RECORD,
+    REPLAY_PLAY
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int replay_mode;
+
+/* Set from the command line, before the machine is first started. */
+extern void replay_set_record(const char *fn);
+extern void replay_set_play(const char *fn);
+
+extern void replay_init(void);
+extern void replay_close(void);
+
+/* Called by pc_run() once per execution slice, before the CPU runs it. */
+extern int  replay_hard_reset(int pending);
+extern void replay_process(void);
+
+/* Hooks for the sources of input the machine does not control. */
+extern int      replay_key_input(int down, uint16_t scan);
+extern int      replay_net_rx(int card, uint8_t *data, int *len, int size, int got);
+extern uint32_t replay_net_link(int card, uint32_t old_state, uint32_t new_state);
+extern int64_t  replay_host_time(int64_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*EMU_REPLAY_H*/
@@ -0,0 +1,75 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Definitions for the machine state snapshot module.
+ *
+ *
+ *
+ */
+#ifndef EMU_SAVESTATE_H
+#define EMU_SAVESTATE_H
+
+/* Bump whenever the layout of any core chunk changes. */
+#define SAVESTATE_VERSION 3
+
+#define SAVESTATE_TAG(a, b, c, d) ((uint32_t) (a) | ((uint32_t) (b) << 8) | \
+                                   ((uint32_t) (c) << 16) | ((uint32_t) (d) << 24))
+
+typedef struct _savestate_ savestate_t;
+
+struct pc_timer_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Every part of the machine is stored in its own tagged chunk. */
+extern void savestate_chunk_begin(savestate_t *state, uint32_t tag);
+extern void savestate_chunk_end(savestate_t *state);
+
+/* Chunk payload primitives, for use by the device save/load hooks. Reads past
+   the end of a chunk return zeroes and mark the snapshot as bad. */
+extern void     savestate_write(savestate_t *state, const void *buf, uint32_t len);
+extern void     savestate_write_u8(savestate_t *state, uint8_t val);
+extern void     savestate_write_u16(savestate_t *state, uint16_t val);
+extern void     savestate_write_u32(savestate_t *state, uint32_t val);
+extern void     savestate_write_u64(savestate_t *state, uint64_t val);
+extern void     savestate_write_string(savestate_t *state, const char *str);
+extern void     savestate_read(savestate_t *state, void *buf, uint32_t len);
+extern uint8_t  savestate_read_u8(savestate_t *state);
+extern uint16_t savestate_read_u16(savestate_t *state);
+extern uint32_t savestate_read_u32(savestate_t *state);
+extern uint64_t savestate_read_u64(savestate_t *state);
+extern void     savestate_read_string(savestate_t *state, char *str, uint32_t size);
+extern int      savestate_error(savestate_t *state);
+
+/* Timers are stored relative to the TSC, so they survive the TSC rebase. */
+extern void savestate_write_timer(savestate_t *state, const struct pc_timer_t *timer);
+extern void savestate_read_timer(savestate_t *state, struct pc_timer_t *timer);
+
+/* Snapshot an identically configured machine to/from a file. Must be called
+   from the emulation thread, between calls to cpu_exec(). */
+extern int savestate_save(const char *fn);
+extern int savestate_load(const char *fn, int force);
+
+/* Save only what changed since the last snapshot saved or loaded, falling
+   back to a full snapshot every so often. Loading a delta loads its parents. */
+extern int savestate_save_delta(const char *fn);
+extern int savestate_compact(const char *fn, const char *out_fn);
+
+/* Queue a save or load for the emulation thread to carry out. */
+extern void savestate_request_save(const char *fn);
+extern void savestate_request_load(const char *fn, int force);
+extern void savestate_checkpoint_start(const char *prefix, uint32_t interval_ms);
+extern void savestate_process(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*EMU_SAVESTATE_H*/
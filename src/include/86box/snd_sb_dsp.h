@@ -114,6 +114,9 @@ typedef struct sb_dsp_t {
     double sblatcho;
     double sblatchi;
 
+    uint64_t input_ts;
+    int      input_on;
+
     uint16_t sb_addr;
 
     int stereo;
@@ -46,9 +46,10 @@ extern int gated;
 extern int speakval;
 extern int speakon;
 
-extern int sound_pos_global;
 extern int sound_card_current[SOUND_CARD_MAX];
 
+extern uint64_t sound_buffer_count; /* buffers mixed since startup */
+
 extern void sound_add_handler(void (*get_buffer)(int32_t *buffer,
                                                  int len, void *priv),
                               void *priv);
@@ -73,6 +74,8 @@ extern int         sound_card_get_from_internal_name(const char *s);
 extern void        sound_card_init(void);
 extern void        sound_set_cd_volume(unsigned int vol_l, unsigned int vol_r);
 
+extern int  sound_pos_get(void);
+extern int  sound_pos_at(uint64_t ts);
 extern void sound_speed_changed(void);
 
 extern void sound_init(void);
@@ -88,6 +91,10 @@ extern void inital(void);
 extern void givealbuffer(void *buf);
 extern void givealbuffer_cd(void *buf);
 
+/* Only in builds that write the sound output to a file. */
+extern int  wavout_start(const char *fn);
+extern void wavout_stop(void);
+
 #define sb_vibra16c_onboard_relocate_base sb_vibra16s_onboard_relocate_base
 extern void sb_vibra16s_onboard_relocate_base(uint16_t new_addr, void *priv);
 
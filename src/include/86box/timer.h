@@ -42,16 +42,19 @@ typedef struct pc_timer_t {
 #else
     ts_t ts;
 #endif
-    int    flags;  /* The flags are defined above. */
-    int    pad;
+    int    flags;    /* The flags are defined above. */
+    int    heap_pos; /* Position in the timer heap while enabled. */
     double period; /* This is used for large period timers to count
                       the microseconds and split the period. */
 
     void (*callback)(void *priv);
     void *priv;
 
-    struct pc_timer_t *prev;
-    struct pc_timer_t *next;
+    uint64_t seq; /* Enable order, to break ties between equal timestamps. */
+
+#ifdef MTR_ENABLED
+    const char *name; /* The callback, to tell timers apart in traces. */
+#endif
 } pc_timer_t;
 
 #ifdef __cplusplus
@@ -70,6 +73,9 @@ extern void timer_disable(pc_timer_t *timer);
 /*Process any pending timers*/
 extern void timer_process(void);
 
+/*Move all enabled timers by delta (32:32), used when the TSC is rebased*/
+extern void timer_shift(uint64_t delta);
+
 /*Reset timer system*/
 extern void timer_close(void);
 extern void timer_init(void);
@@ -77,6 +83,11 @@ extern void timer_init(void);
 /*Add new timer. If start_timer is set, timer will be enabled with a zero
   timestamp - this is useful for permanently enabled timers*/
 extern void timer_add(pc_timer_t *timer, void (*callback)(void *priv), void *priv, int start_timer);
+#ifdef MTR_ENABLED
+/*Same, naming the timer in traces after its callback*/
+extern void timer_add_named(pc_timer_t *timer, void (*callback)(void *priv), void *priv, int start_timer, const char *name);
+#    define timer_add(timer, callback, priv, start_timer) timer_add_named(timer, callback, priv, start_timer, #callback)
+#endif
 
 /*1us in 32:32 format*/
 extern uint64_t TIMER_USEC;
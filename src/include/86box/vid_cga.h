@@ -67,6 +67,7 @@ typedef struct cga_t {
     int snow_enabled;
     int rgb_type;
     int double_type;
+    int frame_skip;
 } cga_t;
 
 void    cga_init(cga_t *cga);
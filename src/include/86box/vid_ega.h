@@ -35,10 +35,6 @@ typedef struct ega_t {
     uint8_t seqaddr;
     uint8_t miscout;
     uint8_t writemask;
-    uint8_t la;
-    uint8_t lb;
-    uint8_t lc;
-    uint8_t ld;
     uint8_t stat;
     uint8_t colourcompare;
     uint8_t colournocare;
@@ -56,6 +52,8 @@ typedef struct ega_t {
 
     uint8_t *vram;
 
+    uint32_t latch; /* Plane n in byte n. */
+
     uint16_t light_pen;
 
     int vidclock;
@@ -140,6 +138,10 @@ typedef struct ega_t {
 
     uint32_t   (*remap_func)(struct ega_t *ega, uint32_t in_addr);
     void       (*render)(struct ega_t *svga);
+
+    struct glyph_cache_t *glyph_cache;
+
+    int        frame_skip;
 } ega_t;
 #endif
 
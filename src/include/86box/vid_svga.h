@@ -283,6 +283,15 @@ typedef struct svga_t {
     void *  dev8514;
     void *  ext8514;
     void *  xga;
+
+    /* Scanline worker thread, if enabled. */
+    void *render_worker;
+
+    /* Text mode glyph rows, see video_glyph_cache_row(). */
+    struct glyph_cache_t *glyph_cache;
+
+    /* The frame is not being drawn, see video_frame_skip_monitor(). */
+    int frame_skip;
 } svga_t;
 
 extern int vga_on;
@@ -314,8 +323,14 @@ extern int  svga_init(const device_t *info, svga_t *svga, void *priv, int memsiz
                       void (*hwcursor_draw)(struct svga_t *svga, int displine),
                       void (*overlay_draw)(struct svga_t *svga, int displine));
 extern void svga_recalctimings(svga_t *svga);
+#ifdef EMU_SAVESTATE_H
+extern void svga_save(svga_t *svga, savestate_t *state);
+extern int  svga_load(svga_t *svga, savestate_t *state);
+#endif
 extern void svga_close(svga_t *svga);
 
+extern uint32_t svga_conv_16to32(struct svga_t *svga, uint16_t color, uint8_t bpp);
+
 uint8_t  svga_read(uint32_t addr, void *priv);
 uint16_t svga_readw(uint32_t addr, void *priv);
 uint32_t svga_readl(uint32_t addr, void *priv);
@@ -75,6 +75,21 @@ extern void svga_render_ABGR8888_highres(svga_t *svga);
 extern void svga_render_RGBA8888_lowres(svga_t *svga);
 extern void svga_render_RGBA8888_highres(svga_t *svga);
 
+/* Line converters for linear, non-wrapping scanout; see vid_svga_render_simd.c. */
+extern void (*svga_render_line_8bpp)(uint32_t *p, const uint8_t *src, const uint32_t *pal, int pixels);
+extern void (*svga_render_line_15bpp)(uint32_t *p, const uint8_t *src, int pixels);
+extern void (*svga_render_line_16bpp)(uint32_t *p, const uint8_t *src, int pixels);
+extern void (*svga_render_line_24bpp)(uint32_t *p, const uint8_t *src, int pixels);
+extern void (*svga_render_line_32bpp)(uint32_t *p, const uint8_t *src, int pixels);
+
+extern void svga_render_simd_init(void);
+
+extern void svga_render_line(svga_t *svga, uint32_t *p, int bpp, const uint32_t *pal, int pixels);
+extern void svga_render_fill(svga_t *svga, uint32_t *p, uint32_t color, int pixels);
+extern void svga_render_worker_init(svga_t *svga);
+extern void svga_render_worker_sync(svga_t *svga);
+extern void svga_render_worker_close(svga_t *svga);
+
 extern void ibm8514_render_8bpp(svga_t *svga);
 extern void ibm8514_render_15bpp(svga_t *svga);
 extern void ibm8514_render_16bpp(svga_t *svga);
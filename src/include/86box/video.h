@@ -86,6 +86,16 @@ typedef struct bitmap_t {
     uint32_t *line[2112];
 } bitmap_t;
 
+/* Changed area of a frame, in target buffer coordinates. */
+typedef struct video_rect_t {
+    int x;
+    int y;
+    int w;
+    int h;
+} video_rect_t;
+
+#define VIDEO_DIRTY_RECTS_MAX 64
+
 typedef struct rgb_t {
     uint8_t r;
     uint8_t g;
@@ -96,6 +106,24 @@ typedef struct dbcs_font_t {
     uint8_t chr[32];
 } dbcs_font_t;
 
+/* Text mode glyph rows as drawn, keyed by character, attribute, scanline
+   and blink phase, see video_glyph_cache_row(). Enough entries for every
+   character and scanline in one attribute. */
+#define GLYPH_CACHE_SIZE (256 * 32)
+
+#define GLYPH_9DOT      1 /* Characters are nine dots wide. */
+#define GLYPH_LINECHARS 2 /* The ninth dot repeats the eighth for characters C0h to DFh. */
+#define GLYPH_BLINK     4 /* Attribute bit 7 blinks instead of selecting a bright background. */
+
+typedef struct glyph_cache_t {
+    int      valid; /* Cleared when the font may have been written. */
+    int      flags;
+    uint32_t charset[2];
+    uint32_t col[16];
+    uint32_t key[GLYPH_CACHE_SIZE];
+    uint32_t row[GLYPH_CACHE_SIZE][9];
+} glyph_cache_t;
+
 struct blit_data_struct;
 
 typedef struct monitor_t {
@@ -123,6 +151,8 @@ typedef struct monitor_t {
     int                      mon_fullchange;
     int                      mon_changeframecount;
     atomic_int               mon_screenshots;
+    int                      mon_skip_frame; /* The frame being drawn is not to be sent. */
+    int                      mon_skip_run;   /* Frames skipped in a row so far. */
     uint32_t                *mon_pal_lookup;
     int                     *mon_cga_palette;
     int                      mon_pal_lookup_static;  /* Whether it should not be freed by the API. */
@@ -198,6 +228,7 @@ extern uint8_t      fontdat12x18[256][36];
 extern dbcs_font_t *fontdatksc5601;
 extern dbcs_font_t *fontdatksc5601_user;
 extern uint32_t    *video_6to8;
+extern uint32_t     video_glyph_mask[256][8];
 extern uint32_t    *video_8togs;
 extern uint32_t    *video_8to32;
 extern uint32_t    *video_15to32;
@@ -209,19 +240,35 @@ extern int          herc_blend;
 extern int          vid_cga_contrast;
 extern int          video_grayscale;
 extern int          video_graytype;
+extern int          video_dirty_lines;
+extern int          video_render_thread;
+extern int          video_frameskip;
+
+extern const uint32_t video_plane_mask[16];
 
-extern double cpuclock;
-extern int    emu_fps;
-extern int    frames;
-extern int    readflash;
-extern int    ibm8514_active;
-extern int    xga_active;
+extern double   cpuclock;
+extern int      emu_fps;
+extern int      frames;
+extern uint64_t video_blit_count; /* frames handed to the blitter */
+extern int      readflash;
+extern int      ibm8514_active;
+extern int      xga_active;
 
 /* Function handler pointers. */
 extern void (*video_recalctimings)(void);
 extern void video_screenshot_monitor(uint32_t *buf, int start_x, int start_y, int row_len, int monitor_index);
 extern void video_screenshot(uint32_t *buf, int start_x, int start_y, int row_len);
 
+#define VIDEO_CAPTURE_PNG 0 /* One PNG file per frame. */
+#define VIDEO_CAPTURE_RAW 1 /* 24-bit RGB frames back to back. */
+
+extern void video_capture_init(void);
+extern void video_capture_close(void);
+extern void video_capture_screenshot(const char *fn, const uint32_t *buf, int start_x, int start_y, int row_len, int w, int h);
+extern void video_capture_frame(int x, int y, int w, int h, int changed, int monitor_index);
+extern int  video_capture_start(const char *fn, int format, int monitor_index);
+extern void video_capture_stop(void);
+
 #ifdef _WIN32
 extern void *__cdecl (*video_copy)(void *_Dst, const void *_Src, size_t _Size);
 extern void *__cdecl video_transform_copy(void *_Dst, const void *_Src, size_t _Size);
@@ -253,10 +300,39 @@ extern void video_blit_memtoscreen_8(int x, int y, int w, int h);
 extern void video_blend_monitor(int x, int y, int monitor_index);
 extern void video_process_8_monitor(int x, int y, int monitor_index);
 extern void video_blit_memtoscreen_monitor(int x, int y, int w, int h, int monitor_index);
+extern void video_blit_dirty_memtoscreen_monitor(int x, int y, int w, int h, int monitor_index);
+extern void video_dirty_line_monitor(int y, int monitor_index);
+extern void video_dirty_all_monitor(int monitor_index);
+extern int  video_frame_skip_monitor(int monitor_index);
+extern void video_refresh_monitor(int monitor_index);
+extern int  video_blit_rects_monitor(const video_rect_t **rects, int monitor_index);
 extern void video_blit_complete_monitor(int monitor_index);
-extern void video_wait_for_blit_monitor(int monitor_index);
 extern void video_wait_for_buffer_monitor(int monitor_index);
 
+extern uint64_t video_get_render_ns(void);
+
+extern glyph_cache_t *video_glyph_cache_init(void);
+extern void           video_glyph_cache_close(glyph_cache_t *gc);
+extern void           video_glyph_cache_begin(glyph_cache_t *gc, const uint32_t *col, uint32_t charseta, uint32_t charsetb, int flags);
+extern void           video_glyph_cache_fill(glyph_cache_t *gc, uint32_t idx, uint32_t key, const uint8_t *vram);
+
+/* The row of a character cell, drawn first if it is not in the cache. */
+static inline const uint32_t *
+video_glyph_cache_row(glyph_cache_t *gc, const uint8_t *vram, uint8_t chr, uint8_t attr, int sc, int blinked)
+{
+    const int      blink = blinked && (attr & 0x80) && (gc->flags & GLYPH_BLINK);
+    const uint32_t key   = chr | (attr << 8) | ((sc & 0x1f) << 16) | (blink << 21);
+    /* The attribute only moves the rows of a character around, so that
+       the usual few of them do not fight over the same entries. */
+    const uint32_t idx   = ((chr | ((sc & 0x1f) << 8)) ^ (attr * 0x1a3)) & (GLYPH_CACHE_SIZE - 1);
+
+    if (gc->key[idx] != key)
+        video_glyph_cache_fill(gc, idx, key, vram);
+
+    return gc->row[idx];
+}
+
+extern bitmap_t *video_blit_buffer_monitor(int monitor_index);
 extern bitmap_t *create_bitmap(int w, int h);
 extern void      destroy_bitmap(bitmap_t *b);
 extern void      cgapal_rebuild_monitor(int monitor_index);
@@ -290,8 +366,8 @@ extern uint32_t video_color_transform(uint32_t color);
 #define video_blit_memtoscreen(x, y, w, h)    video_blit_memtoscreen_monitor(x, y, w, h, monitor_index_global)
 #define video_process_8(x, y)                 video_process_8_monitor(x, y, monitor_index_global)
 #define video_blit_complete()                 video_blit_complete_monitor(monitor_index_global)
-#define video_wait_for_blit()                 video_wait_for_blit_monitor(monitor_index_global)
 #define video_wait_for_buffer()               video_wait_for_buffer_monitor(monitor_index_global)
+#define video_frame_skip()                    video_frame_skip_monitor(monitor_index_global)
 #define cgapal_rebuild()                      cgapal_rebuild_monitor(monitor_index_global)
 #define video_force_resize_get()              video_force_resize_get_monitor(monitor_index_global)
 #define video_force_resize_set(val)           video_force_resize_set_monitor(val, monitor_index_global)
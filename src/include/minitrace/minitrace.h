@@ -53,6 +53,11 @@ void mtr_shutdown(void);
 void mtr_start(void);
 void mtr_stop(void);
 
+// Keeps only the last INTERNAL_MINITRACE_BUFFER_SIZE events in memory instead
+// of streaming them out, to capture what led up to an incident. The events are
+// written out by mtr_shutdown(). Call before mtr_start().
+void mtr_set_ring_buffer(int enable);
+
 // Flushes the collected data to disk, clearing the buffer for new data.
 void mtr_flush(void);
 
@@ -132,7 +137,7 @@ void internal_mtr_raw_event_arg(const char *category, const char *name, char ph,
 // Instant events. For things with no duration.
 #define MTR_INSTANT(c, n) internal_mtr_raw_event(c, n, 'I', 0)
 #define MTR_INSTANT_C(c, n, aname, astrval) internal_mtr_raw_event_arg(c, n, 'I', 0, MTR_ARG_TYPE_STRING_CONST, aname, (void *)(astrval))
-#define MTR_INSTANT_I(c, n, aname, aintval) internal_mtr_raw_event_arg(c, n, 'I', 0, MTR_ARG_TYPE_INT, aname, (void *)(aintval))
+#define MTR_INSTANT_I(c, n, aname, aintval) internal_mtr_raw_event_arg(c, n, 'I', 0, MTR_ARG_TYPE_INT, aname, (void *)(intptr_t)(aintval))
 
 // Counters (can't do multi-value counters yet)
 #define MTR_COUNTER(c, n, val) internal_mtr_raw_event_arg(c, n, 'C', 0, MTR_ARG_TYPE_INT, n, (void *)(intptr_t)(val))
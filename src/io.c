@@ -42,6 +42,9 @@ typedef struct _io_ {
     void (*outw)(uint16_t addr, uint16_t val, void *priv);
     void (*outl)(uint16_t addr, uint32_t val, void *priv);
 
+    int (*inblk)(uint16_t addr, uint8_t *buf, int width, int count, void *priv);
+    int (*outblk)(uint16_t addr, const uint8_t *buf, int width, int count, void *priv);
+
     void *priv;
 
     struct _io_ *prev, *next;
@@ -59,6 +62,28 @@ int   initialized = 0;
 io_t *io[NPORTS];
 io_t *io_last[NPORTS];
 
+/*
+ * Compiled single-handler dispatch, one table per access width.
+ *
+ * An entry is non-NULL only when an access of that width to that port
+ * resolves to exactly one handler call, in which case the list walk
+ * (and the narrower-width fallbacks) can be skipped entirely. Entries
+ * are rebuilt by io_update_fast() whenever the handler lists change.
+ */
+static io_t *io_inb_fast[NPORTS];
+static io_t *io_inw_fast[NPORTS];
+static io_t *io_inl_fast[NPORTS];
+static io_t *io_outb_fast[NPORTS];
+static io_t *io_outw_fast[NPORTS];
+static io_t *io_outl_fast[NPORTS];
+
+#define IO_INB  0x01
+#define IO_INW  0x02
+#define IO_INL  0x04
+#define IO_OUTB 0x08
+#define IO_OUTW 0x10
+#define IO_OUTL 0x20
+
 #ifdef ENABLE_IO_LOG
 int io_do_log = ENABLE_IO_LOG;
 
@@ -77,6 +102,92 @@ io_log(const char *fmt, ...)
 #    define io_log(fmt, ...)
 #endif
 
+static uint8_t
+io_handler_mask(const io_t *p)
+{
+    return (p->inb ? IO_INB : 0) | (p->inw ? IO_INW : 0) | (p->inl ? IO_INL : 0) |
+           (p->outb ? IO_OUTB : 0) | (p->outw ? IO_OUTW : 0) | (p->outl ? IO_OUTL : 0);
+}
+
+/* Count the handlers on a port that have all of the set bits and none of the clear bits. */
+static int
+io_count(uint16_t port, uint8_t set, uint8_t clear, io_t **match)
+{
+    io_t   *p = io[port];
+    int     n = 0;
+    uint8_t mask;
+
+    while (p) {
+        mask = io_handler_mask(p);
+        if (((mask & set) == set) && !(mask & clear)) {
+            if (match)
+                *match = p;
+            n++;
+        }
+        p = p->next;
+    }
+
+    return n;
+}
+
+static void
+io_compile_port(uint16_t port)
+{
+    io_t *p = NULL;
+
+    /* Byte accesses only ever reach the handlers on the port itself. */
+    io_inb_fast[port]  = (io_count(port, IO_INB, 0, &p) == 1) ? p : NULL;
+    io_outb_fast[port] = (io_count(port, IO_OUTB, 0, &p) == 1) ? p : NULL;
+
+    /* Word accesses also reach byte-only handlers on both bytes. */
+    io_inw_fast[port] = NULL;
+    if ((io_count(port, IO_INW, 0, &p) == 1) &&
+        !io_count(port, IO_INB, IO_INW, NULL) &&
+        !io_count((port + 1) & 0xffff, IO_INB, IO_INW, NULL))
+        io_inw_fast[port] = p;
+
+    io_outw_fast[port] = NULL;
+    if ((io_count(port, IO_OUTW, 0, &p) == 1) &&
+        !io_count(port, IO_OUTB, IO_OUTW, NULL) &&
+        !io_count((port + 1) & 0xffff, IO_OUTB, IO_OUTW, NULL))
+        io_outw_fast[port] = p;
+
+    /* Dword accesses also reach word-only and byte-only handlers. */
+    io_inl_fast[port] = NULL;
+    if ((io_count(port, IO_INL, 0, &p) == 1) &&
+        !io_count(port, IO_INW, IO_INL, NULL) &&
+        !io_count((port + 2) & 0xffff, IO_INW, IO_INL, NULL)) {
+        io_inl_fast[port] = p;
+        for (int i = 0; i < 4; i++) {
+            if (io_count((port + i) & 0xffff, IO_INB, IO_INW | IO_INL, NULL)) {
+                io_inl_fast[port] = NULL;
+                break;
+            }
+        }
+    }
+
+    io_outl_fast[port] = NULL;
+    if ((io_count(port, IO_OUTL, 0, &p) == 1) &&
+        !io_count(port, IO_OUTW, IO_OUTL, NULL) &&
+        !io_count((port + 2) & 0xffff, IO_OUTW, IO_OUTL, NULL)) {
+        io_outl_fast[port] = p;
+        for (int i = 0; i < 4; i++) {
+            if (io_count((port + i) & 0xffff, IO_OUTB, IO_OUTW | IO_OUTL, NULL)) {
+                io_outl_fast[port] = NULL;
+                break;
+            }
+        }
+    }
+}
+
+/* Rebuild the fast dispatch entries for every port whose accesses can overlap the range. */
+static void
+io_update_fast(uint16_t base, int size)
+{
+    for (int c = -3; c < size; c++)
+        io_compile_port((base + c) & 0xffff);
+}
+
 void
 io_init(void)
 {
@@ -106,6 +217,13 @@ io_init(void)
         /* io[c] should be NULL. */
         io[c] = io_last[c] = NULL;
     }
+
+    memset(io_inb_fast, 0, sizeof(io_inb_fast));
+    memset(io_inw_fast, 0, sizeof(io_inw_fast));
+    memset(io_inl_fast, 0, sizeof(io_inl_fast));
+    memset(io_outb_fast, 0, sizeof(io_outb_fast));
+    memset(io_outw_fast, 0, sizeof(io_outw_fast));
+    memset(io_outl_fast, 0, sizeof(io_outl_fast));
 }
 
 void
@@ -146,6 +264,8 @@ io_sethandler_common(uint16_t base, int size,
 
         io_last[base + c] = q;
     }
+
+    io_update_fast(base, size);
 }
 
 void
@@ -183,6 +303,8 @@ io_removehandler_common(uint16_t base, int size,
             p = q;
         }
     }
+
+    io_update_fast(base, size);
 }
 
 void
@@ -279,6 +401,111 @@ io_handler_interleaved(int set, uint16_t base, int size,
     io_handler_common(set, base, size, inb, inw, inl, outb, outw, outl, priv, 2);
 }
 
+/*
+ * Attach block transfer handlers to the already registered handlers with
+ * the given priv on a range of ports. A block handler must behave exactly
+ * like count consecutive accesses of the given width to the port, and may
+ * stop early (e.g. at the end of a sector); it returns the number of
+ * elements actually transferred. Removing the port handlers removes these
+ * as well.
+ */
+void
+io_setblockhandler(uint16_t base, int size,
+                   int (*inblk)(uint16_t addr, uint8_t *buf, int width, int count, void *priv),
+                   int (*outblk)(uint16_t addr, const uint8_t *buf, int width, int count, void *priv),
+                   void *priv)
+{
+    io_t *p;
+
+    for (int c = 0; c < size; c++) {
+        p = io[(base + c) & 0xffff];
+        while (p) {
+            if (p->priv == priv) {
+                p->inblk  = inblk;
+                p->outblk = outblk;
+            }
+            p = p->next;
+        }
+    }
+}
+
+static int
+io_block_allowed(uint16_t port)
+{
+    if ((pci_flags & FLAG_CONFIG_IO_ON) && (port >= pci_base) && (port < (pci_base + pci_size)))
+        return 0;
+    if ((pci_flags & FLAG_CONFIG_DEV0_IO_ON) && (port >= 0xc000) && (port < 0xc100))
+        return 0;
+
+    return !(amstrad_latch & 0x80000000);
+}
+
+/* Read up to count elements of width bytes from a port into buf; returns the number read. */
+int
+io_inblock(uint16_t port, uint8_t *buf, int width, int count)
+{
+    io_t *p;
+
+    if (!io_block_allowed(port))
+        return 0;
+
+    switch (width) {
+        case 1:
+            p = io_inb_fast[port];
+            break;
+        case 2:
+            p = io_inw_fast[port];
+            break;
+        case 4:
+            p = io_inl_fast[port];
+            break;
+        default:
+            return 0;
+    }
+
+    if (!p || !p->inblk)
+        return 0;
+
+    count = p->inblk(port, buf, width, count, p->priv);
+
+    io_log("[%04X:%08X] (%i) in block(%04X, %i) = %i\n", CS, cpu_state.pc, in_smm, port, width, count);
+
+    return count;
+}
+
+/* Write up to count elements of width bytes from buf to a port; returns the number written. */
+int
+io_outblock(uint16_t port, const uint8_t *buf, int width, int count)
+{
+    io_t *p;
+
+    if (!io_block_allowed(port))
+        return 0;
+
+    switch (width) {
+        case 1:
+            p = io_outb_fast[port];
+            break;
+        case 2:
+            p = io_outw_fast[port];
+            break;
+        case 4:
+            p = io_outl_fast[port];
+            break;
+        default:
+            return 0;
+    }
+
+    if (!p || !p->outblk)
+        return 0;
+
+    count = p->outblk(port, buf, width, count, p->priv);
+
+    io_log("[%04X:%08X] (%i) out block(%04X, %i) = %i\n", CS, cpu_state.pc, in_smm, port, width, count);
+
+    return count;
+}
+
 uint8_t
 inb(uint16_t port)
 {
@@ -301,6 +528,12 @@ inb(uint16_t port)
         found = 1;
 #ifdef ENABLE_IO_LOG
         qfound = 1;
+#endif
+    } else if (io_inb_fast[port]) {
+        ret = io_inb_fast[port]->inb(port, io_inb_fast[port]->priv);
+        found = 1;
+#ifdef ENABLE_IO_LOG
+        qfound = 1;
 #endif
     } else {
         p = io[port];
@@ -361,6 +594,12 @@ outb(uint16_t port, uint8_t val)
         found = 1;
 #ifdef ENABLE_IO_LOG
         qfound = 1;
+#endif
+    } else if (io_outb_fast[port]) {
+        io_outb_fast[port]->outb(port, val, io_outb_fast[port]->priv);
+        found = 1;
+#ifdef ENABLE_IO_LOG
+        qfound = 1;
 #endif
     } else {
         p = io[port];
@@ -413,6 +652,12 @@ inw(uint16_t port)
         found = 2;
 #ifdef ENABLE_IO_LOG
         qfound = 1;
+#endif
+    } else if (io_inw_fast[port]) {
+        ret = io_inw_fast[port]->inw(port, io_inw_fast[port]->priv);
+        found = 2;
+#ifdef ENABLE_IO_LOG
+        qfound = 1;
 #endif
     } else {
         p = io[port];
@@ -485,6 +730,12 @@ outw(uint16_t port, uint16_t val)
         found = 2;
 #ifdef ENABLE_IO_LOG
         qfound = 1;
+#endif
+    } else if (io_outw_fast[port]) {
+        io_outw_fast[port]->outw(port, val, io_outw_fast[port]->priv);
+        found = 2;
+#ifdef ENABLE_IO_LOG
+        qfound = 1;
 #endif
     } else {
         p = io[port];
@@ -553,6 +804,12 @@ inl(uint16_t port)
         found = 4;
 #ifdef ENABLE_IO_LOG
         qfound = 1;
+#endif
+    } else if (io_inl_fast[port]) {
+        ret = io_inl_fast[port]->inl(port, io_inl_fast[port]->priv);
+        found = 4;
+#ifdef ENABLE_IO_LOG
+        qfound = 1;
 #endif
     } else {
         p = io[port];
@@ -657,6 +914,12 @@ outl(uint16_t port, uint32_t val)
         found = 4;
 #ifdef ENABLE_IO_LOG
         qfound = 1;
+#endif
+    } else if (io_outl_fast[port]) {
+        io_outl_fast[port]->outl(port, val, io_outl_fast[port]->priv);
+        found = 4;
+#ifdef ENABLE_IO_LOG
+        qfound = 1;
 #endif
     } else {
         p = io[port];
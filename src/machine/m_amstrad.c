@@ -859,6 +859,7 @@ vid_close_1640(void *priv)
 {
     amsvid_t *vid = (amsvid_t *) priv;
 
+    video_glyph_cache_close(vid->ega.glyph_cache);
     free(vid->ega.vram);
 
     free(vid);
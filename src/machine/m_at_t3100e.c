@@ -707,6 +707,7 @@ ems_write_ram(uint32_t addr, uint8_t val, void *priv)
         return;
     addr      = regs->page_exec[pg] + (addr & 0x3FFF);
     ram[addr] = val;
+    mem_dirty_mark(addr);
 }
 
 static void
@@ -726,6 +727,8 @@ ems_write_ramw(uint32_t addr, uint16_t val, void *priv)
 #endif
 
     *(uint16_t *) &ram[addr] = val;
+    mem_dirty_mark(addr);
+    mem_dirty_mark(addr + 1);
 }
 
 static void
@@ -738,6 +741,8 @@ ems_write_raml(uint32_t addr, uint32_t val, void *priv)
         return;
     addr                     = regs->page_exec[pg] + (addr & 0x3FFF);
     *(uint32_t *) &ram[addr] = val;
+    mem_dirty_mark(addr);
+    mem_dirty_mark(addr + 3);
 }
 
 /* Read RAM in the upper area. This is basically what the 'remapped'
@@ -776,6 +781,7 @@ upper_write_ram(uint32_t addr, uint8_t val, void *priv)
 
     addr      = (addr - (1024 * mem_size)) + regs->upper_base;
     ram[addr] = val;
+    mem_dirty_mark(addr);
 }
 
 static void
@@ -785,6 +791,8 @@ upper_write_ramw(uint32_t addr, uint16_t val, void *priv)
 
     addr                     = (addr - (1024 * mem_size)) + regs->upper_base;
     *(uint16_t *) &ram[addr] = val;
+    mem_dirty_mark(addr);
+    mem_dirty_mark(addr + 1);
 }
 
 static void
@@ -794,6 +802,8 @@ upper_write_raml(uint32_t addr, uint32_t val, void *priv)
 
     addr                     = (addr - (1024 * mem_size)) + regs->upper_base;
     *(uint32_t *) &ram[addr] = val;
+    mem_dirty_mark(addr);
+    mem_dirty_mark(addr + 3);
 }
 
 int
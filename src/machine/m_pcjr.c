@@ -260,6 +260,7 @@ vid_write(uint32_t addr, uint8_t val, void *priv)
         return;
 
     pcjr->b8000[addr & 0x3fff] = val;
+    mem_dirty_mark_host(&pcjr->b8000[addr & 0x3fff]);
 }
 
 static uint8_t
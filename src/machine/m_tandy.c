@@ -626,14 +626,18 @@ vid_write(uint32_t addr, uint8_t val, void *priv)
         return;
 
     if (dev->is_sl2) {
-        if (vid->array[5] & 1)
+        if (vid->array[5] & 1) {
             vid->b8000[addr & 0xffff] = val;
-        else {
-            if ((addr & 0x7fff) < vid->b8000_limit)
+            mem_dirty_mark_host(&vid->b8000[addr & 0xffff]);
+        } else {
+            if ((addr & 0x7fff) < vid->b8000_limit) {
                 vid->b8000[addr & 0x7fff] = val;
+                mem_dirty_mark_host(&vid->b8000[addr & 0x7fff]);
+            }
         }
     } else {
         vid->b8000[addr & vid->b8000_mask] = val;
+        mem_dirty_mark_host(&vid->b8000[addr & vid->b8000_mask]);
     }
 }
 
@@ -1391,6 +1395,7 @@ write_ram(uint32_t addr, uint8_t val, void *priv)
     const tandy_t *dev = (tandy_t *) priv;
 
     ram[dev->base + (addr & dev->mask)] = val;
+    mem_dirty_mark(dev->base + (addr & dev->mask));
 }
 
 static uint8_t
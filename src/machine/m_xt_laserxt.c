@@ -105,8 +105,10 @@ static void
 mem_write_laserxtems(uint32_t addr, uint8_t val, UNUSED(void *priv))
 {
     addr = get_laserxt_ems_addr(addr);
-    if (addr < (mem_size << 10))
+    if (addr < (mem_size << 10)) {
         ram[addr] = val;
+        mem_dirty_mark(addr);
+    }
 }
 
 static uint8_t
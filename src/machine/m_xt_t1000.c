@@ -526,6 +526,7 @@ ems_write_ram(uint32_t addr, uint8_t val, void *priv)
         nvr_dosave = 1;
 
     ram[addr] = val;
+    mem_dirty_mark(addr);
 }
 
 static void
@@ -550,6 +551,8 @@ ems_write_ramw(uint32_t addr, uint16_t val, void *priv)
         nvr_dosave = 1;
 
     *(uint16_t *) &ram[addr] = val;
+    mem_dirty_mark(addr);
+    mem_dirty_mark(addr + 1);
 }
 
 static void
@@ -566,6 +569,8 @@ ems_write_raml(uint32_t addr, uint32_t val, void *priv)
         nvr_dosave = 1;
 
     *(uint32_t *) &ram[addr] = val;
+    mem_dirty_mark(addr);
+    mem_dirty_mark(addr + 3);
 }
 
 static uint8_t
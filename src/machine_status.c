@@ -21,9 +21,18 @@
 #include <86box/hdd.h>
 #include <86box/thread.h>
 #include <86box/network.h>
+#include <86box/sound.h>
+#include <86box/video.h>
+#include <86box/pacer.h>
 #include <86box/machine_status.h>
+#include <86box/machine_counters.h>
 
-machine_status_t machine_status;
+machine_status_t   machine_status;
+machine_counters_t machine_counters;
+machine_rates_t    machine_rates;
+int                machine_counters_timers = 0;
+
+static machine_counters_t machine_counters_last;
 
 void
 machine_status_init(void)
@@ -55,4 +64,64 @@ machine_status_init(void)
         machine_status.net[i].active = false;
         machine_status.net[i].empty  = !network_is_connected(i);
     }
-}
\ No newline at end of file
+}
+
+/* Cheap enough to call every second: copies the running totals, most of
+   which are kept elsewhere already. */
+void
+machine_counters_sample(machine_counters_t *mc)
+{
+    pacer_stats_t stats;
+
+    pacer_get_stats(&stats);
+
+    *mc                 = machine_counters;
+    mc->sample_ns       = plat_get_nano_ticks();
+    mc->ins             = cpu_ins_interp + cpu_ins_recomp;
+    mc->blocks_run      = cpu_blocks_run;
+    mc->blocks_compiled = cpu_blocks_compiled + cpu_blocks_marked;
+    mc->frames          = video_blit_count;
+    mc->render_ns       = video_get_render_ns();
+    mc->audio_buffers   = sound_buffer_count;
+    mc->late            = stats.late;
+    mc->dropped         = stats.dropped;
+}
+
+void
+machine_counters_rates(const machine_counters_t *prev, const machine_counters_t *cur, machine_rates_t *rates)
+{
+    double   secs   = (double) (cur->sample_ns - prev->sample_ns) / 1000000000.0;
+    double   pct    = (secs > 0.0) ? (100.0 / (secs * 1000000000.0)) : 0.0;
+    uint64_t blocks = (cur->blocks_run - prev->blocks_run) + (cur->blocks_compiled - prev->blocks_compiled);
+
+    memset(rates, 0, sizeof(machine_rates_t));
+    if (secs <= 0.0)
+        return;
+
+    rates->mips      = (double) (cur->ins - prev->ins) / secs / 1000000.0;
+    rates->speed     = (double) (cur->slices - prev->slices) * (double) PACER_SLICE_NS * pct;
+    rates->cpu       = (double) (cur->cpu_ns - prev->cpu_ns) * pct;
+    rates->timers    = (double) (cur->timer_ns - prev->timer_ns) * pct;
+    rates->audio     = (double) (cur->audio_ns - prev->audio_ns) * pct;
+    rates->render    = (double) (cur->render_ns - prev->render_ns) * pct;
+    rates->blit_wait = (double) (cur->blit_wait_ns - prev->blit_wait_ns) * pct;
+    rates->fps       = (double) (cur->frames - prev->frames) / secs;
+    if (blocks > 0)
+        rates->block_hit = (double) (cur->blocks_run - prev->blocks_run) * 100.0 / (double) blocks;
+
+    rates->timer_calls     = (double) (cur->timer_calls - prev->timer_calls) / secs;
+    rates->audio_underruns = cur->audio_underruns - prev->audio_underruns;
+    rates->late            = cur->late - prev->late;
+    rates->dropped         = cur->dropped - prev->dropped;
+}
+
+void
+machine_counters_update(void)
+{
+    machine_counters_t cur;
+
+    machine_counters_sample(&cur);
+    if (machine_counters_last.sample_ns != 0)
+        machine_counters_rates(&machine_counters_last, &cur, &machine_rates);
+    machine_counters_last = cur;
+}
@@ -37,6 +37,7 @@
 #include <86box/mem.h>
 #include <86box/plat.h>
 #include <86box/rom.h>
+#include <86box/savestate.h>
 #include <86box/gdbstub.h>
 #ifdef USE_DYNAREC
 #    include "codegen_public.h"
@@ -145,6 +146,10 @@ static size_t ram2_size = 0;
 static size_t ram_size = 0;
 #endif
 
+/* One bit per 4 KB page of RAM, set when the page is written to. */
+static uint8_t *mem_dirty_map   = NULL;
+static uint32_t mem_dirty_pages = 0;
+
 #ifdef ENABLE_MEM_LOG
 int mem_do_log = ENABLE_MEM_LOG;
 
@@ -604,6 +609,29 @@ addreadlookup(uint32_t virt, uint32_t phys)
     cycles -= 9;
 }
 
+/* Marks the page of RAM at the given offset into ram[] (ram2[] from 1 GB up)
+   as written since the last snapshot. Write handlers that store into RAM
+   themselves, rather than through mem_write_ram*(), must call this. */
+void
+mem_dirty_mark(uint32_t phys)
+{
+    if ((phys >> 12) < mem_dirty_pages)
+        mem_dirty_map[phys >> 15] |= (1 << ((phys >> 12) & 7));
+}
+
+/* For writes that go through a mapping's exec pointer, which may or may not
+   point into RAM. */
+void
+mem_dirty_mark_host(const uint8_t *p)
+{
+    if ((p >= ram) && (p < (ram + ram_size)))
+        mem_dirty_mark((uint32_t) (p - ram));
+#if (!(defined __amd64__ || defined _M_X64 || defined __aarch64__ || defined _M_ARM64))
+    else if ((ram2 != NULL) && (p >= ram2) && (p < (ram2 + ram2_size)))
+        mem_dirty_mark((uint32_t) (p - ram2) + (1 << 30));
+#endif
+}
+
 void
 addwritelookup(uint32_t virt, uint32_t phys)
 {
@@ -611,6 +639,11 @@ addwritelookup(uint32_t virt, uint32_t phys)
     uint32_t a;
 #endif
 
+    /* The mem_write_ram*() handlers come through here before the page gets a
+       fast path, and mem_dirty_clear() takes the fast paths away again.
+       Chipset handlers that write ram[] directly mark their own pages. */
+    mem_dirty_mark(phys);
+
     if (virt == 0xffffffff)
         return;
 
@@ -1713,9 +1746,10 @@ mem_writeb_phys(uint32_t addr, uint8_t val)
     mem_logical_addr = 0xffffffff;
 
     if (map) {
-        if (cpu_use_exec && map->exec)
+        if (cpu_use_exec && map->exec) {
             map->exec[(addr - map->base) & map->mask] = val;
-        else if (map->write_b)
+            mem_dirty_mark_host(&map->exec[(addr - map->base) & map->mask]);
+        } else if (map->write_b)
             map->write_b(addr, val, map->priv);
     }
 }
@@ -1731,6 +1765,8 @@ mem_writew_phys(uint32_t addr, uint16_t val)
     if (cpu_use_exec && ((addr & MEM_GRANULARITY_MASK) <= MEM_GRANULARITY_HBOUND) && (map && map->exec)) {
         p  = (uint16_t *) &(map->exec[(addr - map->base) & map->mask]);
         *p = val;
+        mem_dirty_mark_host((uint8_t *) p);
+        mem_dirty_mark_host((uint8_t *) p + 1);
     } else if (((addr & MEM_GRANULARITY_MASK) <= MEM_GRANULARITY_HBOUND) && (map && map->write_w))
         map->write_w(addr, val, map->priv);
     else {
@@ -1750,6 +1786,8 @@ mem_writel_phys(uint32_t addr, uint32_t val)
     if (cpu_use_exec && ((addr & MEM_GRANULARITY_MASK) <= MEM_GRANULARITY_QBOUND) && (map && map->exec)) {
         p  = (uint32_t *) &(map->exec[(addr - map->base) & map->mask]);
         *p = val;
+        mem_dirty_mark_host((uint8_t *) p);
+        mem_dirty_mark_host((uint8_t *) p + 3);
     } else if (((addr & MEM_GRANULARITY_MASK) <= MEM_GRANULARITY_QBOUND) && (map && map->write_l))
         map->write_l(addr, val, map->priv);
     else {
@@ -2048,8 +2086,10 @@ mem_write_ram(uint32_t addr, uint8_t val, UNUSED(void *priv))
     if (cpu_use_exec) {
         addwritelookup(mem_logical_addr, addr);
         mem_write_ramb_page(addr, val, &pages[addr >> 12]);
-    } else
+    } else {
         ram[addr] = val;
+        mem_dirty_mark(addr);
+    }
 }
 
 void
@@ -2062,8 +2102,11 @@ mem_write_ramw(uint32_t addr, uint16_t val, UNUSED(void *priv))
     if (cpu_use_exec) {
         addwritelookup(mem_logical_addr, addr);
         mem_write_ramw_page(addr, val, &pages[addr >> 12]);
-    } else
+    } else {
         *(uint16_t *) &ram[addr] = val;
+        mem_dirty_mark(addr);
+        mem_dirty_mark(addr + 1);
+    }
 }
 
 void
@@ -2076,8 +2119,11 @@ mem_write_raml(uint32_t addr, uint32_t val, UNUSED(void *priv))
     if (cpu_use_exec) {
         addwritelookup(mem_logical_addr, addr);
         mem_write_raml_page(addr, val, &pages[addr >> 12]);
-    } else
+    } else {
         *(uint32_t *) &ram[addr] = val;
+        mem_dirty_mark(addr);
+        mem_dirty_mark(addr + 3);
+    }
 }
 
 static uint8_t
@@ -2142,8 +2188,10 @@ mem_write_remapped(uint32_t addr, uint8_t val, UNUSED(void *priv))
     if (cpu_use_exec) {
         addwritelookup(mem_logical_addr, addr);
         mem_write_ramb_page(addr, val, &pages[oldaddr >> 12]);
-    } else
+    } else {
         ram[addr] = val;
+        mem_dirty_mark(addr);
+    }
 }
 
 static void
@@ -2154,8 +2202,11 @@ mem_write_remappedw(uint32_t addr, uint16_t val, UNUSED(void *priv))
     if (cpu_use_exec) {
         addwritelookup(mem_logical_addr, addr);
         mem_write_ramw_page(addr, val, &pages[oldaddr >> 12]);
-    } else
+    } else {
         *(uint16_t *) &ram[addr] = val;
+        mem_dirty_mark(addr);
+        mem_dirty_mark(addr + 1);
+    }
 }
 
 static void
@@ -2166,8 +2217,11 @@ mem_write_remappedl(uint32_t addr, uint32_t val, UNUSED(void *priv))
     if (cpu_use_exec) {
         addwritelookup(mem_logical_addr, addr);
         mem_write_raml_page(addr, val, &pages[oldaddr >> 12]);
-    } else
+    } else {
         *(uint32_t *) &ram[addr] = val;
+        mem_dirty_mark(addr);
+        mem_dirty_mark(addr + 3);
+    }
 }
 
 static void
@@ -2178,8 +2232,10 @@ mem_write_remapped2(uint32_t addr, uint8_t val, UNUSED(void *priv))
     if (cpu_use_exec) {
         addwritelookup(mem_logical_addr, addr);
         mem_write_ramb_page(addr, val, &pages[oldaddr >> 12]);
-    } else
+    } else {
         ram[addr] = val;
+        mem_dirty_mark(addr);
+    }
 }
 
 static void
@@ -2190,8 +2246,11 @@ mem_write_remappedw2(uint32_t addr, uint16_t val, UNUSED(void *priv))
     if (cpu_use_exec) {
         addwritelookup(mem_logical_addr, addr);
         mem_write_ramw_page(addr, val, &pages[oldaddr >> 12]);
-    } else
+    } else {
         *(uint16_t *) &ram[addr] = val;
+        mem_dirty_mark(addr);
+        mem_dirty_mark(addr + 1);
+    }
 }
 
 static void
@@ -2202,8 +2261,11 @@ mem_write_remappedl2(uint32_t addr, uint32_t val, UNUSED(void *priv))
     if (cpu_use_exec) {
         addwritelookup(mem_logical_addr, addr);
         mem_write_raml_page(addr, val, &pages[oldaddr >> 12]);
-    } else
+    } else {
         *(uint32_t *) &ram[addr] = val;
+        mem_dirty_mark(addr);
+        mem_dirty_mark(addr + 3);
+    }
 }
 
 void
@@ -2753,6 +2815,16 @@ mem_reset(void)
             ram2 = &(ram[1 << 30]);
     }
 
+    /* Freshly cleared RAM differs from any snapshot taken before the reset. */
+    free(mem_dirty_map);
+    mem_dirty_pages = (uint32_t) (m >> 12);
+    mem_dirty_map   = (uint8_t *) malloc((mem_dirty_pages + 7) >> 3);
+    if (mem_dirty_map == NULL) {
+        fatal("Failed to allocate the RAM dirty page map.\n");
+        return;
+    }
+    memset(mem_dirty_map, 0xff, (mem_dirty_pages + 7) >> 3);
+
     /*
      * Allocate the page table based on how much RAM we have.
      * We re-allocate the table on each (hard) reset, as the
@@ -3086,6 +3158,91 @@ mem_reset_page_blocks(void)
     }
 }
 
+int
+mem_dirty_test(uint32_t page)
+{
+    return (page < mem_dirty_pages) && (mem_dirty_map[page >> 3] & (1 << (page & 7)));
+}
+
+/* Starts a new dirty tracking interval. Dropping the write lookups sends the
+   next write to every page back through addwritelookup(), which marks it. */
+void
+mem_dirty_clear(void)
+{
+    if (mem_dirty_map != NULL)
+        memset(mem_dirty_map, 0x00, (mem_dirty_pages + 7) >> 3);
+
+    flushmmucache_nopc();
+}
+
+void
+mem_save(savestate_t *state)
+{
+    const mem_mapping_t *map;
+    uint32_t             n = 0;
+
+    for (map = base_mapping; map != NULL; map = map->next)
+        n++;
+
+    /* Mappings are added in the same order on every machine with the same
+       configuration, so the list position identifies each of them. */
+    savestate_write_u32(state, n);
+    for (map = base_mapping; map != NULL; map = map->next) {
+        savestate_write_u8(state, map->enable);
+        savestate_write_u32(state, map->base);
+        savestate_write_u32(state, map->size);
+        savestate_write_u32(state, map->mask);
+    }
+
+    savestate_write(state, _mem_state, sizeof(_mem_state));
+
+    savestate_write_u8(state, mem_a20_key);
+    savestate_write_u8(state, mem_a20_alt);
+}
+
+int
+mem_load(savestate_t *state)
+{
+    mem_mapping_t *map;
+    uint32_t       n = 0;
+
+    for (map = base_mapping; map != NULL; map = map->next)
+        n++;
+
+    if (savestate_read_u32(state) != n) {
+        mem_log("MEM: Snapshot has a different memory mapping layout\n");
+        return 1;
+    }
+
+    for (map = base_mapping; map != NULL; map = map->next) {
+        map->enable = savestate_read_u8(state);
+        map->base   = savestate_read_u32(state);
+        map->size   = savestate_read_u32(state);
+        map->mask   = savestate_read_u32(state);
+    }
+
+    savestate_read(state, _mem_state, sizeof(_mem_state));
+    mem_mapping_recalc(0x0000000000000000ULL, 0x0000000100000000ULL);
+
+    mem_a20_key = savestate_read_u8(state);
+    mem_a20_alt = savestate_read_u8(state);
+    /* Force mem_a20_recalc() to see a transition, so rammask gets rebuilt. */
+    mem_a20_state = !(mem_a20_key | mem_a20_alt);
+    mem_a20_recalc();
+
+    /* A snapshot taken in SMM may have had A20 unmasked by enter_smm(). */
+    if (in_smm && unmask_a20_in_smm) {
+        old_rammask = rammask;
+        rammask     = cpu_16bitbus ? 0xffffff : 0xffffffff;
+        if (is6117)
+            rammask |= 0x3000000;
+    }
+
+    flushmmucache();
+
+    return 0;
+}
+
 void
 mem_a20_recalc(void)
 {
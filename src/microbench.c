@@ -0,0 +1,984 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Micro-benchmarks of the emulator hot kernels.
+ *
+ *          Every kernel runs in isolation on synthetic input, without a
+ *          machine around it: only the pieces of the emulator it needs
+ *          are brought up. Each one is first run with a doubling number
+ *          of operations until a batch takes long enough to be timed,
+ *          then batches are repeated for the time budget. The fastest
+ *          batch is reported next to the average, as it is the one that
+ *          is the least disturbed by the host and the better number to
+ *          compare between builds.
+ *
+ *          Kernels that need a ROM, such as the EMU8000 one, are skipped
+ *          when it cannot be found in the roms directory of the current
+ *          directory.
+ *
+ *          Usage: 86Box-microbench [--time ms] [--json] [kernel ...]
+ *
+ *          Only the kernels whose name contains one of the given strings
+ *          are run, all of them if there are none.
+ *
+ *
+ *
+ */
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#include <math.h>
+#define HAVE_STDARG_H
+#include <86box/86box.h>
+#include "cpu.h"
+#include <86box/device.h>
+#include <86box/io.h>
+#include <86box/mem.h>
+#include <86box/rom.h>
+#include <86box/timer.h>
+#include <86box/plat.h>
+#include <86box/thread.h>
+#include <86box/video.h>
+#include <86box/vid_svga.h>
+#include <86box/vid_svga_render.h>
+#include <86box/vid_voodoo_common.h>
+#include <86box/vid_voodoo_regs.h>
+#include <86box/vid_voodoo_render.h>
+#include <86box/sound.h>
+#include <86box/snd_opl.h>
+#include <86box/snd_emu8k.h>
+#include <86box/cdrom_image_backend.h>
+#include <86box/network.h>
+#include <86box/vid_cga.h>
+#include <86box/vid_cga_comp.h>
+
+/* Time stamp counter rate the timers are programmed against. */
+#define MBENCH_TSC_MHZ    100
+/* A batch has to take at least this long to be timed. */
+#define MBENCH_BATCH_NS   2000000ULL
+#define MBENCH_DEF_TIME   250
+
+#define MBENCH_TIMERS     256
+#define MBENCH_MEM_KB     65536
+/* More pages than the 256 entry lookup caches hold, so every access misses. */
+#define MBENCH_MISS_PAGES 1024
+#define MBENCH_HIT_PAGES  64
+#define MBENCH_VRAM       (8 << 20)
+#define MBENCH_SVGA_W     1024
+#define MBENCH_SVGA_H     768
+#define MBENCH_FB_MEM     (4 << 20)
+#define MBENCH_ISO_SECTS  8192
+#define MBENCH_FRAME_LEN  1514
+
+typedef struct mbench_t {
+    const char *name;
+    const char *unit;
+    /* Returns zero if the kernel cannot run here. */
+    int (*init)(void);
+    /* Performs the given number of operations, returns the units processed. */
+    double (*run)(uint32_t ops);
+    void (*close)(void);
+} mbench_t;
+
+/* Not part of any header, as nothing outside their own files calls them. */
+extern void voodoo_triangle(voodoo_t *voodoo, voodoo_params_t *params, int odd_even);
+extern void nuked_write_reg(void *priv, uint16_t reg, uint8_t val);
+extern void nuked_generate(void *priv, int32_t *bufp);
+extern void gus_wave_sample(void *priv);
+extern void sound_poll(void *priv);
+
+static uint64_t mbench_time_ns = MBENCH_DEF_TIME * 1000000ULL;
+static uint32_t mbench_rand    = 0x86b0c5ed;
+
+static pc_timer_t mbench_timers[MBENCH_TIMERS];
+static uint64_t   mbench_timer_period[MBENCH_TIMERS];
+static uint64_t   mbench_timer_fired;
+
+static svga_t *mbench_svga;
+
+static voodoo_t       *mbench_voodoo;
+static voodoo_params_t mbench_voodoo_params;
+
+static void    *mbench_opl;
+static void    *mbench_gus;
+static emu8k_t *mbench_emu8k;
+
+static cd_img_t *mbench_cdi;
+static char      mbench_iso_fn[1024];
+static uint8_t   mbench_sector[RAW_SECTOR_SIZE];
+
+static netqueue_t mbench_netq;
+static uint8_t    mbench_frame[MBENCH_FRAME_LEN];
+
+static volatile uint32_t mbench_sink;
+
+static uint32_t
+mbench_random(void)
+{
+    /* xorshift32, so every run sees the same access patterns. */
+    mbench_rand ^= mbench_rand << 13;
+    mbench_rand ^= mbench_rand >> 17;
+    mbench_rand ^= mbench_rand << 5;
+
+    return mbench_rand;
+}
+
+/* Timers. */
+static void
+mbench_timer_callback(void *priv)
+{
+    pc_timer_t *timer = (pc_timer_t *) priv;
+
+    mbench_timer_fired++;
+    timer_advance_u64(timer, mbench_timer_period[timer - mbench_timers]);
+}
+
+static int
+mbench_timer_init(void)
+{
+    /* Start from an empty queue, so only our timers are in it. */
+    timer_close();
+    timer_init();
+
+    for (int i = 0; i < MBENCH_TIMERS; i++) {
+        /* Periods between 1 and 64 us, a typical spread of device timers. */
+        mbench_timer_period[i] = TIMER_USEC + ((mbench_random() % (63 * TIMER_USEC)) & ~0xffffffffULL);
+        timer_add(&mbench_timers[i], mbench_timer_callback, &mbench_timers[i], 0);
+        timer_set_delay_u64(&mbench_timers[i], mbench_timer_period[i]);
+    }
+
+    return 1;
+}
+
+static double
+mbench_timer_process_run(uint32_t ops)
+{
+    uint64_t start = mbench_timer_fired;
+
+    while ((mbench_timer_fired - start) < ops) {
+        /* Jump straight to the next expiry, as the CPU loop would. */
+        tsc += (uint32_t) (timer_target - (uint32_t) tsc);
+        timer_process();
+    }
+
+    return (double) (mbench_timer_fired - start);
+}
+
+static double
+mbench_timer_enable_run(uint32_t ops)
+{
+    pc_timer_t *timer;
+
+    for (uint32_t i = 0; i < ops; i++) {
+        timer = &mbench_timers[mbench_random() & (MBENCH_TIMERS - 1)];
+        timer_disable(timer);
+        timer_set_delay_u64(timer, mbench_timer_period[timer - mbench_timers]);
+    }
+
+    return (double) ops;
+}
+
+static void
+mbench_timer_close(void)
+{
+    timer_close();
+    timer_init();
+}
+
+/* Memory. */
+static int
+mbench_mem_init(void)
+{
+    static int inited = 0;
+
+    if (!inited) {
+        /* A 386DX with 64 MB of RAM and no paging. */
+        is286        = 1;
+        cpu_16bitbus = 0;
+        cpu_use_exec = 1;
+        mem_size     = MBENCH_MEM_KB;
+
+        mem_init();
+        resetreadlookup();
+        mem_reset();
+        inited = 1;
+    }
+
+    flushmmucache();
+    mbench_rand = 0x86b0c5ed;
+
+    return 1;
+}
+
+/* The same check the interpreter inlines before it calls readmemll(). */
+static __inline uint32_t
+mbench_readl(uint32_t addr)
+{
+    if ((readlookup2[addr >> 12] != (uintptr_t) LOOKUP_INV) && !(addr & 3))
+        return *(uint32_t *) (readlookup2[addr >> 12] + addr);
+
+    return readmemll(addr);
+}
+
+static __inline void
+mbench_writel(uint32_t addr, uint32_t val)
+{
+    if ((writelookup2[addr >> 12] != (uintptr_t) LOOKUP_INV) && !(addr & 3))
+        *(uint32_t *) (writelookup2[addr >> 12] + addr) = val;
+    else
+        writememll(addr, val);
+}
+
+static double
+mbench_mem_read_hit_run(uint32_t ops)
+{
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < ops; i++)
+        sum += mbench_readl(0x100000 + ((mbench_random() % (MBENCH_HIT_PAGES << 12)) & ~3));
+
+    mbench_sink = sum;
+    return (double) ops;
+}
+
+static double
+mbench_mem_read_miss_run(uint32_t ops)
+{
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < ops; i++)
+        sum += mbench_readl(0x100000 + ((mbench_random() % (MBENCH_MISS_PAGES << 12)) & ~3));
+
+    mbench_sink = sum;
+    return (double) ops;
+}
+
+static double
+mbench_mem_write_hit_run(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++)
+        mbench_writel(0x100000 + ((mbench_random() % (MBENCH_HIT_PAGES << 12)) & ~3), i);
+
+    return (double) ops;
+}
+
+static double
+mbench_mem_write_miss_run(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++)
+        mbench_writel(0x100000 + ((mbench_random() % (MBENCH_MISS_PAGES << 12)) & ~3), i);
+
+    return (double) ops;
+}
+
+/* SVGA line renderers. */
+static int
+mbench_svga_init(void)
+{
+    if (mbench_svga == NULL) {
+        mbench_svga = (svga_t *) calloc(1, sizeof(svga_t));
+
+        mbench_svga->monitor_index     = 0;
+        mbench_svga->monitor           = &monitors[0];
+        mbench_svga->vram              = (uint8_t *) malloc(MBENCH_VRAM);
+        mbench_svga->vram_max          = MBENCH_VRAM;
+        mbench_svga->vram_mask         = MBENCH_VRAM - 1;
+        mbench_svga->vram_display_mask = MBENCH_VRAM - 1;
+        mbench_svga->decode_mask       = 0x7fffff;
+        mbench_svga->changedvram       = (uint8_t *) calloc(MBENCH_VRAM >> 12, 1);
+        mbench_svga->glyph_cache       = video_glyph_cache_init();
+        mbench_svga->conv_16to32       = svga_conv_16to32;
+        mbench_svga->map8              = mbench_svga->pallook;
+        mbench_svga->x_add             = 8;
+        mbench_svga->y_add             = 16;
+        mbench_svga->firstline_draw    = 2000;
+        mbench_svga->fullchange        = 1;
+        mbench_svga->attrregs[0x12]    = 0x0f;
+        mbench_svga->crtc[0x17]        = 0xe3; /* Byte mode, as in the SVGA packed-pixel modes. */
+        mbench_svga->plane_mask        = 0x0f;
+
+        for (int i = 0; i < MBENCH_VRAM; i++)
+            mbench_svga->vram[i] = mbench_random() >> 24;
+        for (int i = 0; i < 256; i++)
+            mbench_svga->pallook[i] = mbench_random() & 0xffffff;
+        for (int i = 0; i < 16; i++)
+            mbench_svga->egapal[i] = i;
+
+        svga_recalc_remap_func(mbench_svga);
+        svga_render_simd_init();
+    }
+
+    mbench_svga->hdisp = MBENCH_SVGA_W;
+    mbench_svga->ma    = 0;
+
+    return 1;
+}
+
+static double
+mbench_svga_run(void (*render)(svga_t *svga), uint32_t ops, uint32_t pitch)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        mbench_svga->displine = i % MBENCH_SVGA_H;
+        mbench_svga->sc       = mbench_svga->displine & 15;
+        mbench_svga->ma       = (mbench_svga->displine * pitch) & mbench_svga->vram_display_mask;
+        render(mbench_svga);
+    }
+
+    return (double) ops * mbench_svga->hdisp;
+}
+
+static double
+mbench_svga_4bpp_run(uint32_t ops)
+{
+    return mbench_svga_run(svga_render_4bpp_highres, ops, MBENCH_SVGA_W / 2);
+}
+
+static double
+mbench_svga_8bpp_run(uint32_t ops)
+{
+    return mbench_svga_run(svga_render_8bpp_highres, ops, MBENCH_SVGA_W);
+}
+
+static double
+mbench_svga_16bpp_run(uint32_t ops)
+{
+    return mbench_svga_run(svga_render_16bpp_highres, ops, MBENCH_SVGA_W * 2);
+}
+
+static double
+mbench_svga_24bpp_run(uint32_t ops)
+{
+    return mbench_svga_run(svga_render_24bpp_highres, ops, MBENCH_SVGA_W * 3);
+}
+
+static double
+mbench_svga_32bpp_run(uint32_t ops)
+{
+    return mbench_svga_run(svga_render_32bpp_highres, ops, MBENCH_SVGA_W * 4);
+}
+
+static int
+mbench_svga_text_init(void)
+{
+    mbench_svga_init();
+
+    /* 80x25 with 9 dot wide characters. */
+    mbench_svga->hdisp = 720;
+
+    return 1;
+}
+
+static double
+mbench_svga_text_run(uint32_t ops)
+{
+    return mbench_svga_run(svga_render_text_80, ops, 0);
+}
+
+/* The same with a line of text in two colours, as on most DOS screens,
+   instead of random characters in random colours. */
+static int
+mbench_svga_dos_init(void)
+{
+    mbench_svga_text_init();
+
+    for (int i = 0; i < 80; i++) {
+        mbench_svga->vram[i << 2]       = 'A' + (i % 26);
+        mbench_svga->vram[(i << 2) + 1] = (i < 8) ? 0x1f : 0x07;
+    }
+
+    return 1;
+}
+
+/* CPU access to planar video memory, as in the 16 colour modes. */
+static int
+mbench_svga_planar_init(void)
+{
+    mbench_svga_init();
+
+    mbench_svga->gdcreg[6]     = 0x05; /* Graphics, A0000-AFFFF. */
+    mbench_svga->gdcreg[0]     = 0x05;
+    mbench_svga->gdcreg[1]     = 0x03;
+    mbench_svga->gdcreg[3]     = 0x18; /* XOR. */
+    mbench_svga->gdcreg[8]     = 0x5a;
+    mbench_svga->writemode     = 0;
+    mbench_svga->writemask     = 0x0f;
+    mbench_svga->readmode      = 1;
+    mbench_svga->colourcompare = 0x0a;
+    mbench_svga->colournocare  = 0x0f;
+
+    return 1;
+}
+
+static double
+mbench_svga_write_run(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++)
+        svga_write(0xa0000 + (i & 0xffff), i, mbench_svga);
+
+    return (double) ops;
+}
+
+static double
+mbench_svga_read_run(uint32_t ops)
+{
+    uint8_t ret = 0;
+
+    for (uint32_t i = 0; i < ops; i++)
+        ret ^= svga_read(0xa0000 + (i & 0xffff), mbench_svga);
+    mbench_sink += ret;
+
+    return (double) ops;
+}
+
+/* CGA composite colour decoding, 640 pixels a line. */
+#define MBENCH_COMP_LINES 256
+
+static uint32_t *mbench_comp_lines;
+static uint32_t  mbench_comp_line[640];
+
+static int
+mbench_comp_init(void)
+{
+    if (mbench_comp_lines == NULL) {
+        mbench_comp_lines = (uint32_t *) malloc(MBENCH_COMP_LINES * 640 * sizeof(uint32_t));
+        for (int i = 0; i < (MBENCH_COMP_LINES * 640); i++)
+            mbench_comp_lines[i] = mbench_random() & 0x0f;
+    }
+
+    /* More distinct lines than are kept decoded, so every line is worked out. */
+    cga_comp_init(0);
+    update_cga16_color(0x1a);
+
+    return 1;
+}
+
+static double
+mbench_comp_run(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        memcpy(mbench_comp_line, &mbench_comp_lines[(i % MBENCH_COMP_LINES) * 640], sizeof(mbench_comp_line));
+        Composite_Process(0x1a, 0, 160, mbench_comp_line);
+    }
+
+    return (double) ops * 640;
+}
+
+/* Voodoo rasteriser. */
+static int
+mbench_voodoo_init(int recompiler)
+{
+    voodoo_params_t *params = &mbench_voodoo_params;
+
+#ifdef NO_CODEGEN
+    if (recompiler)
+        return 0;
+#endif
+
+    if (mbench_voodoo == NULL) {
+        mbench_voodoo = (voodoo_t *) calloc(1, sizeof(voodoo_t));
+
+        mbench_voodoo->type    = VOODOO_1;
+        mbench_voodoo->fb_mem  = (uint8_t *) calloc(MBENCH_FB_MEM, 1);
+        mbench_voodoo->fb_mask = MBENCH_FB_MEM - 1;
+        mbench_voodoo->h_disp  = 640;
+        mbench_voodoo->v_disp  = 480;
+#ifndef NO_CODEGEN
+        voodoo_codegen_init(mbench_voodoo);
+#endif
+    }
+    mbench_voodoo->use_recompiler = recompiler;
+
+    /* A large Gouraud shaded, dithered and depth buffered triangle.
+       Vertices are 12.4 fixed point, colours and depth 12.12. */
+    memset(params, 0, sizeof(voodoo_params_t));
+    params->vertexAx = 320 << 4;
+    params->vertexAy = 16 << 4;
+    params->vertexBx = 32 << 4;
+    params->vertexBy = 400 << 4;
+    params->vertexCx = 608 << 4;
+    params->vertexCy = 464 << 4;
+    params->sign     = 1;
+
+    params->startR = 0x20 << 12;
+    params->startG = 0x80 << 12;
+    params->startB = 0xe0 << 12;
+    params->startA = 0xff << 12;
+    params->startZ = 0x8000 << 12;
+    params->dRdX   = 1 << 11;
+    params->dGdY   = 1 << 11;
+    params->dBdX   = -(1 << 11);
+    params->dZdX   = 16 << 12;
+    params->dZdY   = -(16 << 12);
+
+    params->fbzMode     = FBZ_RGB_WMASK | FBZ_DEPTH_WMASK | FBZ_DEPTH_ENABLE | FBZ_DITHER | (DEPTHOP_ALWAYS << 5);
+    params->draw_offset = 0;
+    params->aux_offset  = MBENCH_FB_MEM / 2;
+    params->row_width   = 640 * 2;
+
+    return 1;
+}
+
+static int
+mbench_voodoo_interp_init(void)
+{
+    return mbench_voodoo_init(0);
+}
+
+static int
+mbench_voodoo_recomp_init(void)
+{
+    return mbench_voodoo_init(1);
+}
+
+static double
+mbench_voodoo_run(uint32_t ops)
+{
+    int start = mbench_voodoo->fbiPixelsIn;
+
+    for (uint32_t i = 0; i < ops; i++)
+        voodoo_triangle(mbench_voodoo, &mbench_voodoo_params, 0);
+
+    return (double) (mbench_voodoo->fbiPixelsIn - start);
+}
+
+/* Nuked OPL3. */
+static int
+mbench_opl_init(void)
+{
+    static const uint8_t op_offset[9] = { 0x00, 0x01, 0x02, 0x08, 0x09, 0x0a, 0x10, 0x11, 0x12 };
+    uint16_t             bank;
+    uint16_t             op;
+
+    if (mbench_opl == NULL)
+        mbench_opl = device_add(&ymf262_nuked_device);
+
+    /* OPL3 mode, then all 18 two-operator channels keyed on with their
+       own waveform, feedback and pitch. */
+    nuked_write_reg(mbench_opl, 0x105, 0x01);
+    for (uint8_t ch = 0; ch < 18; ch++) {
+        bank = (ch >= 9) ? 0x100 : 0x000;
+        op   = bank | op_offset[ch % 9];
+
+        for (uint8_t i = 0; i < 2; i++, op += 3) {
+            nuked_write_reg(mbench_opl, 0x20 + op, 0x21 + i);
+            nuked_write_reg(mbench_opl, 0x40 + op, i ? 0x00 : 0x18);
+            nuked_write_reg(mbench_opl, 0x60 + op, 0xf2);
+            nuked_write_reg(mbench_opl, 0x80 + op, 0x53);
+            nuked_write_reg(mbench_opl, 0xe0 + op, (ch + i) & 7);
+        }
+
+        nuked_write_reg(mbench_opl, bank + 0xc0 + (ch % 9), 0x30 | ((ch & 7) << 1));
+        nuked_write_reg(mbench_opl, bank + 0xa0 + (ch % 9), 0x41 + (ch * 13));
+        nuked_write_reg(mbench_opl, bank + 0xb0 + (ch % 9), 0x20 | (((ch % 6) + 2) << 2) | 0x01);
+    }
+
+    return 1;
+}
+
+static double
+mbench_opl_run(uint32_t ops)
+{
+    int32_t buf[2];
+
+    for (uint32_t i = 0; i < ops; i++)
+        nuked_generate(mbench_opl, buf);
+
+    mbench_sink = buf[0];
+    return (double) ops;
+}
+
+/* Gravis UltraSound. */
+static void
+mbench_gus_write(uint8_t reg, uint16_t val)
+{
+    outb(0x0323, reg);
+    outb(0x0324, val & 0xff);
+    outb(0x0325, val >> 8);
+}
+
+static int
+mbench_gus_init(void)
+{
+    uint32_t addr;
+
+    if (mbench_gus != NULL)
+        return 1;
+
+    /* At the default 220h. */
+    mbench_gus = device_add(&gus_device);
+
+    /* 32 looping 8-bit voices, each at its own interpolated pitch. */
+    for (uint8_t d = 0; d < 32; d++) {
+        addr = (d * 0x4000) << 9;
+
+        outb(0x0322, d);
+        mbench_gus_write(0x01, 0x0100 + (d * 24));
+        mbench_gus_write(0x02, addr >> 16);
+        mbench_gus_write(0x03, addr & 0xffff);
+        mbench_gus_write(0x04, (addr + (0x2000 << 9)) >> 16);
+        mbench_gus_write(0x05, (addr + (0x2000 << 9)) & 0xffff);
+        mbench_gus_write(0x0a, addr >> 16);
+        mbench_gus_write(0x0b, addr & 0xffff);
+        mbench_gus_write(0x09, 0xf000);
+        mbench_gus_write(0x0c, (d & 15) << 8);
+        mbench_gus_write(0x0d, 0x0300);
+        mbench_gus_write(0x00, 0x0800);
+    }
+    mbench_gus_write(0x0e, 0xdf00);
+    mbench_gus_write(0x4c, 0x0700);
+
+    return 1;
+}
+
+static double
+mbench_gus_run(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++)
+        gus_wave_sample(mbench_gus);
+
+    return (double) ops * 32;
+}
+
+/* EMU8000. */
+static void
+mbench_sound_get_buffer(UNUSED(int32_t *buffer), UNUSED(int len), UNUSED(void *priv))
+{
+    /* Nothing to add, measures the mixing around the devices. */
+}
+
+static void
+mbench_emu8k_get_buffer(UNUSED(int32_t *buffer), UNUSED(int len), void *priv)
+{
+    emu8k_t *emu8k = (emu8k_t *) priv;
+
+    emu8k_update(emu8k);
+    emu8k->pos = 0;
+}
+
+static int
+mbench_sound_init(void)
+{
+    static int inited = 0;
+
+    if (!inited) {
+        sound_reset();
+        sound_speed_changed();
+        sound_add_handler(mbench_sound_get_buffer, NULL);
+        /* The first call only starts the buffer. */
+        sound_poll(NULL);
+        inited = 1;
+    }
+
+    return 1;
+}
+
+static int
+mbench_emu8k_init(void)
+{
+    emu8k_voice_t *voice;
+
+    if (mbench_emu8k != NULL)
+        return 1;
+
+    if (!rom_present("roms/sound/creative/awe32.raw"))
+        return 0;
+
+    mbench_sound_init();
+
+    mbench_emu8k = (emu8k_t *) calloc(1, sizeof(emu8k_t));
+    emu8k_init(mbench_emu8k, 0x620, 512);
+    mbench_emu8k->hwcf3 |= 0x04;
+
+    /* 32 voices looping over the sample ROM in their sustain phase, all
+       through the filter, at their own pitch and pan. */
+    for (uint8_t c = 0; c < 32; c++) {
+        voice = &mbench_emu8k->voice[c];
+
+        voice->addr.int_address       = 0x1000 + (c * 0x2000);
+        voice->loop_start.int_address = voice->addr.int_address;
+        voice->loop_end.int_address   = voice->addr.int_address + 0x1800;
+        voice->ip                     = 0xd000 + (c * 0x100);
+        voice->initial_att            = 0;
+        voice->initial_filter         = 0x100000 + (c * 0x8000);
+        voice->filterq_idx            = c & 15;
+        voice->filt_att               = 0x100;
+        voice->vol_l                  = 0xff - (c * 8);
+        voice->vol_r                  = c * 8;
+        voice->vol_envelope.state     = 5; /* ENV_SUSTAIN */
+        voice->cvcf_curr_volume       = 0x8000;
+        voice->env_engine_on          = 1;
+    }
+
+    sound_add_handler(mbench_emu8k_get_buffer, mbench_emu8k);
+
+    return 1;
+}
+
+static double
+mbench_sound_run(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++)
+        sound_poll(NULL);
+
+    return (double) ops * SOUNDBUFLEN;
+}
+
+/* CD-ROM image. */
+static int
+mbench_cdi_init(void)
+{
+    FILE *fp;
+
+    if (mbench_cdi != NULL)
+        return 1;
+
+    plat_tempfile(mbench_iso_fn, "mbench", ".iso");
+    fp = plat_fopen(mbench_iso_fn, "wb");
+    if (fp == NULL)
+        return 0;
+
+    for (int i = 0; i < MBENCH_ISO_SECTS; i++) {
+        for (int j = 0; j < COOKED_SECTOR_SIZE; j++)
+            mbench_sector[j] = mbench_random() >> 24;
+        fwrite(mbench_sector, 1, COOKED_SECTOR_SIZE, fp);
+    }
+    fclose(fp);
+
+    mbench_cdi = (cd_img_t *) calloc(1, sizeof(cd_img_t));
+    if (!cdi_load_iso(mbench_cdi, mbench_iso_fn)) {
+        cdi_close(mbench_cdi);
+        mbench_cdi = NULL;
+        plat_remove(mbench_iso_fn);
+        return 0;
+    }
+
+    return 1;
+}
+
+static double
+mbench_cdi_run(int raw, uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++)
+        cdi_read_sector(mbench_cdi, mbench_sector, raw, i % MBENCH_ISO_SECTS);
+
+    return (double) ops * (raw ? RAW_SECTOR_SIZE : COOKED_SECTOR_SIZE) / 1048576.0;
+}
+
+static double
+mbench_cdi_cooked_run(uint32_t ops)
+{
+    return mbench_cdi_run(0, ops);
+}
+
+static double
+mbench_cdi_raw_run(uint32_t ops)
+{
+    return mbench_cdi_run(1, ops);
+}
+
+static void
+mbench_cdi_close(void)
+{
+    cdi_close(mbench_cdi);
+    mbench_cdi = NULL;
+    plat_remove(mbench_iso_fn);
+}
+
+/* Network packet queue. */
+static int
+mbench_netq_init(void)
+{
+    network_queue_init(&mbench_netq);
+
+    for (int i = 0; i < MBENCH_FRAME_LEN; i++)
+        mbench_frame[i] = mbench_random() >> 24;
+
+    return 1;
+}
+
+static double
+mbench_netq_run(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++) {
+        network_queue_put(&mbench_netq, mbench_frame, MBENCH_FRAME_LEN);
+        /* The other end takes it right away, so the queue never fills up. */
+        mbench_netq.tail = mbench_netq.head;
+    }
+
+    return (double) ops * MBENCH_FRAME_LEN / 1048576.0;
+}
+
+static void
+mbench_netq_close(void)
+{
+    network_queue_clear(&mbench_netq);
+}
+
+static const mbench_t mbench_kernels[] = {
+  // clang-format off
+    { "timer_process (256 timers)",            "callbacks",   mbench_timer_init,         mbench_timer_process_run, NULL               },
+    { "timer_enable (256 timers)",             "timers",      mbench_timer_init,         mbench_timer_enable_run,  mbench_timer_close },
+    { "readmemll (lookup hit)",                "accesses",    mbench_mem_init,           mbench_mem_read_hit_run,  NULL               },
+    { "readmemll (lookup miss)",               "accesses",    mbench_mem_init,           mbench_mem_read_miss_run, NULL               },
+    { "writememll (lookup hit)",               "accesses",    mbench_mem_init,           mbench_mem_write_hit_run, NULL               },
+    { "writememll (lookup miss)",              "accesses",    mbench_mem_init,           mbench_mem_write_miss_run,NULL               },
+    { "svga_render_text_80",                   "pixels",      mbench_svga_text_init,     mbench_svga_text_run,     NULL               },
+    { "svga_render_text_80 (text screen)",     "pixels",      mbench_svga_dos_init,      mbench_svga_text_run,     NULL               },
+    { "svga_write (planar, XOR)",              "bytes",       mbench_svga_planar_init,   mbench_svga_write_run,    NULL               },
+    { "svga_read (planar, colour compare)",    "bytes",       mbench_svga_planar_init,   mbench_svga_read_run,     NULL               },
+    { "Composite_Process (CGA composite)",      "pixels",      mbench_comp_init,          mbench_comp_run,          NULL               },
+    { "svga_render_4bpp_highres",              "pixels",      mbench_svga_init,          mbench_svga_4bpp_run,     NULL               },
+    { "svga_render_8bpp_highres",              "pixels",      mbench_svga_init,          mbench_svga_8bpp_run,     NULL               },
+    { "svga_render_16bpp_highres",             "pixels",      mbench_svga_init,          mbench_svga_16bpp_run,    NULL               },
+    { "svga_render_24bpp_highres",             "pixels",      mbench_svga_init,          mbench_svga_24bpp_run,    NULL               },
+    { "svga_render_32bpp_highres",             "pixels",      mbench_svga_init,          mbench_svga_32bpp_run,    NULL               },
+    { "voodoo_triangle (interpreter)",         "pixels",      mbench_voodoo_interp_init, mbench_voodoo_run,        NULL               },
+    { "voodoo_triangle (recompiler)",          "pixels",      mbench_voodoo_recomp_init, mbench_voodoo_run,        NULL               },
+    { "nuked_generate (18 channels)",          "samples",     mbench_opl_init,           mbench_opl_run,           NULL               },
+    { "gus_wave_sample (32 voices)",           "voice samples", mbench_gus_init,         mbench_gus_run,           NULL               },
+    { "sound_poll (mixer only)",               "samples",     mbench_sound_init,         mbench_sound_run,         NULL               },
+    { "sound_poll (mixer and emu8k_update)",   "samples",     mbench_emu8k_init,         mbench_sound_run,         NULL               },
+    { "cdi_read_sector (ISO, cooked)",         "MB",          mbench_cdi_init,           mbench_cdi_cooked_run,    NULL               },
+    { "cdi_read_sector (ISO, raw)",            "MB",          mbench_cdi_init,           mbench_cdi_raw_run,       mbench_cdi_close   },
+    { "network_queue_put (1514 byte frames)",  "MB",          mbench_netq_init,          mbench_netq_run,          mbench_netq_close  },
+    { NULL,                                    NULL,          NULL,                      NULL,                     NULL               }
+  // clang-format on
+};
+
+static int
+mbench_selected(const mbench_t *mb, int argc, char **argv, int first)
+{
+    if (first >= argc)
+        return 1;
+
+    for (int i = first; i < argc; i++) {
+        if (strstr(mb->name, argv[i]) != NULL)
+            return 1;
+    }
+
+    return 0;
+}
+
+static void
+mbench_measure(const mbench_t *mb, double *ns_min, double *ns_avg, double *units_per_sec)
+{
+    uint32_t ops = 1;
+    uint64_t start;
+    uint64_t elapsed;
+    uint64_t total_ns    = 0;
+    uint64_t total_ops   = 0;
+    double   total_units = 0.0;
+    double   units;
+
+    /* Warm up, and find a batch size that can be timed. */
+    do {
+        start   = plat_get_nano_ticks();
+        mb->run(ops);
+        elapsed = plat_get_nano_ticks() - start;
+        if (elapsed < MBENCH_BATCH_NS)
+            ops <<= 1;
+    } while ((elapsed < MBENCH_BATCH_NS) && (ops < (1U << 30)));
+
+    *ns_min = HUGE_VAL;
+    while (total_ns < mbench_time_ns) {
+        start   = plat_get_nano_ticks();
+        units   = mb->run(ops);
+        elapsed = plat_get_nano_ticks() - start;
+
+        if (((double) elapsed / ops) < *ns_min)
+            *ns_min = (double) elapsed / ops;
+        total_ns += elapsed;
+        total_ops += ops;
+        total_units += units;
+    }
+
+    *ns_avg        = (double) total_ns / total_ops;
+    *units_per_sec = total_units * 1000000000.0 / total_ns;
+}
+
+static void
+mbench_usage(const char *name)
+{
+    printf("Usage: %s [--time ms] [--json] [kernel ...]\n\n", name);
+    printf("Kernels:\n");
+    for (const mbench_t *mb = mbench_kernels; mb->name != NULL; mb++)
+        printf("  %s\n", mb->name);
+}
+
+int
+main(int argc, char **argv)
+{
+    int    json  = 0;
+    int    first = 1;
+    int    count = 0;
+    double ns_min;
+    double ns_avg;
+    double rate;
+
+    for (; first < argc; first++) {
+        if (!strcmp(argv[first], "--time") && ((first + 1) < argc))
+            mbench_time_ns = (uint64_t) atoi(argv[++first]) * 1000000ULL;
+        else if (!strcmp(argv[first], "--json"))
+            json = 1;
+        else if (!strcmp(argv[first], "--help") || !strcmp(argv[first], "-?")) {
+            mbench_usage(argv[0]);
+            return 0;
+        } else
+            break;
+    }
+    if (mbench_time_ns == 0)
+        mbench_time_ns = MBENCH_DEF_TIME * 1000000ULL;
+
+    /* What pc_init() and a hard reset would bring up, minus the machine. */
+    TIMER_USEC = (uint64_t) MBENCH_TSC_MHZ << 32;
+    io_init();
+    timer_init();
+    device_init();
+    video_init();
+    sound_init();
+
+    if (json)
+        printf("[\n");
+    else
+        printf("%-40s %12s %12s   %s\n", "kernel", "ns/op (min)", "ns/op (avg)", "throughput");
+
+    for (const mbench_t *mb = mbench_kernels; mb->name != NULL; mb++) {
+        if (!mbench_selected(mb, argc, argv, first))
+            continue;
+
+        if (!mb->init()) {
+            if (!json)
+                printf("%-40s %12s\n", mb->name, "skipped");
+            continue;
+        }
+
+        mbench_measure(mb, &ns_min, &ns_avg, &rate);
+
+        if (json) {
+            printf("%s  { \"kernel\": \"%s\", \"ns_per_op_min\": %.2f, \"ns_per_op_avg\": %.2f, "
+                   "\"throughput\": %.1f, \"unit\": \"%s/s\" }",
+                   count ? ",\n" : "", mb->name, ns_min, ns_avg, rate, mb->unit);
+        } else if (rate >= 1000000.0)
+            printf("%-40s %12.2f %12.2f   %.2f M%s/s\n", mb->name, ns_min, ns_avg, rate / 1000000.0, mb->unit);
+        else
+            printf("%-40s %12.2f %12.2f   %.1f %s/s\n", mb->name, ns_min, ns_avg, rate, mb->unit);
+        fflush(stdout);
+        count++;
+
+        if (mb->close != NULL)
+            mb->close();
+    }
+
+    if (json)
+        printf("%s]\n", count ? "\n" : "");
+
+    return 0;
+}
@@ -5,6 +5,7 @@
 
 // See minitrace.h for basic documentation.
 
+#include <inttypes.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -70,6 +71,8 @@ static volatile int event_count;
 static __attribute__ ((aligned (32))) atomic_long is_tracing = FALSE;
 static __attribute__ ((aligned (32))) atomic_long stop_flushing_requested = FALSE;
 static int is_flushing = FALSE;
+static int is_ring = FALSE;
+static int ring_wrapped = FALSE;
 static int events_in_progress = 0;
 static int64_t time_offset;
 static int first_line = 1;
@@ -211,8 +214,8 @@ static void termination_handler(int signum) {
     if (is_tracing) {
         printf("Ctrl-C detected! Flushing trace and shutting down.\n\n");
         mtr_flush();
-        fwrite("\n]}\n", 1, 4, f);
-        fclose(f);
+        fwrite("\n]}\n", 1, 4, fp);
+        fclose(fp);
     }
     exit(1);
 }
@@ -232,9 +235,10 @@ void mtr_init_from_stream(void *stream) {
 #ifndef MTR_ENABLED
     return;
 #endif
-    event_buffer = (raw_event_t *)malloc(INTERNAL_MINITRACE_BUFFER_SIZE * sizeof(raw_event_t));
-    flush_buffer = (raw_event_t *)malloc(INTERNAL_MINITRACE_BUFFER_SIZE * sizeof(raw_event_t));
+    event_buffer = (raw_event_t *)calloc(INTERNAL_MINITRACE_BUFFER_SIZE, sizeof(raw_event_t));
+    flush_buffer = (raw_event_t *)calloc(INTERNAL_MINITRACE_BUFFER_SIZE, sizeof(raw_event_t));
     event_count = 0;
+    ring_wrapped = FALSE;
     fp = (FILE *) stream;
     const char *header = "{\"traceEvents\":[\n";
     fwrite(header, 1, strlen(header), fp);
@@ -265,6 +269,8 @@ void mtr_shutdown(void) {
     fp = 0;
     free(event_buffer);
     event_buffer = 0;
+    free(flush_buffer);
+    flush_buffer = 0;
     for (uint8_t i = 0; i < STRING_POOL_SIZE; i++) {
         if (str_pool[i]) {
             free(str_pool[i]);
@@ -299,7 +305,17 @@ void mtr_start(void) {
     pthread_cond_init(&buffer_full_cond, NULL);
 #endif
     atomic_store(&is_tracing, TRUE);
-    init_flushing_thread();
+    // A ring buffer is only written out on shutdown.
+    if (is_ring) {
+        pthread_mutex_lock(&mutex);
+        is_flushing = FALSE;
+        pthread_mutex_unlock(&mutex);
+    } else
+        init_flushing_thread();
+}
+
+void mtr_set_ring_buffer(int enable) {
+    is_ring = enable;
 }
 
 void mtr_stop(void) {
@@ -310,7 +326,8 @@ void mtr_stop(void) {
     atomic_store(&stop_flushing_requested, TRUE);
     pthread_cond_signal(&buffer_not_full_cond);
     pthread_cond_signal(&buffer_full_cond);
-    join_flushing_thread();
+    if (!is_ring)
+        join_flushing_thread();
     atomic_store(&stop_flushing_requested, FALSE);
 }
 
@@ -328,6 +345,7 @@ void mtr_flush_with_state(int is_last) {
     char arg_buf[1024];
     char id_buf[256];
     int event_count_copy = 0;
+    int event_start = 0;
     int events_in_progress_copy = 1;
     raw_event_t *event_buffer_tmp = NULL;
 
@@ -341,6 +359,10 @@ void mtr_flush_with_state(int is_last) {
         pthread_mutex_unlock(&mutex);
         return;
     }
+    if (is_ring && !is_last) {
+        pthread_mutex_unlock(&mutex);
+        return;
+    }
     is_flushing = TRUE;
     if(!is_last) {
         while(event_count < INTERNAL_MINITRACE_BUFFER_SIZE && atomic_load(&is_tracing)) {
@@ -348,6 +370,12 @@ void mtr_flush_with_state(int is_last) {
         }
     }
     event_count_copy = event_count;
+    if (ring_wrapped) {
+        // Oldest event first.
+        event_start = event_count;
+        event_count_copy = INTERNAL_MINITRACE_BUFFER_SIZE;
+        ring_wrapped = FALSE;
+    }
     event_buffer_tmp = flush_buffer;
     flush_buffer = event_buffer;
     event_buffer = event_buffer_tmp;
@@ -362,7 +390,7 @@ void mtr_flush_with_state(int is_last) {
     pthread_cond_signal(&buffer_not_full_cond);
 
     for (i = 0; i < event_count_copy; i++) {
-        raw_event_t *raw = &flush_buffer[i];
+        raw_event_t *raw = &flush_buffer[(event_start + i) % INTERNAL_MINITRACE_BUFFER_SIZE];
         int len;
         switch (raw->arg_type) {
         case MTR_ARG_TYPE_INT:
@@ -419,11 +447,12 @@ void mtr_flush_with_state(int is_last) {
         len = snprintf(linebuf, ARRAY_SIZE(linebuf), "%s{\"cat\":\"%s\",\"pid\":%i,\"tid\":%i,\"ts\":%" PRId64 ",\"ph\":\"%c\",\"name\":\"%s\",\"args\":{%s}%s}",
                 first_line ? "" : ",\n",
                 cat, raw->pid, raw->tid, raw->ts - time_offset, raw->ph, raw->name, arg_buf, id_buf);
-        fwrite(linebuf, 1, len, f);
+        fwrite(linebuf, 1, len, fp);
         first_line = 0;
 
         if (raw->arg_type == MTR_ARG_TYPE_STRING_COPY) {
             free((void*)raw->a_str);
+            raw->arg_type = MTR_ARG_TYPE_NONE;
         }
         #ifdef MTR_COPY_EVENT_CATEGORY_AND_NAME
         free(raw->name);
@@ -449,18 +478,27 @@ void internal_mtr_raw_event(const char *category, const char *name, char ph, voi
         return;
     }
     pthread_mutex_lock(&mutex);
+    if (is_ring && event_count >= INTERNAL_MINITRACE_BUFFER_SIZE) {
+        event_count = 0;
+        ring_wrapped = TRUE;
+    }
     while(event_count >= INTERNAL_MINITRACE_BUFFER_SIZE && atomic_load(&is_tracing)) {
         pthread_cond_wait(&buffer_not_full_cond, &mutex);
 
     }
     raw_event_t *ev = &event_buffer[event_count];
+    if (ev->arg_type == MTR_ARG_TYPE_STRING_COPY) {
+        // Overwriting the oldest event of a ring buffer.
+        free((void*)ev->a_str);
+        ev->arg_type = MTR_ARG_TYPE_NONE;
+    }
     ++event_count;
     pthread_mutex_lock(&event_mutex);
     ++events_in_progress;
     pthread_mutex_unlock(&event_mutex);
     int local_event_count = event_count;
     pthread_mutex_unlock(&mutex);
-    if(local_event_count >= INTERNAL_MINITRACE_BUFFER_SIZE) {
+    if(local_event_count >= INTERNAL_MINITRACE_BUFFER_SIZE && !is_ring) {
         pthread_cond_signal(&buffer_full_cond);
     }
 
@@ -514,17 +552,26 @@ void internal_mtr_raw_event_arg(const char *category, const char *name, char ph,
         return;
     }
     pthread_mutex_lock(&mutex);
+    if (is_ring && event_count >= INTERNAL_MINITRACE_BUFFER_SIZE) {
+        event_count = 0;
+        ring_wrapped = TRUE;
+    }
     while(event_count >= INTERNAL_MINITRACE_BUFFER_SIZE && atomic_load(&is_tracing)) {
         pthread_cond_wait(&buffer_not_full_cond, &mutex);
     }
     raw_event_t *ev = &event_buffer[event_count];
+    if (ev->arg_type == MTR_ARG_TYPE_STRING_COPY) {
+        // Overwriting the oldest event of a ring buffer.
+        free((void*)ev->a_str);
+        ev->arg_type = MTR_ARG_TYPE_NONE;
+    }
     ++event_count;
     pthread_mutex_lock(&event_mutex);
     ++events_in_progress;
     pthread_mutex_unlock(&event_mutex);
     int local_event_count = event_count;
     pthread_mutex_unlock(&mutex);
-    if(local_event_count >= INTERNAL_MINITRACE_BUFFER_SIZE) {
+    if(local_event_count >= INTERNAL_MINITRACE_BUFFER_SIZE && !is_ring) {
         pthread_cond_signal(&buffer_full_cond);
     }
 
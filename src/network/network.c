@@ -67,6 +67,7 @@
 #include <86box/ui.h>
 #include <86box/timer.h>
 #include <86box/network.h>
+#include <86box/replay.h>
 #include <86box/net_3c501.h>
 #include <86box/net_3c503.h>
 #include <86box/net_ne2000.h>
@@ -75,6 +76,7 @@
 #include <86box/net_wd8003.h>
 #include <86box/net_tulip.h>
 #include <86box/net_rtl8139.h>
+#include <minitrace/minitrace.h>
 
 #ifdef _WIN32
 #    define WIN32_LEAN_AND_MEAN
@@ -388,7 +390,8 @@ network_rx_queue(void *priv)
 {
     netcard_t *card = (netcard_t *) priv;
 
-    uint32_t new_link_state = net_cards_conf[card->card_num].link_state;
+    uint32_t new_link_state = replay_net_link(card->card_num, card->link_state,
+                                              net_cards_conf[card->card_num].link_state);
     if (new_link_state != card->link_state) {
         if (card->set_link_state)
             card->set_link_state(card->card_drv, new_link_state);
@@ -396,11 +399,16 @@ network_rx_queue(void *priv)
     }
 
     uint32_t rx_bytes = 0;
+    MTR_BEGIN("network", "rx");
     for (int i = 0; i < NET_QUEUE_LEN; i++) {
         if (card->queued_pkt.len == 0) {
             thread_wait_mutex(card->rx_mutex);
             int res = network_queue_get_swap(&card->queues[NET_QUEUE_RX], &card->queued_pkt);
             thread_release_mutex(card->rx_mutex);
+            /* Record the packet as it enters the card, or swap in the one
+               that entered it at this point of the recorded session. */
+            if (replay_net_rx(card->card_num, card->queued_pkt.data, &card->queued_pkt.len, NET_MAX_FRAME, res))
+                res = (card->queued_pkt.len != 0);
             if (!res)
                 break;
         }
@@ -412,9 +420,11 @@ network_rx_queue(void *priv)
         rx_bytes += card->queued_pkt.len;
         card->queued_pkt.len = 0;
     }
+    MTR_END_I("network", "rx", "bytes", rx_bytes);
 
     /* Transmission. */
     uint32_t tx_bytes = 0;
+    MTR_BEGIN("network", "tx");
     thread_wait_mutex(card->tx_mutex);
     for (int i = 0; i < NET_QUEUE_LEN; i++) {
         uint32_t bytes = network_queue_move(&card->queues[NET_QUEUE_TX_HOST], &card->queues[NET_QUEUE_TX_VM]);
@@ -427,6 +437,7 @@ network_rx_queue(void *priv)
         /* Notify host that a packet is available in the TX queue */
         card->host_drv.notify_in(card->host_drv.priv);
     }
+    MTR_END_I("network", "tx", "bytes", tx_bytes);
 
     double timer_period = card->byte_period * (rx_bytes > tx_bytes ? rx_bytes : tx_bytes);
     if (timer_period < 200)
@@ -595,6 +606,7 @@ network_reset(void)
 void
 network_tx(netcard_t *card, uint8_t *bufp, int len)
 {
+    MTR_INSTANT_I("network", "network_tx", "len", len);
     network_queue_put(&card->queues[NET_QUEUE_TX_VM], bufp, len);
 }
 
@@ -633,6 +645,7 @@ network_rx_put(netcard_t *card, uint8_t *bufp, int len)
 {
     int ret = 0;
 
+    MTR_INSTANT_I("network", "network_rx_put", "len", len);
     thread_wait_mutex(card->rx_mutex);
     ret = network_queue_put(&card->queues[NET_QUEUE_RX], bufp, len);
     thread_release_mutex(card->rx_mutex);
@@ -59,6 +59,8 @@
 #include <86box/path.h>
 #include <86box/plat.h>
 #include <86box/nvr.h>
+#include <86box/replay.h>
+#include <86box/bench.h>
 
 int nvr_dosave; /* NVR is dirty, needs saved */
 
@@ -228,8 +230,9 @@ nvr_load(void)
     FILE       *fp;
     uint8_t     regs[NVR_MAXSIZE] = { 0 };
 
-    /* Make sure we have been initialized. */
-    if (saved_nvr == NULL)
+    /* Make sure we have been initialized, and that every
+       benchmark run starts from the same CMOS contents. */
+    if ((saved_nvr == NULL) || bench_active)
         return 0;
 
     /* Clear out any old data. */
@@ -277,8 +280,9 @@ nvr_save(void)
     const char *path;
     FILE       *fp;
 
-    /* Make sure we have been initialized. */
-    if (saved_nvr == NULL)
+    /* Make sure we have been initialized, and that every
+       benchmark run starts from the same CMOS contents. */
+    if ((saved_nvr == NULL) || bench_active)
         return 0;
 
     if (saved_nvr->size != 0) {
@@ -315,6 +319,9 @@ nvr_time_sync(void)
 
     /* Get the current time of day, and convert to local time. */
     (void) time(&now);
+    if (bench_active)
+        now = (time_t) BENCH_HOST_TIME;
+    now = (time_t) replay_host_time((int64_t) now);
     if (time_sync & TIME_SYNC_UTC)
         tm = gmtime(&now);
     else
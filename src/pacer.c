@@ -0,0 +1,158 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Emulation thread pacing scheduler.
+ *
+ *          Slices of emulated time are run against absolute deadlines
+ *          on the host's monotonic nanosecond clock, so time lost to a
+ *          late wakeup or a slow slice is made up by the next ones
+ *          instead of accumulating. When the host falls too far behind
+ *          the missed slices are dropped rather than run in a burst.
+ *
+ *          Sleeps are shortened by how late the host has been waking
+ *          the thread up recently; a slice that is due within a short
+ *          margin is run straight away rather than spun for, which is
+ *          harmless as the following deadline does not move.
+ *
+ *          Optionally, a host clock such as the audio output can pull
+ *          the deadlines slightly towards itself, to stop the two from
+ *          drifting apart over time.
+ *
+ *
+ *
+ */
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#define HAVE_STDARG_H
+#include <86box/86box.h>
+#include <86box/plat.h>
+#include <86box/pacer.h>
+
+/* Slices due within this margin are run early instead of slept for. */
+#define PACER_EARLY_NS     200000ULL
+#define PACER_OVERSLEEP_NS 1000000ULL
+
+static struct {
+    uint64_t      period;
+    uint64_t      deadline;
+    uint64_t      oversleep;
+    uint64_t      lag;
+    int64_t       drift;
+    int           started;
+    pacer_stats_t stats;
+} pacer;
+
+void
+pacer_init(uint64_t period_ns)
+{
+    memset(&pacer, 0x00, sizeof(pacer));
+    pacer.period = period_ns;
+}
+
+/* Start over from now, as after a pause, without counting the gap as late. */
+void
+pacer_reset(void)
+{
+    pacer.started = 0;
+    pacer.lag     = 0;
+    pacer.drift   = 0;
+}
+
+int
+pacer_wait(int free_run)
+{
+    uint64_t now = plat_get_nano_ticks();
+    uint64_t left;
+    uint64_t late;
+    uint64_t woke;
+    uint64_t over;
+    int64_t  adj;
+
+    if (!pacer.started || free_run) {
+        pacer.deadline = now;
+        pacer.started  = 1;
+    }
+
+    if ((now + PACER_EARLY_NS) < pacer.deadline) {
+        left = pacer.deadline - now;
+        if (left > pacer.oversleep)
+            left -= pacer.oversleep;
+        plat_delay_ns(left);
+
+        woke = plat_get_nano_ticks() - now;
+        over = (woke > left) ? (woke - left) : 0;
+        if (over > PACER_OVERSLEEP_NS)
+            over = PACER_OVERSLEEP_NS;
+        pacer.oversleep = pacer.oversleep - (pacer.oversleep >> 3) + (over >> 3);
+
+        return 0;
+    }
+
+    pacer.stats.slices++;
+    late      = (now > pacer.deadline) ? (now - pacer.deadline) : 0;
+    pacer.lag = late;
+    if (late > PACER_LATE_NS) {
+        pacer.stats.late++;
+        pacer.stats.late_total_ns += late;
+        if (late > pacer.stats.late_max_ns)
+            pacer.stats.late_max_ns = late;
+    }
+    if (late > PACER_CATCHUP_NS) {
+        pacer.stats.dropped += late / pacer.period;
+        pacer.deadline = now;
+    }
+
+    /* Pull towards the host clock by at most 0.5% per slice. */
+    adj = pacer.drift / 64;
+    if (adj > (int64_t) (pacer.period / 200))
+        adj = (int64_t) (pacer.period / 200);
+    else if (adj < -(int64_t) (pacer.period / 200))
+        adj = -(int64_t) (pacer.period / 200);
+    pacer.drift -= adj;
+
+    pacer.deadline += pacer.period + adj;
+
+    return 1;
+}
+
+void
+pacer_sync(int64_t offset_ns)
+{
+    if (!pace_to_audio || fast_forward)
+        return;
+
+    pacer.drift += (offset_ns - pacer.drift) / 16;
+}
+
+uint64_t
+pacer_get_lag(void)
+{
+    return pacer.lag;
+}
+
+void
+pacer_get_stats(pacer_stats_t *stats)
+{
+    *stats = pacer.stats;
+}
+
+void
+pacer_log_stats(void)
+{
+    if (!pacer.stats.slices)
+        return;
+
+    pclog("Pacer: %llu slices, %llu late (worst %.2f ms, average %.2f ms), %llu dropped\n",
+          (unsigned long long) pacer.stats.slices, (unsigned long long) pacer.stats.late,
+          (double) pacer.stats.late_max_ns / 1000000.0,
+          pacer.stats.late ? ((double) pacer.stats.late_total_ns / pacer.stats.late / 1000000.0) : 0.0,
+          (unsigned long long) pacer.stats.dropped);
+}
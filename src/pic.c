@@ -18,6 +18,7 @@
  *          Copyright 2016-2020 Miran Grca.
  */
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -37,6 +38,7 @@
 #include <86box/apm.h>
 #include <86box/nvr.h>
 #include <86box/acpi.h>
+#include <86box/savestate.h>
 #include <86box/plat_unused.h>
 
 enum {
@@ -279,6 +281,35 @@ pic_reset(void)
     pic_pci = 0;
 }
 
+void
+pic_save(savestate_t *state)
+{
+    /* Everything up to the slave pointers is plain register state. */
+    savestate_write(state, &pic, offsetof(pic_t, slaves));
+    savestate_write(state, &pic2, offsetof(pic_t, slaves));
+    savestate_write_timer(state, &pic_timer);
+
+    savestate_write_u8(state, shadow);
+    savestate_write_u8(state, pic_pci);
+    savestate_write_u16(state, smi_irq_mask);
+    savestate_write_u16(state, smi_irq_status);
+    savestate_write_u16(state, latched_irqs);
+}
+
+void
+pic_load(savestate_t *state)
+{
+    savestate_read(state, &pic, offsetof(pic_t, slaves));
+    savestate_read(state, &pic2, offsetof(pic_t, slaves));
+    savestate_read_timer(state, &pic_timer);
+
+    shadow         = savestate_read_u8(state);
+    pic_pci        = savestate_read_u8(state);
+    smi_irq_mask   = savestate_read_u16(state);
+    smi_irq_status = savestate_read_u16(state);
+    latched_irqs   = savestate_read_u16(state);
+}
+
 void
 pic_set_shadow(int sh)
 {
@@ -18,6 +18,7 @@
 #include <inttypes.h>
 #include <math.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -37,6 +38,7 @@
 #include <86box/pit.h>
 #include <86box/pit_fast.h>
 #include <86box/ppi.h>
+#include <86box/savestate.h>
 #include <86box/machine.h>
 #include <86box/sound.h>
 #include <86box/snd_speaker.h>
@@ -864,6 +866,34 @@ pit_close(void *priv)
         free(dev);
 }
 
+/* The output and load callbacks are set up by whoever created the PIT and
+   are left alone; only the counter state itself is stored. */
+static void
+pit_save(void *priv, savestate_t *state)
+{
+    const pit_t *dev = (const pit_t *) priv;
+
+    savestate_write_u32(state, dev->clock);
+    for (uint8_t i = 0; i < 3; i++)
+        savestate_write(state, &dev->counters[i], offsetof(ctr_t, load_func));
+    savestate_write_u8(state, dev->ctrl);
+    savestate_write_timer(state, &dev->callback_timer);
+}
+
+static int
+pit_load(void *priv, savestate_t *state)
+{
+    pit_t *dev = (pit_t *) priv;
+
+    dev->clock = savestate_read_u32(state);
+    for (uint8_t i = 0; i < 3; i++)
+        savestate_read(state, &dev->counters[i], offsetof(ctr_t, load_func));
+    dev->ctrl = savestate_read_u8(state);
+    savestate_read_timer(state, &dev->callback_timer);
+
+    return 0;
+}
+
 static void *
 pit_init(const device_t *info)
 {
@@ -896,7 +926,9 @@ const device_t i8253_device = {
     { .available = NULL },
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pit_save,
+    .load          = pit_load
 };
 
 const device_t i8254_device = {
@@ -910,7 +942,9 @@ const device_t i8254_device = {
     { .available = NULL },
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pit_save,
+    .load          = pit_load
 };
 
 const device_t i8254_sec_device = {
@@ -924,7 +958,9 @@ const device_t i8254_sec_device = {
     { .available = NULL },
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pit_save,
+    .load          = pit_load
 };
 
 const device_t i8254_ext_io_device = {
@@ -938,7 +974,9 @@ const device_t i8254_ext_io_device = {
     { .available = NULL },
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pit_save,
+    .load          = pit_load
 };
 
 const device_t i8254_ps2_device = {
@@ -952,7 +990,9 @@ const device_t i8254_ps2_device = {
     { .available = NULL },
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pit_save,
+    .load          = pit_load
 };
 
 pit_t *
@@ -18,6 +18,7 @@
 #include <inttypes.h>
 #include <math.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -37,6 +38,7 @@
 #include <86box/pit.h>
 #include <86box/pit_fast.h>
 #include <86box/ppi.h>
+#include <86box/savestate.h>
 #include <86box/machine.h>
 #include <86box/sound.h>
 #include <86box/snd_speaker.h>
@@ -668,6 +670,34 @@ pitf_close(void *priv)
         free(dev);
 }
 
+/* The output and load callbacks are set up by whoever created the PIT and
+   are left alone; only the counter state itself is stored. */
+static void
+pitf_save(void *priv, savestate_t *state)
+{
+    const pitf_t *dev = (const pitf_t *) priv;
+
+    for (uint8_t i = 0; i < 3; i++) {
+        savestate_write(state, &dev->counters[i], offsetof(ctrf_t, timer));
+        savestate_write_timer(state, &dev->counters[i].timer);
+    }
+    savestate_write_u8(state, dev->ctrl);
+}
+
+static int
+pitf_load(void *priv, savestate_t *state)
+{
+    pitf_t *dev = (pitf_t *) priv;
+
+    for (uint8_t i = 0; i < 3; i++) {
+        savestate_read(state, &dev->counters[i], offsetof(ctrf_t, timer));
+        savestate_read_timer(state, &dev->counters[i].timer);
+    }
+    dev->ctrl = savestate_read_u8(state);
+
+    return 0;
+}
+
 static void *
 pitf_init(const device_t *info)
 {
@@ -702,7 +732,9 @@ const device_t i8253_fast_device = {
     { .available = NULL },
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pitf_save,
+    .load          = pitf_load
 };
 
 const device_t i8254_fast_device = {
@@ -716,7 +748,9 @@ const device_t i8254_fast_device = {
     { .available = NULL },
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pitf_save,
+    .load          = pitf_load
 };
 
 const device_t i8254_sec_fast_device = {
@@ -730,7 +764,9 @@ const device_t i8254_sec_fast_device = {
     { .available = NULL },
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pitf_save,
+    .load          = pitf_load
 };
 
 const device_t i8254_ext_io_fast_device = {
@@ -744,7 +780,9 @@ const device_t i8254_ext_io_fast_device = {
     { .available = NULL },
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pitf_save,
+    .load          = pitf_load
 };
 
 const device_t i8254_ps2_fast_device = {
@@ -758,7 +796,9 @@ const device_t i8254_ps2_fast_device = {
     { .available = NULL },
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pitf_save,
+    .load          = pitf_load
 };
 
 const pit_intf_t pit_fast_intf = {
@@ -174,6 +174,7 @@ D3D9Renderer::blit(int x, int y, int w, int h)
     }
     surfaceInUse    = true;
     auto origSource = source;
+    auto buf        = video_blit_buffer_monitor(m_monitor_index);
     source.setRect(x, y, w, h);
     RECT           srcRect;
     D3DLOCKED_RECT lockRect;
@@ -183,11 +184,11 @@ D3D9Renderer::blit(int x, int y, int w, int h)
     srcRect.right  = source.right();
 
     if (monitors[m_monitor_index].mon_screenshots) {
-        video_screenshot_monitor((uint32_t *) &(monitors[m_monitor_index].target_buffer->line[y][x]), 0, 0, 2048, m_monitor_index);
+        video_screenshot_monitor((uint32_t *) &(buf->line[y][x]), 0, 0, 2048, m_monitor_index);
     }
     if (SUCCEEDED(d3d9surface->LockRect(&lockRect, &srcRect, 0))) {
         for (int y1 = 0; y1 < h; y1++) {
-            video_copy(((uint8_t *) lockRect.pBits) + (y1 * lockRect.Pitch), &(monitors[m_monitor_index].target_buffer->line[y + y1][x]), w * 4);
+            video_copy(((uint8_t *) lockRect.pBits) + (y1 * lockRect.Pitch), &(buf->line[y + y1][x]), w * 4);
         }
         video_blit_complete_monitor(m_monitor_index);
         d3d9surface->UnlockRect();
@@ -58,6 +58,9 @@ extern "C" {
 #   include <86box/discord.h>
 #endif
 #include <86box/gdbstub.h>
+#include <86box/replay.h>
+#include <86box/pacer.h>
+#include <86box/bench.h>
 }
 
 #include <thread>
@@ -88,33 +91,27 @@ void qt_set_sequence_auto_mnemonic(bool b);
 void
 main_thread_fn()
 {
-    uint64_t old_time;
-    uint64_t new_time;
-    int      drawits;
-    int      frames;
+    int frames;
+    int free_run;
 
     QThread::currentThread()->setPriority(QThread::HighestPriority);
     plat_set_thread_name(NULL, "main_thread_fn");
     framecountx = 0;
     // title_update = 1;
-    old_time = elapsed_timer.elapsed();
-    drawits = frames = 0;
+    frames = 0;
+    pacer_init(PACER_SLICE_NS);
     while (!is_quit && cpu_thread_run) {
-        /* See if it is time to run a frame of code. */
-        new_time = elapsed_timer.elapsed();
+        /* Fast-forward, replays and benchmarks run as fast as the host allows. */
+        free_run = fast_forward || bench_active || (replay_mode == REPLAY_PLAY);
 #ifdef USE_GDBSTUB
-        if (gdbstub_next_asap && (drawits <= 0))
-            drawits = 10;
-        else
+        free_run |= gdbstub_next_asap;
 #endif
-            drawits += (new_time - old_time);
-        old_time = new_time;
-        if (drawits > 0 && !dopause) {
-            /* Yes, so do one frame now. */
-            drawits -= 10;
-            if (drawits > 50)
-                drawits = 0;
-
+        if (dopause) {
+            /* Just so we dont overload the host OS. */
+            ack_pause();
+            pacer_reset();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        } else if (pacer_wait(free_run)) {
 #ifdef USE_INSTRUMENT
             uint64_t start_time = elapsed_timer.nsecsElapsed();
 #endif
@@ -136,13 +133,9 @@ main_thread_fn()
                 nvr_dosave = 0;
                 frames     = 0;
             }
-        } else {
-            /* Just so we dont overload the host OS. */
-            if (dopause)
-                ack_pause();
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
     }
+    pacer_log_stats();
 
     is_quit = 1;
     if (gfxcard[1]) {
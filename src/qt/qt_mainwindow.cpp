@@ -331,6 +331,7 @@ MainWindow::MainWindow(QWidget *parent)
     connect(this, &MainWindow::statusBarMessage, status.get(), &MachineStatus::message, Qt::QueuedConnection);
 
     ui->actionKeyboard_requires_capture->setChecked(kbd_req_capture);
+    ui->actionFast_forward->setChecked(fast_forward);
     ui->actionRight_CTRL_is_left_ALT->setChecked(rctrl_is_lalt);
     ui->actionResizable_window->setChecked(vid_resize == 1);
     ui->actionRemember_size_and_position->setChecked(window_remember);
@@ -924,6 +925,13 @@ MainWindow::on_actionPause_triggered()
     plat_pause(dopause ^ 1);
 }
 
+void
+MainWindow::on_actionFast_forward_triggered()
+{
+    pc_set_fast_forward(fast_forward ^ 1);
+    ui->actionFast_forward->setChecked(fast_forward);
+}
+
 void
 MainWindow::on_actionExit_triggered()
 {
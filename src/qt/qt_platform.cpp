@@ -61,8 +61,9 @@ extern QElapsedTimer elapsed_timer;
 extern MainWindow   *main_window;
 QElapsedTimer        elapsed_timer;
 
-static std::atomic_int      blitmx_contention = 0;
+static std::atomic_int      blitmx_waiting = 0;
 static std::recursive_mutex blitmx;
+static thread_local int     blitmx_depth = 0;
 
 class CharPointer {
 public:
@@ -174,6 +175,12 @@ plat_get_ticks(void)
     return elapsed_timer.elapsed();
 }
 
+uint64_t
+plat_get_nano_ticks(void)
+{
+    return elapsed_timer.nsecsElapsed();
+}
+
 uint64_t
 plat_timer_read(void)
 {
@@ -522,24 +529,25 @@ dynld_close(void *handle)
 void
 startblit()
 {
-    blitmx_contention++;
-    if (blitmx.try_lock()) {
-        return;
+    if (!blitmx.try_lock()) {
+        blitmx_waiting++;
+        blitmx.lock();
+        blitmx_waiting--;
     }
-
-    blitmx.lock();
+    blitmx_depth++;
 }
 
 void
 endblit()
 {
-    blitmx_contention--;
     blitmx.unlock();
-    if (blitmx_contention > 0) {
-        // a deadlock has been observed on linux when toggling via video_toggle_option
-        // because the mutex is typically unfair on linux
-        // => sleep if there's contention
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // the mutex is typically unfair on linux, and a deadlock has been observed
+    // when toggling via video_toggle_option
+    // => once it is really let go, step aside until a waiting thread has it
+    if (--blitmx_depth == 0) {
+        while (blitmx_waiting > 0)
+            std::this_thread::yield();
     }
 }
 }
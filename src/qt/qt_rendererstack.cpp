@@ -452,9 +452,14 @@ RendererStack::createRenderer(Renderer renderer)
 
     if (renderer != Renderer::OpenGL3 && renderer != Renderer::Vulkan && renderer != Renderer::Direct3D9) {
         imagebufs = rendererWindow->getBuffers();
+        dirtyRegions.assign(imagebufs.size(), QRegion());
+        blitArea = QRect();
         endblit();
         emit rendererChanged();
     }
+
+    /* The new renderer starts out blank, so have the next frame sent in full. */
+    video_refresh_monitor(m_monitor_index);
 }
 
 void
@@ -481,19 +486,45 @@ RendererStack::blitRenderer(int x, int y, int w, int h)
 void
 RendererStack::blitCommon(int x, int y, int w, int h)
 {
-    if (blitDummied || (x < 0) || (y < 0) || (w <= 0) || (h <= 0) || (w > 2048) || (h > 2048) || (monitors[m_monitor_index].target_buffer == NULL) || imagebufs.empty() || std::get<std::atomic_flag *>(imagebufs[currentBuf])->test_and_set()) {
+    const video_rect_t *rects;
+    int                 num;
+
+    if (blitDummied || (x < 0) || (y < 0) || (w <= 0) || (h <= 0) || (w > 2048) || (h > 2048) || (monitors[m_monitor_index].target_buffer == NULL) || imagebufs.empty()) {
+        video_blit_complete_monitor(m_monitor_index);
+        return;
+    }
+
+    /* Every buffer keeps track of what changed since it was last filled, dropped frames included. */
+    const QRect area(x, y, w, h);
+    if (area != blitArea) {
+        blitArea = area;
+        for (auto &region : dirtyRegions)
+            region = area;
+    } else {
+        num = video_blit_rects_monitor(&rects, m_monitor_index);
+        for (auto &region : dirtyRegions) {
+            for (int i = 0; i < num; i++)
+                region += QRect(rects[i].x, rects[i].y, rects[i].w, rects[i].h);
+        }
+    }
+
+    if (std::get<std::atomic_flag *>(imagebufs[currentBuf])->test_and_set()) {
         video_blit_complete_monitor(m_monitor_index);
         return;
     }
     sx = x;
     sy = y;
     sw = this->w = w;
-    sh = this->h       = h;
-    uint8_t *imagebits = std::get<uint8_t *>(imagebufs[currentBuf]);
-    for (int y1 = y; y1 < (y + h); y1++) {
-        auto scanline = imagebits + (y1 * rendererWindow->getBytesPerRow()) + (x * 4);
-        video_copy(scanline, &(monitors[m_monitor_index].target_buffer->line[y1][x]), w * 4);
+    sh = this->h        = h;
+    uint8_t  *imagebits = std::get<uint8_t *>(imagebufs[currentBuf]);
+    bitmap_t *buf       = video_blit_buffer_monitor(m_monitor_index);
+    for (const QRect &rect : dirtyRegions[currentBuf] & area) {
+        for (int y1 = rect.top(); y1 <= rect.bottom(); y1++) {
+            auto scanline = imagebits + (y1 * rendererWindow->getBytesPerRow()) + (rect.left() * 4);
+            video_copy(scanline, &(buf->line[y1][rect.left()]), rect.width() * 4);
+        }
     }
+    dirtyRegions[currentBuf] = QRegion();
 
     if (monitors[m_monitor_index].mon_screenshots) {
         video_screenshot_monitor((uint32_t *) imagebits, x, y, 2048, m_monitor_index);
@@ -4,6 +4,7 @@
 #include <QDialog>
 #include <QEvent>
 #include <QKeyEvent>
+#include <QRegion>
 #include <QStackedWidget>
 #include <QWidget>
 #include <QCursor>
@@ -110,6 +111,8 @@ private:
     Renderer current_vid_api = Renderer::None;
 
     std::vector<std::tuple<uint8_t *, std::atomic_flag *>> imagebufs;
+    std::vector<QRegion>                                   dirtyRegions;
+    QRect                                                  blitArea;
 
     RendererCommon          *rendererWindow { nullptr };
     std::unique_ptr<QWidget> current;
@@ -303,10 +303,11 @@ sdl_stretch(int *w, int *h, int *x, int *y)
 static void
 sdl_blit(int x, int y, int w, int h)
 {
-    SDL_Rect r_src;
-    void    *pixeldata;
-    int      ret;
-    int      pitch;
+    const video_rect_t *rects;
+    const bitmap_t     *buf;
+    SDL_Rect            r_src;
+    int                 num;
+    int                 ret;
 
     if (!sdl_enabled || (x < 0) || (y < 0) || (w <= 0) || (h <= 0) || (w > 2048) || (h > 2048) || (buffer32 == NULL) || (sdl_render == NULL) || (sdl_tex == NULL)) {
         video_blit_complete();
@@ -314,14 +315,20 @@ sdl_blit(int x, int y, int w, int h)
     }
 
     SDL_LockMutex(sdl_mutex);
-    SDL_LockTexture(sdl_tex, 0, &pixeldata, &pitch);
 
-    video_copy(pixeldata, &(buffer32->line[y][x]), h * (2048) * sizeof(uint32_t));
+    /* Only upload the parts of the frame that changed. */
+    buf = video_blit_buffer_monitor(0);
+    num = video_blit_rects_monitor(&rects, 0);
+    for (int i = 0; i < num; i++) {
+        r_src.x = rects[i].x - x;
+        r_src.y = rects[i].y - y;
+        r_src.w = rects[i].w;
+        r_src.h = rects[i].h;
+        SDL_UpdateTexture(sdl_tex, &r_src, &(buf->line[rects[i].y][rects[i].x]), 2048 * sizeof(uint32_t));
+    }
 
     if (monitors[m_monitor_index].mon_screenshots)
-        video_screenshot((uint32_t *) pixeldata, 0, 0, (2048));
-
-    SDL_UnlockTexture(sdl_tex);
+        video_screenshot(&(buf->line[y][x]), 0, 0, 2048);
 
     video_blit_complete();
 
@@ -62,6 +62,12 @@ plat_delay_ms(uint32_t count)
     QThread::msleep(count);
 }
 
+void
+plat_delay_ns(uint64_t count)
+{
+    QThread::usleep(count / 1000);
+}
+
 wchar_t *
 ui_window_title(wchar_t *str)
 {
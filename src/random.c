@@ -25,6 +25,8 @@
 
 uint32_t preconst = 0x6ED9EBA1;
 
+static int random_seeded = 0;
+
 static __inline uint32_t
 rotl32c(uint32_t x, uint32_t n)
 {
@@ -72,6 +74,10 @@ rdtsc(void)
 static uint32_t
 RDTSC(void)
 {
+    /* Sessions that get replayed must not mix host time into the numbers. */
+    if (random_seeded)
+        return 0;
+
     return (uint32_t) (rdtsc());
 }
 
@@ -100,3 +106,12 @@ random_init(void)
     srand(seed);
     return;
 }
+
+/* Make the sequence depend on nothing but the seed, for record/replay. */
+void
+random_set_seed(uint32_t seed)
+{
+    random_seeded = 1;
+    preconst      = 0x6ED9EBA1;
+    srand(seed);
+}
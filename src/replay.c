@@ -0,0 +1,588 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Session record/replay.
+ *
+ *          Everything the emulated machine does follows from its own
+ *          state, except for the input it takes from the host: the
+ *          keyboard and mouse, packets from the network, the host clock
+ *          the RTC is set from and hard resets asked for by the user.
+ *          While recording, each of those is logged with the TSC at the
+ *          point where the machine takes it in; a replay feeds the log
+ *          back in at exactly the same points, ignoring the host.
+ *
+ *          Keyboard and mouse input arrives on the UI thread at any
+ *          time, so while recording or replaying it only reaches the
+ *          machine in replay_process(), between two execution slices.
+ *
+ *          The log is a gzip stream of events, each one a type byte, the
+ *          TSC difference to the previous event and the payload length,
+ *          all as variable length integers, followed by the payload.
+ *
+ *
+ *
+ */
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <wchar.h>
+#include <zlib.h>
+#define HAVE_STDARG_H
+#include <86box/86box.h>
+#include <86box/replay.h>
+#include "cpu.h"
+#include <86box/timer.h>
+#include <86box/device.h>
+#include <86box/machine.h>
+#include <86box/mem.h>
+#include <86box/keyboard.h>
+#include <86box/mouse.h>
+#include <86box/thread.h>
+#include <86box/network.h>
+#include <86box/random.h>
+
+#define REPLAY_MAGIC     "86BoxRpl"
+#define REPLAY_VERSION   1
+#define REPLAY_KEY_QUEUE 256
+#define REPLAY_MAX_EVENT (NET_MAX_FRAME + 16)
+
+enum {
+    EV_END = 0,
+    EV_RESET,
+    EV_KEY,
+    EV_MOUSE,
+    EV_NET_RX,
+    EV_NET_LINK,
+    EV_CLOCK
+};
+
+/* Which parts of a mouse event are present. */
+#define MOUSE_X       0x01
+#define MOUSE_Y       0x02
+#define MOUSE_Z       0x04
+#define MOUSE_BUTTONS 0x08
+
+int replay_mode = REPLAY_NONE;
+
+static char     replay_fn[1024];
+static int      replay_requested = REPLAY_NONE;
+static gzFile   replay_fp        = NULL;
+/* Events store their TSC relative to the previous one. A hard reset restarts
+   the TSC from zero. */
+static uint64_t replay_tsc = 0;
+
+/* The event a replay is waiting to feed in. */
+static uint8_t  replay_type;
+static uint64_t replay_due_tsc;
+static uint32_t replay_len;
+static uint8_t  replay_buf[REPLAY_MAX_EVENT];
+
+/* Keystrokes from the UI thread, waiting for the emulation thread. */
+static mutex_t *replay_key_mutex = NULL;
+static uint16_t replay_keys[REPLAY_KEY_QUEUE];
+static int      replay_key_head = 0;
+static int      replay_key_tail = 0;
+
+static int replay_mouse_b = 0;
+
+#ifdef ENABLE_REPLAY_LOG
+int replay_do_log = ENABLE_REPLAY_LOG;
+
+static void
+replay_log(const char *fmt, ...)
+{
+    va_list ap;
+
+    if (replay_do_log) {
+        va_start(ap, fmt);
+        pclog_ex(fmt, ap);
+        va_end(ap);
+    }
+}
+#else
+#    define replay_log(fmt, ...)
+#endif
+
+static int
+replay_put_varint(uint8_t *p, uint64_t val)
+{
+    int n = 0;
+
+    while (val >= 0x80) {
+        p[n++] = (uint8_t) (val | 0x80);
+        val >>= 7;
+    }
+    p[n++] = (uint8_t) val;
+
+    return n;
+}
+
+static uint64_t
+replay_get_varint(const uint8_t **p, const uint8_t *end)
+{
+    uint64_t val   = 0;
+    int      shift = 0;
+
+    while ((*p < end) && (shift < 64)) {
+        val |= ((uint64_t) (**p & 0x7f)) << shift;
+        if (!(*((*p)++) & 0x80))
+            break;
+        shift += 7;
+    }
+
+    return val;
+}
+
+static uint64_t
+replay_zigzag(int64_t val)
+{
+    return ((uint64_t) val << 1) ^ (uint64_t) (val >> 63);
+}
+
+static int64_t
+replay_unzigzag(uint64_t val)
+{
+    return (int64_t) (val >> 1) ^ -(int64_t) (val & 1);
+}
+
+static void
+replay_stop(void)
+{
+    if (replay_fp != NULL) {
+        gzclose(replay_fp);
+        replay_fp = NULL;
+    }
+
+    replay_mode = REPLAY_NONE;
+}
+
+static void
+replay_write_event(uint8_t type, const uint8_t *data, uint32_t len)
+{
+    uint8_t hdr[24];
+    int     n = 0;
+
+    hdr[n++] = type;
+    n += replay_put_varint(&hdr[n], tsc - replay_tsc);
+    n += replay_put_varint(&hdr[n], len);
+    replay_tsc = (type == EV_RESET) ? 0 : tsc;
+
+    if ((gzwrite(replay_fp, hdr, n) != n) || (len && (gzwrite(replay_fp, data, len) != (int) len))) {
+        pclog("REPLAY: Error writing \"%s\", recording stopped\n", replay_fn);
+        replay_stop();
+    }
+}
+
+static int
+replay_read_varint(uint64_t *val)
+{
+    int c;
+    int shift = 0;
+
+    *val = 0;
+    do {
+        if ((c = gzgetc(replay_fp)) < 0)
+            return 1;
+        *val |= ((uint64_t) (c & 0x7f)) << shift;
+        shift += 7;
+    } while ((c & 0x80) && (shift < 64));
+
+    return 0;
+}
+
+/* Fetches the next event of a replay, ending the replay after the last one. */
+static void
+replay_next(void)
+{
+    uint64_t delta;
+    uint64_t len;
+    int      c = gzgetc(replay_fp);
+
+    if ((c <= EV_END) || replay_read_varint(&delta) || replay_read_varint(&len)) {
+        pclog("REPLAY: End of \"%s\" reached at TSC %llu\n", replay_fn, (unsigned long long) tsc);
+        replay_stop();
+        return;
+    }
+
+    if ((len > sizeof(replay_buf)) || (gzread(replay_fp, replay_buf, (unsigned) len) != (int) len)) {
+        pclog("REPLAY: \"%s\" is damaged, replay stopped\n", replay_fn);
+        replay_stop();
+        return;
+    }
+
+    replay_type    = (uint8_t) c;
+    replay_len     = (uint32_t) len;
+    replay_due_tsc = replay_tsc + delta;
+    replay_tsc     = (replay_type == EV_RESET) ? 0 : replay_due_tsc;
+}
+
+static int
+replay_due(uint8_t type)
+{
+    return (replay_mode == REPLAY_PLAY) && (replay_type == type) && (replay_due_tsc <= tsc);
+}
+
+static void
+replay_write_string(const char *str)
+{
+    uint32_t len = (uint32_t) strlen(str);
+
+    gzwrite(replay_fp, &len, sizeof(len));
+    gzwrite(replay_fp, str, len);
+}
+
+static int
+replay_check_string(const char *str)
+{
+    char     buf[256];
+    uint32_t len;
+
+    if ((gzread(replay_fp, &len, sizeof(len)) != (int) sizeof(len)) || (len >= sizeof(buf)) ||
+        (gzread(replay_fp, buf, len) != (int) len))
+        return 1;
+    buf[len] = '\0';
+
+    return strcmp(buf, str) != 0;
+}
+
+void
+replay_set_record(const char *fn)
+{
+    snprintf(replay_fn, sizeof(replay_fn), "%s", fn);
+    replay_requested = REPLAY_RECORD;
+}
+
+void
+replay_set_play(const char *fn)
+{
+    snprintf(replay_fn, sizeof(replay_fn), "%s", fn);
+    replay_requested = REPLAY_PLAY;
+}
+
+/* Opens the log, before the machine is started for the first time. */
+void
+replay_init(void)
+{
+    uint32_t hdr[4];
+    char     magic[8];
+
+    if (replay_requested == REPLAY_NONE)
+        return;
+
+    replay_tsc = 0;
+
+    if (replay_requested == REPLAY_RECORD) {
+        replay_fp = gzopen(replay_fn, "wb1");
+        if (replay_fp == NULL) {
+            pclog("REPLAY: Unable to create \"%s\"\n", replay_fn);
+            return;
+        }
+        gzbuffer(replay_fp, 1 << 18);
+
+        hdr[0] = REPLAY_VERSION;
+        hdr[1] = (uint32_t) cpu;
+        hdr[2] = mem_size;
+        hdr[3] = (uint32_t) time(NULL) ^ (uint32_t) rand();
+
+        gzwrite(replay_fp, REPLAY_MAGIC, 8);
+        replay_write_string(machine_get_internal_name());
+        replay_write_string(cpu_f->internal_name);
+        gzwrite(replay_fp, hdr, sizeof(hdr));
+
+        if (replay_key_mutex == NULL)
+            replay_key_mutex = thread_create_mutex();
+        replay_key_head = replay_key_tail = 0;
+    } else {
+        replay_fp = gzopen(replay_fn, "rb");
+        if (replay_fp == NULL) {
+            pclog("REPLAY: Unable to open \"%s\"\n", replay_fn);
+            return;
+        }
+        gzbuffer(replay_fp, 1 << 18);
+
+        if ((gzread(replay_fp, magic, sizeof(magic)) != (int) sizeof(magic)) ||
+            memcmp(magic, REPLAY_MAGIC, sizeof(magic)) ||
+            replay_check_string(machine_get_internal_name()) || replay_check_string(cpu_f->internal_name) ||
+            (gzread(replay_fp, hdr, sizeof(hdr)) != (int) sizeof(hdr)) || (hdr[0] != REPLAY_VERSION) ||
+            (hdr[1] != (uint32_t) cpu) || (hdr[2] != mem_size)) {
+            pclog("REPLAY: \"%s\" was not recorded on this machine\n", replay_fn);
+            gzclose(replay_fp);
+            replay_fp = NULL;
+            return;
+        }
+    }
+
+    /* Anything that draws random numbers has to draw the same ones again. */
+    random_set_seed(hdr[3]);
+
+    replay_mode     = replay_requested;
+    replay_mouse_b  = 0;
+    if (replay_mode == REPLAY_PLAY)
+        replay_next();
+
+    replay_log("REPLAY: %s \"%s\"\n", (replay_requested == REPLAY_RECORD) ? "Recording to" : "Replaying", replay_fn);
+}
+
+void
+replay_close(void)
+{
+    if (replay_mode == REPLAY_RECORD)
+        replay_write_event(EV_END, NULL, 0);
+
+    replay_stop();
+}
+
+/* Called with the pending hard reset state, returns whether to reset now. */
+int
+replay_hard_reset(int pending)
+{
+    switch (replay_mode) {
+        case REPLAY_RECORD:
+            if (pending)
+                replay_write_event(EV_RESET, NULL, 0);
+            return pending;
+
+        case REPLAY_PLAY:
+            /* Resets asked for from the UI wait until the recorded ones. */
+            if (!replay_due(EV_RESET))
+                return 0;
+            replay_next();
+            return 1;
+
+        default:
+            return pending;
+    }
+}
+
+static void
+replay_record_input(void)
+{
+    uint16_t keys[REPLAY_KEY_QUEUE];
+    uint8_t  buf[40];
+    double   x;
+    double   y;
+    int      z;
+    int      b;
+    int      nkeys = 0;
+    int      n;
+
+    thread_wait_mutex(replay_key_mutex);
+    while (replay_key_tail != replay_key_head) {
+        keys[nkeys++]   = replay_keys[replay_key_tail];
+        replay_key_tail = (replay_key_tail + 1) & (REPLAY_KEY_QUEUE - 1);
+    }
+    thread_release_mutex(replay_key_mutex);
+
+    for (int i = 0; i < nkeys; i++) {
+        replay_write_event(EV_KEY, buf, replay_put_varint(buf, keys[i]));
+        keyboard_input_replayed(keys[i] & 1, keys[i] >> 1);
+    }
+
+    mouse_input_take(&x, &y, &z, &b);
+    if ((x == 0.0) && (y == 0.0) && !z && (b == replay_mouse_b))
+        return;
+
+    n = 1;
+    buf[0] = 0x00;
+    if (x != 0.0) {
+        buf[0] |= MOUSE_X;
+        memcpy(&buf[n], &x, sizeof(double));
+        n += sizeof(double);
+    }
+    if (y != 0.0) {
+        buf[0] |= MOUSE_Y;
+        memcpy(&buf[n], &y, sizeof(double));
+        n += sizeof(double);
+    }
+    if (z) {
+        buf[0] |= MOUSE_Z;
+        n += replay_put_varint(&buf[n], replay_zigzag(z));
+    }
+    if (b != replay_mouse_b) {
+        buf[0] |= MOUSE_BUTTONS;
+        n += replay_put_varint(&buf[n], (uint64_t) b);
+    }
+    replay_write_event(EV_MOUSE, buf, n);
+
+    mouse_input_put(x, y, z, b);
+    replay_mouse_b = b;
+}
+
+static void
+replay_play_mouse(void)
+{
+    const uint8_t *p   = &replay_buf[1];
+    const uint8_t *end = &replay_buf[replay_len];
+    double         x   = 0.0;
+    double         y   = 0.0;
+    int            z   = 0;
+
+    if (replay_len < 1)
+        return;
+
+    if ((replay_buf[0] & MOUSE_X) && ((p + sizeof(double)) <= end)) {
+        memcpy(&x, p, sizeof(double));
+        p += sizeof(double);
+    }
+    if ((replay_buf[0] & MOUSE_Y) && ((p + sizeof(double)) <= end)) {
+        memcpy(&y, p, sizeof(double));
+        p += sizeof(double);
+    }
+    if (replay_buf[0] & MOUSE_Z)
+        z = (int) replay_unzigzag(replay_get_varint(&p, end));
+    if (replay_buf[0] & MOUSE_BUTTONS)
+        replay_mouse_b = (int) replay_get_varint(&p, end);
+
+    mouse_input_put(x, y, z, replay_mouse_b);
+}
+
+/* Feeds keyboard and mouse input to the machine, from the host when recording
+   or from the log when replaying. */
+void
+replay_process(void)
+{
+    const uint8_t *p;
+    uint16_t       key;
+    double         x;
+    double         y;
+    int            z;
+    int            b;
+
+    if (replay_mode == REPLAY_RECORD) {
+        replay_record_input();
+        return;
+    }
+
+    if (replay_mode != REPLAY_PLAY)
+        return;
+
+    /* The host mouse is not ours to use during a replay. */
+    mouse_input_take(&x, &y, &z, &b);
+
+    while (replay_mode == REPLAY_PLAY) {
+        if (replay_due(EV_KEY)) {
+            p   = replay_buf;
+            key = (uint16_t) replay_get_varint(&p, &replay_buf[replay_len]);
+            keyboard_input_replayed(key & 1, key >> 1);
+        } else if (replay_due(EV_MOUSE))
+            replay_play_mouse();
+        else
+            break;
+
+        replay_next();
+    }
+
+    /* Every event still waiting should have been taken in by now. If it
+       was not, the machine no longer does what it did while recording. */
+    if ((replay_mode == REPLAY_PLAY) && (replay_due_tsc < tsc)) {
+        pclog("REPLAY: Machine diverged from the recording at TSC %llu, replay stopped\n",
+              (unsigned long long) replay_due_tsc);
+        replay_stop();
+    }
+}
+
+int
+replay_key_input(int down, uint16_t scan)
+{
+    int next;
+
+    if (replay_mode == REPLAY_NONE)
+        return 0;
+
+    if (replay_mode == REPLAY_RECORD) {
+        thread_wait_mutex(replay_key_mutex);
+        next = (replay_key_head + 1) & (REPLAY_KEY_QUEUE - 1);
+        if (next != replay_key_tail) {
+            replay_keys[replay_key_head] = (scan << 1) | !!down;
+            replay_key_head              = next;
+        }
+        thread_release_mutex(replay_key_mutex);
+    }
+
+    return 1;
+}
+
+/* Called as a network card takes in a received packet, got being whether the
+   host had one for it. Returns 1 if the packet was replaced by the replay. */
+int
+replay_net_rx(int card, uint8_t *data, int *len, int size, int got)
+{
+    uint8_t buf[REPLAY_MAX_EVENT];
+
+    switch (replay_mode) {
+        case REPLAY_RECORD:
+            if (got && (*len > 0) && (*len < (int) sizeof(buf))) {
+                buf[0] = (uint8_t) card;
+                memcpy(&buf[1], data, *len);
+                replay_write_event(EV_NET_RX, buf, *len + 1);
+            }
+            return 0;
+
+        case REPLAY_PLAY:
+            *len = 0;
+            if (replay_due(EV_NET_RX) && (replay_len > 1) && (replay_buf[0] == card)) {
+                *len = (int) replay_len - 1;
+                if (*len > size)
+                    *len = size;
+                memcpy(data, &replay_buf[1], *len);
+                replay_next();
+            }
+            return 1;
+
+        default:
+            return 0;
+    }
+}
+
+uint32_t
+replay_net_link(int card, uint32_t old_state, uint32_t new_state)
+{
+    const uint8_t *p;
+    uint8_t        buf[8];
+
+    switch (replay_mode) {
+        case REPLAY_RECORD:
+            if (new_state != old_state) {
+                buf[0] = (uint8_t) card;
+                replay_write_event(EV_NET_LINK, buf, 1 + replay_put_varint(&buf[1], new_state));
+            }
+            return new_state;
+
+        case REPLAY_PLAY:
+            if (replay_due(EV_NET_LINK) && (replay_len > 1) && (replay_buf[0] == card)) {
+                p         = &replay_buf[1];
+                new_state = (uint32_t) replay_get_varint(&p, &replay_buf[replay_len]);
+                replay_next();
+                return new_state;
+            }
+            return old_state;
+
+        default:
+            return new_state;
+    }
+}
+
+int64_t
+replay_host_time(int64_t now)
+{
+    const uint8_t *p;
+    uint8_t        buf[10];
+
+    if (replay_mode == REPLAY_RECORD)
+        replay_write_event(EV_CLOCK, buf, replay_put_varint(buf, replay_zigzag(now)));
+    else if (replay_due(EV_CLOCK)) {
+        p   = replay_buf;
+        now = replay_unzigzag(replay_get_varint(&p, &replay_buf[replay_len]));
+        replay_next();
+    }
+
+    return now;
+}
@@ -0,0 +1,821 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Machine state snapshots.
+ *
+ *          A snapshot is a gzip stream holding a small header followed by
+ *          tagged chunks: the TSC, the CPU, the memory map, RAM, the PIC
+ *          and DMA controllers and then one chunk per device that has
+ *          save/load hooks. Snapshots can only be restored on a machine
+ *          with the same configuration as the one they were taken on.
+ *
+ *          A delta snapshot stores only the RAM pages written since the
+ *          snapshot it names as its parent, as tracked by mem.c, and has
+ *          to be loaded on top of that one.
+ *
+ *
+ *
+ */
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <wchar.h>
+#include <zlib.h>
+#define HAVE_STDARG_H
+#include <86box/86box.h>
+#include <86box/savestate.h>
+#include "cpu.h"
+#include <86box/timer.h>
+#include <86box/device.h>
+#include <86box/machine.h>
+#include <86box/mem.h>
+#include <86box/pic.h>
+#include <86box/dma.h>
+#include <86box/path.h>
+#include <86box/plat.h>
+
+#define SAVESTATE_MAGIC     "86BoxSav"
+#define SAVESTATE_RAM_BLOCK (1 << 20)
+/* Guest RAM above this is in ram2, not ram; a run of pages cannot span it. */
+#define SAVESTATE_RAM_SPLIT (1ULL << 30)
+/* Deltas taken on top of one full snapshot before the next one is full. */
+#define SAVESTATE_CHAIN_MAX 16
+/* Refuse chains nested deeper than this, in case a chain loops. */
+#define SAVESTATE_CHAIN_DEPTH 256
+
+/* Header flags. */
+#define SAVESTATE_FLAG_PARTIAL 0x00000001 /* Some devices have no saved state. */
+
+#define TAG_TSC             SAVESTATE_TAG('T', 'S', 'C', ' ')
+#define TAG_CPU             SAVESTATE_TAG('C', 'P', 'U', ' ')
+#define TAG_MEM             SAVESTATE_TAG('M', 'E', 'M', ' ')
+#define TAG_RAM             SAVESTATE_TAG('R', 'A', 'M', ' ')
+#define TAG_RAMD            SAVESTATE_TAG('R', 'A', 'M', 'D')
+#define TAG_PIC             SAVESTATE_TAG('P', 'I', 'C', ' ')
+#define TAG_DMA             SAVESTATE_TAG('D', 'M', 'A', ' ')
+#define TAG_DEV             SAVESTATE_TAG('D', 'E', 'V', ' ')
+#define TAG_DEVS            SAVESTATE_TAG('D', 'E', 'V', 'S')
+#define TAG_END             SAVESTATE_TAG('E', 'N', 'D', ' ')
+
+struct _savestate_ {
+    gzFile   fp;
+    int      error;
+    uint32_t tag;
+
+    /* The chunk being built (save) or parsed (load). */
+    uint8_t *buf;
+    uint32_t size;
+    uint32_t len;
+    uint32_t pos;
+};
+
+static char savestate_save_fn[1024];
+static char savestate_load_fn[1024];
+static int  savestate_save_pending = 0;
+static int  savestate_load_pending = 0;
+static int  savestate_load_force   = 0;
+
+/* The last snapshot saved or loaded, which the next delta is built on. */
+static char     savestate_base_fn[1024];
+static uint64_t savestate_base_id   = 0;
+static int      savestate_chain_len = 0;
+
+static char     savestate_checkpoint_prefix[1024];
+static uint32_t savestate_checkpoint_interval = 0;
+static uint32_t savestate_checkpoint_last     = 0;
+static uint32_t savestate_checkpoint_seq      = 0;
+
+#ifdef ENABLE_SAVESTATE_LOG
+int savestate_do_log = ENABLE_SAVESTATE_LOG;
+
+static void
+savestate_log(const char *fmt, ...)
+{
+    va_list ap;
+
+    if (savestate_do_log) {
+        va_start(ap, fmt);
+        pclog_ex(fmt, ap);
+        va_end(ap);
+    }
+}
+#else
+#    define savestate_log(fmt, ...)
+#endif
+
+void
+savestate_chunk_begin(savestate_t *state, uint32_t tag)
+{
+    state->tag = tag;
+    state->len = 0;
+}
+
+void
+savestate_chunk_end(savestate_t *state)
+{
+    uint32_t hdr[2] = { state->tag, state->len };
+
+    if (gzwrite(state->fp, hdr, sizeof(hdr)) != (int) sizeof(hdr))
+        state->error = 1;
+    else if (state->len && (gzwrite(state->fp, state->buf, state->len) != (int) state->len))
+        state->error = 1;
+}
+
+void
+savestate_write(savestate_t *state, const void *buf, uint32_t len)
+{
+    uint8_t *new_buf;
+    uint32_t new_size;
+
+    if ((state->len + len) > state->size) {
+        new_size = state->size ? state->size : 65536;
+        while (new_size < (state->len + len))
+            new_size <<= 1;
+
+        new_buf = (uint8_t *) realloc(state->buf, new_size);
+        if (new_buf == NULL) {
+            state->error = 1;
+            return;
+        }
+        state->buf  = new_buf;
+        state->size = new_size;
+    }
+
+    memcpy(&state->buf[state->len], buf, len);
+    state->len += len;
+}
+
+void
+savestate_write_u8(savestate_t *state, uint8_t val)
+{
+    savestate_write(state, &val, sizeof(val));
+}
+
+void
+savestate_write_u16(savestate_t *state, uint16_t val)
+{
+    savestate_write(state, &val, sizeof(val));
+}
+
+void
+savestate_write_u32(savestate_t *state, uint32_t val)
+{
+    savestate_write(state, &val, sizeof(val));
+}
+
+void
+savestate_write_u64(savestate_t *state, uint64_t val)
+{
+    savestate_write(state, &val, sizeof(val));
+}
+
+void
+savestate_write_string(savestate_t *state, const char *str)
+{
+    uint32_t len = (str != NULL) ? (uint32_t) strlen(str) : 0;
+
+    savestate_write_u32(state, len);
+    savestate_write(state, str, len);
+}
+
+void
+savestate_read(savestate_t *state, void *buf, uint32_t len)
+{
+    if ((state->pos + len) > state->len) {
+        memset(buf, 0x00, len);
+        state->pos   = state->len;
+        state->error = 1;
+        return;
+    }
+
+    memcpy(buf, &state->buf[state->pos], len);
+    state->pos += len;
+}
+
+uint8_t
+savestate_read_u8(savestate_t *state)
+{
+    uint8_t val;
+
+    savestate_read(state, &val, sizeof(val));
+
+    return val;
+}
+
+uint16_t
+savestate_read_u16(savestate_t *state)
+{
+    uint16_t val;
+
+    savestate_read(state, &val, sizeof(val));
+
+    return val;
+}
+
+uint32_t
+savestate_read_u32(savestate_t *state)
+{
+    uint32_t val;
+
+    savestate_read(state, &val, sizeof(val));
+
+    return val;
+}
+
+uint64_t
+savestate_read_u64(savestate_t *state)
+{
+    uint64_t val;
+
+    savestate_read(state, &val, sizeof(val));
+
+    return val;
+}
+
+void
+savestate_read_string(savestate_t *state, char *str, uint32_t size)
+{
+    uint32_t len = savestate_read_u32(state);
+
+    if (len >= size) {
+        state->error = 1;
+        len          = 0;
+    }
+
+    savestate_read(state, str, len);
+    str[len] = '\0';
+}
+
+int
+savestate_error(savestate_t *state)
+{
+    return state->error;
+}
+
+void
+savestate_write_timer(savestate_t *state, const pc_timer_t *timer)
+{
+    savestate_write_u8(state, timer->flags & (TIMER_ENABLED | TIMER_SPLIT));
+    savestate_write_u64(state, timer->ts.ts64 - (tsc << 32));
+    savestate_write(state, &timer->period, sizeof(timer->period));
+}
+
+void
+savestate_read_timer(savestate_t *state, pc_timer_t *timer)
+{
+    uint8_t flags = savestate_read_u8(state);
+
+    timer_disable(timer);
+
+    timer->ts.ts64 = (tsc << 32) + savestate_read_u64(state);
+    savestate_read(state, &timer->period, sizeof(timer->period));
+    timer->flags = (timer->flags & ~TIMER_SPLIT) | (flags & TIMER_SPLIT);
+
+    if (flags & TIMER_ENABLED)
+        timer_enable(timer);
+}
+
+/* RAM goes straight from guest memory into the stream, rather than through the
+   chunk buffer, so taking a snapshot does not need a second copy of it. */
+static uint8_t *
+savestate_ram_ptr(uint64_t addr)
+{
+    if (addr < SAVESTATE_RAM_SPLIT)
+        return &ram[addr];
+
+    return &ram2[addr - SAVESTATE_RAM_SPLIT];
+}
+
+/* A chunk of RAM has to fit in guest memory, and on one side of the split
+   between ram and ram2, since it is read in one go through one pointer. */
+static int
+savestate_ram_span_ok(uint64_t addr, uint32_t len)
+{
+    if ((addr + len) > ((uint64_t) mem_size << 10))
+        return 0;
+
+    return (addr >= SAVESTATE_RAM_SPLIT) || ((addr + len) <= SAVESTATE_RAM_SPLIT);
+}
+
+static void
+savestate_save_ram(savestate_t *state)
+{
+    uint64_t total = (uint64_t) mem_size << 10;
+    uint32_t hdr[2];
+
+    for (uint64_t addr = 0; addr < total; addr += SAVESTATE_RAM_BLOCK) {
+        hdr[0] = TAG_RAM;
+        hdr[1] = ((total - addr) < SAVESTATE_RAM_BLOCK) ? (uint32_t) (total - addr) : SAVESTATE_RAM_BLOCK;
+
+        if ((gzwrite(state->fp, hdr, sizeof(hdr)) != (int) sizeof(hdr)) ||
+            (gzwrite(state->fp, savestate_ram_ptr(addr), hdr[1]) != (int) hdr[1])) {
+            state->error = 1;
+            return;
+        }
+    }
+}
+
+/* Delta snapshots only store the pages written since the previous snapshot,
+   as runs of consecutive dirty pages: [u32 first page][page data]. */
+static void
+savestate_save_ram_delta(savestate_t *state)
+{
+    uint32_t pages = mem_size >> 2;
+    uint32_t page  = 0;
+    uint32_t end;
+    uint32_t run;
+    uint32_t hdr[3];
+
+    while (page < pages) {
+        if (!mem_dirty_test(page)) {
+            page++;
+            continue;
+        }
+
+        end = pages;
+        if ((page < (SAVESTATE_RAM_SPLIT >> 12)) && (end > (SAVESTATE_RAM_SPLIT >> 12)))
+            end = SAVESTATE_RAM_SPLIT >> 12;
+
+        run = 1;
+        while (((page + run) < end) && (run < (SAVESTATE_RAM_BLOCK >> 12)) && mem_dirty_test(page + run))
+            run++;
+
+        hdr[0] = TAG_RAMD;
+        hdr[1] = sizeof(uint32_t) + (run << 12);
+        hdr[2] = page;
+        if ((gzwrite(state->fp, hdr, sizeof(hdr)) != (int) sizeof(hdr)) ||
+            (gzwrite(state->fp, savestate_ram_ptr((uint64_t) page << 12), run << 12) != (int) (run << 12))) {
+            state->error = 1;
+            return;
+        }
+
+        page += run;
+    }
+}
+
+static void
+savestate_core_chunk(savestate_t *state, uint32_t tag, void (*save)(savestate_t *state))
+{
+    savestate_chunk_begin(state, tag);
+    save(state);
+    savestate_chunk_end(state);
+}
+
+static void
+savestate_save_tsc(savestate_t *state)
+{
+    savestate_write_u64(state, tsc);
+}
+
+static uint64_t
+savestate_new_id(void)
+{
+    static uint32_t seq = 0;
+
+    return ((uint64_t) time(NULL) << 32) ^ (tsc * 0x9e3779b97f4a7c15ULL) ^ ++seq;
+}
+
+/* Deltas name their parent relative to their own directory when they share
+   one, so a chain of snapshots can be moved around as a whole. */
+static void
+savestate_parent_name(char *dest, size_t size, const char *fn, const char *parent_fn)
+{
+    size_t dir_len = path_get_filename((char *) fn) - fn;
+
+    if ((dir_len == (size_t) (path_get_filename((char *) parent_fn) - parent_fn)) && !strncmp(fn, parent_fn, dir_len))
+        parent_fn += dir_len;
+
+    snprintf(dest, size, "%s", parent_fn);
+}
+
+static int
+savestate_save_file(const char *fn, int delta)
+{
+    savestate_t state;
+    uint64_t    id = savestate_new_id();
+    char        parent[1024];
+
+    memset(&state, 0x00, sizeof(savestate_t));
+
+    state.fp = gzopen(fn, "wb1");
+    if (state.fp == NULL) {
+        pclog("SAVESTATE: Unable to create \"%s\"\n", fn);
+        return 1;
+    }
+
+    /* Header: identifies the snapshot, the machine it belongs to and, for a
+       delta, the snapshot it has to be applied on top of. */
+    savestate_chunk_begin(&state, 0);
+    savestate_write(&state, SAVESTATE_MAGIC, 8);
+    savestate_write_u32(&state, SAVESTATE_VERSION);
+    savestate_write_string(&state, machine_get_internal_name());
+    savestate_write_string(&state, cpu_f->internal_name);
+    savestate_write_u32(&state, cpu);
+    savestate_write_u32(&state, mem_size);
+    savestate_write_u32(&state, device_save_missing() ? SAVESTATE_FLAG_PARTIAL : 0);
+    savestate_write_u64(&state, id);
+    if (delta) {
+        savestate_parent_name(parent, sizeof(parent), fn, savestate_base_fn);
+        savestate_write_u64(&state, savestate_base_id);
+        savestate_write_string(&state, parent);
+    } else {
+        savestate_write_u64(&state, 0);
+        savestate_write_string(&state, NULL);
+    }
+    if (gzwrite(state.fp, state.buf, state.len) != (int) state.len)
+        state.error = 1;
+
+    /* The TSC has to come first, everything else stores timers relative to it. */
+    savestate_core_chunk(&state, TAG_TSC, savestate_save_tsc);
+    savestate_core_chunk(&state, TAG_CPU, cpu_save);
+    savestate_core_chunk(&state, TAG_MEM, mem_save);
+    if (delta)
+        savestate_save_ram_delta(&state);
+    else
+        savestate_save_ram(&state);
+    savestate_core_chunk(&state, TAG_PIC, pic_save);
+    savestate_core_chunk(&state, TAG_DMA, dma_save);
+
+    device_save_all(&state);
+
+    savestate_chunk_begin(&state, TAG_END);
+    savestate_chunk_end(&state);
+
+    if (gzclose(state.fp) != Z_OK)
+        state.error = 1;
+    free(state.buf);
+
+    if (state.error) {
+        /* Keep the current chain and dirty pages, the next delta still
+           applies on top of the last good snapshot. */
+        pclog("SAVESTATE: Error writing \"%s\"\n", fn);
+        return 1;
+    }
+
+    savestate_log("SAVESTATE: Saved %s \"%s\"\n", delta ? "delta" : "snapshot", fn);
+
+    snprintf(savestate_base_fn, sizeof(savestate_base_fn), "%s", fn);
+    savestate_base_id   = id;
+    savestate_chain_len = delta ? (savestate_chain_len + 1) : 0;
+    mem_dirty_clear();
+
+    return 0;
+}
+
+int
+savestate_save(const char *fn)
+{
+    return savestate_save_file(fn, 0);
+}
+
+int
+savestate_save_delta(const char *fn)
+{
+    /* Start a new chain when there is nothing to build on, or when the current
+       one has grown long enough to make loading it slow. */
+    if ((savestate_base_fn[0] == '\0') || (savestate_chain_len >= SAVESTATE_CHAIN_MAX))
+        return savestate_save_file(fn, 0);
+
+    return savestate_save_file(fn, 1);
+}
+
+static int
+savestate_check_header(savestate_t *state, uint32_t *flags, uint64_t *id, uint64_t *parent_id, char *parent, uint32_t size)
+{
+    char     str[256];
+    char     magic[8];
+    uint32_t len;
+
+    if (gzread(state->fp, magic, sizeof(magic)) != (int) sizeof(magic) ||
+        memcmp(magic, SAVESTATE_MAGIC, sizeof(magic)))
+        return 1;
+
+    if (gzread(state->fp, &len, sizeof(len)) != (int) sizeof(len) || (len != SAVESTATE_VERSION)) {
+        pclog("SAVESTATE: Unsupported snapshot version\n");
+        return 1;
+    }
+
+    /* The header is not a chunk, so pull it in field by field. */
+    for (uint8_t i = 0; i < 2; i++) {
+        if ((gzread(state->fp, &len, sizeof(len)) != (int) sizeof(len)) || (len >= sizeof(str)) ||
+            (gzread(state->fp, str, len) != (int) len))
+            return 1;
+        str[len] = '\0';
+
+        if (strcmp(str, i ? cpu_f->internal_name : machine_get_internal_name())) {
+            pclog("SAVESTATE: Snapshot is for a different %s (%s)\n", i ? "CPU" : "machine", str);
+            return 1;
+        }
+    }
+
+    if ((gzread(state->fp, &len, sizeof(len)) != (int) sizeof(len)) || (len != (uint32_t) cpu))
+        return 1;
+
+    if ((gzread(state->fp, &len, sizeof(len)) != (int) sizeof(len)) || (len != mem_size)) {
+        pclog("SAVESTATE: Snapshot has a different amount of memory\n");
+        return 1;
+    }
+
+    if (gzread(state->fp, flags, sizeof(uint32_t)) != (int) sizeof(uint32_t))
+        return 1;
+
+    if ((gzread(state->fp, id, sizeof(uint64_t)) != (int) sizeof(uint64_t)) ||
+        (gzread(state->fp, parent_id, sizeof(uint64_t)) != (int) sizeof(uint64_t)))
+        return 1;
+
+    if ((gzread(state->fp, &len, sizeof(len)) != (int) sizeof(len)) || (len >= size) ||
+        (gzread(state->fp, parent, len) != (int) len))
+        return 1;
+    parent[len] = '\0';
+
+    return 0;
+}
+
+static int
+savestate_load_chunk(savestate_t *state, uint64_t *ram_addr)
+{
+    uint32_t hdr[2];
+    uint32_t page;
+    uint64_t new_tsc;
+
+    if (gzread(state->fp, hdr, sizeof(hdr)) != (int) sizeof(hdr))
+        return -1;
+
+    if (hdr[0] == TAG_END)
+        return 0;
+
+    if (hdr[0] == TAG_RAM) {
+        if (!savestate_ram_span_ok(*ram_addr, hdr[1]) ||
+            (gzread(state->fp, savestate_ram_ptr(*ram_addr), hdr[1]) != (int) hdr[1]))
+            return -1;
+        *ram_addr += hdr[1];
+        return 1;
+    }
+
+    if (hdr[0] == TAG_RAMD) {
+        if ((hdr[1] < sizeof(uint32_t)) || ((hdr[1] - sizeof(uint32_t)) & 0xfff) ||
+            (gzread(state->fp, &page, sizeof(page)) != (int) sizeof(page)))
+            return -1;
+        hdr[1] -= sizeof(uint32_t);
+        if (!savestate_ram_span_ok((uint64_t) page << 12, hdr[1]) ||
+            (gzread(state->fp, savestate_ram_ptr((uint64_t) page << 12), hdr[1]) != (int) hdr[1]))
+            return -1;
+        return 1;
+    }
+
+    state->len = 0;
+    state->pos = 0;
+    if (hdr[1]) {
+        if (hdr[1] > state->size) {
+            uint8_t *new_buf = (uint8_t *) realloc(state->buf, hdr[1]);
+            if (new_buf == NULL)
+                return -1;
+            state->buf  = new_buf;
+            state->size = hdr[1];
+        }
+        if (gzread(state->fp, state->buf, hdr[1]) != (int) hdr[1])
+            return -1;
+    }
+    state->len = hdr[1];
+
+    switch (hdr[0]) {
+        case TAG_TSC:
+            /* Rebase every running timer onto the restored TSC first, so the
+               ones that nobody restores keep their relative deadlines. */
+            new_tsc = savestate_read_u64(state);
+            timer_shift((new_tsc - tsc) << 32);
+            tsc = new_tsc;
+            break;
+
+        case TAG_CPU:
+            cpu_load(state);
+            break;
+
+        case TAG_MEM:
+            if (mem_load(state))
+                return -1;
+            break;
+
+        case TAG_PIC:
+            pic_load(state);
+            break;
+
+        case TAG_DMA:
+            dma_load(state);
+            break;
+
+        case TAG_DEV:
+            if (device_load_one(state))
+                return -1;
+            break;
+
+        case TAG_DEVS:
+            device_load_skipped(state);
+            break;
+
+        default:
+            savestate_log("SAVESTATE: Skipping unknown chunk %08X\n", hdr[0]);
+            state->pos = state->len;
+            break;
+    }
+
+    /* A chunk that is not consumed exactly means a layout mismatch. */
+    if (state->error || (state->pos != state->len))
+        return -1;
+
+    return 1;
+}
+
+/* Loads a snapshot, first loading the chain of snapshots below it if it is a
+   delta. Everything but RAM is stored whole in every snapshot, so the last
+   one to load wins; the RAM pages of each delta land on top of its parent.
+   Returns 2 if the snapshot is refused before anything has been loaded. */
+static int
+savestate_load_file(const char *fn, int depth, int force, uint64_t *id)
+{
+    savestate_t state;
+    uint32_t    flags;
+    uint64_t    ram_addr = 0;
+    uint64_t    parent_id;
+    uint64_t    loaded_id;
+    char        parent[1024];
+    char        parent_fn[2048];
+    size_t      dir_len;
+    int         ret;
+
+    memset(&state, 0x00, sizeof(savestate_t));
+
+    state.fp = gzopen(fn, "rb");
+    if (state.fp == NULL) {
+        pclog("SAVESTATE: Unable to open \"%s\"\n", fn);
+        return 1;
+    }
+    gzbuffer(state.fp, 1 << 18);
+
+    if (savestate_check_header(&state, &flags, id, &parent_id, parent, sizeof(parent))) {
+        pclog("SAVESTATE: \"%s\" does not match this machine\n", fn);
+        gzclose(state.fp);
+        return 1;
+    }
+
+    /* Devices the snapshot has no state for would carry on with whatever state
+       they have now, which the restored guest is not expecting. Only the top
+       of a chain counts, its device chunks override those of its parents. */
+    if ((depth == 0) && (flags & SAVESTATE_FLAG_PARTIAL) && !force) {
+        pclog("SAVESTATE: \"%s\" is missing the state of some devices, not loading it unless forced\n", fn);
+        gzclose(state.fp);
+        return 2;
+    }
+
+    if (parent_id != 0) {
+        if (depth >= SAVESTATE_CHAIN_DEPTH) {
+            pclog("SAVESTATE: Snapshot chain at \"%s\" is too long\n", fn);
+            gzclose(state.fp);
+            return 1;
+        }
+
+        dir_len = path_get_filename((char *) fn) - fn;
+        if (path_abs(parent) || (dir_len >= sizeof(parent_fn)))
+            dir_len = 0;
+        snprintf(parent_fn, sizeof(parent_fn), "%.*s%s", (int) dir_len, fn, parent);
+
+        if (savestate_load_file(parent_fn, depth + 1, force, &loaded_id)) {
+            gzclose(state.fp);
+            return 1;
+        }
+        if (loaded_id != parent_id) {
+            pclog("SAVESTATE: \"%s\" is not the snapshot \"%s\" was taken on top of\n", parent_fn, fn);
+            gzclose(state.fp);
+            return 1;
+        }
+    }
+
+    while ((ret = savestate_load_chunk(&state, &ram_addr)) > 0)
+        ;
+
+    gzclose(state.fp);
+    free(state.buf);
+
+    /* A full snapshot has to cover all of RAM, a delta has no full RAM chunks. */
+    if ((ret < 0) || (ram_addr != ((parent_id != 0) ? 0 : ((uint64_t) mem_size << 10)))) {
+        pclog("SAVESTATE: Error loading \"%s\"\n", fn);
+        return 1;
+    }
+
+    savestate_log("SAVESTATE: Loaded \"%s\"\n", fn);
+
+    if (depth == 0) {
+        /* Later deltas get built on top of what was just loaded. */
+        snprintf(savestate_base_fn, sizeof(savestate_base_fn), "%s", fn);
+        savestate_base_id = *id;
+    }
+    if (parent_id == 0)
+        savestate_chain_len = 0;
+    else
+        savestate_chain_len++;
+
+    return 0;
+}
+
+/* A snapshot some device states are missing from is only loaded if forced. */
+int
+savestate_load(const char *fn, int force)
+{
+    uint64_t id;
+    int      ret;
+
+    ret = savestate_load_file(fn, 0, force, &id);
+    if (ret == 2)
+        return 1;
+    if (ret) {
+        /* The machine may be half-restored at this point, start it over. */
+        pclog("SAVESTATE: Unable to load \"%s\", resetting the machine\n", fn);
+        savestate_base_fn[0] = '\0';
+        pc_reset_hard();
+        return 1;
+    }
+
+    mem_dirty_clear();
+
+#ifdef USE_DYNAREC
+    /* RAM was read in behind the back of the write handlers, so none of the
+       code translated before the load can be trusted to still be there. */
+    codegen_reset();
+#endif
+
+    return 0;
+}
+
+/* Folds a chain of deltas into a single full snapshot, which then becomes the
+   base for further deltas. A partial chain folds into a snapshot that is
+   flagged as partial in turn, so it does not need forcing. */
+int
+savestate_compact(const char *fn, const char *out_fn)
+{
+    if (savestate_load(fn, 1))
+        return 1;
+
+    return savestate_save(out_fn);
+}
+
+void
+savestate_request_save(const char *fn)
+{
+    snprintf(savestate_save_fn, sizeof(savestate_save_fn), "%s", fn);
+    savestate_save_pending = 1;
+}
+
+void
+savestate_request_load(const char *fn, int force)
+{
+    snprintf(savestate_load_fn, sizeof(savestate_load_fn), "%s", fn);
+    savestate_load_force   = force;
+    savestate_load_pending = 1;
+}
+
+/* Takes a delta snapshot every interval_ms milliseconds, named after prefix
+   and numbered in sequence, which is useful for rewinding long test runs. */
+void
+savestate_checkpoint_start(const char *prefix, uint32_t interval_ms)
+{
+    snprintf(savestate_checkpoint_prefix, sizeof(savestate_checkpoint_prefix), "%s", prefix);
+    savestate_checkpoint_interval = interval_ms;
+    savestate_checkpoint_last     = plat_get_ticks();
+    savestate_checkpoint_seq      = 0;
+}
+
+/* Called by the emulation thread between frames, where the CPU is at an
+   instruction boundary and the TSC is up to date. */
+void
+savestate_process(void)
+{
+    char     fn[1024 + 16];
+    uint32_t now;
+
+    if (savestate_load_pending) {
+        savestate_load_pending = 0;
+        savestate_load(savestate_load_fn, savestate_load_force);
+    }
+
+    if (savestate_save_pending) {
+        savestate_save_pending = 0;
+        savestate_save(savestate_save_fn);
+    }
+
+    if (savestate_checkpoint_interval) {
+        now = plat_get_ticks();
+        if ((now - savestate_checkpoint_last) >= savestate_checkpoint_interval) {
+            savestate_checkpoint_last = now;
+            snprintf(fn, sizeof(fn), "%s-%04u.86s", savestate_checkpoint_prefix, savestate_checkpoint_seq++);
+            savestate_save_delta(fn);
+        }
+    }
+}
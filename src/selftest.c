@@ -0,0 +1,351 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Self-tests of the emulator core.
+ *
+ *          Like the micro-benchmarks, every test runs without a machine
+ *          around it, with only the pieces of the emulator it needs
+ *          brought up, so no ROMs are needed.
+ *
+ *          Usage: 86Box-selftest [test ...]
+ *
+ *          Only the tests whose name contains one of the given strings
+ *          are run, all of them if there are none. The exit status is
+ *          non-zero if any of them failed.
+ *
+ *
+ *
+ */
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#define HAVE_STDARG_H
+#include <86box/86box.h>
+#include "cpu.h"
+#ifdef USE_DYNAREC
+#    include "codegen_public.h"
+#endif
+#include "x86seg.h"
+#include <86box/device.h>
+#include <86box/io.h>
+#include <86box/mem.h>
+#include <86box/timer.h>
+#include <86box/savestate.h>
+#include <86box/video.h>
+#include <86box/vid_svga.h>
+#include <86box/vid_svga_render.h>
+
+#define STEST_MEM_KB    1024
+/* Where the test code runs, in real mode with CS at 0. */
+#define STEST_CODE_ADDR 0x1000
+/* Enough for a translated block to be run many times over. */
+#define STEST_CYCLES    100000
+#define STEST_VRAM      (1 << 20)
+#define STEST_OVERSCAN  16
+#define STEST_BORDER    0x00123456
+#define STEST_GLYPH_CHR 0x41
+
+typedef struct stest_t {
+    const char *name;
+    /* Returns zero if the test passed. */
+    int (*run)(void);
+} stest_t;
+
+static int
+stest_cpu_init(void)
+{
+    static int inited = 0;
+
+    if (!inited) {
+        /* A 386DX, which runs through the recompiler when there is one. */
+        cpu_f = cpu_get_family("i386dx");
+        if (cpu_f == NULL)
+            return 0;
+        cpu             = 0;
+        fpu_type        = FPU_NONE;
+        cpu_use_dynarec = 1;
+        mem_size        = STEST_MEM_KB;
+
+        mem_init();
+#ifdef USE_DYNAREC
+        codegen_init();
+#endif
+        cpu_set();
+        mem_reset();
+        inited = 1;
+    }
+
+    resetx86();
+    loadcs(0x0000);
+
+    return 1;
+}
+
+/* Places "mov ax, val; jmp $-3" at the code address, the way the guest
+   itself would write it. */
+static void
+stest_put_loop(uint16_t val)
+{
+    const uint8_t code[] = { 0xb8, val & 0xff, val >> 8, 0xeb, 0xfb };
+
+    for (uint32_t i = 0; i < sizeof(code); i++)
+        writemembl(STEST_CODE_ADDR + i, code[i]);
+}
+
+static uint16_t
+stest_run_loop(void)
+{
+    cpu_state.pc = STEST_CODE_ADDR;
+    AX           = 0x0000;
+    cpu_exec(STEST_CYCLES);
+
+    return AX;
+}
+
+/* Loading a snapshot puts back code the CPU may already have translated
+   something else for, at the same address: the code from the snapshot has
+   to be the one that runs. */
+static int
+stest_savestate_code(void)
+{
+    char     fn[32];
+    uint16_t ax;
+    int      ret = 1;
+
+    if (!stest_cpu_init())
+        return 1;
+
+    snprintf(fn, sizeof(fn), "selftest-%08x.86s", (uint32_t) rand());
+
+    stest_put_loop(0x1111);
+    if (stest_run_loop() != 0x1111) {
+        printf("  the first loop did not run\n");
+        return 1;
+    }
+    if (savestate_save(fn)) {
+        printf("  unable to save \"%s\"\n", fn);
+        return 1;
+    }
+
+    stest_put_loop(0x2222);
+    if (stest_run_loop() != 0x2222) {
+        printf("  the second loop did not run\n");
+        goto done;
+    }
+
+    if (savestate_load(fn, 0)) {
+        printf("  unable to load \"%s\"\n", fn);
+        goto done;
+    }
+
+    ax = stest_run_loop();
+    if (ax != 0x1111)
+        printf("  the loaded loop left AX at %04X instead of 1111\n", ax);
+    else
+        ret = 0;
+
+done:
+    remove(fn);
+    return ret;
+}
+
+/* A packed-pixel line queued for the render worker is wider than the screen
+   when it is scrolled, and must not end up drawn over the borders next to
+   it. The steps are the ones svga_do_render() takes for a line. */
+static int
+stest_svga_overscan(void)
+{
+    svga_t   *svga = (svga_t *) calloc(1, sizeof(svga_t));
+    uint32_t *line;
+    int       right;
+    int       ret = 0;
+
+    svga->monitor_index     = 0;
+    svga->monitor           = &monitors[0];
+    svga->vram              = (uint8_t *) calloc(STEST_VRAM, 1);
+    svga->vram_max          = STEST_VRAM;
+    svga->vram_mask         = STEST_VRAM - 1;
+    svga->vram_display_mask = STEST_VRAM - 1;
+    svga->decode_mask       = STEST_VRAM - 1;
+    svga->changedvram       = (uint8_t *) calloc(STEST_VRAM >> 12, 1);
+    svga->map8              = svga->pallook;
+    svga->firstline_draw    = 2000;
+    svga->fullchange        = 1;
+    svga->attrregs[0x12]    = 0x0f;
+    svga->crtc[0x17]        = 0xe3; /* Byte mode, as in the SVGA packed-pixel modes. */
+    svga->plane_mask        = 0x0f;
+    svga->hdisp             = 640;
+    svga->scrollcache       = 4;
+    svga->y_add             = 8;
+    svga->overscan_color    = STEST_BORDER;
+    for (int i = 0; i < 256; i++)
+        svga->pallook[i] = 0x00ffffff;
+
+    svga->monitor->mon_overscan_x = STEST_OVERSCAN;
+
+    svga_recalc_remap_func(svga);
+    svga_render_simd_init();
+    video_render_thread = 1;
+    svga_render_worker_init(svga);
+
+    svga->x_add = (svga->monitor->mon_overscan_x >> 1) - svga->scrollcache;
+    svga_render_8bpp_highres(svga);
+    svga->x_add = (svga->monitor->mon_overscan_x >> 1);
+    svga_render_overscan_left(svga);
+    svga_render_overscan_right(svga);
+    svga_render_worker_sync(svga);
+
+    line  = svga->monitor->target_buffer->line[svga->displine + svga->y_add];
+    right = svga->x_add + svga->hdisp;
+    for (int x = 0; x < svga->x_add; x++) {
+        if ((line[x] != STEST_BORDER) || (line[right + x] != STEST_BORDER)) {
+            printf("  the border at %i or %i was drawn over\n", x, right + x);
+            ret = 1;
+            break;
+        }
+    }
+
+    svga_render_worker_close(svga);
+    video_render_thread = 0;
+    free(svga->changedvram);
+    free(svga->vram);
+    free(svga);
+
+    return ret;
+}
+
+/* Draws the first character cell of the line the way svga_render_text_80()
+   does, and checks it against the font row and colours it should have. */
+static int
+stest_svga_text_cell(svga_t *svga, uint8_t font, uint32_t fg, uint32_t bg)
+{
+    const uint32_t *line = svga->monitor->target_buffer->line[0];
+
+    svga->ma = 0;
+    svga_render_text_80(svga);
+
+    for (int x = 0; x < 8; x++) {
+        if (line[x] != ((font & (0x80 >> x)) ? fg : bg)) {
+            printf("  dot %i is %06X\n", x, line[x]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Text rows come from a cache, which must not outlive the font or colours
+   they were drawn with. */
+static int
+stest_svga_glyph_cache(void)
+{
+    svga_t *svga = (svga_t *) calloc(1, sizeof(svga_t));
+    int     ret  = 0;
+
+    svga->monitor_index     = 0;
+    svga->monitor           = &monitors[0];
+    svga->vram              = (uint8_t *) calloc(STEST_VRAM, 1);
+    svga->vram_max          = STEST_VRAM;
+    svga->vram_mask         = STEST_VRAM - 1;
+    svga->vram_display_mask = STEST_VRAM - 1;
+    svga->decode_mask       = STEST_VRAM - 1;
+    svga->changedvram       = (uint8_t *) calloc(STEST_VRAM >> 12, 1);
+    svga->glyph_cache       = video_glyph_cache_init();
+    svga->firstline_draw    = 2000;
+    svga->fullchange        = 1;
+    svga->force_old_addr    = 1; /* Character and attribute at ma * 2. */
+    svga->seqregs[1]        = 0x01; /* 8 dot characters. */
+    svga->gdcreg[6]         = 0x04; /* 64k at A0000. */
+    svga->gdcreg[8]         = 0xff;
+    svga->writemask         = 0x04; /* The font plane only, as when loading a font. */
+    svga->charseta          = 2;
+    svga->charsetb          = 2;
+    svga->hdisp             = 8;
+    for (int c = 0; c < 16; c++) {
+        svga->egapal[c]  = c;
+        svga->pallook[c] = 0x00111111 * c;
+    }
+
+    svga->vram[0]                                        = STEST_GLYPH_CHR;
+    svga->vram[1]                                        = 0x07;
+    svga->vram[svga->charseta + (STEST_GLYPH_CHR * 128)] = 0xf0;
+
+    if (stest_svga_text_cell(svga, 0xf0, svga->pallook[7], svga->pallook[0]))
+        ret = 1;
+
+    svga_write(0xa0000 + (STEST_GLYPH_CHR * 32), 0x3c, svga);
+    if (!ret && stest_svga_text_cell(svga, 0x3c, svga->pallook[7], svga->pallook[0])) {
+        printf("  after the font was written\n");
+        ret = 1;
+    }
+
+    svga->pallook[7] = STEST_BORDER;
+    if (!ret && stest_svga_text_cell(svga, 0x3c, STEST_BORDER, svga->pallook[0])) {
+        printf("  after the palette was written\n");
+        ret = 1;
+    }
+
+    video_glyph_cache_close(svga->glyph_cache);
+    free(svga->changedvram);
+    free(svga->vram);
+    free(svga);
+
+    return ret;
+}
+
+static const stest_t stest_tests[] = {
+  // clang-format off
+    { "savestate_code",   stest_savestate_code   },
+    { "svga_overscan",    stest_svga_overscan    },
+    { "svga_glyph_cache", stest_svga_glyph_cache },
+    { NULL,               NULL                   }
+  // clang-format on
+};
+
+static int
+stest_selected(const stest_t *st, int argc, char **argv)
+{
+    if (argc < 2)
+        return 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strstr(st->name, argv[i]) != NULL)
+            return 1;
+    }
+
+    return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    int failed = 0;
+
+    /* What pc_init() and a hard reset would bring up, minus the machine. */
+    io_init();
+    timer_init();
+    device_init();
+    video_init();
+
+    for (const stest_t *st = stest_tests; st->name != NULL; st++) {
+        if (!stest_selected(st, argc, argv))
+            continue;
+
+        if (st->run()) {
+            printf("%-40s FAILED\n", st->name);
+            failed++;
+        } else
+            printf("%-40s ok\n", st->name);
+        fflush(stdout);
+    }
+
+    return !!failed;
+}
@@ -33,6 +33,8 @@
 #include <86box/86box.h>
 #include <86box/midi.h>
 #include <86box/sound.h>
+#include <86box/pacer.h>
+#include <86box/machine_counters.h>
 #include <86box/plat_unused.h>
 
 #define FREQ   SOUND_FREQ
@@ -238,10 +240,19 @@ givealbuffer_common(void *buf, uint8_t src, int size, int freq)
     alGetSourcei(source[src], AL_SOURCE_STATE, &state);
 
     if (state == 0x1014) {
+        /* Stopped, having played everything it was given. */
+        if (src == 0)
+            machine_counters.audio_underruns++;
         alSourcePlay(source[src]);
     }
 
     alGetSourcei(source[src], AL_BUFFERS_PROCESSED, &processed);
+
+    /* One buffer played per buffer given means the emulation keeps pace
+       with the audio device, none means it is running ahead. */
+    if (src == 0)
+        pacer_sync((1 - processed) * ((1000000000LL * BUFLEN) / FREQ));
+
     if (processed >= 1) {
         gain = pow(10.0, (double) sound_gain / 20.0);
         alListenerf(AL_GAIN, gain);
@@ -526,8 +526,9 @@ ac97_via_remap_modem_codec(void *priv, uint16_t new_io_base, uint8_t enable)
 static void
 ac97_via_update_stereo(ac97_via_t *dev, ac97_via_sgd_t *sgd)
 {
-    int32_t l = (((sgd->out_l * sgd->vol_l) >> 15) * dev->master_vol_l) >> 15;
-    int32_t r = (((sgd->out_r * sgd->vol_r) >> 15) * dev->master_vol_r) >> 15;
+    int32_t   l         = (((sgd->out_l * sgd->vol_l) >> 15) * dev->master_vol_l) >> 15;
+    int32_t   r         = (((sgd->out_r * sgd->vol_r) >> 15) * dev->master_vol_r) >> 15;
+    const int sound_pos = sound_pos_get();
 
     if (l < -32768)
         l = -32768;
@@ -538,7 +539,7 @@ ac97_via_update_stereo(ac97_via_t *dev, ac97_via_sgd_t *sgd)
     else if (r > 32767)
         r = 32767;
 
-    for (; sgd->pos < sound_pos_global; sgd->pos++) {
+    for (; sgd->pos < sound_pos; sgd->pos++) {
         sgd->buffer[sgd->pos * 2]     = l;
         sgd->buffer[sgd->pos * 2 + 1] = r;
     }
@@ -647,7 +647,9 @@ adgold_read(uint16_t addr, void *priv)
 void
 adgold_update(adgold_t *adgold)
 {
-    for (; adgold->pos < sound_pos_global; adgold->pos++) {
+    const int sound_pos = sound_pos_get();
+
+    for (; adgold->pos < sound_pos; adgold->pos++) {
         adgold->mma_buffer[0][adgold->pos] = adgold->mma_buffer[1][adgold->pos] = 0;
 
         if (adgold->adgold_mma_regs[0][9] & 0x20)
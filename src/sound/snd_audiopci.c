@@ -1894,8 +1894,9 @@ es1371_next_sample_filtered(es1371_t *dev, int dac_nr, int out_idx)
 static void
 es1371_update(es1371_t *dev)
 {
-    int32_t l;
-    int32_t r;
+    int32_t   l;
+    int32_t   r;
+    const int sound_pos = sound_pos_get();
 
     l = (dev->dac[0].out_l * dev->dac[0].vol_l) >> 12;
     l += ((dev->dac[1].out_l * dev->dac[1].vol_l) >> 12);
@@ -1917,7 +1918,7 @@ es1371_update(es1371_t *dev)
     else if (r > 32767)
         r = 32767;
 
-    for (; dev->pos < sound_pos_global; dev->pos++) {
+    for (; dev->pos < sound_pos; dev->pos++) {
         dev->buffer[dev->pos * 2]     = l;
         dev->buffer[dev->pos * 2 + 1] = r;
     }
@@ -1027,11 +1027,12 @@ cmi8x38_pci_write(int func, int addr, uint8_t val, void *priv)
 static void
 cmi8x38_update(cmi8x38_t *dev, cmi8x38_dma_t *dma)
 {
-    const sb_ct1745_mixer_t *mixer = &dev->sb->mixer_sb16;
-    int32_t                  l     = (dma->out_fl * mixer->voice_l) * mixer->master_l;
-    int32_t                  r     = (dma->out_fr * mixer->voice_r) * mixer->master_r;
+    const sb_ct1745_mixer_t *mixer     = &dev->sb->mixer_sb16;
+    int32_t                  l         = (dma->out_fl * mixer->voice_l) * mixer->master_l;
+    int32_t                  r         = (dma->out_fr * mixer->voice_r) * mixer->master_r;
+    const int                sound_pos = sound_pos_get();
 
-    for (; dma->pos < sound_pos_global; dma->pos++) {
+    for (; dma->pos < sound_pos; dma->pos++) {
         dma->buffer[dma->pos * 2]     = l;
         dma->buffer[dma->pos * 2 + 1] = r;
     }
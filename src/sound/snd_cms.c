@@ -15,7 +15,9 @@
 void
 cms_update(cms_t *cms)
 {
-    for (; cms->pos < sound_pos_global; cms->pos++) {
+    const int sound_pos = sound_pos_get();
+
+    for (; cms->pos < sound_pos; cms->pos++) {
         int16_t out_l = 0;
         int16_t out_r = 0;
 
@@ -1758,7 +1758,7 @@ int32_t old_vol[32]   = { 0 };
 void
 emu8k_update(emu8k_t *emu8k)
 {
-    int new_pos = (sound_pos_global * FREQ_44100) / SOUND_FREQ;
+    int new_pos = (sound_pos_get() * FREQ_44100) / SOUND_FREQ;
     if (emu8k->pos >= new_pos)
         return;
 
@@ -22,6 +22,11 @@
 #include <86box/plat_fallthrough.h>
 #include <86box/plat_unused.h>
 
+/* Most GF1 samples the voices may run ahead of the sample timer. */
+#define GUS_WAVE_BATCH   64
+/* Beyond this many owed samples the voices skip ahead instead. */
+#define GUS_WAVE_MAX_LAG (SOUNDBUFLEN * 4)
+
 enum {
     MIDI_INT_RECEIVE  = 0x01,
     MIDI_INT_TRANSMIT = 0x02,
@@ -94,6 +99,7 @@ typedef struct gus_t {
 
     pc_timer_t samp_timer;
     uint64_t   samp_latch;
+    uint64_t   samp_ts;
 
     uint8_t *ram;
     uint32_t gus_end_ram;
@@ -162,6 +168,9 @@ int gusfreqs[] = {
 
 double vol16bit[4096];
 
+static void gus_wave_sync(gus_t *gus);
+static void gus_wave_schedule(gus_t *gus);
+
 void
 gus_update_int_status(gus_t *gus)
 {
@@ -265,6 +274,9 @@ writegus(uint16_t addr, uint8_t val, void *priv)
     else
         port = addr & 0xf0f;
 
+    /* Voices see register and DRAM writes at the sample they happen. */
+    gus_wave_sync(gus);
+
     switch (port) {
         case 0x300: /*MIDI control*/
             old            = gus->midi_ctrl;
@@ -709,6 +721,8 @@ writegus(uint16_t addr, uint8_t val, void *priv)
         default:
             break;
     }
+
+    gus_wave_schedule(gus);
 }
 
 uint8_t
@@ -723,6 +737,8 @@ readgus(uint16_t addr, void *priv)
     else
         port = addr & 0xf0f;
 
+    gus_wave_sync(gus);
+
     switch (port) {
         case 0x300: /*MIDI status*/
             val = gus->midi_status;
@@ -1006,9 +1022,9 @@ gus_poll_timer_2(void *priv)
 }
 
 static void
-gus_update(gus_t *gus)
+gus_fill(gus_t *gus, int sound_pos)
 {
-    for (; gus->pos < sound_pos_global; gus->pos++) {
+    for (; gus->pos < sound_pos; gus->pos++) {
         if (gus->out_l < -32768)
             gus->buffer[0][gus->pos] = -32768;
         else if (gus->out_l > 32767)
@@ -1024,8 +1040,9 @@ gus_update(gus_t *gus)
     }
 }
 
+/* Runs the voices for one GF1 sample period. */
 void
-gus_poll_wave(void *priv)
+gus_wave_sample(void *priv)
 {
     gus_t   *gus = (gus_t *) priv;
     uint32_t addr;
@@ -1033,10 +1050,6 @@ gus_poll_wave(void *priv)
     int32_t  vl;
     int      update_irqs = 0;
 
-    gus_update(gus);
-
-    timer_advance_u64(&gus->samp_timer, gus->samp_latch);
-
     gus->out_l = gus->out_r = 0;
 
     if ((gus->reset & 3) != 3)
@@ -1177,6 +1190,91 @@ gus_poll_wave(void *priv)
         gus_update_int_status(gus);
 }
 
+/* Samples owed by the voices are produced in one go, each one placed in the
+   output buffer at the time it was due, whenever the GF1 is accessed, the
+   mixer wants the buffer, or the sample timer fires. */
+static void
+gus_wave_sync(gus_t *gus)
+{
+    const uint64_t now = (uint64_t) (tsc + 1) << 32;
+
+    /* Snapshot loads and long pauses move the clock far ahead. */
+    if ((int64_t) (now - gus->samp_ts) > (int64_t) (gus->samp_latch * GUS_WAVE_MAX_LAG))
+        gus->samp_ts = now - gus->samp_latch;
+
+    while ((int64_t) (now - gus->samp_ts) > 0) {
+        gus_fill(gus, sound_pos_at(gus->samp_ts));
+        gus_wave_sample(gus);
+        gus->samp_ts += gus->samp_latch;
+    }
+}
+
+/* Samples until a voice or ramp crosses its boundary, counted from a position
+   that moves by step per sample. */
+static uint32_t
+gus_wave_samples_left(uint32_t dist, uint32_t step)
+{
+    if (!step)
+        return GUS_WAVE_BATCH;
+    if (!dist)
+        return 1;
+
+    return ((dist - 1) / step) + 1;
+}
+
+/* The sample timer only has to fire where a voice or ramp IRQ can be raised,
+   otherwise once per batch to keep the voices from drifting too far. */
+static void
+gus_wave_schedule(gus_t *gus)
+{
+    uint32_t left = GUS_WAVE_BATCH;
+    uint32_t n;
+
+    if ((gus->reset & 3) == 3) {
+        for (uint8_t d = 0; d < 32; d++) {
+            if (!(gus->ctrl[d] & 3) && (gus->ctrl[d] & 0x20)) {
+                if (gus->ctrl[d] & 0x40)
+                    n = gus_wave_samples_left((gus->cur[d] > gus->start[d]) ? (gus->cur[d] - gus->start[d]) : 0,
+                                              gus->freq[d] >> 1);
+                else
+                    n = gus_wave_samples_left((gus->end[d] > gus->cur[d]) ? (gus->end[d] - gus->cur[d]) : 0,
+                                              gus->freq[d] >> 1);
+                if (n < left)
+                    left = n;
+            }
+            if (!(gus->rctrl[d] & 3) && (gus->rctrl[d] & 0x20)) {
+                if (gus->rctrl[d] & 0x40)
+                    n = gus_wave_samples_left((gus->rcur[d] > gus->rstart[d]) ? (gus->rcur[d] - gus->rstart[d]) : 0,
+                                              gus->rfreq[d]);
+                else
+                    n = gus_wave_samples_left((gus->rend[d] > gus->rcur[d]) ? (gus->rend[d] - gus->rcur[d]) : 0,
+                                              gus->rfreq[d]);
+                if (n < left)
+                    left = n;
+            }
+        }
+    }
+
+    gus->samp_timer.ts.ts64 = gus->samp_ts + ((left - 1) * gus->samp_latch);
+    timer_enable(&gus->samp_timer);
+}
+
+void
+gus_poll_wave(void *priv)
+{
+    gus_t *gus = (gus_t *) priv;
+
+    gus_wave_sync(gus);
+    gus_wave_schedule(gus);
+}
+
+static void
+gus_update(gus_t *gus)
+{
+    gus_wave_sync(gus);
+    gus_fill(gus, sound_pos_get());
+}
+
 static void
 gus_get_buffer(int32_t *buffer, int len, void *priv)
 {
@@ -1393,6 +1491,7 @@ gus_init(UNUSED(const device_t *info))
     }
 #endif
 
+    gus->samp_ts = (uint64_t) tsc << 32;
     timer_add(&gus->samp_timer, gus_poll_wave, gus, 1);
     timer_add(&gus->timer_1, gus_poll_timer_1, gus, 1);
     timer_add(&gus->timer_2, gus_poll_timer_2, gus, 1);
@@ -1419,11 +1518,15 @@ gus_speed_changed(void *priv)
 {
     gus_t *gus = (gus_t *) priv;
 
+    gus_wave_sync(gus);
+
     if (gus->voices < 14)
         gus->samp_latch = (uint64_t) (TIMER_USEC * (1000000.0 / 44100.0));
     else
         gus->samp_latch = (uint64_t) (TIMER_USEC * (1000000.0 / gusfreqs[gus->voices - 14]));
 
+    gus_wave_schedule(gus);
+
 #if defined(DEV_BRANCH) && defined(USE_GUSMAX)
     if ((gus->type == GUS_MAX) && (gus->max_ctrl))
         ad1848_speed_changed(&gus->ad1848);
@@ -32,7 +32,9 @@ typedef struct dss_t {
 static void
 dss_update(dss_t *dss)
 {
-    for (; dss->pos < sound_pos_global; dss->pos++)
+    const int sound_pos = sound_pos_get();
+
+    for (; dss->pos < sound_pos; dss->pos++)
         dss->buffer[dss->pos] = (int8_t) (dss->dac_val ^ 0x80) * 0x40;
 }
 
@@ -1531,16 +1531,17 @@ nuked_drv_close(void *priv)
 static int32_t *
 nuked_drv_update(void *priv)
 {
-    nuked_drv_t *dev = (nuked_drv_t *) priv;
+    nuked_drv_t *dev       = (nuked_drv_t *) priv;
+    const int    sound_pos = sound_pos_get();
 
-    if (dev->pos >= sound_pos_global)
+    if (dev->pos >= sound_pos)
         return dev->buffer;
 
     nuked_generate_stream(&dev->opl,
                           &dev->buffer[dev->pos * 2],
-                          sound_pos_global - dev->pos);
+                          sound_pos - dev->pos);
 
-    for (; dev->pos < sound_pos_global; dev->pos++) {
+    for (; dev->pos < sound_pos; dev->pos++) {
         dev->buffer[dev->pos * 2] /= 2;
         dev->buffer[(dev->pos * 2) + 1] /= 2;
     }
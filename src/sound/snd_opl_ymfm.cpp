@@ -206,12 +206,14 @@ public:
 
     virtual int32_t *update() override
     {
-        if (m_buf_pos >= sound_pos_global)
+        const int sound_pos = sound_pos_get();
+
+        if (m_buf_pos >= sound_pos)
             return m_buffer;
 
-        generate_resampled(&m_buffer[m_buf_pos * 2], sound_pos_global - m_buf_pos);
+        generate_resampled(&m_buffer[m_buf_pos * 2], sound_pos - m_buf_pos);
 
-        for (; m_buf_pos < sound_pos_global; m_buf_pos++) {
+        for (; m_buf_pos < sound_pos; m_buf_pos++) {
             m_buffer[m_buf_pos * 2] /= 2;
             m_buffer[(m_buf_pos * 2) + 1] /= 2;
         }
@@ -710,13 +710,15 @@ pas16_out_base(UNUSED(uint16_t port), uint8_t val, void *priv)
 static void
 pas16_update(pas16_t *pas16)
 {
+    const int sound_pos = sound_pos_get();
+
     if (!(pas16->audiofilt & PAS16_FILT_MUTE)) {
-        for (; pas16->pos < sound_pos_global; pas16->pos++) {
+        for (; pas16->pos < sound_pos; pas16->pos++) {
             pas16->pcm_buffer[0][pas16->pos] = 0;
             pas16->pcm_buffer[1][pas16->pos] = 0;
         }
     } else {
-        for (; pas16->pos < sound_pos_global; pas16->pos++) {
+        for (; pas16->pos < sound_pos; pas16->pos++) {
             pas16->pcm_buffer[0][pas16->pos] = (int16_t) pas16->pcm_dat_l;
             pas16->pcm_buffer[1][pas16->pos] = (int16_t) pas16->pcm_dat_r;
         }
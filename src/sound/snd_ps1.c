@@ -125,7 +125,9 @@ ps1snd_write(uint16_t port, uint8_t val, void *priv)
 static void
 ps1snd_update(ps1snd_t *ps1snd)
 {
-    for (; ps1snd->pos < sound_pos_global; ps1snd->pos++)
+    const int sound_pos = sound_pos_get();
+
+    for (; ps1snd->pos < sound_pos; ps1snd->pos++)
         ps1snd->buffer[ps1snd->pos] = (int8_t) (ps1snd->dac_val ^ 0x80) * 0x20;
 }
 
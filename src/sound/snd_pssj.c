@@ -122,7 +122,9 @@ pssj_read(uint16_t port, void *priv)
 static void
 pssj_update(pssj_t *pssj)
 {
-    for (; pssj->pos < sound_pos_global; pssj->pos++)
+    const int sound_pos = sound_pos_get();
+
+    for (; pssj->pos < sound_pos; pssj->pos++)
         pssj->buffer[pssj->pos] = (((int8_t) (pssj->dac_val ^ 0x80) * 0x20) * pssj->amplitude) / 15;
 }
 
@@ -35,9 +35,17 @@
 /*The recording safety margin is intended for uneven "len" calls to the get_buffer mixer calls on sound_sb*/
 #define SB_DSP_REC_SAFEFTY_MARGIN 4096
 
+/*Recorded samples are handed to the guest in batches of up to this many, on the input timer or
+  whenever the DSP is accessed; the timer always fires on the sample that ends a DMA block*/
+#define SB_DSP_REC_BATCH 32
+
 void pollsb(void *priv);
 void sb_poll_i(void *priv);
 
+static void sb_input_start(sb_dsp_t *dsp);
+static void sb_input_sync(sb_dsp_t *dsp);
+static void sb_input_schedule(sb_dsp_t *dsp);
+
 static int sbe2dat[4][9] = {
     {0x01,   -0x02, -0x04, 0x08,  -0x10, 0x20,  0x40,  -0x80, -106},
     { -0x01, 0x02,  -0x04, 0x08,  0x10,  -0x20, 0x40,  -0x80, 165 },
@@ -272,6 +280,7 @@ sb_dsp_reset(sb_dsp_t *dsp)
 
     timer_disable(&dsp->output_timer);
     timer_disable(&dsp->input_timer);
+    dsp->input_on = 0;
 
     dsp->sb_command = 0;
 
@@ -326,6 +335,8 @@ sb_doreset(sb_dsp_t *dsp)
 void
 sb_dsp_speed_changed(sb_dsp_t *dsp)
 {
+    sb_input_sync(dsp);
+
     if (dsp->sb_timeo < 256)
         dsp->sblatcho = TIMER_USEC * (256 - dsp->sb_timeo);
     else
@@ -335,6 +346,8 @@ sb_dsp_speed_changed(sb_dsp_t *dsp)
         dsp->sblatchi = TIMER_USEC * (256 - dsp->sb_timei);
     else
         dsp->sblatchi = (uint64_t) (TIMER_USEC * (1000000.0f / (float) (dsp->sb_timei - 256)));
+
+    sb_input_schedule(dsp);
 }
 
 void
@@ -389,8 +402,7 @@ sb_start_dma_i(sb_dsp_t *dsp, int dma8, int autoinit, uint8_t format, int len)
         if (dsp->sb_16_enable && !dsp->sb_16_output)
             dsp->sb_16_enable = 0;
         dsp->sb_8_output = 0;
-        if (!timer_is_enabled(&dsp->input_timer))
-            timer_set_delay_u64(&dsp->input_timer, dsp->sblatchi);
+        sb_input_start(dsp);
     } else {
         dsp->sb_16_length = dsp->sb_16_origlength = len;
         dsp->sb_16_format                         = format;
@@ -400,8 +412,7 @@ sb_start_dma_i(sb_dsp_t *dsp, int dma8, int autoinit, uint8_t format, int len)
         if (dsp->sb_8_enable && !dsp->sb_8_output)
             dsp->sb_8_enable = 0;
         dsp->sb_16_output = 0;
-        if (!timer_is_enabled(&dsp->input_timer))
-            timer_set_delay_u64(&dsp->input_timer, dsp->sblatchi);
+        sb_input_start(dsp);
     }
 
     memset(dsp->record_buffer, 0, sizeof(dsp->record_buffer));
@@ -696,13 +707,13 @@ sb_exec_command(sb_dsp_t *dsp)
         case 0x20: /* 8-bit direct input */
             sb_add_data(dsp, (dsp->record_buffer[dsp->record_pos_read] >> 8) ^ 0x80);
             /* Due to the current implementation, I need to emulate a samplerate, even if this
-               mode does not imply such samplerate. Position is increased in sb_poll_i(). */
-            if (!timer_is_enabled(&dsp->input_timer)) {
+               mode does not imply such samplerate. Position is increased in sb_input_sample(). */
+            if (!dsp->input_on) {
                 dsp->sb_timei = 256 - 22;
                 dsp->sblatchi = TIMER_USEC * 22;
                 temp          = 1000000 / 22;
                 dsp->sb_freq  = temp;
-                timer_set_delay_u64(&dsp->input_timer, dsp->sblatchi);
+                sb_input_start(dsp);
             }
             break;
         case 0x24: /* 8-bit single cycle DMA input */
@@ -1039,6 +1050,8 @@ sb_write(uint16_t a, uint8_t v, void *priv)
     if (dsp->sb_type < SB16)
         a &= 0xfffe;
 
+    sb_input_sync(dsp);
+
     switch (a & 0xF) {
         case 6: /* Reset */
             if (!dsp->uart_midi) {
@@ -1083,6 +1096,7 @@ sb_write(uint16_t a, uint8_t v, void *priv)
             }
             if (dsp->sb_data_stat == sb_commands[dsp->sb_command] || sb_commands[dsp->sb_command] == -1) {
                 sb_exec_command(dsp);
+                sb_input_schedule(dsp);
                 dsp->sb_data_stat = -1;
                 if (IS_AZTECH(dsp)) {
                     /* variable length commands */
@@ -1107,6 +1121,8 @@ sb_read(uint16_t a, void *priv)
     if (dsp->sb_type < SB16)
         a &= 0xfffe;
 
+    sb_input_sync(dsp);
+
     switch (a & 0xf) {
         case 0xA: /* Read data */
             if (dsp->mpu && dsp->uart_midi) {
@@ -1576,13 +1592,10 @@ pollsb(void *priv)
     }
 }
 
-void
-sb_poll_i(void *priv)
+static void
+sb_input_sample(sb_dsp_t *dsp)
 {
-    sb_dsp_t *dsp       = (sb_dsp_t *) priv;
-    int       processed = 0;
-
-    timer_advance_u64(&dsp->input_timer, dsp->sblatchi);
+    int processed = 0;
 
     if (dsp->sb_8_enable && !dsp->sb_8_pause && dsp->sb_pausetime < 0 && !dsp->sb_8_output) {
         switch (dsp->sb_8_format) {
@@ -1622,7 +1635,7 @@ sb_poll_i(void *priv)
                 dsp->sb_8_length = dsp->sb_8_origlength = dsp->sb_8_autolen;
             else {
                 dsp->sb_8_enable = 0;
-                timer_disable(&dsp->input_timer);
+                dsp->input_on    = 0;
             }
             sb_irq(dsp, 1);
         }
@@ -1670,7 +1683,7 @@ sb_poll_i(void *priv)
                 dsp->sb_16_length = dsp->sb_16_origlength = dsp->sb_16_autolen;
             else {
                 dsp->sb_16_enable = 0;
-                timer_disable(&dsp->input_timer);
+                dsp->input_on     = 0;
             }
             sb_irq(dsp, 0);
         }
@@ -1683,14 +1696,93 @@ sb_poll_i(void *priv)
     }
 }
 
+/*Samples until a recording DMA block ends, or 0 if that channel is not recording*/
+static int
+sb_input_block_left(int enable, int pause, int output, int format, int length)
+{
+    if (!enable || pause || output)
+        return 0;
+    if (length < 0)
+        return 1;
+
+    return ((format & 0x20) ? (length / 2) : length) + 1;
+}
+
+static void
+sb_input_schedule(sb_dsp_t *dsp)
+{
+    int left = SB_DSP_REC_BATCH;
+    int n;
+
+    if (!dsp->input_on) {
+        timer_disable(&dsp->input_timer);
+        return;
+    }
+
+    if (dsp->sb_pausetime < 0) {
+        n = sb_input_block_left(dsp->sb_8_enable, dsp->sb_8_pause, dsp->sb_8_output,
+                                dsp->sb_8_format, dsp->sb_8_length);
+        if (n && (n < left))
+            left = n;
+        n = sb_input_block_left(dsp->sb_16_enable, dsp->sb_16_pause, dsp->sb_16_output,
+                                dsp->sb_16_format, dsp->sb_16_length);
+        if (n && (n < left))
+            left = n;
+    }
+
+    dsp->input_timer.ts.ts64 = dsp->input_ts + ((uint64_t) (left - 1) * (uint64_t) dsp->sblatchi);
+    timer_enable(&dsp->input_timer);
+}
+
+static void
+sb_input_sync(sb_dsp_t *dsp)
+{
+    const uint64_t now   = (uint64_t) (tsc + 1) << 32;
+    const uint64_t latch = (uint64_t) dsp->sblatchi;
+
+    if (!dsp->input_on)
+        return;
+
+    /*Snapshot loads and long pauses move the clock far ahead*/
+    if ((int64_t) (now - dsp->input_ts) > (int64_t) (latch * SB_DSP_REC_SAFEFTY_MARGIN))
+        dsp->input_ts = now - latch;
+
+    while (dsp->input_on && ((int64_t) (now - dsp->input_ts) > 0)) {
+        sb_input_sample(dsp);
+        dsp->input_ts += latch;
+    }
+}
+
+static void
+sb_input_start(sb_dsp_t *dsp)
+{
+    if (dsp->input_on)
+        return;
+
+    dsp->input_on = 1;
+    dsp->input_ts = ((uint64_t) tsc << 32) + (uint64_t) dsp->sblatchi;
+    sb_input_schedule(dsp);
+}
+
+void
+sb_poll_i(void *priv)
+{
+    sb_dsp_t *dsp = (sb_dsp_t *) priv;
+
+    sb_input_sync(dsp);
+    sb_input_schedule(dsp);
+}
+
 void
 sb_dsp_update(sb_dsp_t *dsp)
 {
+    const int sound_pos = sound_pos_get();
+
     if (dsp->muted) {
         dsp->sbdatl = 0;
         dsp->sbdatr = 0;
     }
-    for (; dsp->pos < sound_pos_global; dsp->pos++) {
+    for (; dsp->pos < sound_pos; dsp->pos++) {
         dsp->buffer[dsp->pos * 2]     = dsp->sbdatl;
         dsp->buffer[dsp->pos * 2 + 1] = dsp->sbdatr;
     }
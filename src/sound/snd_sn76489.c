@@ -2,7 +2,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 #include <wchar.h>
 
 #include <86box/86box.h>
@@ -24,7 +23,9 @@ static float volslog[16] = {
 void
 sn76489_update(sn76489_t *sn76489)
 {
-    for (; sn76489->pos < sound_pos_global; sn76489->pos++) {
+    const int sound_pos = sound_pos_get();
+
+    for (; sn76489->pos < sound_pos; sn76489->pos++) {
         int16_t result = 0;
 
         for (uint8_t c = 1; c < 4; c++) {
@@ -185,7 +186,6 @@ sn76489_init(sn76489_t *sn76489, uint16_t base, uint16_t size, int type, int fre
     sn76489->vol[0]                                                               = 0;
     sn76489->vol[1] = sn76489->vol[2] = sn76489->vol[3] = 8;
     sn76489->stat[0] = sn76489->stat[1] = sn76489->stat[2] = sn76489->stat[3] = 127;
-    srand(time(NULL));
     sn76489->count[0] = 0;
     sn76489->count[1] = (rand() & 0x3FF) << 6;
     sn76489->count[2] = (rand() & 0x3FF) << 6;
@@ -53,16 +53,17 @@ speaker_set_count(uint8_t new_m, int new_count)
 void
 speaker_update(void)
 {
-    int32_t val;
-    double  amplitude;
+    const int sound_pos = sound_pos_get();
+    int32_t   val;
+    double    amplitude;
 
     amplitude = ((speaker_count / 64.0) * 10240.0) - 5120.0;
 
     if (amplitude > 5120.0)
         amplitude = 5120.0;
 
-    if (speaker_pos < sound_pos_global) {
-        for (; speaker_pos < sound_pos_global; speaker_pos++) {
+    if (speaker_pos < sound_pos) {
+        for (; speaker_pos < sound_pos; speaker_pos++) {
             if (speaker_gated && was_speaker_enable) {
                 if ((speaker_mode == 0) || (speaker_mode == 4))
                     val = (int32_t) amplitude;
@@ -24,11 +24,13 @@ typedef struct ssi2001_t {
 static void
 ssi2001_update(ssi2001_t *ssi2001)
 {
-    if (ssi2001->pos >= sound_pos_global)
+    const int sound_pos = sound_pos_get();
+
+    if (ssi2001->pos >= sound_pos)
         return;
 
-    sid_fillbuf(&ssi2001->buffer[ssi2001->pos], sound_pos_global - ssi2001->pos, ssi2001->psid);
-    ssi2001->pos = sound_pos_global;
+    sid_fillbuf(&ssi2001->buffer[ssi2001->pos], sound_pos - ssi2001->pos, ssi2001->psid);
+    ssi2001->pos = sound_pos;
 }
 
 static void
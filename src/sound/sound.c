@@ -41,6 +41,8 @@
 #include <86box/sound.h>
 #include <86box/snd_opl.h>
 #include <86box/snd_sb_dsp.h>
+#include <86box/machine_counters.h>
+#include <minitrace/minitrace.h>
 
 typedef struct {
     const device_t *device;
@@ -52,9 +54,10 @@ typedef struct {
 } sound_handler_t;
 
 int sound_card_current[SOUND_CARD_MAX] = { 0, 0, 0, 0 };
-int sound_pos_global                   = 0;
 int sound_gain                         = 0;
 
+uint64_t sound_buffer_count = 0;
+
 static sound_handler_t sound_handlers[8];
 
 static thread_t  *sound_cd_thread_h;
@@ -66,6 +69,20 @@ static int16_t   *outbuffer_ex_int16;
 static int        sound_handlers_num;
 static pc_timer_t sound_poll_timer;
 static uint64_t   sound_poll_latch;
+static int        sound_buf_running;
+static int        sound_buf_full;
+
+/* Fast-forward output: buffers go out at the rate the host plays them. */
+#define SOUND_FF_FADE 64
+typedef struct sound_ff_t {
+    int      active;
+    int      last_out; /* whether the previous buffer went out */
+    uint32_t next;     /* when the next buffer is due */
+    uint32_t buf_ms;   /* how long a buffer plays for */
+} sound_ff_t;
+static sound_ff_t sound_ff    = { .buf_ms = (SOUNDBUFLEN * 1000) / SOUND_FREQ };
+static sound_ff_t sound_ff_cd = { .buf_ms = (CD_BUFLEN * 1000) / CD_FREQ }; /* CD audio thread only */
+static int32_t    sound_ff_cont[SOUND_FF_FADE * 2];
 
 static int16_t      cd_buffer[CDROM_NUM][CD_BUFLEN * 2];
 static float        cd_out_buffer[CD_BUFLEN * 2];
@@ -251,17 +268,89 @@ sound_cd_clean_buffers(void)
         memset(cd_out_buffer_int16, 0, (CD_BUFLEN * 2) * sizeof(int16_t));
 }
 
+/* While fast-forwarding, buffers are produced faster than the host plays
+   them. Only as many go out as the host plays in real time and the rest are
+   dropped, which shortens the audio without changing its pitch. */
+static int
+sound_ff_due(sound_ff_t *ff)
+{
+    uint32_t now = plat_get_ticks();
+
+    if (!ff->active) {
+        ff->active   = 1;
+        ff->last_out = 1;
+        ff->next     = now;
+    }
+
+    if ((int32_t) (now - ff->next) < 0) {
+        ff->last_out = 0;
+        return 0;
+    }
+
+    /* After a stall, start over rather than send out a burst. */
+    if ((now - ff->next) > (ff->buf_ms * 4))
+        ff->next = now;
+    ff->next += ff->buf_ms;
+
+    ff->last_out = 1;
+    return 1;
+}
+
+/* To keep the splice from clicking, a buffer following dropped ones is
+   crossfaded in from the start of the one that followed the previous
+   buffer to go out. */
+static int
+sound_ff_filter(int32_t *buf)
+{
+    int    spliced = sound_ff.active && !sound_ff.last_out;
+    double a;
+
+    if (!spliced)
+        memcpy(sound_ff_cont, buf, sizeof(sound_ff_cont));
+
+    if (!sound_ff_due(&sound_ff))
+        return 0;
+
+    if (spliced) {
+        for (int c = 0; c < SOUND_FF_FADE; c++) {
+            a                = (double) (c + 1) / (double) (SOUND_FF_FADE + 1);
+            buf[c * 2]       = (int32_t) ((sound_ff_cont[c * 2] * (1.0 - a)) + (buf[c * 2] * a));
+            buf[(c * 2) + 1] = (int32_t) ((sound_ff_cont[(c * 2) + 1] * (1.0 - a)) + (buf[(c * 2) + 1] * a));
+        }
+    }
+
+    return 1;
+}
+
+/* There is nothing to crossfade a CD buffer with, so one that follows dropped
+   ones fades in from silence instead. */
+static void
+sound_cd_fade_in(void)
+{
+    double a;
+
+    for (int c = 0; c < SOUND_FF_FADE * 2; c++) {
+        a = (double) ((c >> 1) + 1) / (double) (SOUND_FF_FADE + 1);
+        if (sound_is_float)
+            cd_out_buffer[c] = (float) (cd_out_buffer[c] * a);
+        else
+            cd_out_buffer_int16[c] = (int16_t) (cd_out_buffer_int16[c] * a);
+    }
+}
+
 static void
 sound_cd_thread(UNUSED(void *param))
 {
     uint32_t lba;
     int      r;
     int      pre;
+    int      spliced;
     int      channel_select[2];
     double   audio_vol_l;
     double   audio_vol_r;
     double   cd_buffer_temp[2] = { 0.0, 0.0 };
 
+    MTR_META_THREAD_NAME("CD audio");
     thread_set_event(sound_cd_start_event);
 
     while (cdaudioon) {
@@ -271,6 +360,7 @@ sound_cd_thread(UNUSED(void *param))
         if (!cdaudioon)
             return;
 
+        MTR_BEGIN("sound", "cd_buffer");
         sound_cd_clean_buffers();
 
         for (uint8_t i = 0; i < CDROM_NUM; i++) {
@@ -366,10 +456,25 @@ sound_cd_thread(UNUSED(void *param))
             }
         }
 
+        /* Thinned out like the rest of the sound while fast-forwarding. The
+           drive still has to be read from above, to keep its position. */
+        if (!fast_forward)
+            sound_ff_cd.active = 0;
+        else {
+            spliced = sound_ff_cd.active && !sound_ff_cd.last_out;
+            if (!sound_ff_due(&sound_ff_cd)) {
+                MTR_END("sound", "cd_buffer");
+                continue;
+            }
+            if (spliced)
+                sound_cd_fade_in();
+        }
+
         if (sound_is_float)
             givealbuffer_cd(cd_out_buffer);
         else
             givealbuffer_cd(cd_out_buffer_int16);
+        MTR_END("sound", "cd_buffer");
     }
 }
 
@@ -456,40 +561,108 @@ sound_set_pc_speaker_filter(void (*filter)(int channel, double *buffer, void *pr
     }
 }
 
+/* Position within the current buffer of the emulated time ts (32:32 format),
+   for devices that render samples lazily and need to place each one at the
+   time it would have been produced. */
+int
+sound_pos_at(uint64_t ts)
+{
+    int64_t  remaining;
+    uint64_t buf_len;
+    int      pos;
+
+    if (!sound_buf_running || !sound_poll_latch)
+        return 0;
+
+    /* The tick timestamp still marks the end of this buffer while the tick
+       itself is running, so this also holds inside get_buffer(). */
+
+    buf_len   = sound_poll_latch * SOUNDBUFLEN;
+    remaining = (int64_t) (sound_poll_timer.ts.ts64 - ts);
+    if (remaining <= 0)
+        return SOUNDBUFLEN;
+    if ((uint64_t) remaining >= buf_len)
+        return 0;
+
+    pos = (int) ((buf_len - remaining) / sound_poll_latch);
+    if (pos > SOUNDBUFLEN)
+        pos = SOUNDBUFLEN;
+
+    return pos;
+}
+
+/* The mixer timer fires once per buffer; the position within the current
+   buffer is derived from how far the emulated clock has run towards the
+   next tick, so devices can catch up on demand without a per-sample tick. */
+int
+sound_pos_get(void)
+{
+    uint64_t remaining;
+    uint64_t buf_len;
+    int      pos;
+
+    if (sound_buf_full)
+        return SOUNDBUFLEN;
+
+    if (!sound_buf_running || !sound_poll_latch)
+        return 0;
+
+    buf_len   = sound_poll_latch * SOUNDBUFLEN;
+    remaining = timer_get_remaining_u64(&sound_poll_timer);
+    if (remaining >= buf_len)
+        return 0;
+
+    pos = (int) ((buf_len - remaining) / sound_poll_latch);
+    if (pos > SOUNDBUFLEN)
+        pos = SOUNDBUFLEN;
+
+    return pos;
+}
+
 void
 sound_poll(UNUSED(void *priv))
 {
-    timer_advance_u64(&sound_poll_timer, sound_poll_latch);
+    if (sound_buf_running) {
+        uint64_t start = plat_get_nano_ticks();
+        int      c;
 
-    midi_poll();
-
-    sound_pos_global++;
-    if (sound_pos_global == SOUNDBUFLEN) {
-        int c;
+        MTR_BEGIN("sound", "sound_poll");
+        for (c = 0; c < SOUNDBUFLEN; c++)
+            midi_poll();
 
         memset(outbuffer, 0x00, SOUNDBUFLEN * 2 * sizeof(int32_t));
 
+        /* Devices render whatever they have not caught up on yet up to the
+           end of the buffer. */
+        sound_buf_full = 1;
         for (c = 0; c < sound_handlers_num; c++)
             sound_handlers[c].get_buffer(outbuffer, SOUNDBUFLEN, sound_handlers[c].priv);
+        sound_buf_full = 0;
+        sound_buffer_count++;
+
+        if (!fast_forward)
+            sound_ff.active = 0;
+
+        if (!fast_forward || sound_ff_filter(outbuffer)) {
+            for (c = 0; c < SOUNDBUFLEN * 2; c++) {
+                if (sound_is_float)
+                    outbuffer_ex[c] = ((float) outbuffer[c]) / (float) 32768.0;
+                else {
+                    if (outbuffer[c] > 32767)
+                        outbuffer[c] = 32767;
+                    if (outbuffer[c] < -32768)
+                        outbuffer[c] = -32768;
+
+                    outbuffer_ex_int16[c] = outbuffer[c];
+                }
+            }
 
-        for (c = 0; c < SOUNDBUFLEN * 2; c++) {
             if (sound_is_float)
-                outbuffer_ex[c] = ((float) outbuffer[c]) / (float) 32768.0;
-            else {
-                if (outbuffer[c] > 32767)
-                    outbuffer[c] = 32767;
-                if (outbuffer[c] < -32768)
-                    outbuffer[c] = -32768;
-
-                outbuffer_ex_int16[c] = outbuffer[c];
-            }
+                givealbuffer(outbuffer_ex);
+            else
+                givealbuffer(outbuffer_ex_int16);
         }
 
-        if (sound_is_float)
-            givealbuffer(outbuffer_ex);
-        else
-            givealbuffer(outbuffer_ex_int16);
-
         if (cd_thread_enable) {
             cd_buf_update--;
             if (!cd_buf_update) {
@@ -497,15 +670,24 @@ sound_poll(UNUSED(void *priv))
                 thread_set_event(sound_cd_event);
             }
         }
-
-        sound_pos_global = 0;
+        MTR_END("sound", "sound_poll");
+        machine_counters.audio_ns += plat_get_nano_ticks() - start;
     }
+
+    sound_buf_running = 1;
+    timer_advance_u64(&sound_poll_timer, sound_poll_latch * SOUNDBUFLEN);
 }
 
 void
 sound_speed_changed(void)
 {
+    int pos = sound_pos_get();
+
     sound_poll_latch = (uint64_t) ((double) TIMER_USEC * (1000000.0 / (double) SOUND_FREQ));
+
+    /* Keep the position within the current buffer across the change. */
+    if (sound_buf_running && timer_is_enabled(&sound_poll_timer))
+        timer_set_delay_u64(&sound_poll_timer, (SOUNDBUFLEN - pos) * sound_poll_latch);
 }
 
 void
@@ -518,6 +700,8 @@ sound_reset(void)
 
     inital();
 
+    sound_buf_running = 0;
+    sound_buf_full    = 0;
     timer_add(&sound_poll_timer, sound_poll, NULL, 1);
 
     sound_handlers_num = 0;
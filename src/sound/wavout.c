@@ -0,0 +1,159 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Sound output to a WAV file, for builds without an audio
+ *          device such as the headless front end.
+ *
+ *          Nothing is written until wavout_start() is called. Only the
+ *          main mixer output is captured, CD audio and external MIDI
+ *          synthesizers play at their own rates and are dropped.
+ *
+ *
+ *
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <86box/86box.h>
+#include <86box/plat.h>
+#include <86box/sound.h>
+#include <86box/thread.h>
+#include <86box/plat_unused.h>
+
+/* The RIFF size, which counts 36 bytes of header too, has to fit in 32 bits. */
+#define WAV_DATA_MAX (UINT32_MAX - 36)
+
+static mutex_t *wav_mutex = NULL;
+static FILE    *wav_fp    = NULL;
+static uint32_t wav_bytes;
+
+static void
+wav_put_u16(uint8_t *p, uint16_t val)
+{
+    p[0] = val & 0xff;
+    p[1] = val >> 8;
+}
+
+static void
+wav_put_u32(uint8_t *p, uint32_t val)
+{
+    wav_put_u16(p, val & 0xffff);
+    wav_put_u16(p + 2, val >> 16);
+}
+
+static void
+wav_write_header(FILE *fp, uint32_t data_len)
+{
+    uint8_t  hdr[44];
+    uint16_t bits = sound_is_float ? 32 : 16;
+
+    memcpy(hdr, "RIFF", 4);
+    wav_put_u32(&hdr[4], 36 + data_len);
+    memcpy(&hdr[8], "WAVEfmt ", 8);
+    wav_put_u32(&hdr[16], 16);
+    wav_put_u16(&hdr[20], sound_is_float ? 3 : 1); /* IEEE float or PCM */
+    wav_put_u16(&hdr[22], 2);
+    wav_put_u32(&hdr[24], SOUND_FREQ);
+    wav_put_u32(&hdr[28], SOUND_FREQ * 2 * (bits >> 3));
+    wav_put_u16(&hdr[32], 2 * (bits >> 3));
+    wav_put_u16(&hdr[34], bits);
+    memcpy(&hdr[36], "data", 4);
+    wav_put_u32(&hdr[40], data_len);
+
+    fseek(fp, 0, SEEK_SET);
+    fwrite(hdr, 1, sizeof(hdr), fp);
+    fseek(fp, 0, SEEK_END);
+}
+
+int
+wavout_start(const char *fn)
+{
+    FILE *fp;
+
+    inital();
+    wavout_stop();
+
+    fp = plat_fopen(fn, "wb");
+    if (fp == NULL)
+        return 0;
+
+    wav_write_header(fp, 0);
+
+    thread_wait_mutex(wav_mutex);
+    wav_bytes = 0;
+    wav_fp    = fp;
+    thread_release_mutex(wav_mutex);
+
+    return 1;
+}
+
+void
+wavout_stop(void)
+{
+    FILE *fp;
+
+    if (wav_mutex == NULL)
+        return;
+
+    thread_wait_mutex(wav_mutex);
+    fp     = wav_fp;
+    wav_fp = NULL;
+    thread_release_mutex(wav_mutex);
+
+    if (fp != NULL) {
+        wav_write_header(fp, wav_bytes);
+        fclose(fp);
+    }
+}
+
+void
+al_set_midi(UNUSED(int freq), UNUSED(int buf_size))
+{
+    /* No-op. */
+}
+
+void
+closeal(void)
+{
+    wavout_stop();
+}
+
+void
+inital(void)
+{
+    if (wav_mutex == NULL)
+        wav_mutex = thread_create_mutex();
+}
+
+void
+givealbuffer(void *buf)
+{
+    uint32_t len = (SOUNDBUFLEN << 1) * (sound_is_float ? sizeof(float) : sizeof(int16_t));
+
+    if (wav_fp == NULL)
+        return;
+
+    thread_wait_mutex(wav_mutex);
+    /* Stop short of the 4 GB limit of the format, RIFF size included. */
+    if ((wav_fp != NULL) && (len <= (WAV_DATA_MAX - wav_bytes)) && (fwrite(buf, 1, len, wav_fp) == len))
+        wav_bytes += len;
+    thread_release_mutex(wav_mutex);
+}
+
+void
+givealbuffer_cd(UNUSED(void *buf))
+{
+    /* No-op. */
+}
+
+void
+givealbuffer_midi(UNUSED(void *buf), UNUSED(uint32_t size))
+{
+    /* No-op. */
+}
@@ -1,87 +1,148 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <wchar.h>
 #include <86box/86box.h>
 #include <86box/timer.h>
+#include <86box/plat.h>
+#include <86box/machine_counters.h>
+#include <minitrace/minitrace.h>
 
 uint64_t TIMER_USEC;
 uint32_t timer_target;
 
-/*Enabled timers are stored in a linked list, with the first timer to expire at
-  the head.*/
-pc_timer_t *timer_head = NULL;
+/*Enabled timers are stored in a 4-ary min-heap, with the first timer to expire
+  at the root. Timers with equal timestamps expire in the reverse order of being
+  enabled, which is the order the old sorted linked list gave them.*/
+#define TIMER_HEAP_ARITY 4
+
+static pc_timer_t **timer_heap       = NULL;
+static int          timer_heap_size  = 0;
+static int          timer_heap_alloc = 0;
+static uint64_t     timer_seq        = 0;
 
 /* Are we initialized? */
 int timer_inited = 0;
 
 static void timer_advance_ex(pc_timer_t *timer, int start);
 
+/*True if timer a has to expire before timer b*/
+static __inline int
+timer_heap_before(pc_timer_t *a, pc_timer_t *b)
+{
+    int64_t diff = (int64_t) (a->ts.ts64 - b->ts.ts64);
+
+    if (diff != 0)
+        return diff < 0;
+
+    return a->seq > b->seq;
+}
+
+static __inline void
+timer_heap_set(int pos, pc_timer_t *timer)
+{
+    timer_heap[pos]  = timer;
+    timer->heap_pos = pos;
+}
+
+static void
+timer_heap_sift_up(int pos)
+{
+    pc_timer_t *timer = timer_heap[pos];
+    int         parent;
+
+    while (pos > 0) {
+        parent = (pos - 1) / TIMER_HEAP_ARITY;
+        if (!timer_heap_before(timer, timer_heap[parent]))
+            break;
+        timer_heap_set(pos, timer_heap[parent]);
+        pos = parent;
+    }
+
+    timer_heap_set(pos, timer);
+}
+
+static void
+timer_heap_sift_down(int pos)
+{
+    pc_timer_t *timer = timer_heap[pos];
+    int         child;
+    int         best;
+    int         last;
+
+    while (1) {
+        child = (pos * TIMER_HEAP_ARITY) + 1;
+        if (child >= timer_heap_size)
+            break;
+
+        best = child;
+        last = child + TIMER_HEAP_ARITY;
+        if (last > timer_heap_size)
+            last = timer_heap_size;
+        for (child++; child < last; child++) {
+            if (timer_heap_before(timer_heap[child], timer_heap[best]))
+                best = child;
+        }
+
+        if (!timer_heap_before(timer_heap[best], timer))
+            break;
+        timer_heap_set(pos, timer_heap[best]);
+        pos = best;
+    }
+
+    timer_heap_set(pos, timer);
+}
+
+static void
+timer_heap_remove(pc_timer_t *timer)
+{
+    int         pos  = timer->heap_pos;
+    pc_timer_t *last = timer_heap[--timer_heap_size];
+
+    if (last != timer) {
+        timer_heap_set(pos, last);
+        if ((pos > 0) && timer_heap_before(last, timer_heap[(pos - 1) / TIMER_HEAP_ARITY]))
+            timer_heap_sift_up(pos);
+        else
+            timer_heap_sift_down(pos);
+    }
+
+    timer_heap[timer_heap_size] = NULL;
+}
+
 void
 timer_enable(pc_timer_t *timer)
 {
-    pc_timer_t *timer_node = timer_head;
-    int ret = 0;
-
     if (!timer_inited || (timer == NULL))
         return;
 
-    if (timer->flags & TIMER_ENABLED)
-        timer_disable(timer);
-
-    if (timer->next || timer->prev)
-        fatal("timer_enable - timer->next\n");
-
-    /*List currently empty - add to head*/
-    if (!timer_head) {
-        timer_head  = timer;
-        timer->next = timer->prev = NULL;
-        timer_target              = timer_head->ts.ts32.integer;
-        ret = 1;
-    } else if (TIMER_LESS_THAN(timer, timer_head)) {
-        timer->next      = timer_head;
-        timer->prev      = NULL;
-        timer_head->prev = timer;
-        timer_head       = timer;
-        timer_target     = timer_head->ts.ts32.integer;
-        ret = 1;
-    } else if (!timer_head->next) {
-        timer_head->next = timer;
-        timer->prev      = timer_head;
-        ret = 1;
-    }
+    timer->seq = ++timer_seq;
 
-    if (ret == 0) {
-        pc_timer_t *prev = timer_head;
-        timer_node       = timer_head->next;
-
-        while (1) {
-            /*Timer expires before timer_node. Add to list in front of timer_node*/
-            if (TIMER_LESS_THAN(timer, timer_node)) {
-                timer->next      = timer_node;
-                timer->prev      = prev;
-                timer_node->prev = timer;
-                prev->next       = timer;
-                ret = 1;
-                break;
-            }
-
-            /*timer_node is last in the list. Add timer to end of list*/
-            if (!timer_node->next) {
-                timer_node->next = timer;
-                timer->prev      = timer_node;
-                ret = 1;
-                break;
-            }
-
-            prev       = timer_node;
-            timer_node = timer_node->next;
+    if (timer->flags & TIMER_ENABLED) {
+        /*Already queued - just move it to its new place*/
+        if ((timer->heap_pos >= timer_heap_size) || (timer_heap[timer->heap_pos] != timer))
+            fatal("timer_enable - timer not in heap\n");
+
+        if ((timer->heap_pos > 0) && timer_heap_before(timer, timer_heap[(timer->heap_pos - 1) / TIMER_HEAP_ARITY]))
+            timer_heap_sift_up(timer->heap_pos);
+        else
+            timer_heap_sift_down(timer->heap_pos);
+    } else {
+        if (timer_heap_size == timer_heap_alloc) {
+            timer_heap_alloc = timer_heap_alloc ? (timer_heap_alloc << 1) : 64;
+            timer_heap       = (pc_timer_t **) realloc(timer_heap, timer_heap_alloc * sizeof(pc_timer_t *));
+            if (timer_heap == NULL)
+                fatal("timer_enable - out of memory\n");
         }
-    }
 
-    /* Do not mark it as enabled if it has failed every single condition. */
-    if (ret == 1)
+        timer_heap_set(timer_heap_size++, timer);
+        timer_heap_sift_up(timer->heap_pos);
+
         timer->flags |= TIMER_ENABLED;
+    }
+
+    timer_target = timer_heap[0]->ts.ts32.integer;
 }
 
 void
@@ -90,69 +151,78 @@ timer_disable(pc_timer_t *timer)
     if (!timer_inited || (timer == NULL) || !(timer->flags & TIMER_ENABLED))
         return;
 
-    if (!timer->next && !timer->prev && timer != timer_head)
-        fatal("timer_disable - !timer->next\n");
+    if ((timer->heap_pos >= timer_heap_size) || (timer_heap[timer->heap_pos] != timer))
+        fatal("timer_disable - timer not in heap\n");
 
     timer->flags &= ~TIMER_ENABLED;
 
-    if (timer->prev)
-        timer->prev->next = timer->next;
-    else
-        timer_head = timer->next;
-    if (timer->next)
-        timer->next->prev = timer->prev;
-    timer->prev = timer->next = NULL;
+    timer_heap_remove(timer);
 }
 
 void
 timer_process(void)
 {
     pc_timer_t *timer;
+    uint64_t    start = 0;
 
-    if (!timer_head)
+    if (!timer_heap_size)
         return;
 
-    while (1) {
-        timer = timer_head;
+    if (machine_counters_timers)
+        start = plat_get_nano_ticks();
+
+    while (timer_heap_size) {
+        timer = timer_heap[0];
 
         if (!TIMER_LESS_THAN_VAL(timer, (uint32_t) tsc))
             break;
 
-        timer_head = timer->next;
-        if (timer_head)
-            timer_head->prev = NULL;
-
-        timer->next = timer->prev = NULL;
+        timer_heap_remove(timer);
         timer->flags &= ~TIMER_ENABLED;
 
         if (timer->flags & TIMER_SPLIT)
             timer_advance_ex(timer, 0);   /* We're splitting a > 1 s period into
                                              multiple <= 1 s periods. */
-        else if (timer->callback != NULL) /* Make sure it's not NULL, so that we can
-                                             have a NULL callback when no operation
-                                             is needed. */
+        else if (timer->callback != NULL) { /* Make sure it's not NULL, so that we can
+                                               have a NULL callback when no operation
+                                               is needed. */
+            MTR_BEGIN("timer", timer->name);
             timer->callback(timer->priv);
+            MTR_END("timer", timer->name);
+            machine_counters.timer_calls++;
+        }
     }
 
-    timer_target = timer_head->ts.ts32.integer;
+    if (start)
+        machine_counters.timer_ns += plat_get_nano_ticks() - start;
+
+    if (timer_heap_size)
+        timer_target = timer_heap[0]->ts.ts32.integer;
 }
 
 void
-timer_close(void)
+timer_shift(uint64_t delta)
 {
-    pc_timer_t *t = timer_head;
-    pc_timer_t *r;
+    /* Moving every timer by the same amount keeps the heap ordered. */
+    for (int i = 0; i < timer_heap_size; i++)
+        timer_heap[i]->ts.ts64 += delta;
+
+    if (timer_heap_size)
+        timer_target = timer_heap[0]->ts.ts32.integer;
+}
 
-    /* Set all timers' prev and next to NULL so it is assured that
-       timers that are not in malloc'd structs don't keep pointing
-       to timers that may be in malloc'd structs. */
-    while (t != NULL) {
-        r       = t;
-        r->prev = r->next = NULL;
-        t                 = r->next;
+void
+timer_close(void)
+{
+    /* Mark all queued timers as disabled so it is assured that timers that
+       are not in malloc'd structs don't think they are still in the heap. */
+    for (int i = 0; i < timer_heap_size; i++) {
+        timer_heap[i]->flags &= ~TIMER_ENABLED;
+        timer_heap[i] = NULL;
     }
 
-    timer_head = NULL;
+    timer_heap_size = 0;
+    timer_seq       = 0;
 
     timer_inited = 0;
 }
@@ -167,18 +237,29 @@ timer_init(void)
 }
 
 void
-timer_add(pc_timer_t *timer, void (*callback)(void *priv), void *priv, int start_timer)
+(timer_add)(pc_timer_t *timer, void (*callback)(void *priv), void *priv, int start_timer)
 {
     memset(timer, 0, sizeof(pc_timer_t));
 
     timer->callback = callback;
     timer->priv     = priv;
     timer->flags    = 0;
-    timer->prev = timer->next = NULL;
+#ifdef MTR_ENABLED
+    timer->name = "timer";
+#endif
     if (start_timer)
         timer_set_delay_u64(timer, 0);
 }
 
+#ifdef MTR_ENABLED
+void
+timer_add_named(pc_timer_t *timer, void (*callback)(void *priv), void *priv, int start_timer, const char *name)
+{
+    (timer_add)(timer, callback, priv, start_timer);
+    timer->name = name;
+}
+#endif
+
 /* The API for big timer periods starts here. */
 void
 timer_stop(pc_timer_t *timer)
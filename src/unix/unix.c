@@ -44,6 +44,9 @@
 #include <86box/video.h>
 #include <86box/ui.h>
 #include <86box/gdbstub.h>
+#include <86box/replay.h>
+#include <86box/pacer.h>
+#include <86box/bench.h>
 
 #define __USE_GNU 1 /* shouldn't be done, yet it is */
 #include <pthread.h>
@@ -190,59 +193,6 @@ typedef struct sdl_blit_params {
 sdl_blit_params params  = { 0, 0, 0, 0 };
 int             blitreq = 0;
 
-void *
-dynld_module(const char *name, dllimp_t *table)
-{
-    dllimp_t *imp;
-    void     *modhandle = dlopen(name, RTLD_LAZY | RTLD_GLOBAL);
-
-    if (modhandle) {
-        for (imp = table; imp->name != NULL; imp++) {
-            if ((*(void **) imp->func = dlsym(modhandle, imp->name)) == NULL) {
-                dlclose(modhandle);
-                return NULL;
-            }
-        }
-    }
-
-    return modhandle;
-}
-
-void
-plat_tempfile(char *bufp, char *prefix, char *suffix)
-{
-    struct tm     *calendertime;
-    struct timeval t;
-    time_t         curtime;
-
-    if (prefix != NULL)
-        sprintf(bufp, "%s-", prefix);
-    else
-        strcpy(bufp, "");
-    gettimeofday(&t, NULL);
-    curtime      = time(NULL);
-    calendertime = localtime(&curtime);
-    sprintf(&bufp[strlen(bufp)], "%d%02d%02d-%02d%02d%02d-%03ld%s", calendertime->tm_year, calendertime->tm_mon, calendertime->tm_mday, calendertime->tm_hour, calendertime->tm_min, calendertime->tm_sec, t.tv_usec / 1000, suffix);
-}
-
-int
-plat_getcwd(char *bufp, int max)
-{
-    return getcwd(bufp, max) != 0;
-}
-
-int
-plat_chdir(char *str)
-{
-    return chdir(str);
-}
-
-void
-dynld_close(void *handle)
-{
-    dlclose(handle);
-}
-
 wchar_t *
 plat_get_string(int i)
 {
@@ -283,145 +233,6 @@ plat_get_string(int i)
     return L"";
 }
 
-FILE *
-plat_fopen(const char *path, const char *mode)
-{
-    return fopen(path, mode);
-}
-
-FILE *
-plat_fopen64(const char *path, const char *mode)
-{
-    return fopen(path, mode);
-}
-
-int
-path_abs(char *path)
-{
-    return path[0] == '/';
-}
-
-void
-path_normalize(char *path)
-{
-    /* No-op. */
-}
-
-void
-path_slash(char *path)
-{
-    if (path[strlen(path) - 1] != '/') {
-        strcat(path, "/");
-    }
-    path_normalize(path);
-}
-
-const char *
-path_get_slash(char *path)
-{
-    char *ret = "";
-
-    if (path[strlen(path) - 1] != '/')
-        ret =  "/";
-
-    return ret;
-}
-
-void
-plat_put_backslash(char *s)
-{
-    int c = strlen(s) - 1;
-
-    if (s[c] != '/')
-        s[c] = '/';
-}
-
-/* Return the last element of a pathname. */
-char *
-plat_get_basename(const char *path)
-{
-    int c = (int) strlen(path);
-
-    while (c > 0) {
-        if (path[c] == '/')
-            return ((char *) &path[c + 1]);
-        c--;
-    }
-
-    return ((char *) path);
-}
-char *
-path_get_filename(char *s)
-{
-    int c = strlen(s) - 1;
-
-    while (c > 0) {
-        if (s[c] == '/' || s[c] == '\\')
-            return (&s[c + 1]);
-        c--;
-    }
-
-    return s;
-}
-
-char *
-path_get_extension(char *s)
-{
-    int c = strlen(s) - 1;
-
-    if (c <= 0)
-        return s;
-
-    while (c && s[c] != '.')
-        c--;
-
-    if (!c)
-        return (&s[strlen(s)]);
-
-    return (&s[c + 1]);
-}
-
-void
-path_append_filename(char *dest, const char *s1, const char *s2)
-{
-    strcpy(dest, s1);
-    path_slash(dest);
-    strcat(dest, s2);
-}
-
-int
-plat_dir_check(char *path)
-{
-    struct stat dummy;
-    if (stat(path, &dummy) < 0) {
-        return 0;
-    }
-    return S_ISDIR(dummy.st_mode);
-}
-
-int
-plat_dir_create(char *path)
-{
-    return mkdir(path, S_IRWXU);
-}
-
-void *
-plat_mmap(size_t size, uint8_t executable)
-{
-#if defined __APPLE__ && defined MAP_JIT
-    void *ret = mmap(0, size, PROT_READ | PROT_WRITE | (executable ? PROT_EXEC : 0), MAP_ANON | MAP_PRIVATE | (executable ? MAP_JIT : 0), -1, 0);
-#else
-    void *ret = mmap(0, size, PROT_READ | PROT_WRITE | (executable ? PROT_EXEC : 0), MAP_ANON | MAP_PRIVATE, -1, 0);
-#endif
-    return (ret < 0) ? NULL : ret;
-}
-
-void
-plat_munmap(void *ptr, size_t size)
-{
-    munmap(ptr, size);
-}
-
 uint64_t
 plat_timer_read(void)
 {
@@ -457,22 +268,20 @@ plat_get_micro_ticks(void)
     return (uint32_t) plat_get_ticks_common();
 }
 
-void
-plat_remove(char *path)
+uint64_t
+plat_get_nano_ticks(void)
 {
-    remove(path);
-}
+    uint64_t elapsed;
 
-void
-ui_sb_update_icon_state(int tag, int state)
-{
-    /* No-op. */
-}
+    if (first_use) {
+        Frequency    = SDL_GetPerformanceFrequency();
+        StartingTime = SDL_GetPerformanceCounter();
+        first_use    = 0;
+    }
+    elapsed = SDL_GetPerformanceCounter() - StartingTime;
 
-void
-ui_sb_update_icon(int tag, int active)
-{
-    /* No-op. */
+    /* Split up so the multiplication cannot overflow. */
+    return ((elapsed / Frequency) * 1000000000ULL) + (((elapsed % Frequency) * 1000000000ULL) / Frequency);
 }
 
 void
@@ -481,92 +290,30 @@ plat_delay_ms(uint32_t count)
     SDL_Delay(count);
 }
 
-void
-ui_sb_update_tip(int arg)
-{
-    /* No-op. */
-}
-
-void
-ui_sb_update_panes(void)
-{
-    /* No-op. */
-}
-
-void
-ui_sb_update_text(void)
-{
-    /* No-op. */
-}
-
-void
-path_get_dirname(char *dest, const char *path)
-{
-    int   c = (int) strlen(path);
-    char *ptr = (char *) path;
-
-    while (c > 0) {
-        if (path[c] == '/' || path[c] == '\\') {
-            ptr = (char *) &path[c];
-            break;
-        }
-        c--;
-    }
-
-    /* Copy to destination. */
-    while (path < ptr)
-        *dest++ = *path++;
-    *dest = '\0';
-}
 volatile int cpu_thread_run = 1;
-void
-ui_sb_set_text_w(wchar_t *wstr)
-{
-    /* No-op. */
-}
-
-int
-stricmp(const char *s1, const char *s2)
-{
-    return strcasecmp(s1, s2);
-}
-
-int
-strnicmp(const char *s1, const char *s2, size_t n)
-{
-    return strncasecmp(s1, s2, n);
-}
-
 void
 main_thread(void *param)
 {
-    uint32_t old_time;
-    uint32_t new_time;
-    int      drawits;
-    int      frames;
+    int frames;
+    int free_run;
 
     SDL_SetThreadPriority(SDL_THREAD_PRIORITY_HIGH);
     framecountx = 0;
     // title_update = 1;
-    old_time = SDL_GetTicks();
-    drawits = frames = 0;
+    frames = 0;
+    pacer_init(PACER_SLICE_NS);
     while (!is_quit && cpu_thread_run) {
-        /* See if it is time to run a frame of code. */
-        new_time = SDL_GetTicks();
+        /* Fast-forward, replays and benchmarks run as fast as the host allows. */
+        free_run = fast_forward || bench_active || (replay_mode == REPLAY_PLAY);
 #ifdef USE_GDBSTUB
-        if (gdbstub_next_asap && (drawits <= 0))
-            drawits = 10;
-        else
+        free_run |= gdbstub_next_asap;
 #endif
-            drawits += (new_time - old_time);
-        old_time = new_time;
-        if (drawits > 0 && !dopause) {
-            /* Yes, so do one frame now. */
-            drawits -= 10;
-            if (drawits > 50)
-                drawits = 0;
-
-            /* Run a block of code. */
+        if (dopause) {
+            /* Just so we dont overload the host OS. */
+            pacer_reset();
+            SDL_Delay(1);
+        } else if (pacer_wait(free_run)) {
+            /* It is time to run a frame of code. */
             pc_run();
 
             /* Every 200 frames we save the machine status. */
@@ -575,8 +322,7 @@ main_thread(void *param)
                 nvr_dosave = 0;
                 frames     = 0;
             }
-        } else /* Just so we dont overload the host OS. */
-            SDL_Delay(1);
+        }
 
         /* If needed, handle a screen resize. */
         if (atomic_load(&doresize_monitors[0]) && !video_fullscreen && !is_quit) {
@@ -587,6 +333,7 @@ main_thread(void *param)
             atomic_store(&doresize_monitors[0], 1);
         }
     }
+    pacer_log_stats();
 
     is_quit = 1;
 }
@@ -635,12 +382,6 @@ do_stop(void)
     thMain = NULL;
 }
 
-int
-ui_msgbox(int flags, void *message)
-{
-    return ui_msgbox_header(flags, NULL, message);
-}
-
 int
 ui_msgbox_header(int flags, void *header, void *message)
 {
@@ -697,26 +438,6 @@ plat_get_exe_name(char *s, int size)
     snprintf(s, size, "%s%s", basepath, basepath[strlen(basepath) - 1] == '/' ? "86box" : "/86box");
 }
 
-void
-plat_power_off(void)
-{
-    confirm_exit = 0;
-    nvr_save();
-    config_save();
-
-    /* Deduct a sufficiently large number of cycles that no instructions will
-       run before the main thread is terminated */
-    cycles -= 99999999;
-
-    cpu_thread_run = 0;
-}
-
-void
-ui_sb_bugui(char *str)
-{
-    /* No-op. */
-}
-
 extern void sdl_blit(int x, int y, int w, int h);
 
 typedef struct mouseinputdata {
@@ -730,12 +451,6 @@ SDL_mutex *mousemutex;
 int        real_sdl_w;
 int        real_sdl_h;
 
-void
-ui_sb_set_ready(int ready)
-{
-    /* No-op. */
-}
-
 char *xargv[512];
 
 // From musl.
@@ -962,6 +677,7 @@ monitor_thread(void *param)
                         "moeject <id> - eject image from MO drive <id>.\n\n"
                         "hardreset - hard reset the emulated system.\n"
                         "pause - pause the the emulated system.\n"
+                        "fastforward - toggle running as fast as the host allows.\n"
                         "fullscreen - toggle fullscreen.\n"
                         "version - print version and license information.\n"
                         "exit - exit 86Box.\n");
@@ -1009,6 +725,9 @@ monitor_thread(void *param)
                 } else if (strncasecmp(xargv[0], "pause", 5) == 0) {
                     plat_pause(dopause ^ 1);
                     printf("%s", dopause ? "Paused.\n" : "Unpaused.\n");
+                } else if (strncasecmp(xargv[0], "fastforward", 11) == 0) {
+                    pc_set_fast_forward(fast_forward ^ 1);
+                    printf("%s", fast_forward ? "Fast-forwarding.\n" : "Running at normal speed.\n");
                 } else if (strncasecmp(xargv[0], "hardreset", 9) == 0) {
                     pc_reset_hard();
                 } else if (strncasecmp(xargv[0], "cdload", 6) == 0 && cmdargc >= 3) {
@@ -1361,71 +1080,6 @@ plat_vidapi_name(int i)
     return "default";
 }
 
-void
-set_language(uint32_t id)
-{
-    lang_id = id;
-}
-
-/* Sets up the program language before initialization. */
-uint32_t
-plat_language_code(char *langcode)
-{
-    /* or maybe not */
-    return 0;
-}
-
-void
-plat_get_cpu_string(char *outbuf, uint8_t len) {
-    char cpu_string[] = "Unknown";
-
-    strncpy(outbuf, cpu_string, len);
-}
-
-void
-plat_set_thread_name(void *thread, const char *name)
-{
-#ifdef __APPLE__
-    if (thread) /* Apple pthread can only set self's name */
-        return;
-    char truncated[64];
-#else
-    char truncated[16];
-#endif
-    strncpy(truncated, name, sizeof(truncated) - 1);
-#ifdef __APPLE__
-    pthread_setname_np(truncated);
-#else
-    pthread_setname_np(thread ? *((pthread_t *) thread) : pthread_self(), truncated);
-#endif
-}
-
-/* Converts back the language code to LCID */
-void
-plat_language_code_r(uint32_t lcid, char *outbuf, int len)
-{
-    /* or maybe not */
-    return;
-}
-
-void
-joystick_init(void)
-{
-    /* No-op. */
-}
-
-void
-joystick_close(void)
-{
-    /* No-op. */
-}
-
-void
-joystick_process(void)
-{
-    /* No-op. */
-}
-
 void
 startblit(void)
 {
@@ -1437,16 +1091,3 @@ endblit(void)
 {
     SDL_UnlockMutex(blitmtx);
 }
-
-/* API */
-void
-ui_sb_mt32lcd(char *str)
-{
-    /* No-op. */
-}
-
-void
-ui_hard_reset_completed(void)
-{
-    /* No-op. */
-}
@@ -0,0 +1,431 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Platform functions shared by the SDL and headless front ends.
+ *
+ *
+ *
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/param.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <dlfcn.h>
+#include <wchar.h>
+
+#include <86box/86box.h>
+#include <86box/mem.h>
+#include <86box/config.h>
+#include <86box/path.h>
+#include <86box/plat.h>
+#include <86box/plat_dynld.h>
+#include <86box/timer.h>
+#include <86box/nvr.h>
+#include <86box/ui.h>
+
+#define __USE_GNU 1 /* shouldn't be done, yet it is */
+#include <pthread.h>
+
+void *
+dynld_module(const char *name, dllimp_t *table)
+{
+    dllimp_t *imp;
+    void     *modhandle = dlopen(name, RTLD_LAZY | RTLD_GLOBAL);
+
+    if (modhandle) {
+        for (imp = table; imp->name != NULL; imp++) {
+            if ((*(void **) imp->func = dlsym(modhandle, imp->name)) == NULL) {
+                dlclose(modhandle);
+                return NULL;
+            }
+        }
+    }
+
+    return modhandle;
+}
+
+void
+dynld_close(void *handle)
+{
+    dlclose(handle);
+}
+
+void
+plat_tempfile(char *bufp, char *prefix, char *suffix)
+{
+    struct tm     *calendertime;
+    struct timeval t;
+    time_t         curtime;
+
+    if (prefix != NULL)
+        sprintf(bufp, "%s-", prefix);
+    else
+        strcpy(bufp, "");
+    gettimeofday(&t, NULL);
+    curtime      = time(NULL);
+    calendertime = localtime(&curtime);
+    sprintf(&bufp[strlen(bufp)], "%d%02d%02d-%02d%02d%02d-%03ld%s", calendertime->tm_year, calendertime->tm_mon, calendertime->tm_mday, calendertime->tm_hour, calendertime->tm_min, calendertime->tm_sec, t.tv_usec / 1000, suffix);
+}
+
+int
+plat_getcwd(char *bufp, int max)
+{
+    return getcwd(bufp, max) != 0;
+}
+
+int
+plat_chdir(char *str)
+{
+    return chdir(str);
+}
+
+FILE *
+plat_fopen(const char *path, const char *mode)
+{
+    return fopen(path, mode);
+}
+
+FILE *
+plat_fopen64(const char *path, const char *mode)
+{
+    return fopen(path, mode);
+}
+
+int
+path_abs(char *path)
+{
+    return path[0] == '/';
+}
+
+void
+path_normalize(char *path)
+{
+    /* No-op. */
+}
+
+void
+path_slash(char *path)
+{
+    if (path[strlen(path) - 1] != '/') {
+        strcat(path, "/");
+    }
+    path_normalize(path);
+}
+
+const char *
+path_get_slash(char *path)
+{
+    char *ret = "";
+
+    if (path[strlen(path) - 1] != '/')
+        ret = "/";
+
+    return ret;
+}
+
+void
+plat_put_backslash(char *s)
+{
+    int c = strlen(s) - 1;
+
+    if (s[c] != '/')
+        s[c] = '/';
+}
+
+/* Return the last element of a pathname. */
+char *
+plat_get_basename(const char *path)
+{
+    int c = (int) strlen(path);
+
+    while (c > 0) {
+        if (path[c] == '/')
+            return ((char *) &path[c + 1]);
+        c--;
+    }
+
+    return ((char *) path);
+}
+
+char *
+path_get_filename(char *s)
+{
+    int c = strlen(s) - 1;
+
+    while (c > 0) {
+        if (s[c] == '/' || s[c] == '\\')
+            return (&s[c + 1]);
+        c--;
+    }
+
+    return s;
+}
+
+char *
+path_get_extension(char *s)
+{
+    int c = strlen(s) - 1;
+
+    if (c <= 0)
+        return s;
+
+    while (c && s[c] != '.')
+        c--;
+
+    if (!c)
+        return (&s[strlen(s)]);
+
+    return (&s[c + 1]);
+}
+
+void
+path_append_filename(char *dest, const char *s1, const char *s2)
+{
+    strcpy(dest, s1);
+    path_slash(dest);
+    strcat(dest, s2);
+}
+
+void
+path_get_dirname(char *dest, const char *path)
+{
+    int   c = (int) strlen(path);
+    char *ptr;
+
+    ptr = (char *) path;
+
+    while (c > 0) {
+        if (path[c] == '/' || path[c] == '\\') {
+            ptr = (char *) &path[c];
+            break;
+        }
+        c--;
+    }
+
+    /* Copy to destination. */
+    while (path < ptr)
+        *dest++ = *path++;
+    *dest = '\0';
+}
+
+int
+plat_dir_check(char *path)
+{
+    struct stat dummy;
+    if (stat(path, &dummy) < 0) {
+        return 0;
+    }
+    return S_ISDIR(dummy.st_mode);
+}
+
+int
+plat_dir_create(char *path)
+{
+    return mkdir(path, S_IRWXU);
+}
+
+void *
+plat_mmap(size_t size, uint8_t executable)
+{
+#if defined __APPLE__ && defined MAP_JIT
+    void *ret = mmap(0, size, PROT_READ | PROT_WRITE | (executable ? PROT_EXEC : 0), MAP_ANON | MAP_PRIVATE | (executable ? MAP_JIT : 0), -1, 0);
+#else
+    void *ret = mmap(0, size, PROT_READ | PROT_WRITE | (executable ? PROT_EXEC : 0), MAP_ANON | MAP_PRIVATE, -1, 0);
+#endif
+    return (ret == MAP_FAILED) ? NULL : ret;
+}
+
+void
+plat_munmap(void *ptr, size_t size)
+{
+    munmap(ptr, size);
+}
+
+void
+plat_remove(char *path)
+{
+    remove(path);
+}
+
+void
+plat_delay_ns(uint64_t count)
+{
+    struct timespec ts;
+
+    ts.tv_sec  = count / 1000000000ULL;
+    ts.tv_nsec = count % 1000000000ULL;
+    while ((nanosleep(&ts, &ts) == -1) && (errno == EINTR))
+        ;
+}
+
+void
+ui_sb_update_icon_state(int tag, int state)
+{
+    /* No-op. */
+}
+
+void
+ui_sb_update_icon(int tag, int active)
+{
+    /* No-op. */
+}
+
+void
+ui_sb_update_tip(int arg)
+{
+    /* No-op. */
+}
+
+void
+ui_sb_update_panes(void)
+{
+    /* No-op. */
+}
+
+void
+ui_sb_update_text(void)
+{
+    /* No-op. */
+}
+
+void
+ui_sb_set_text_w(wchar_t *wstr)
+{
+    /* No-op. */
+}
+
+void
+ui_sb_bugui(char *str)
+{
+    /* No-op. */
+}
+
+void
+ui_sb_set_ready(int ready)
+{
+    /* No-op. */
+}
+
+void
+ui_sb_mt32lcd(char *str)
+{
+    /* No-op. */
+}
+
+void
+ui_hard_reset_completed(void)
+{
+    /* No-op. */
+}
+
+int
+stricmp(const char *s1, const char *s2)
+{
+    return strcasecmp(s1, s2);
+}
+
+int
+strnicmp(const char *s1, const char *s2, size_t n)
+{
+    return strncasecmp(s1, s2, n);
+}
+
+int
+ui_msgbox(int flags, void *message)
+{
+    return ui_msgbox_header(flags, NULL, message);
+}
+
+void
+plat_power_off(void)
+{
+    confirm_exit = 0;
+    nvr_save();
+    config_save();
+
+    /* Deduct a sufficiently large number of cycles that no instructions will
+       run before the main thread is terminated */
+    cycles -= 99999999;
+
+    cpu_thread_run = 0;
+}
+
+void
+set_language(uint32_t id)
+{
+    lang_id = id;
+}
+
+/* Sets up the program language before initialization. */
+uint32_t
+plat_language_code(char *langcode)
+{
+    /* or maybe not */
+    return 0;
+}
+
+/* Converts back the language code to LCID */
+void
+plat_language_code_r(uint32_t lcid, char *outbuf, int len)
+{
+    /* or maybe not */
+    return;
+}
+
+void
+plat_get_cpu_string(char *outbuf, uint8_t len)
+{
+    char cpu_string[] = "Unknown";
+
+    strncpy(outbuf, cpu_string, len);
+}
+
+void
+plat_set_thread_name(void *thread, const char *name)
+{
+#ifdef __APPLE__
+    if (thread) /* Apple pthread can only set self's name */
+        return;
+    char truncated[64];
+#else
+    char truncated[16];
+#endif
+    strncpy(truncated, name, sizeof(truncated) - 1);
+    truncated[sizeof(truncated) - 1] = '\0';
+#ifdef __APPLE__
+    pthread_setname_np(truncated);
+#else
+    pthread_setname_np(thread ? *((pthread_t *) thread) : pthread_self(), truncated);
+#endif
+}
+
+void
+joystick_init(void)
+{
+    /* No-op. */
+}
+
+void
+joystick_close(void)
+{
+    /* No-op. */
+}
+
+void
+joystick_process(void)
+{
+    /* No-op. */
+}
@@ -0,0 +1,961 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Headless front end, for hosts without a display.
+ *
+ *          The machine runs without any window, renderer or audio
+ *          device: finished frames are dropped unless a screenshot was
+ *          asked for, and the sound output only goes to a WAV file
+ *          while one is being captured.
+ *
+ *          It is controlled with one command per line, read from the
+ *          standard input and, if 86BOX_CONTROL_SOCKET is set, from
+ *          clients of a local socket created at that path. Every
+ *          command is answered with "ok" or "error: <reason>".
+ *
+ *
+ *
+ */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/param.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <dlfcn.h>
+#include <wchar.h>
+#include <pwd.h>
+#include <stdatomic.h>
+
+#include <86box/86box.h>
+#include <86box/mem.h>
+#include <86box/rom.h>
+#include <86box/keyboard.h>
+#include <86box/mouse.h>
+#include <86box/config.h>
+#include <86box/path.h>
+#include <86box/plat.h>
+#include <86box/plat_dynld.h>
+#include <86box/thread.h>
+#include <86box/device.h>
+#include <86box/gameport.h>
+#include <86box/timer.h>
+#include <86box/nvr.h>
+#include <86box/fdd.h>
+#include <86box/scsi_device.h>
+#include <86box/cdrom.h>
+#include <86box/zip.h>
+#include <86box/mo.h>
+#include <86box/sound.h>
+#include <86box/video.h>
+#include <86box/ui.h>
+#include <86box/gdbstub.h>
+#include <86box/replay.h>
+#include <86box/pacer.h>
+#include <86box/bench.h>
+#include <86box/savestate.h>
+#include <86box/machine_counters.h>
+#include <minitrace/minitrace.h>
+
+#define __USE_GNU 1 /* shouldn't be done, yet it is */
+#include <pthread.h>
+
+#define CMD_ARGS 8
+
+typedef struct headless_cmd_t {
+    const char *name;
+    int         min_args;
+    const char *help;
+    const char *(*func)(int argc, char **argv, FILE *out);
+} headless_cmd_t;
+
+static struct timespec  start_time;
+int                     rctrl_is_lalt;
+int                     update_icons;
+int                     kbd_req_capture;
+int                     hide_status_bar;
+int                     hide_tool_bar;
+int                     fixed_size_x = 640;
+int                     fixed_size_y = 480;
+int                     mouse_capture;
+plat_joystick_t         plat_joystick_state[MAX_PLAT_JOYSTICKS];
+joystick_t              joystick_state[MAX_JOYSTICKS];
+int                     joysticks_present;
+int                     status_icons_fullscreen = 0; /* unused. */
+static pthread_mutex_t  blitmtx                 = PTHREAD_MUTEX_INITIALIZER;
+static int              control_fd              = -1;
+static char             control_path[sizeof(((struct sockaddr_un *) 0)->sun_path)];
+static wchar_t          headless_title[512]     = L"86Box";
+uint32_t                lang_id                 = 0x0409; // Multilangual UI variables, for now all set to LCID of en-US
+uint32_t                lang_sys                = 0x0409; // Multilangual UI variables, for now all set to LCID of en-US
+char                    icon_set[256]           = "";     /* name of the iconset to be used */
+volatile int            cpu_thread_run          = 1;
+thread_t               *thMain                  = NULL;
+
+/* Set from the signal handler as well. */
+static volatile sig_atomic_t exit_event = 0;
+
+wchar_t *
+plat_get_string(int i)
+{
+    switch (i) {
+        case IDS_2131:
+            return L"Invalid configuration";
+        case IDS_4099:
+            return L"MFM/RLL or ESDI CD-ROM drives never existed";
+        case IDS_2094:
+            return L"Failed to set up PCap";
+        case IDS_2095:
+            return L"No PCap devices found";
+        case IDS_2096:
+            return L"Invalid PCap device";
+        case IDS_2133:
+            return L"libgs is required for automatic conversion of PostScript files to PDF.\n\nAny documents sent to the generic PostScript printer will be saved as PostScript (.ps) files.";
+        case IDS_2130:
+            return L"Make sure libpcap is installed and that you are on a libpcap-compatible network connection.";
+        case IDS_2115:
+            return L"Unable to initialize Ghostscript";
+        case IDS_2063:
+            return L"Machine \"%hs\" is not available due to missing ROMs in the roms/machines directory. Switching to an available machine.";
+        case IDS_2064:
+            return L"Video card \"%hs\" is not available due to missing ROMs in the roms/video directory. Switching to an available video card.";
+        case IDS_2129:
+            return L"Hardware not available";
+        case IDS_2143:
+            return L"Monitor in sleep mode";
+    }
+    return L"";
+}
+
+uint64_t
+plat_get_nano_ticks(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t) (now.tv_sec - start_time.tv_sec) * 1000000000ULL) + now.tv_nsec - start_time.tv_nsec;
+}
+
+uint64_t
+plat_timer_read(void)
+{
+    return plat_get_nano_ticks();
+}
+
+uint32_t
+plat_get_ticks(void)
+{
+    return (uint32_t) (plat_get_nano_ticks() / 1000000);
+}
+
+uint32_t
+plat_get_micro_ticks(void)
+{
+    return (uint32_t) (plat_get_nano_ticks() / 1000);
+}
+
+void
+plat_delay_ms(uint32_t count)
+{
+    plat_delay_ns((uint64_t) count * 1000000ULL);
+}
+
+/* There is nobody to click a button, so just log the message. */
+int
+ui_msgbox_header(int flags, void *header, void *message)
+{
+    if (!header)
+        header = (flags & MBX_ANSI) ? (void *) "86Box" : (void *) L"86Box";
+    if (header <= (void *) 7168)
+        header = (void *) plat_get_string((uintptr_t) header);
+    if (message <= (void *) 7168)
+        message = (void *) plat_get_string((uintptr_t) message);
+
+    if (flags & MBX_ANSI)
+        fprintf(stderr, "%s: %s\n", (char *) header, (char *) message);
+    else
+        fprintf(stderr, "%ls: %ls\n", (wchar_t *) header, (wchar_t *) message);
+
+    return 0;
+}
+
+void
+plat_get_exe_name(char *s, int size)
+{
+    char path[PATH_MAX] = { 0 };
+
+    if ((readlink("/proc/self/exe", path, sizeof(path) - 1) <= 0) && !plat_getcwd(path, sizeof(path) - 1))
+        strcpy(path, ".");
+
+    path_get_dirname(s, path);
+    strncat(s, "/86box", size - strlen(s) - 1);
+}
+
+void
+plat_pause(int p)
+{
+    if ((!!p) == dopause)
+        return;
+
+    if ((p == 0) && (time_sync & TIME_SYNC_ENABLED))
+        nvr_time_sync();
+
+    do_pause(p);
+}
+
+void
+plat_init_rom_paths(void)
+{
+#ifndef __APPLE__
+    char *home = getenv("HOME") ? getenv("HOME") : getpwuid(getuid())->pw_dir;
+    char  rom_path[1024];
+
+    if (getenv("XDG_DATA_HOME"))
+        snprintf(rom_path, sizeof(rom_path), "%s/86Box/", getenv("XDG_DATA_HOME"));
+    else
+        snprintf(rom_path, sizeof(rom_path), "%s/.local/share/86Box/", home);
+    if (!plat_dir_check(rom_path))
+        plat_dir_create(rom_path);
+    strncat(rom_path, "roms/", sizeof(rom_path) - strlen(rom_path) - 1);
+    if (!plat_dir_check(rom_path))
+        plat_dir_create(rom_path);
+    rom_add_path(rom_path);
+
+    if (getenv("XDG_DATA_DIRS")) {
+        char *xdg_rom_paths = strdup(getenv("XDG_DATA_DIRS"));
+        char *saveptr       = NULL;
+
+        if (xdg_rom_paths) {
+            for (char *p = strtok_r(xdg_rom_paths, ":", &saveptr); p != NULL; p = strtok_r(NULL, ":", &saveptr)) {
+                snprintf(rom_path, sizeof(rom_path), "%s%s86Box/roms/", p, (p[strlen(p) - 1] == '/') ? "" : "/");
+                rom_add_path(rom_path);
+            }
+            free(xdg_rom_paths);
+        }
+    } else {
+        rom_add_path("/usr/local/share/86Box/roms/");
+        rom_add_path("/usr/share/86Box/roms/");
+    }
+#else
+    char default_rom_path[1024] = { '\0' };
+    getDefaultROMPath(default_rom_path);
+    rom_add_path(default_rom_path);
+#endif
+}
+
+/* The same directory SDL_GetPrefPath() gives the SDL front end. */
+void
+plat_get_global_config_dir(char *strptr)
+{
+    char *home = getenv("HOME") ? getenv("HOME") : getpwuid(getuid())->pw_dir;
+
+#ifdef __APPLE__
+    snprintf(strptr, 1024, "%s/Library/Application Support/net.86Box.86Box/", home);
+#else
+    if (getenv("XDG_DATA_HOME"))
+        snprintf(strptr, 1024, "%s/86Box/", getenv("XDG_DATA_HOME"));
+    else
+        snprintf(strptr, 1024, "%s/.local/share/86Box/", home);
+#endif
+    if (!plat_dir_check(strptr))
+        plat_dir_create(strptr);
+}
+
+int
+plat_vidapi(char *api)
+{
+    return 0;
+}
+
+char *
+plat_vidapi_name(int i)
+{
+    return "none";
+}
+
+void
+plat_mouse_capture(int on)
+{
+    mouse_capture = on;
+}
+
+void
+plat_resize(int w, int h)
+{
+    /* No-op. */
+}
+
+void
+plat_resize_request(int w, int h, int monitor_index)
+{
+    /* No-op. */
+}
+
+wchar_t *
+ui_window_title(wchar_t *str)
+{
+    if (!str)
+        return headless_title;
+
+    wcsncpy(headless_title, str, sizeof_w(headless_title) - 1);
+    return str;
+}
+
+void
+ui_init_monitor(int monitor_index)
+{
+    /* No-op. */
+}
+
+void
+ui_deinit_monitor(int monitor_index)
+{
+    /* No-op. */
+}
+
+void
+startblit(void)
+{
+    pthread_mutex_lock(&blitmtx);
+}
+
+void
+endblit(void)
+{
+    pthread_mutex_unlock(&blitmtx);
+}
+
+/* Frames are only looked at when a screenshot has been asked for. */
+static void
+headless_blit(int x, int y, int w, int h, int monitor_index)
+{
+    bitmap_t *buf = video_blit_buffer_monitor(monitor_index);
+
+    if (monitors[monitor_index].mon_screenshots && (buf != NULL) && (w > 0) && (h > 0))
+        video_screenshot_monitor(buf->dat, x, y, buf->w, monitor_index);
+
+    video_blit_complete_monitor(monitor_index);
+}
+
+void
+main_thread(void *param)
+{
+    int frames;
+    int free_run;
+
+    plat_set_thread_name(NULL, "main_thread");
+    framecountx = 0;
+    frames      = 0;
+    pacer_init(PACER_SLICE_NS);
+    while (!is_quit && cpu_thread_run) {
+        /* Fast-forward, replays and benchmarks run as fast as the host allows. */
+        free_run = fast_forward || bench_active || (replay_mode == REPLAY_PLAY);
+#ifdef USE_GDBSTUB
+        free_run |= gdbstub_next_asap;
+#endif
+        if (dopause) {
+            /* Just so we dont overload the host OS. */
+            ack_pause();
+            pacer_reset();
+            plat_delay_ms(1);
+        } else if (pacer_wait(free_run)) {
+            pc_run();
+
+            /* Every 200 frames we save the machine status. */
+            if (++frames >= 200 && nvr_dosave) {
+                nvr_save();
+                nvr_dosave = 0;
+                frames     = 0;
+            }
+        }
+    }
+    pacer_log_stats();
+
+    is_quit = 1;
+}
+
+void
+do_start(void)
+{
+    /* We have not stopped yet. */
+    is_quit = 0;
+
+    timer_freq = 1000000000ULL;
+
+    /* Start the emulator, really. */
+    thMain = thread_create(main_thread, NULL);
+}
+
+void
+do_stop(void)
+{
+    is_quit = 1;
+
+    pc_close(thMain);
+
+    thMain = NULL;
+
+#ifdef MTR_ENABLED
+    if (tracing_on) {
+        mtr_stop();
+        mtr_shutdown();
+        tracing_on = 0;
+    }
+#endif
+}
+
+static const char *
+cmd_exit(int argc, char **argv, FILE *out)
+{
+    exit_event = 1;
+    return NULL;
+}
+
+static const char *
+cmd_pause(int argc, char **argv, FILE *out)
+{
+    plat_pause(dopause ^ 1);
+    fprintf(out, "%s\n", dopause ? "paused" : "running");
+    return NULL;
+}
+
+static const char *
+cmd_fastforward(int argc, char **argv, FILE *out)
+{
+    pc_set_fast_forward(fast_forward ^ 1);
+    fprintf(out, "%s\n", fast_forward ? "fast-forwarding" : "running at normal speed");
+    return NULL;
+}
+
+static const char *
+cmd_hardreset(int argc, char **argv, FILE *out)
+{
+    pc_reset_hard();
+    return NULL;
+}
+
+static const char *
+cmd_cad(int argc, char **argv, FILE *out)
+{
+    pc_send_cad();
+    return NULL;
+}
+
+static const char *
+cmd_fddload(int argc, char **argv, FILE *out)
+{
+    int id = atoi(argv[1]);
+
+    if ((id < 0) || (id >= FDD_NUM))
+        return "no such drive";
+    floppy_mount(id, argv[2], (argc > 3) ? atoi(argv[3]) : 0);
+    return NULL;
+}
+
+static const char *
+cmd_fddeject(int argc, char **argv, FILE *out)
+{
+    int id = atoi(argv[1]);
+
+    if ((id < 0) || (id >= FDD_NUM))
+        return "no such drive";
+    floppy_eject(id);
+    return NULL;
+}
+
+static const char *
+cmd_cdload(int argc, char **argv, FILE *out)
+{
+    int id = atoi(argv[1]);
+
+    if ((id < 0) || (id >= CDROM_NUM))
+        return "no such drive";
+    cdrom_mount(id, argv[2]);
+    return NULL;
+}
+
+static const char *
+cmd_cdeject(int argc, char **argv, FILE *out)
+{
+    int id = atoi(argv[1]);
+
+    if ((id < 0) || (id >= CDROM_NUM))
+        return "no such drive";
+    cdrom_mount(id, "");
+    return NULL;
+}
+
+static const char *
+cmd_zipload(int argc, char **argv, FILE *out)
+{
+    int id = atoi(argv[1]);
+
+    if ((id < 0) || (id >= ZIP_NUM))
+        return "no such drive";
+    zip_mount(id, argv[2], (argc > 3) ? atoi(argv[3]) : 0);
+    return NULL;
+}
+
+static const char *
+cmd_zipeject(int argc, char **argv, FILE *out)
+{
+    int id = atoi(argv[1]);
+
+    if ((id < 0) || (id >= ZIP_NUM))
+        return "no such drive";
+    zip_eject(id);
+    return NULL;
+}
+
+static const char *
+cmd_moload(int argc, char **argv, FILE *out)
+{
+    int id = atoi(argv[1]);
+
+    if ((id < 0) || (id >= MO_NUM))
+        return "no such drive";
+    mo_mount(id, argv[2], (argc > 3) ? atoi(argv[3]) : 0);
+    return NULL;
+}
+
+static const char *
+cmd_moeject(int argc, char **argv, FILE *out)
+{
+    int id = atoi(argv[1]);
+
+    if ((id < 0) || (id >= MO_NUM))
+        return "no such drive";
+    mo_eject(id);
+    return NULL;
+}
+
+static const char *
+cmd_cartload(int argc, char **argv, FILE *out)
+{
+    int id = atoi(argv[1]);
+
+    if ((id < 0) || (id >= 2))
+        return "no such drive";
+    cartridge_mount(id, argv[2], (argc > 3) ? atoi(argv[3]) : 0);
+    return NULL;
+}
+
+static const char *
+cmd_carteject(int argc, char **argv, FILE *out)
+{
+    int id = atoi(argv[1]);
+
+    if ((id < 0) || (id >= 2))
+        return "no such drive";
+    cartridge_eject(id);
+    return NULL;
+}
+
+static const char *
+cmd_screenshot(int argc, char **argv, FILE *out)
+{
+    monitors[0].mon_screenshots++;
+    return NULL;
+}
+
+static const char *
+cmd_wavstart(int argc, char **argv, FILE *out)
+{
+    return wavout_start(argv[1]) ? NULL : "unable to create the file";
+}
+
+static const char *
+cmd_wavstop(int argc, char **argv, FILE *out)
+{
+    wavout_stop();
+    return NULL;
+}
+
+static const char *
+cmd_capstart(int argc, char **argv, FILE *out)
+{
+    int format = VIDEO_CAPTURE_PNG;
+
+    if (argc > 2) {
+        if (!strcasecmp(argv[2], "raw"))
+            format = VIDEO_CAPTURE_RAW;
+        else if (strcasecmp(argv[2], "png"))
+            return "unknown format";
+    }
+
+    return video_capture_start(argv[1], format, 0) ? NULL : "unable to create the file";
+}
+
+static const char *
+cmd_capstop(int argc, char **argv, FILE *out)
+{
+    video_capture_stop();
+    return NULL;
+}
+
+static const char *
+cmd_savestate(int argc, char **argv, FILE *out)
+{
+    savestate_request_save(argv[1]);
+    return NULL;
+}
+
+static const char *
+cmd_loadstate(int argc, char **argv, FILE *out)
+{
+    savestate_request_load(argv[1], (argc > 2) && !strcmp(argv[2], "force"));
+    return NULL;
+}
+
+#ifdef MTR_ENABLED
+static const char *
+cmd_tracestart(int argc, char **argv, FILE *out)
+{
+    FILE *fp;
+
+    if (tracing_on)
+        return "already tracing";
+
+    fp = plat_fopen(argv[1], "wb");
+    if (fp == NULL)
+        return "unable to create the file";
+
+    /* In ring mode only the last events are kept, and written out on stop. */
+    mtr_set_ring_buffer((argc > 2) && !strcmp(argv[2], "ring"));
+    mtr_init_from_stream(fp);
+    mtr_start();
+    tracing_on = 1;
+    return NULL;
+}
+
+static const char *
+cmd_tracestop(int argc, char **argv, FILE *out)
+{
+    if (!tracing_on)
+        return "not tracing";
+
+    mtr_stop();
+    mtr_shutdown();
+    tracing_on = 0;
+    return NULL;
+}
+#endif
+
+extern int fps;
+
+static const char *
+cmd_stats(int argc, char **argv, FILE *out)
+{
+    pacer_stats_t stats;
+
+    pacer_get_stats(&stats);
+    fprintf(out, "speed %i%%, %" PRIu64 " slices, %" PRIu64 " late, %" PRIu64 " dropped\n",
+            fps, stats.slices, stats.late, stats.dropped);
+    return NULL;
+}
+
+/* Running totals first, then the rates over the last second, one per line
+   so that they are easy to scrape. */
+static const char *
+cmd_counters(int argc, char **argv, FILE *out)
+{
+    machine_counters_t     mc;
+    const machine_rates_t *mr = &machine_rates;
+
+    machine_counters_sample(&mc);
+    fprintf(out, "slices %" PRIu64 "\n", mc.slices);
+    fprintf(out, "instructions %" PRIu64 "\n", mc.ins);
+    fprintf(out, "blocks_run %" PRIu64 "\n", mc.blocks_run);
+    fprintf(out, "blocks_compiled %" PRIu64 "\n", mc.blocks_compiled);
+    fprintf(out, "frames %" PRIu64 "\n", mc.frames);
+    fprintf(out, "frames_skipped %" PRIu64 "\n", mc.frames_skipped);
+    fprintf(out, "audio_buffers %" PRIu64 "\n", mc.audio_buffers);
+    fprintf(out, "audio_underruns %" PRIu64 "\n", mc.audio_underruns);
+    fprintf(out, "slices_late %" PRIu64 "\n", mc.late);
+    fprintf(out, "slices_dropped %" PRIu64 "\n", mc.dropped);
+    fprintf(out, "timer_calls %" PRIu64 "\n", mc.timer_calls);
+    fprintf(out, "cpu_ns %" PRIu64 "\n", mc.cpu_ns);
+    fprintf(out, "timer_ns %" PRIu64 "\n", mc.timer_ns);
+    fprintf(out, "audio_ns %" PRIu64 "\n", mc.audio_ns);
+    fprintf(out, "render_ns %" PRIu64 "\n", mc.render_ns);
+    fprintf(out, "blit_wait_ns %" PRIu64 "\n", mc.blit_wait_ns);
+    fprintf(out, "mips %.2f\n", mr->mips);
+    fprintf(out, "speed_percent %.1f\n", mr->speed);
+    fprintf(out, "target_percent %s\n", fast_forward ? "unlimited" : "100");
+    fprintf(out, "cpu_percent %.1f\n", mr->cpu);
+    fprintf(out, "timer_percent %.1f\n", mr->timers);
+    fprintf(out, "timer_calls_per_sec %.0f\n", mr->timer_calls);
+    fprintf(out, "audio_percent %.1f\n", mr->audio);
+    fprintf(out, "render_percent %.1f\n", mr->render);
+    fprintf(out, "blit_wait_percent %.1f\n", mr->blit_wait);
+    fprintf(out, "block_hit_percent %.1f\n", mr->block_hit);
+    fprintf(out, "fps %.1f\n", mr->fps);
+    return NULL;
+}
+
+static const char *cmd_help(int argc, char **argv, FILE *out);
+
+static const headless_cmd_t headless_cmds[] = {
+  // clang-format off
+    { "help",        0, "                     - list the commands",                        cmd_help        },
+    { "exit",        0, "                     - exit 86Box",                               cmd_exit        },
+    { "pause",       0, "                     - pause or resume the emulated system",      cmd_pause       },
+    { "fastforward", 0, "                     - toggle running as fast as the host allows", cmd_fastforward },
+    { "hardreset",   0, "                     - hard reset the emulated system",           cmd_hardreset   },
+    { "cad",         0, "                     - send Ctrl+Alt+Del",                        cmd_cad         },
+    { "fddload",     2, "<id> <file> [wp]     - load a floppy disk image",                 cmd_fddload     },
+    { "fddeject",    1, "<id>                 - eject a floppy disk",                      cmd_fddeject    },
+    { "cdload",      2, "<id> <file>          - load a CD-ROM image",                      cmd_cdload      },
+    { "cdeject",     1, "<id>                 - eject a CD-ROM",                           cmd_cdeject     },
+    { "zipload",     2, "<id> <file> [wp]     - load a ZIP image",                         cmd_zipload     },
+    { "zipeject",    1, "<id>                 - eject a ZIP image",                        cmd_zipeject    },
+    { "moload",      2, "<id> <file> [wp]     - load an MO image",                         cmd_moload      },
+    { "moeject",     1, "<id>                 - eject an MO image",                        cmd_moeject     },
+    { "cartload",    2, "<id> <file> [wp]     - load a cartridge image",                   cmd_cartload    },
+    { "carteject",   1, "<id>                 - eject a cartridge",                        cmd_carteject   },
+    { "screenshot",  0, "                     - save the next frame to the screenshots directory", cmd_screenshot },
+    { "wavstart",    1, "<file>               - start writing the sound output to a WAV file", cmd_wavstart },
+    { "wavstop",     0, "                     - stop writing the sound output",            cmd_wavstop     },
+    { "capstart",    1, "<file> [png|raw]     - start capturing the frames, as numbered PNG files or raw RGB", cmd_capstart },
+    { "capstop",     0, "                     - stop capturing the frames",                cmd_capstop     },
+    { "savestate",   1, "<file>               - save a machine state snapshot",            cmd_savestate   },
+    { "loadstate",   1, "<file> [force]       - load a machine state snapshot",            cmd_loadstate   },
+    { "stats",       0, "                     - show the emulation speed and pacing",      cmd_stats       },
+    { "counters",    0, "                     - show the performance counters",            cmd_counters    },
+#ifdef MTR_ENABLED
+    { "tracestart",  1, "<file> [ring]        - start writing a Chrome trace",             cmd_tracestart  },
+    { "tracestop",   0, "                     - stop tracing and close the trace",         cmd_tracestop   },
+#endif
+    { NULL,          0, NULL,                                                              NULL            }
+  // clang-format on
+};
+
+static const char *
+cmd_help(int argc, char **argv, FILE *out)
+{
+    for (const headless_cmd_t *cmd = headless_cmds; cmd->name != NULL; cmd++)
+        fprintf(out, "%-12s%s\n", cmd->name, cmd->help);
+    return NULL;
+}
+
+/* Split a line into words, which may be quoted to contain spaces. */
+static int
+headless_split(char *line, char **argv)
+{
+    int argc = 0;
+
+    while (argc < CMD_ARGS) {
+        while ((*line == ' ') || (*line == '\t'))
+            line++;
+        if ((*line == '\0') || (*line == '\r') || (*line == '\n'))
+            break;
+
+        if ((*line == '"') || (*line == '\'')) {
+            char quote = *line++;
+
+            argv[argc++] = line;
+            while (*line && (*line != quote))
+                line++;
+        } else {
+            argv[argc++] = line;
+            while (*line && (*line != ' ') && (*line != '\t') && (*line != '\r') && (*line != '\n'))
+                line++;
+        }
+        if (*line == '\0')
+            break;
+        *line++ = '\0';
+    }
+
+    return argc;
+}
+
+static void
+headless_command(char *line, FILE *out)
+{
+    char       *argv[CMD_ARGS];
+    const char *err = "unknown command, try \"help\"";
+    int         argc;
+
+    argc = headless_split(line, argv);
+    if (argc == 0)
+        return;
+
+    for (const headless_cmd_t *cmd = headless_cmds; cmd->name != NULL; cmd++) {
+        if (strcasecmp(argv[0], cmd->name))
+            continue;
+
+        if ((argc - 1) < cmd->min_args)
+            err = "missing arguments";
+        else
+            err = cmd->func(argc, argv, out);
+        break;
+    }
+
+    if (err)
+        fprintf(out, "error: %s\n", err);
+    else
+        fprintf(out, "ok\n");
+    fflush(out);
+}
+
+static void
+headless_serve(FILE *in, FILE *out)
+{
+    char  *line = NULL;
+    size_t n    = 0;
+
+    while (!exit_event && (getline(&line, &n, in) != -1))
+        headless_command(line, out);
+
+    free(line);
+}
+
+static void
+stdin_thread(void *param)
+{
+    headless_serve(stdin, stdout);
+}
+
+/* One client at a time, each one gets its own session. */
+static void
+control_thread(void *param)
+{
+    FILE *in;
+    FILE *out;
+    int   fd;
+
+    while (!exit_event) {
+        fd = accept(control_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        in  = fdopen(fd, "r");
+        out = fdopen(dup(fd), "w");
+        if (in && out)
+            headless_serve(in, out);
+        if (in)
+            fclose(in);
+        else
+            close(fd);
+        if (out)
+            fclose(out);
+    }
+}
+
+static int
+control_open(const char *path)
+{
+    struct sockaddr_un addr;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Control socket path too long: %s\n", path);
+        return 0;
+    }
+
+    memset(&addr, 0x00, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    control_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (control_fd < 0)
+        return 0;
+
+    unlink(path);
+    if ((bind(control_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) || (listen(control_fd, 1) < 0)) {
+        fprintf(stderr, "Unable to listen on %s: %s\n", path, strerror(errno));
+        close(control_fd);
+        control_fd = -1;
+        return 0;
+    }
+    strcpy(control_path, path);
+
+    return 1;
+}
+
+static void
+control_close(void)
+{
+    if (control_fd < 0)
+        return;
+
+    shutdown(control_fd, SHUT_RDWR);
+    close(control_fd);
+    unlink(control_path);
+    control_fd = -1;
+}
+
+static void
+handle_signal(int sig)
+{
+    exit_event = 1;
+}
+
+extern int gfxcard[2];
+int
+headless_main(int argc, char **argv)
+{
+    uint32_t last_sec;
+    int      ret;
+
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+    ret = pc_init(argc, argv);
+    if (ret == 0)
+        return 0;
+    if (!pc_init_modules()) {
+        ui_msgbox_header(MBX_FATAL, L"No ROMs found.", L"86Box could not find any usable ROM images.\n\nPlease download a ROM set and extract it into the \"roms\" directory.");
+        return 6;
+    }
+
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    gfxcard[1] = 0;
+    video_setblit(headless_blit);
+
+    /* Fire up the machine. */
+    pc_reset_hard_init();
+
+    plat_pause(0);
+
+    do_start();
+
+    thread_create(stdin_thread, NULL);
+    if (getenv("86BOX_CONTROL_SOCKET") && control_open(getenv("86BOX_CONTROL_SOCKET")))
+        thread_create(control_thread, NULL);
+
+    /* Nothing else to do here but keep the clock ticking. */
+    last_sec = plat_get_ticks();
+    while (!exit_event && cpu_thread_run) {
+        plat_delay_ms(100);
+        if ((plat_get_ticks() - last_sec) >= 1000) {
+            last_sec += 1000;
+            pc_onesec();
+        }
+    }
+
+    control_close();
+    do_stop();
+
+    return 0;
+}
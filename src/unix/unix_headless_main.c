@@ -0,0 +1,24 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Entry point of the headless front end.
+ *
+ *          Kept apart from the rest of the platform code, so that other
+ *          programs, such as the micro-benchmarks, can link against the
+ *          emulator and bring their own main().
+ *
+ *
+ *
+ */
+extern int headless_main(int argc, char **argv);
+
+int
+main(int argc, char **argv)
+{
+    return headless_main(argc, argv);
+}
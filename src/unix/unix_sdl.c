@@ -153,7 +153,7 @@ sdl_blit_shim(int x, int y, int w, int h, int monitor_index)
 
     if (!(!sdl_enabled || (x < 0) || (y < 0) || (w <= 0) || (h <= 0) || (w > 2048) || (h > 2048) || (buffer32 == NULL) || (sdl_render == NULL) || (sdl_tex == NULL)) || (monitor_index >= 1))
         for (int row = 0; row < h; ++row)
-            video_copy(&(((uint8_t *) pixeldata)[row * 2048 * sizeof(uint32_t)]), &(buffer32->line[y + row][x]), w * sizeof(uint32_t));
+            video_copy(&(((uint8_t *) pixeldata)[row * 2048 * sizeof(uint32_t)]), &(video_blit_buffer_monitor(monitor_index)->line[y + row][x]), w * sizeof(uint32_t));
 
     if (monitors[monitor_index].mon_screenshots)
         video_screenshot((uint32_t *) pixeldata, 0, 0, 2048);
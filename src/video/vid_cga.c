@@ -472,7 +472,7 @@ cga_interpolate(cga_t *cga, int x, int y, int w, int h)
 static void
 cga_blit_memtoscreen(cga_t *cga, int x, int y, int w, int h)
 {
-    if (cga->double_type > DOUBLE_SIMPLE)
+    if ((cga->double_type > DOUBLE_SIMPLE) && !cga->frame_skip)
         cga_interpolate(cga, x, y, w, h);
 
     video_blit_memtoscreen(x, y, w, h);
@@ -496,7 +496,15 @@ cga_poll(void *priv)
         oldsc        = cga->sc;
         if ((cga->crtc[8] & 3) == 3)
             cga->sc = ((cga->sc << 1) + cga->oddeven) & 7;
-        if (cga->cgadispon) {
+        if (cga->frame_skip) {
+            if (cga->cgadispon) {
+                if (cga->displine < cga->firstline)
+                    cga->firstline = cga->displine;
+                cga->lastline = cga->displine;
+                /* Move on through the line as cga_render() would. */
+                cga->ma += cga->crtc[1];
+            }
+        } else if (cga->cgadispon) {
             if (cga->displine < cga->firstline) {
                 cga->firstline = cga->displine;
                 video_wait_for_buffer();
@@ -532,14 +540,16 @@ cga_poll(void *priv)
             }
         }
 
-        switch (cga->double_type) {
-            default:
-                cga_render_process(cga, cga->displine << 1);
-                cga_render_process(cga, (cga->displine << 1) + 1);
-                break;
-            case DOUBLE_NONE:
-                cga_render_process(cga, cga->displine);
-                break;
+        if (!cga->frame_skip) {
+            switch (cga->double_type) {
+                default:
+                    cga_render_process(cga, cga->displine << 1);
+                    cga_render_process(cga, (cga->displine << 1) + 1);
+                    break;
+                case DOUBLE_NONE:
+                    cga_render_process(cga, cga->displine);
+                    break;
+            }
         }
 
         cga->sc = oldsc;
@@ -675,8 +685,9 @@ cga_poll(void *priv)
                     } else
                         video_bpp = 1;
                 }
-                cga->firstline = 1000;
-                cga->lastline  = 0;
+                cga->firstline  = 1000;
+                cga->lastline   = 0;
+                cga->frame_skip = video_frame_skip();
                 cga->cgablink++;
                 cga->oddeven ^= 1;
             }
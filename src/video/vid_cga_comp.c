@@ -29,6 +29,11 @@
 #include <86box/vid_cga.h>
 #include <86box/vid_cga_comp.h>
 
+#if (defined __amd64__ || defined _M_X64 || defined __i386__) && defined __GNUC__
+#    define USE_AVX2
+#    include <immintrin.h>
+#endif
+
 int CGA_Composite_Table[1024];
 
 static double brightness = 0;
@@ -86,6 +91,8 @@ int    tandy_mode_control = 0;
 
 static bool new_cga = 0;
 
+static void comp_coef_update(void);
+
 void
 update_cga16_color(uint8_t cgamode)
 {
@@ -170,6 +177,8 @@ update_cga16_color(uint8_t cgamode)
     video_bi        = (int) (bi * iq_adjust_i + bq * iq_adjust_q);
     video_bq        = (int) (-bi * iq_adjust_q + bq * iq_adjust_i);
     video_sharpness = (int) (sharpness * 256 / 100);
+
+    comp_coef_update();
 }
 
 static uint8_t
@@ -186,38 +195,163 @@ static int temp[SCALER_MAXWIDTH + 10] = { 0 };
 static int atemp[SCALER_MAXWIDTH + 2] = { 0 };
 static int btemp[SCALER_MAXWIDTH + 2] = { 0 };
 
+/*
+   The decoding coefficients as integers. They only ever hold whole
+   numbers, so the sums below come out the same as with the doubles
+   the algorithm was written with.
+ */
+typedef struct comp_coef_t {
+    int sharpness;
+    int ra[4]; /* Multiply the chroma pair of each pixel, by phase. */
+    int rb[4];
+    int ga[4];
+    int gb[4];
+    int ba[4];
+    int bb[4];
+} comp_coef_t;
+
+static comp_coef_t comp_coef;
+
+/*
+   Decoded lines, looked up by what went into them so a line that comes
+   round again is copied instead of decoded. Any change to the tables
+   starts a new generation, which makes all of them stale.
+ */
+#define COMP_CACHE_LINES 32
+
+typedef struct comp_line_t {
+    uint32_t gen;
+    int      w;
+    uint8_t  border;
+    uint8_t  mono;
+    uint8_t  in[SCALER_MAXWIDTH];
+    uint32_t out[SCALER_MAXWIDTH];
+} comp_line_t;
+
+static comp_line_t comp_cache[COMP_CACHE_LINES];
+static uint32_t    comp_gen = 1;
+static uint8_t     comp_in[SCALER_MAXWIDTH];
+
+/* t is the composite signal, x8 and with the chroma taken out for colour. */
+static void
+comp_decode_c(uint32_t *srgb, const int *t, const int *ap, const int *bp, int w, int mono)
+{
+    for (int x = 0; x < w; x++) {
+        int c = t[x] + t[x];
+        int d = t[x - 1] + t[x + 1];
+        int y = ((c + d) << 8) + comp_coef.sharpness * (c - d);
+
+        if (mono)
+            srgb[x] = byte_clamp(y) * 0x10101;
+        else {
+            int rr = y + comp_coef.ra[x & 3] * ap[x] + comp_coef.rb[x & 3] * bp[x];
+            int gg = y + comp_coef.ga[x & 3] * ap[x] + comp_coef.gb[x & 3] * bp[x];
+            int bb = y + comp_coef.ba[x & 3] * ap[x] + comp_coef.bb[x & 3] * bp[x];
+
+            srgb[x] = (byte_clamp(rr) << 16) | (byte_clamp(gg) << 8) | byte_clamp(bb);
+        }
+    }
+}
+
+/* The plain C decoder until the first coefficient update has had a chance
+   to pick a faster one, which not every machine does before drawing. */
+static void (*comp_decode)(uint32_t *srgb, const int *t, const int *ap, const int *bp, int w, int mono) = comp_decode_c;
+
+#ifdef USE_AVX2
+static inline __attribute__((target("avx2"))) __m256i
+comp_clamp_avx2(__m256i v)
+{
+    return _mm256_min_epi32(_mm256_max_epi32(_mm256_srai_epi32(v, 13), _mm256_setzero_si256()), _mm256_set1_epi32(255));
+}
+
+static inline __attribute__((target("avx2"))) __m256i
+comp_coef_avx2(const int *coef)
+{
+    return _mm256_setr_epi32(coef[0], coef[1], coef[2], coef[3], coef[0], coef[1], coef[2], coef[3]);
+}
+
+static __attribute__((target("avx2"))) void
+comp_decode_avx2(uint32_t *srgb, const int *t, const int *ap, const int *bp, int w, int mono)
+{
+    const __m256i sharp = _mm256_set1_epi32(comp_coef.sharpness);
+    const __m256i ra    = comp_coef_avx2(comp_coef.ra);
+    const __m256i rb    = comp_coef_avx2(comp_coef.rb);
+    const __m256i ga    = comp_coef_avx2(comp_coef.ga);
+    const __m256i gb    = comp_coef_avx2(comp_coef.gb);
+    const __m256i ba    = comp_coef_avx2(comp_coef.ba);
+    const __m256i bb    = comp_coef_avx2(comp_coef.bb);
+    int           x;
+
+    /* Whole blocks of 8 keep the phase of every lane the same. */
+    for (x = 0; (x + 8) <= w; x += 8) {
+        __m256i t0 = _mm256_loadu_si256((const __m256i *) &t[x]);
+        __m256i c  = _mm256_add_epi32(t0, t0);
+        __m256i d  = _mm256_add_epi32(_mm256_loadu_si256((const __m256i *) &t[x - 1]), _mm256_loadu_si256((const __m256i *) &t[x + 1]));
+        __m256i y  = _mm256_add_epi32(_mm256_slli_epi32(_mm256_add_epi32(c, d), 8), _mm256_mullo_epi32(sharp, _mm256_sub_epi32(c, d)));
+        __m256i out;
+
+        if (mono)
+            out = _mm256_mullo_epi32(comp_clamp_avx2(y), _mm256_set1_epi32(0x10101));
+        else {
+            __m256i a  = _mm256_loadu_si256((const __m256i *) &ap[x]);
+            __m256i b  = _mm256_loadu_si256((const __m256i *) &bp[x]);
+            __m256i rr = _mm256_add_epi32(y, _mm256_add_epi32(_mm256_mullo_epi32(ra, a), _mm256_mullo_epi32(rb, b)));
+            __m256i gg = _mm256_add_epi32(y, _mm256_add_epi32(_mm256_mullo_epi32(ga, a), _mm256_mullo_epi32(gb, b)));
+            __m256i bl = _mm256_add_epi32(y, _mm256_add_epi32(_mm256_mullo_epi32(ba, a), _mm256_mullo_epi32(bb, b)));
+
+            out = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(comp_clamp_avx2(rr), 16), _mm256_slli_epi32(comp_clamp_avx2(gg), 8)),
+                                  comp_clamp_avx2(bl));
+        }
+
+        _mm256_storeu_si256((__m256i *) &srgb[x], out);
+    }
+
+    comp_decode_c(&srgb[x], &t[x], &ap[x], &bp[x], w - x, mono);
+}
+#endif
+
+static void
+comp_coef_update(void)
+{
+    /* I and Q of the four phases, as multiples of the chroma pair (a, b). */
+    static const int ia[4] = { 1, 0, -1, 0 };
+    static const int ib[4] = { 0, -1, 0, 1 };
+    static const int qa[4] = { 0, 1, 0, -1 };
+    static const int qb[4] = { 1, 0, -1, 0 };
+
+    comp_coef.sharpness = video_sharpness;
+    for (uint8_t x = 0; x < 4; x++) {
+        comp_coef.ra[x] = (int) video_ri * ia[x] + (int) video_rq * qa[x];
+        comp_coef.rb[x] = (int) video_ri * ib[x] + (int) video_rq * qb[x];
+        comp_coef.ga[x] = (int) video_gi * ia[x] + (int) video_gq * qa[x];
+        comp_coef.gb[x] = (int) video_gi * ib[x] + (int) video_gq * qb[x];
+        comp_coef.ba[x] = (int) video_bi * ia[x] + (int) video_bq * qa[x];
+        comp_coef.bb[x] = (int) video_bi * ib[x] + (int) video_bq * qb[x];
+    }
+
+    comp_gen++;
+
+#ifdef USE_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        comp_decode = comp_decode_avx2;
+#endif
+}
+
 uint32_t *
 Composite_Process(uint8_t cgamode, uint8_t border, uint32_t blocks /*, bool doublewidth*/, uint32_t *TempLine)
 {
-    uint32_t x2;
-
-    int w = blocks * 4;
+    int w    = blocks * 4;
+    int mono = (cgamode & 4) != 0;
 
     int            *o;
     const uint32_t *rgbi;
     const int      *b;
     int            *i;
-    uint32_t       *srgb;
     int            *ap;
     int            *bp;
-
-#define COMPOSITE_CONVERT(I, Q)                                                  \
-    do {                                                                         \
-        i[1] = (i[1] << 3) - ap[1];                                              \
-        a    = ap[0];                                                            \
-        b    = bp[0];                                                            \
-        c    = i[0] + i[0];                                                      \
-        d    = i[-1] + i[1];                                                     \
-        y    = ((c + d) << 8) + video_sharpness * (c - d);                       \
-        rr   = y + video_ri * (I) + video_rq * (Q);                              \
-        gg   = y + video_gi * (I) + video_gq * (Q);                              \
-        bb   = y + video_bi * (I) + video_bq * (Q);                              \
-        ++i;                                                                     \
-        ++ap;                                                                    \
-        ++bp;                                                                    \
-        *srgb = (byte_clamp(rr) << 16) | (byte_clamp(gg) << 8) | byte_clamp(bb); \
-        ++srgb;                                                                  \
-    } while (0)
+    comp_line_t    *line = NULL;
+    uint32_t        hash = 2166136261u;
 
 #define OUT(v)    \
     do {          \
@@ -225,6 +359,20 @@ Composite_Process(uint8_t cgamode, uint8_t border, uint32_t blocks /*, bool doub
         ++o;      \
     } while (0)
 
+    if (w <= SCALER_MAXWIDTH) {
+        for (int x = 0; x < w; ++x) {
+            comp_in[x] = TempLine[x] & 0x0f;
+            hash       = (hash ^ comp_in[x]) * 16777619u;
+        }
+        hash = (hash ^ border ^ (mono << 4)) * 16777619u;
+
+        line = &comp_cache[(hash ^ (hash >> 16)) % COMP_CACHE_LINES];
+        if ((line->gen == comp_gen) && (line->w == w) && (line->border == border) && (line->mono == mono) && !memcmp(line->in, comp_in, w)) {
+            memcpy(TempLine, line->out, w * sizeof(uint32_t));
+            return TempLine;
+        }
+    }
+
     /* Simulate CGA composite output */
     o    = temp;
     rgbi = TempLine;
@@ -240,52 +388,35 @@ Composite_Process(uint8_t cgamode, uint8_t border, uint32_t blocks /*, bool doub
     for (uint8_t x = 0; x < 5; ++x)
         OUT(b[x & 3]);
 
-    if ((cgamode & 4) != 0) {
-        /* Decode */
-        i    = temp + 5;
-        srgb = TempLine;
-        for (x2 = 0; x2 < blocks * 4; ++x2) {
-            int c = (i[0] + i[0]) << 3;
-            int d = (i[-1] + i[1]) << 3;
-            int y = ((c + d) << 8) + video_sharpness * (c - d);
-            ++i;
-            *srgb = byte_clamp(y) * 0x10101;
-            ++srgb;
-        }
+    ap = atemp + 1;
+    bp = btemp + 1;
+    i  = temp + 5;
+    if (mono) {
+        for (int x = -1; x < w + 1; ++x)
+            i[x] <<= 3;
     } else {
         /* Store chroma */
-        i  = temp + 4;
-        ap = atemp + 1;
-        bp = btemp + 1;
         for (int x = -1; x < w + 1; ++x) {
-            ap[x] = i[-4] - ((i[-2] - i[0] + i[2]) << 1) + i[4];
-            bp[x] = (i[-3] - i[-1] + i[1] - i[3]) << 1;
-            ++i;
-        }
-
-        /* Decode */
-        i     = temp + 5;
-        i[-1] = (i[-1] << 3) - ap[-1];
-        i[0]  = (i[0] << 3) - ap[0];
-        srgb  = TempLine;
-        for (x2 = 0; x2 < blocks; ++x2) {
-            int y;
-            int a;
-            int b;
-            int c;
-            int d;
-            int rr;
-            int gg;
-            int bb;
-            COMPOSITE_CONVERT(a, b);
-            COMPOSITE_CONVERT(-b, a);
-            COMPOSITE_CONVERT(-a, -b);
-            COMPOSITE_CONVERT(b, -a);
+            ap[x] = i[x - 4] - ((i[x - 2] - i[x] + i[x + 2]) << 1) + i[x + 4];
+            bp[x] = (i[x - 3] - i[x - 1] + i[x + 1] - i[x + 3]) << 1;
         }
+        for (int x = -1; x < w + 1; ++x)
+            i[x] = (i[x] << 3) - ap[x];
     }
-#undef COMPOSITE_CONVERT
+
+    /* Decode */
+    comp_decode(TempLine, i, ap, bp, w, mono);
 #undef OUT
 
+    if (line != NULL) {
+        line->gen    = comp_gen;
+        line->w      = w;
+        line->border = border;
+        line->mono   = mono;
+        memcpy(line->in, comp_in, w);
+        memcpy(line->out, TempLine, w * sizeof(uint32_t));
+    }
+
     return TempLine;
 }
 
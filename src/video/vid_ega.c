@@ -429,6 +429,9 @@ ega_recalctimings(ega_t *ega)
     double disptime;
     double crtcconst;
 
+    /* The font may have been written in a mode that does not watch for it. */
+    ega->glyph_cache->valid = 0;
+
     ega->vtotal     = ega->crtc[6];
     ega->dispend    = ega->crtc[0x12];
     ega->vsyncstart = ega->crtc[0x10];
@@ -718,7 +721,7 @@ ega_poll(void *priv)
             old_ma = ega->ma;
             ega->displine *= ega->vres + 1;
             ega->y_add *= ega->vres + 1;
-            for (y = 0; y <= ega->vres; y++) {
+            for (y = 0; !ega->frame_skip && (y <= ega->vres); y++) {
                 /* Render scanline */
                 ega->render(ega);
 
@@ -860,6 +863,8 @@ ega_poll(void *priv)
             ega->firstline_draw = 2000;
             ega->lastline_draw  = 0;
 
+            ega->frame_skip = video_frame_skip();
+
             ega->oddeven ^= 1;
 
             changeframecount = ega->interlace ? 3 : 2;
@@ -956,7 +961,7 @@ ega_doblit(int wx, int wy, ega_t *ega)
             video_force_resize_set(0);
     }
 
-    if ((wx >= 160) && ((wy + 1) >= 120)) {
+    if (!ega->frame_skip && (wx >= 160) && ((wy + 1) >= 120)) {
         /* Draw (overscan_size - scroll size) lines of overscan on top and bottom. */
         for (i = 0; i < ega->y_add; i++) {
             p = &buffer32->line[i & 0x7ff][0];
@@ -1055,12 +1060,13 @@ ega_remap_cpu_addr(uint32_t inaddr, ega_t *ega)
 void
 ega_write(uint32_t addr, uint8_t val, void *priv)
 {
-    ega_t  *ega = (ega_t *) priv;
-    uint8_t vala;
-    uint8_t valb;
-    uint8_t valc;
-    uint8_t vald;
-    int     writemask2 = ega->writemask;
+    ega_t    *ega        = (ega_t *) priv;
+    int       writemask2 = ega->writemask;
+    uint32_t *vram;
+    uint32_t  wmask;
+    uint32_t  bitmask;
+    uint32_t  setreset;
+    uint32_t  vall;
 
     cycles -= video_timing_write_b;
 
@@ -1080,171 +1086,67 @@ ega_write(uint32_t addr, uint8_t val, void *priv)
     if (!(ega->gdcreg[6] & 1))
         ega->fullchange = 2;
 
+    /* The font is in plane 2. */
+    if (writemask2 & 4)
+        ega->glyph_cache->valid = 0;
+
+    /* All four planes are worked out at once, byte n being plane n. */
+    vram    = (uint32_t *) &ega->vram[addr];
+    wmask   = video_plane_mask[writemask2 & 0xf];
+    bitmask = (uint32_t) ega->gdcreg[8] * 0x01010101;
+
     switch (ega->writemode) {
         case 1:
-            if (writemask2 & 1)
-                ega->vram[addr] = ega->la;
-            if (writemask2 & 2)
-                ega->vram[addr | 0x1] = ega->lb;
-            if (writemask2 & 4)
-                ega->vram[addr | 0x2] = ega->lc;
-            if (writemask2 & 8)
-                ega->vram[addr | 0x3] = ega->ld;
-            break;
+            *vram = (*vram & ~wmask) | (ega->latch & wmask);
+            return;
         case 0:
             if (ega->gdcreg[3] & 7)
                 val = ega_rotate[ega->gdcreg[3] & 7][val];
 
+            vall = (uint32_t) val * 0x01010101;
             if ((ega->gdcreg[8] == 0xff) && !(ega->gdcreg[3] & 0x18) && !ega->gdcreg[1]) {
-                if (writemask2 & 1)
-                    ega->vram[addr] = val;
-                if (writemask2 & 2)
-                    ega->vram[addr | 0x1] = val;
-                if (writemask2 & 4)
-                    ega->vram[addr | 0x2] = val;
-                if (writemask2 & 8)
-                    ega->vram[addr | 0x3] = val;
-            } else {
-                if (ega->gdcreg[1] & 1)
-                    vala = (ega->gdcreg[0] & 1) ? 0xff : 0;
-                else
-                    vala = val;
-                if (ega->gdcreg[1] & 2)
-                    valb = (ega->gdcreg[0] & 2) ? 0xff : 0;
-                else
-                    valb = val;
-                if (ega->gdcreg[1] & 4)
-                    valc = (ega->gdcreg[0] & 4) ? 0xff : 0;
-                else
-                    valc = val;
-                if (ega->gdcreg[1] & 8)
-                    vald = (ega->gdcreg[0] & 8) ? 0xff : 0;
-                else
-                    vald = val;
-                switch (ega->gdcreg[3] & 0x18) {
-                    case 0: /*Set*/
-                        if (writemask2 & 1)
-                            ega->vram[addr] = (vala & ega->gdcreg[8]) | (ega->la & ~ega->gdcreg[8]);
-                        if (writemask2 & 2)
-                            ega->vram[addr | 0x1] = (valb & ega->gdcreg[8]) | (ega->lb & ~ega->gdcreg[8]);
-                        if (writemask2 & 4)
-                            ega->vram[addr | 0x2] = (valc & ega->gdcreg[8]) | (ega->lc & ~ega->gdcreg[8]);
-                        if (writemask2 & 8)
-                            ega->vram[addr | 0x3] = (vald & ega->gdcreg[8]) | (ega->ld & ~ega->gdcreg[8]);
-                        break;
-                    case 8: /*AND*/
-                        if (writemask2 & 1)
-                            ega->vram[addr] = (vala | ~ega->gdcreg[8]) & ega->la;
-                        if (writemask2 & 2)
-                            ega->vram[addr | 0x1] = (valb | ~ega->gdcreg[8]) & ega->lb;
-                        if (writemask2 & 4)
-                            ega->vram[addr | 0x2] = (valc | ~ega->gdcreg[8]) & ega->lc;
-                        if (writemask2 & 8)
-                            ega->vram[addr | 0x3] = (vald | ~ega->gdcreg[8]) & ega->ld;
-                        break;
-                    case 0x10: /*OR*/
-                        if (writemask2 & 1)
-                            ega->vram[addr] = (vala & ega->gdcreg[8]) | ega->la;
-                        if (writemask2 & 2)
-                            ega->vram[addr | 0x1] = (valb & ega->gdcreg[8]) | ega->lb;
-                        if (writemask2 & 4)
-                            ega->vram[addr | 0x2] = (valc & ega->gdcreg[8]) | ega->lc;
-                        if (writemask2 & 8)
-                            ega->vram[addr | 0x3] = (vald & ega->gdcreg[8]) | ega->ld;
-                        break;
-                    case 0x18: /*XOR*/
-                        if (writemask2 & 1)
-                            ega->vram[addr] = (vala & ega->gdcreg[8]) ^ ega->la;
-                        if (writemask2 & 2)
-                            ega->vram[addr | 0x1] = (valb & ega->gdcreg[8]) ^ ega->lb;
-                        if (writemask2 & 4)
-                            ega->vram[addr | 0x2] = (valc & ega->gdcreg[8]) ^ ega->lc;
-                        if (writemask2 & 8)
-                            ega->vram[addr | 0x3] = (vald & ega->gdcreg[8]) ^ ega->ld;
-                        break;
-
-                    default:
-                        break;
-                }
+                *vram = (*vram & ~wmask) | (vall & wmask);
+                return;
             }
+
+            setreset = video_plane_mask[ega->gdcreg[1] & 0xf];
+            vall     = (vall & ~setreset) | (video_plane_mask[ega->gdcreg[0] & 0xf] & setreset);
             break;
         case 2:
-            if (!(ega->gdcreg[3] & 0x18) && !ega->gdcreg[1]) {
-                if (writemask2 & 1)
-                    ega->vram[addr] = (((val & 1) ? 0xff : 0) & ega->gdcreg[8]) | (ega->la & ~ega->gdcreg[8]);
-                if (writemask2 & 2)
-                    ega->vram[addr | 0x1] = (((val & 2) ? 0xff : 0) & ega->gdcreg[8]) | (ega->lb & ~ega->gdcreg[8]);
-                if (writemask2 & 4)
-                    ega->vram[addr | 0x2] = (((val & 4) ? 0xff : 0) & ega->gdcreg[8]) | (ega->lc & ~ega->gdcreg[8]);
-                if (writemask2 & 8)
-                    ega->vram[addr | 0x3] = (((val & 8) ? 0xff : 0) & ega->gdcreg[8]) | (ega->ld & ~ega->gdcreg[8]);
-            } else {
-                vala = ((val & 1) ? 0xff : 0);
-                valb = ((val & 2) ? 0xff : 0);
-                valc = ((val & 4) ? 0xff : 0);
-                vald = ((val & 8) ? 0xff : 0);
-                switch (ega->gdcreg[3] & 0x18) {
-                    case 0: /*Set*/
-                        if (writemask2 & 1)
-                            ega->vram[addr] = (vala & ega->gdcreg[8]) | (ega->la & ~ega->gdcreg[8]);
-                        if (writemask2 & 2)
-                            ega->vram[addr | 0x1] = (valb & ega->gdcreg[8]) | (ega->lb & ~ega->gdcreg[8]);
-                        if (writemask2 & 4)
-                            ega->vram[addr | 0x2] = (valc & ega->gdcreg[8]) | (ega->lc & ~ega->gdcreg[8]);
-                        if (writemask2 & 8)
-                            ega->vram[addr | 0x3] = (vald & ega->gdcreg[8]) | (ega->ld & ~ega->gdcreg[8]);
-                        break;
-                    case 8: /*AND*/
-                        if (writemask2 & 1)
-                            ega->vram[addr] = (vala | ~ega->gdcreg[8]) & ega->la;
-                        if (writemask2 & 2)
-                            ega->vram[addr | 0x1] = (valb | ~ega->gdcreg[8]) & ega->lb;
-                        if (writemask2 & 4)
-                            ega->vram[addr | 0x2] = (valc | ~ega->gdcreg[8]) & ega->lc;
-                        if (writemask2 & 8)
-                            ega->vram[addr | 0x3] = (vald | ~ega->gdcreg[8]) & ega->ld;
-                        break;
-                    case 0x10: /*OR*/
-                        if (writemask2 & 1)
-                            ega->vram[addr] = (vala & ega->gdcreg[8]) | ega->la;
-                        if (writemask2 & 2)
-                            ega->vram[addr | 0x1] = (valb & ega->gdcreg[8]) | ega->lb;
-                        if (writemask2 & 4)
-                            ega->vram[addr | 0x2] = (valc & ega->gdcreg[8]) | ega->lc;
-                        if (writemask2 & 8)
-                            ega->vram[addr | 0x3] = (vald & ega->gdcreg[8]) | ega->ld;
-                        break;
-                    case 0x18: /*XOR*/
-                        if (writemask2 & 1)
-                            ega->vram[addr] = (vala & ega->gdcreg[8]) ^ ega->la;
-                        if (writemask2 & 2)
-                            ega->vram[addr | 0x1] = (valb & ega->gdcreg[8]) ^ ega->lb;
-                        if (writemask2 & 4)
-                            ega->vram[addr | 0x2] = (valc & ega->gdcreg[8]) ^ ega->lc;
-                        if (writemask2 & 8)
-                            ega->vram[addr | 0x3] = (vald & ega->gdcreg[8]) ^ ega->ld;
-                        break;
+            vall = video_plane_mask[val & 0xf];
+            break;
 
-                    default:
-                        break;
-                }
-            }
+        default:
+            return;
+    }
+
+    switch (ega->gdcreg[3] & 0x18) {
+        case 0: /*Set*/
+            vall = (vall & bitmask) | (ega->latch & ~bitmask);
+            break;
+        case 8: /*AND*/
+            vall = (vall | ~bitmask) & ega->latch;
+            break;
+        case 0x10: /*OR*/
+            vall = (vall & bitmask) | ega->latch;
+            break;
+        case 0x18: /*XOR*/
+            vall = (vall & bitmask) ^ ega->latch;
             break;
 
         default:
             break;
     }
+
+    *vram = (*vram & ~wmask) | (vall & wmask);
 }
 
 uint8_t
 ega_read(uint32_t addr, void *priv)
 {
-    ega_t  *ega = (ega_t *) priv;
-    uint8_t temp;
-    uint8_t temp2;
-    uint8_t temp3;
-    uint8_t temp4;
-    int     readplane = ega->readplane;
+    ega_t   *ega       = (ega_t *) priv;
+    uint32_t temp;
+    int      readplane = ega->readplane;
 
     cycles -= video_timing_read_b;
 
@@ -1259,24 +1161,13 @@ ega_read(uint32_t addr, void *priv)
     if (addr >= ega->vram_limit)
         return 0xff;
 
-    ega->la = ega->vram[addr];
-    ega->lb = ega->vram[addr | 0x1];
-    ega->lc = ega->vram[addr | 0x2];
-    ega->ld = ega->vram[addr | 0x3];
+    ega->latch = *(uint32_t *) &ega->vram[addr];
     if (ega->readmode) {
-        temp = ega->la;
-        temp ^= (ega->colourcompare & 1) ? 0xff : 0;
-        temp &= (ega->colournocare & 1) ? 0xff : 0;
-        temp2 = ega->lb;
-        temp2 ^= (ega->colourcompare & 2) ? 0xff : 0;
-        temp2 &= (ega->colournocare & 2) ? 0xff : 0;
-        temp3 = ega->lc;
-        temp3 ^= (ega->colourcompare & 4) ? 0xff : 0;
-        temp3 &= (ega->colournocare & 4) ? 0xff : 0;
-        temp4 = ega->ld;
-        temp4 ^= (ega->colourcompare & 8) ? 0xff : 0;
-        temp4 &= (ega->colournocare & 8) ? 0xff : 0;
-        return ~(temp | temp2 | temp3 | temp4);
+        /* A pixel matches unless a plane that is cared about differs. */
+        temp = (ega->latch ^ video_plane_mask[ega->colourcompare & 0xf]) & video_plane_mask[ega->colournocare & 0xf];
+        temp |= temp >> 16;
+        temp |= temp >> 8;
+        return ~temp & 0xff;
     }
     return ega->vram[addr | readplane];
 }
@@ -1288,8 +1179,9 @@ ega_init(ega_t *ega, int monitor_type, int is_mono)
     int d;
     int e;
 
-    ega->vram     = malloc(0x40000);
-    ega->vrammask = 0x3ffff;
+    ega->vram        = malloc(0x40000);
+    ega->vrammask    = 0x3ffff;
+    ega->glyph_cache = video_glyph_cache_init();
 
     for (c = 0; c < 256; c++) {
         e = c;
@@ -1526,6 +1418,7 @@ ega_close(void *priv)
 
     if (ega->eeprom)
         free(ega->eeprom);
+    video_glyph_cache_close(ega->glyph_cache);
     free(ega->vram);
     free(ega);
 }
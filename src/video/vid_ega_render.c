@@ -125,6 +125,13 @@ ega_render_text(ega_t *ega)
         const int  charwidth     = dotwidth * (seq9dot ? 9 : 8);
         const bool blinked       = ega->blink & 0x10;
         uint32_t  *p             = &buffer32->line[ega->displine + ega->y_add][ega->x_add];
+        uint32_t   col[16];
+
+        for (int c = 0; c < 16; c++)
+            col[c] = ega->pallook[ega->egapal[c]];
+
+        video_glyph_cache_begin(ega->glyph_cache, col, ega->charseta, ega->charsetb,
+                                (seq9dot ? GLYPH_9DOT : 0) | (attrlinechars ? GLYPH_LINECHARS : 0) | (attrblink ? GLYPH_BLINK : 0));
 
         /* Compensate for 8dot scroll */
         if (!seq9dot) {
@@ -147,36 +154,31 @@ ega_render_text(ega_t *ega)
             } else
                 chr = attr = 0;
 
-            uint32_t charaddr;
-            if (attr & 8)
-                charaddr = ega->charsetb + (chr * 0x80);
-            else
-                charaddr = ega->charseta + (chr * 0x80);
-
-            int fg;
-            int bg;
             if (drawcursor) {
-                bg = ega->pallook[ega->egapal[attr & 0x0f]];
-                fg = ega->pallook[ega->egapal[attr >> 4]];
+                /* Colours swapped and no blinking, so not from the cache. */
+                const uint32_t  charaddr = ((attr & 8) ? ega->charsetb : ega->charseta) + (chr * 0x80);
+                const uint8_t   dat      = ega->vram[charaddr + (ega->sc << 2)];
+                const uint32_t  fg       = col[attr >> 4];
+                const uint32_t  bg       = col[attr & 0x0f];
+                const uint32_t *mask     = video_glyph_mask[dat];
+
+                for (int xx = 0; xx < (dotwidth << 3); xx++)
+                    p[xx] = bg ^ (mask[xx >> dwshift] & (fg ^ bg));
+
+                /* The ninth dot repeats the eighth for the line drawing characters. */
+                if (seq9dot) {
+                    const uint32_t ninth = ((chr & ~0x1F) == 0xC0 && attrlinechars && (dat & 1)) ? fg : bg;
+
+                    for (int xx = (dotwidth << 3); xx < charwidth; xx++)
+                        p[xx] = ninth;
+                }
             } else {
-                fg = ega->pallook[ega->egapal[attr & 0x0f]];
-                bg = ega->pallook[ega->egapal[attr >> 4]];
+                const uint32_t *row = video_glyph_cache_row(ega->glyph_cache, ega->vram, chr, attr, ega->sc, blinked);
 
-                if ((attr & 0x80) && attrblink) {
-                    bg = ega->pallook[ega->egapal[(attr >> 4) & 7]];
-                    if (blinked)
-                        fg = bg;
-                }
+                for (int xx = 0; xx < charwidth; xx++)
+                    p[xx] = row[xx >> dwshift];
             }
 
-            uint32_t dat = ega->vram[charaddr + (ega->sc << 2)];
-            dat <<= 1;
-            if ((chr & ~0x1F) == 0xC0 && attrlinechars)
-                dat |= (dat >> 1) & 1;
-
-            for (int xx = 0; xx < charwidth; xx++)
-                p[xx] = (dat & (0x100 >> (xx >> dwshift))) ? fg : bg;
-
             ega->ma += 4;
             p += charwidth;
         }
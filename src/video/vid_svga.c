@@ -37,6 +37,7 @@
 #include <86box/mem.h>
 #include <86box/rom.h>
 #include <86box/plat.h>
+#include <86box/savestate.h>
 #include <86box/ui.h>
 #include <86box/video.h>
 #include <86box/vid_8514a.h>
@@ -86,6 +87,9 @@ svga_get_pri(void)
 void
 svga_set_override(svga_t *svga, int val)
 {
+    /* Whatever takes over draws into the same lines. */
+    svga_render_worker_sync(svga);
+
     if (svga->override && !val)
         svga->fullchange = svga->monitor->mon_changeframecount;
     svga->override = val;
@@ -194,8 +198,11 @@ svga_out(uint16_t addr, uint8_t val, void *priv)
                         svga_recalctimings(svga);
                 } else if (svga->attraddr == 0x11) {
                     svga->overscan_color = svga->pallook[svga->attrregs[0x11]];
-                    if (o != val)
+                    if (o != val) {
+                        /* The border is part of every line. */
+                        svga->fullchange = svga->monitor->mon_changeframecount;
                         svga_recalctimings(svga);
+                    }
                 } else if (svga->attraddr == 0x12) {
                     if ((val & 0xf) != svga->plane_mask)
                         svga->fullchange = svga->monitor->mon_changeframecount;
@@ -581,6 +588,9 @@ svga_recalctimings(svga_t *svga)
     int              hsyncend;
 #endif
 
+    /* The font may have been written in a mode that does not watch for it. */
+    svga->glyph_cache->valid = 0;
+
     svga->vtotal      = svga->crtc[6];
     svga->dispend     = svga->crtc[0x12];
     svga->vsyncstart  = svga->crtc[0x10];
@@ -864,22 +874,71 @@ svga_recalctimings(svga_t *svga)
     }
 }
 
+/* For when someone else sends the frames, none of which may then be dropped. */
+static void
+svga_frame_skip_off(svga_t *svga)
+{
+    svga->frame_skip              = 0;
+    svga->monitor->mon_skip_frame = 0;
+    svga->monitor->mon_skip_run   = 0;
+}
+
+/* Keeps the cursor and overlay line counts going on lines that are not drawn. */
+static void
+svga_skip_render(svga_t *svga)
+{
+    if (svga->overlay_on) {
+        svga->overlay_on--;
+        if (svga->overlay_on && svga->interlace)
+            svga->overlay_on--;
+    }
+
+    if (svga->dac_hwcursor_on) {
+        svga->dac_hwcursor_on--;
+        if (svga->dac_hwcursor_on && svga->interlace)
+            svga->dac_hwcursor_on--;
+    }
+
+    if (svga->hwcursor_on) {
+        svga->hwcursor_on--;
+        if (svga->hwcursor_on && svga->interlace)
+            svga->hwcursor_on--;
+    }
+}
+
 static void
 svga_do_render(svga_t *svga)
 {
+    int drawn;
+
+    if (svga->frame_skip) {
+        svga_skip_render(svga);
+        return;
+    }
+
     /* Always render a blank screen and nothing else while in DPMS mode. */
     if (svga->dpms) {
         svga_render_blank(svga);
+        if (video_dirty_lines)
+            video_dirty_line_monitor(svga->displine + svga->y_add, svga->monitor_index);
         return;
     }
 
     if (!svga->override) {
         svga->render(svga);
 
-        svga->x_add = (svga->monitor->mon_overscan_x >> 1);
-        svga_render_overscan_left(svga);
-        svga_render_overscan_right(svga);
-        svga->x_add = (svga->monitor->mon_overscan_x >> 1) - svga->scrollcache;
+        /* The renderers only touch lastline_draw on lines they actually drew. */
+        drawn = (svga->firstline_draw != 2000) && (svga->lastline_draw == svga->displine);
+
+        if (!video_dirty_lines || drawn) {
+            svga->x_add = (svga->monitor->mon_overscan_x >> 1);
+            svga_render_overscan_left(svga);
+            svga_render_overscan_right(svga);
+            svga->x_add = (svga->monitor->mon_overscan_x >> 1) - svga->scrollcache;
+        }
+
+        if (video_dirty_lines && drawn)
+            video_dirty_line_monitor(svga->displine + svga->y_add, svga->monitor_index);
     }
 
     if (svga->overlay_on) {
@@ -922,11 +981,15 @@ svga_poll(void *priv)
 
     if (!svga->override) {
         if (ibm8514_active && dev && (dev->on[0] || dev->on[1])) {
+            svga_render_worker_sync(svga);
+            svga_frame_skip_off(svga);
             ibm8514_poll(dev, svga);
             return;
         }
         if (xga_active && xga && xga->on) {
             if ((xga->disp_cntl_2 & 7) >= 2) {
+                svga_render_worker_sync(svga);
+                svga_frame_skip_off(svga);
                 xga_poll(xga, svga);
                 return;
             }
@@ -1093,12 +1156,15 @@ svga_poll(void *priv)
 
             svga->blink = (svga->blink + 1) & 0x7f;
 
-            for (x = 0; x < ((svga->vram_mask + 1) >> 12); x++) {
-                if (svga->changedvram[x])
-                    svga->changedvram[x]--;
+            /* Changes stay pending through frames that were not drawn. */
+            if (!svga->frame_skip) {
+                for (x = 0; x < ((svga->vram_mask + 1) >> 12); x++) {
+                    if (svga->changedvram[x])
+                        svga->changedvram[x]--;
+                }
+                if (svga->fullchange)
+                    svga->fullchange--;
             }
-            if (svga->fullchange)
-                svga->fullchange--;
         }
         if (svga->vc == svga->vsyncstart) {
             svga->dispon = 0;
@@ -1128,6 +1194,12 @@ svga_poll(void *priv)
             svga->firstline_draw = 2000;
             svga->lastline_draw  = 0;
 
+            /* Cards drawing over the top send frames of their own. */
+            if (svga->override)
+                svga_frame_skip_off(svga);
+            else
+                svga->frame_skip = video_frame_skip_monitor(svga->monitor_index);
+
             svga->oddeven ^= 1;
 
             svga->monitor->mon_changeframecount = svga->interlace ? 3 : 2;
@@ -1238,6 +1310,7 @@ svga_init(const device_t *info, svga_t *svga, void *priv, int memsize,
     svga->vram_display_mask = svga->vram_mask = memsize - 1;
     svga->decode_mask                         = 0x7fffff;
     svga->changedvram                         = calloc(memsize >> 12, 1);
+    svga->glyph_cache                         = video_glyph_cache_init();
     svga->recalctimings_ex                    = recalctimings_ex;
     svga->video_in                            = video_in;
     svga->video_out                           = video_out;
@@ -1245,6 +1318,9 @@ svga_init(const device_t *info, svga_t *svga, void *priv, int memsize,
     svga->overlay_draw                        = overlay_draw;
     svga->conv_16to32                         = svga_conv_16to32;
 
+    svga_render_simd_init();
+    svga_render_worker_init(svga);
+
     svga->hwcursor.cur_xsize = svga->hwcursor.cur_ysize = 32;
 
     svga->dac_hwcursor.cur_xsize = svga->dac_hwcursor.cur_ysize = 32;
@@ -1283,9 +1359,130 @@ svga_init(const device_t *info, svga_t *svga, void *priv, int memsize,
     return 0;
 }
 
+/* Helpers for the snapshot hooks of SVGA-based cards. Card-specific extended
+   registers are up to the card itself, the rest is derived again from the
+   registers stored here. */
+void
+svga_save(svga_t *svga, savestate_t *state)
+{
+    savestate_write(state, svga->crtc, sizeof(svga->crtc));
+    savestate_write(state, svga->gdcreg, sizeof(svga->gdcreg));
+    savestate_write(state, svga->attrregs, sizeof(svga->attrregs));
+    savestate_write(state, svga->seqregs, sizeof(svga->seqregs));
+    savestate_write(state, svga->egapal, sizeof(svga->egapal));
+    savestate_write(state, svga->vgapal, sizeof(svga->vgapal));
+    savestate_write(state, svga->pallook, sizeof(svga->pallook));
+    savestate_write(state, &svga->latch, sizeof(svga->latch));
+
+    savestate_write_u8(state, svga->crtcreg);
+    savestate_write_u8(state, svga->gdcaddr);
+    savestate_write_u8(state, svga->attrff);
+    savestate_write_u8(state, svga->attr_palette_enable);
+    savestate_write_u8(state, svga->attraddr);
+    savestate_write_u8(state, svga->seqaddr);
+    savestate_write_u8(state, svga->miscout);
+    savestate_write_u8(state, svga->plane_mask);
+    savestate_write_u8(state, svga->writemask);
+    savestate_write_u8(state, svga->colourcompare);
+    savestate_write_u8(state, svga->colournocare);
+    savestate_write_u8(state, svga->dac_mask);
+    savestate_write_u8(state, svga->dac_status);
+    savestate_write_u8(state, svga->chain4);
+    savestate_write_u8(state, svga->chain2_write);
+    savestate_write_u8(state, svga->chain2_read);
+    savestate_write_u8(state, svga->fast);
+    savestate_write_u8(state, svga->readmode);
+    savestate_write_u8(state, svga->writemode);
+    savestate_write_u8(state, svga->readplane);
+    savestate_write_u8(state, svga->set_reset_disabled);
+    savestate_write_u8(state, svga->fcr);
+
+    savestate_write_u32(state, svga->dac_addr);
+    savestate_write_u32(state, svga->dac_pos);
+    savestate_write_u32(state, svga->dac_r);
+    savestate_write_u32(state, svga->dac_g);
+    savestate_write_u32(state, svga->dac_b);
+    savestate_write_u32(state, svga->write_bank);
+    savestate_write_u32(state, svga->read_bank);
+    savestate_write_u32(state, svga->extra_banks[0]);
+    savestate_write_u32(state, svga->extra_banks[1]);
+    savestate_write_u32(state, svga->banked_mask);
+    savestate_write_u32(state, svga->charseta);
+    savestate_write_u32(state, svga->charsetb);
+
+    savestate_write_timer(state, &svga->timer);
+
+    savestate_write_u32(state, svga->vram_max);
+    savestate_write(state, svga->vram, svga->vram_max);
+}
+
+int
+svga_load(svga_t *svga, savestate_t *state)
+{
+    savestate_read(state, svga->crtc, sizeof(svga->crtc));
+    savestate_read(state, svga->gdcreg, sizeof(svga->gdcreg));
+    savestate_read(state, svga->attrregs, sizeof(svga->attrregs));
+    savestate_read(state, svga->seqregs, sizeof(svga->seqregs));
+    savestate_read(state, svga->egapal, sizeof(svga->egapal));
+    savestate_read(state, svga->vgapal, sizeof(svga->vgapal));
+    savestate_read(state, svga->pallook, sizeof(svga->pallook));
+    savestate_read(state, &svga->latch, sizeof(svga->latch));
+
+    svga->crtcreg             = savestate_read_u8(state);
+    svga->gdcaddr             = savestate_read_u8(state);
+    svga->attrff              = savestate_read_u8(state);
+    svga->attr_palette_enable = savestate_read_u8(state);
+    svga->attraddr            = savestate_read_u8(state);
+    svga->seqaddr             = savestate_read_u8(state);
+    svga->miscout             = savestate_read_u8(state);
+    svga->plane_mask          = savestate_read_u8(state);
+    svga->writemask           = savestate_read_u8(state);
+    svga->colourcompare       = savestate_read_u8(state);
+    svga->colournocare        = savestate_read_u8(state);
+    svga->dac_mask            = savestate_read_u8(state);
+    svga->dac_status          = savestate_read_u8(state);
+    svga->chain4              = savestate_read_u8(state);
+    svga->chain2_write        = savestate_read_u8(state);
+    svga->chain2_read         = savestate_read_u8(state);
+    svga->fast                = savestate_read_u8(state);
+    svga->readmode            = savestate_read_u8(state);
+    svga->writemode           = savestate_read_u8(state);
+    svga->readplane           = savestate_read_u8(state);
+    svga->set_reset_disabled  = savestate_read_u8(state);
+    svga->fcr                 = savestate_read_u8(state);
+
+    svga->dac_addr       = savestate_read_u32(state);
+    svga->dac_pos        = savestate_read_u32(state);
+    svga->dac_r          = savestate_read_u32(state);
+    svga->dac_g          = savestate_read_u32(state);
+    svga->dac_b          = savestate_read_u32(state);
+    svga->write_bank     = savestate_read_u32(state);
+    svga->read_bank      = savestate_read_u32(state);
+    svga->extra_banks[0] = savestate_read_u32(state);
+    svga->extra_banks[1] = savestate_read_u32(state);
+    svga->banked_mask    = savestate_read_u32(state);
+    svga->charseta       = savestate_read_u32(state);
+    svga->charsetb       = savestate_read_u32(state);
+
+    savestate_read_timer(state, &svga->timer);
+
+    if (savestate_read_u32(state) != svga->vram_max)
+        return 1;
+    savestate_read(state, svga->vram, svga->vram_max);
+
+    svga_recalctimings(svga);
+    memset(svga->changedvram, 0x02, svga->vram_max >> 12);
+    svga->fullchange = svga->monitor->mon_changeframecount;
+
+    return 0;
+}
+
 void
 svga_close(svga_t *svga)
 {
+    svga_render_worker_close(svga);
+
+    video_glyph_cache_close(svga->glyph_cache);
     free(svga->changedvram);
     free(svga->vram);
 
@@ -1336,6 +1533,76 @@ svga_decode_addr(svga_t *svga, uint32_t addr, int write)
     return addr;
 }
 
+/*
+   Write modes 0 to 3 on the usual four planes, all of them worked out
+   at once with byte n of each value being plane n.
+ */
+static void
+svga_write_planes(svga_t *svga, uint32_t addr, uint8_t val, int writemask2)
+{
+    uint32_t *vram     = (uint32_t *) &svga->vram[addr];
+    uint32_t  wmask    = video_plane_mask[writemask2 & 0xf];
+    uint32_t  bitmask  = (uint32_t) svga->gdcreg[8] * 0x01010101;
+    uint32_t  latch    = svga->latch.d[0];
+    uint32_t  setreset = video_plane_mask[svga->gdcreg[1] & 0xf];
+    uint32_t  vall;
+
+    switch (svga->writemode) {
+        case 0:
+            val  = ((val >> (svga->gdcreg[3] & 7)) | (val << (8 - (svga->gdcreg[3] & 7))));
+            vall = (uint32_t) val * 0x01010101;
+            if ((svga->gdcreg[8] == 0xff) && !(svga->gdcreg[3] & 0x18) && (!svga->gdcreg[1] || svga->set_reset_disabled)) {
+                *vram = (*vram & ~wmask) | (vall & wmask);
+                return;
+            }
+            vall = (vall & ~setreset) | (video_plane_mask[svga->gdcreg[0] & 0xf] & setreset);
+            break;
+        case 1:
+            *vram = (*vram & ~wmask) | (latch & wmask);
+            return;
+        case 2:
+            vall = video_plane_mask[val & 0xf];
+            break;
+
+        default:
+            val  = ((val >> (svga->gdcreg[3] & 7)) | (val << (8 - (svga->gdcreg[3] & 7))));
+            vall = video_plane_mask[svga->gdcreg[0] & 0xf];
+            bitmask &= (uint32_t) val * 0x01010101;
+            break;
+    }
+
+    switch (svga->gdcreg[3] & 0x18) {
+        case 0x00: /* Set */
+            vall = (vall & bitmask) | (latch & ~bitmask);
+            break;
+        case 0x08: /* AND */
+            vall = (vall | ~bitmask) & latch;
+            break;
+        case 0x10: /* OR */
+            vall = (vall & bitmask) | latch;
+            break;
+        case 0x18: /* XOR */
+            vall = (vall & bitmask) ^ latch;
+            break;
+
+        default:
+            break;
+    }
+
+    *vram = (*vram & ~wmask) | (vall & wmask);
+}
+
+static void
+svga_latch_fill(svga_t *svga, uint32_t latch_addr, uint8_t count)
+{
+    if ((count == 4) && !(latch_addr & 3))
+        svga->latch.d[0] = *(uint32_t *) &svga->vram[latch_addr];
+    else {
+        for (uint8_t i = 0; i < count; i++)
+            svga->latch.b[i] = svga->vram[latch_addr | i];
+    }
+}
+
 static __inline void
 svga_write_common(uint32_t addr, uint8_t val, uint8_t linear, void *priv)
 {
@@ -1430,10 +1697,19 @@ svga_write_common(uint32_t addr, uint8_t val, uint8_t linear, void *priv)
 
     svga->changedvram[addr >> 12] = svga->monitor->mon_changeframecount;
 
+    /* The font is in plane 2. */
+    if (writemask2 & 4)
+        svga->glyph_cache->valid = 0;
+
     count = 4;
     if (svga->adv_flags & FLAG_LATCH8)
         count = 8;
 
+    if ((count == 4) && (svga->writemode < 4) && !(addr & 3) && !((svga->adv_flags & FLAG_EXT_WRITE) && (svga->adv_flags & FLAG_ADDR_BY8))) {
+        svga_write_planes(svga, addr, val, writemask2);
+        return;
+    }
+
     /* Undocumented Cirrus Logic behavior: The datasheet says that, with EXT_WRITE and FLAG_ADDR_BY8, the write mask only
        changes meaning in write modes 4 and 5, as well as write mode 1. In reality, however, all other write modes are also
        affected, as proven by the Windows 3.1 CL-GD 5422/4 drivers in 8bpp modes. */
@@ -1564,6 +1840,7 @@ svga_read_common(uint32_t addr, uint8_t linear, void *priv)
     svga_t  *svga       = (svga_t *) priv;
     xga_t   *xga        = (xga_t *) svga->xga;
     uint32_t latch_addr = 0;
+    uint32_t diff;
     int      readplane  = svga->readplane;
     uint8_t  count;
     uint8_t  temp;
@@ -1632,8 +1909,7 @@ svga_read_common(uint32_t addr, uint8_t linear, void *priv)
         if (addr >= svga->vram_max)
             return 0xff;
         latch_addr = (addr & svga->vram_mask) & ~3;
-        for (uint8_t i = 0; i < count; i++)
-            svga->latch.b[i] = svga->vram[latch_addr | i];
+        svga_latch_fill(svga, latch_addr, count);
         return svga->vram[addr & svga->vram_mask];
     } else if (svga->chain4 && !svga->force_old_addr) {
         readplane = addr & 3;
@@ -1658,9 +1934,7 @@ svga_read_common(uint32_t addr, uint8_t linear, void *priv)
             svga->latch.b[i] = 0xff;
     } else {
         latch_addr &= svga->vram_mask;
-
-        for (uint8_t i = 0; i < count; i++)
-            svga->latch.b[i] = svga->vram[latch_addr | i];
+        svga_latch_fill(svga, latch_addr, count);
     }
 
     if (addr >= svga->vram_max)
@@ -1668,7 +1942,13 @@ svga_read_common(uint32_t addr, uint8_t linear, void *priv)
 
     addr &= svga->vram_mask;
 
-    if (svga->readmode) {
+    if (svga->readmode && (count == 4)) {
+        /* A pixel matches unless a plane that is cared about differs. */
+        diff = (svga->latch.d[0] ^ video_plane_mask[svga->colourcompare & 0xf]) & video_plane_mask[svga->colournocare & 0xf];
+        diff |= diff >> 16;
+        diff |= diff >> 8;
+        ret = ~diff & 0xff;
+    } else if (svga->readmode) {
         temp = 0xff;
 
         for (uint8_t pixel = 0; pixel < 8; pixel++) {
@@ -1726,6 +2006,9 @@ svga_doblit(int wx, int wy, svga_t *svga)
     int       xs_temp;
     int       ys_temp;
 
+    /* The frame has to be complete before it goes anywhere. */
+    svga_render_worker_sync(svga);
+
     y_add   = enable_overscan ? svga->monitor->mon_overscan_y : 0;
     x_add   = enable_overscan ? svga->monitor->mon_overscan_x : 0;
     y_start = enable_overscan ? 0 : (svga->monitor->mon_overscan_y >> 1);
@@ -1774,9 +2057,15 @@ svga_doblit(int wx, int wy, svga_t *svga)
 
         if (video_force_resize_get_monitor(svga->monitor_index))
             video_force_resize_set_monitor(0, svga->monitor_index);
+
+        video_dirty_all_monitor(svga->monitor_index);
     }
 
-    if ((wx >= 160) && ((wy + 1) >= 120)) {
+    /* Also covers the top and bottom borders, which are redrawn below. */
+    if (svga->fullchange)
+        video_dirty_all_monitor(svga->monitor_index);
+
+    if (!svga->frame_skip && (wx >= 160) && ((wy + 1) >= 120)) {
         /* Draw (overscan_size - scroll size) lines of overscan on top and bottom. */
         for (i = 0; i < svga->y_add; i++) {
             p = &svga->monitor->target_buffer->line[i & 0x7ff][0];
@@ -1793,7 +2082,10 @@ svga_doblit(int wx, int wy, svga_t *svga)
         }
     }
 
-    video_blit_memtoscreen_monitor(x_start, y_start, svga->monitor->mon_xsize + x_add, svga->monitor->mon_ysize + y_add, svga->monitor_index);
+    if (video_dirty_lines)
+        video_blit_dirty_memtoscreen_monitor(x_start, y_start, svga->monitor->mon_xsize + x_add, svga->monitor->mon_ysize + y_add, svga->monitor_index);
+    else
+        video_blit_memtoscreen_monitor(x_start, y_start, svga->monitor->mon_xsize + x_add, svga->monitor->mon_ysize + y_add, svga->monitor_index);
 
     if (svga->vertical_linedbl)
         svga->vertical_linedbl >>= 1;
@@ -44,6 +44,74 @@ svga_lookup_lut_ram(svga_t* svga, uint32_t val)
 
 #define lookup_lut(val) svga_lookup_lut_ram(svga, val)
 
+/*
+   Whether the next bytes of the line can go through the vectorised
+   line converters: linear addressing, and no wraparound within them.
+ */
+static inline bool
+svga_render_is_linear(const svga_t *svga, uint32_t bytes)
+{
+    return !svga->remap_required && ((svga->ma + bytes) <= (svga->vram_display_mask + 1));
+}
+
+/* Draws one row of a text mode glyph, without the ninth column. */
+static inline void
+svga_render_glyph_row(uint32_t *p, uint8_t dat, uint32_t fg, uint32_t bg, int dotwidth)
+{
+    const uint32_t *mask = video_glyph_mask[dat];
+    const uint32_t  diff = fg ^ bg;
+    uint32_t        row[8];
+
+    /* Built in a local first so the compiler does not have to assume p aliases the mask table. */
+    for (int xx = 0; xx < 8; xx++)
+        row[xx] = bg ^ (mask[xx] & diff);
+
+    if (dotwidth == 2) {
+        for (int xx = 0; xx < 8; xx++)
+            p[xx << 1] = p[(xx << 1) + 1] = row[xx];
+    } else
+        memcpy(p, row, sizeof(row));
+}
+
+/* The colours of the 16 text attributes for the current line, which the
+   cached glyph rows are checked against. */
+static void
+svga_render_text_begin(svga_t *svga, uint32_t *col)
+{
+    int flags = 0;
+
+    for (int c = 0; c < 16; c++)
+        col[c] = svga->pallook[svga->egapal[c]];
+
+    if (!(svga->seqregs[1] & 1))
+        flags |= GLYPH_9DOT;
+    if (svga->attrregs[0x10] & 4)
+        flags |= GLYPH_LINECHARS;
+    if (svga->attrregs[0x10] & 8)
+        flags |= GLYPH_BLINK;
+
+    video_glyph_cache_begin(svga->glyph_cache, col, svga->charseta, svga->charsetb, flags);
+}
+
+/* Draws the cell under the cursor, which has its colours swapped and does
+   not blink, so it does not go through the cache. */
+static void
+svga_render_text_cursor(const svga_t *svga, uint32_t *p, uint8_t chr, uint8_t attr, const uint32_t *col, int dotwidth)
+{
+    const uint32_t charaddr = ((attr & 8) ? svga->charsetb : svga->charseta) + (chr * 128);
+    const uint8_t  dat      = svga->vram[charaddr + (svga->sc << 2)];
+    const uint32_t fg       = col[attr >> 4];
+    const uint32_t bg       = col[attr & 15];
+
+    svga_render_glyph_row(p, dat, fg, bg, dotwidth);
+    if (!(svga->seqregs[1] & 1)) {
+        const uint32_t ninth = ((chr & ~0x1f) == 0xc0 && (svga->attrregs[0x10] & 4) && (dat & 1)) ? fg : bg;
+
+        for (int xx = (dotwidth << 3); xx < (dotwidth * 9); xx++)
+            p[xx] = ninth;
+    }
+}
+
 void
 svga_render_null(svga_t *svga)
 {
@@ -111,8 +179,7 @@ svga_render_overscan_left(svga_t *svga)
         return;
 
     uint32_t *line_ptr = svga->monitor->target_buffer->line[svga->displine + svga->y_add];
-    for (int i = 0; i < svga->x_add; i++)
-        *line_ptr++ = svga->overscan_color;
+    svga_render_fill(svga, line_ptr, svga->overscan_color, svga->x_add);
 }
 
 void
@@ -128,35 +195,34 @@ svga_render_overscan_right(svga_t *svga)
 
     uint32_t *line_ptr = &svga->monitor->target_buffer->line[svga->displine + svga->y_add][svga->x_add + svga->hdisp];
     right              = (overscan_x >> 1);
-    for (int i = 0; i < right; i++)
-        *line_ptr++ = svga->overscan_color;
+    svga_render_fill(svga, line_ptr, svga->overscan_color, right);
 }
 
 void
 svga_render_text_40(svga_t *svga)
 {
     uint32_t *p;
-    int       xx;
     int       drawcursor;
     int       xinc;
+    int       blinked;
     uint8_t   chr;
     uint8_t   attr;
-    uint8_t   dat;
-    uint32_t  charaddr;
-    int       fg;
-    int       bg;
+    uint32_t  col[16];
     uint32_t  addr = 0;
 
     if ((svga->displine + svga->y_add) < 0)
         return;
 
-    if (svga->firstline_draw == 2000)
-        svga->firstline_draw = svga->displine;
-    svga->lastline_draw = svga->displine;
-
     if (svga->fullchange) {
-        p    = &svga->monitor->target_buffer->line[svga->displine + svga->y_add][svga->x_add];
-        xinc = (svga->seqregs[1] & 1) ? 16 : 18;
+        if (svga->firstline_draw == 2000)
+            svga->firstline_draw = svga->displine;
+        svga->lastline_draw = svga->displine;
+
+        p       = &svga->monitor->target_buffer->line[svga->displine + svga->y_add][svga->x_add];
+        xinc    = (svga->seqregs[1] & 1) ? 16 : 18;
+        blinked = !!(svga->blink & 16);
+
+        svga_render_text_begin(svga, col);
 
         for (int x = 0; x < (svga->hdisp + svga->scrollcache); x += xinc) {
             if (!svga->force_old_addr)
@@ -172,36 +238,13 @@ svga_render_text_40(svga_t *svga)
                 attr = svga->vram[addr + 1];
             }
 
-            if (attr & 8)
-                charaddr = svga->charsetb + (chr * 128);
-            else
-                charaddr = svga->charseta + (chr * 128);
-
             if (drawcursor) {
-                bg = svga->pallook[svga->egapal[attr & 15]];
-                fg = svga->pallook[svga->egapal[attr >> 4]];
+                svga_render_text_cursor(svga, p, chr, attr, col, 2);
             } else {
-                fg = svga->pallook[svga->egapal[attr & 15]];
-                bg = svga->pallook[svga->egapal[attr >> 4]];
-
-                if (attr & 0x80 && svga->attrregs[0x10] & 8) {
-                    bg = svga->pallook[svga->egapal[(attr >> 4) & 7]];
-                    if (svga->blink & 16)
-                        fg = bg;
-                }
-            }
+                const uint32_t *row = video_glyph_cache_row(svga->glyph_cache, svga->vram, chr, attr, svga->sc, blinked);
 
-            dat = svga->vram[charaddr + (svga->sc << 2)];
-            if (svga->seqregs[1] & 1) {
-                for (xx = 0; xx < 16; xx += 2)
-                    p[xx] = p[xx + 1] = (dat & (0x80 >> (xx >> 1))) ? fg : bg;
-            } else {
-                for (xx = 0; xx < 16; xx += 2)
-                    p[xx] = p[xx + 1] = (dat & (0x80 >> (xx >> 1))) ? fg : bg;
-                if ((chr & ~0x1f) != 0xc0 || !(svga->attrregs[0x10] & 4))
-                    p[16] = p[17] = bg;
-                else
-                    p[16] = p[17] = (dat & 1) ? fg : bg;
+                for (int xx = 0; xx < (xinc >> 1); xx++)
+                    p[xx << 1] = p[(xx << 1) + 1] = row[xx];
             }
             svga->ma += 4;
             p += xinc;
@@ -214,27 +257,27 @@ void
 svga_render_text_80(svga_t *svga)
 {
     uint32_t *p;
-    int       xx;
     int       drawcursor;
     int       xinc;
+    int       blinked;
     uint8_t   chr;
     uint8_t   attr;
-    uint8_t   dat;
-    uint32_t  charaddr;
-    int       fg;
-    int       bg;
+    uint32_t  col[16];
     uint32_t  addr = 0;
 
     if ((svga->displine + svga->y_add) < 0)
         return;
 
-    if (svga->firstline_draw == 2000)
-        svga->firstline_draw = svga->displine;
-    svga->lastline_draw = svga->displine;
-
     if (svga->fullchange) {
-        p    = &svga->monitor->target_buffer->line[svga->displine + svga->y_add][svga->x_add];
-        xinc = (svga->seqregs[1] & 1) ? 8 : 9;
+        if (svga->firstline_draw == 2000)
+            svga->firstline_draw = svga->displine;
+        svga->lastline_draw = svga->displine;
+
+        p       = &svga->monitor->target_buffer->line[svga->displine + svga->y_add][svga->x_add];
+        xinc    = (svga->seqregs[1] & 1) ? 8 : 9;
+        blinked = !!(svga->blink & 16);
+
+        svga_render_text_begin(svga, col);
 
         for (int x = 0; x < (svga->hdisp + svga->scrollcache); x += xinc) {
             if (!svga->force_old_addr)
@@ -250,35 +293,16 @@ svga_render_text_80(svga_t *svga)
                 attr = svga->vram[addr + 1];
             }
 
-            if (attr & 8)
-                charaddr = svga->charsetb + (chr * 128);
-            else
-                charaddr = svga->charseta + (chr * 128);
+            if (drawcursor)
+                svga_render_text_cursor(svga, p, chr, attr, col, 1);
+            else {
+                const uint32_t *row = video_glyph_cache_row(svga->glyph_cache, svga->vram, chr, attr, svga->sc, blinked);
 
-            if (drawcursor) {
-                bg = svga->pallook[svga->egapal[attr & 15]];
-                fg = svga->pallook[svga->egapal[attr >> 4]];
-            } else {
-                fg = svga->pallook[svga->egapal[attr & 15]];
-                bg = svga->pallook[svga->egapal[attr >> 4]];
-                if (attr & 0x80 && svga->attrregs[0x10] & 8) {
-                    bg = svga->pallook[svga->egapal[(attr >> 4) & 7]];
-                    if (svga->blink & 16)
-                        fg = bg;
-                }
-            }
-
-            dat = svga->vram[charaddr + (svga->sc << 2)];
-            if (svga->seqregs[1] & 1) {
-                for (xx = 0; xx < 8; xx++)
-                    p[xx] = (dat & (0x80 >> xx)) ? fg : bg;
-            } else {
-                for (xx = 0; xx < 8; xx++)
-                    p[xx] = (dat & (0x80 >> xx)) ? fg : bg;
-                if ((chr & ~0x1F) != 0xC0 || !(svga->attrregs[0x10] & 4))
-                    p[8] = bg;
+                /* Sizes known up front, so the copies are done inline. */
+                if (xinc == 9)
+                    memcpy(p, row, 9 * sizeof(uint32_t));
                 else
-                    p[8] = (dat & 1) ? fg : bg;
+                    memcpy(p, row, 8 * sizeof(uint32_t));
             }
             svga->ma += 4;
             p += xinc;
@@ -306,11 +330,11 @@ svga_render_text_80_ksc5601(svga_t *svga)
     if ((svga->displine + svga->y_add) < 0)
         return;
 
-    if (svga->firstline_draw == 2000)
-        svga->firstline_draw = svga->displine;
-    svga->lastline_draw = svga->displine;
-
     if (svga->fullchange) {
+        if (svga->firstline_draw == 2000)
+            svga->firstline_draw = svga->displine;
+        svga->lastline_draw = svga->displine;
+
         p = &svga->monitor->target_buffer->line[svga->displine + svga->y_add][svga->x_add];
 
         xinc = (svga->seqregs[1] & 1) ? 8 : 9;
@@ -551,6 +575,21 @@ svga_render_indexed_gfx(svga_t *svga, bool highres, bool combine8bits)
         svga->firstline_draw = svga->displine;
     svga->lastline_draw = svga->displine;
 
+    /*
+       Packed 8bpp with all planes enabled and nothing blinking boils down
+       to a palette lookup of consecutive bytes.
+     */
+    if (highres8bpp && !svga->force_old_addr && !svga->ati_4color && !svga->packed_4bpp &&
+        (incevery == 1) && (loadevery == 1) && (planemask == 0xffffffff) && !attrblink) {
+        x = ((svga->hdisp + svga->scrollcache) & ~3) + 4;
+
+        if (svga_render_is_linear(svga, x)) {
+            svga_render_line(svga, p, 8, svga->map8, x);
+            svga->ma = (svga->ma + x) & svga->vram_display_mask;
+            return;
+        }
+    }
+
     uint32_t incr_counter = 0;
     uint32_t load_counter = 0;
     uint32_t edat         = 0;
@@ -1178,7 +1217,12 @@ svga_render_15bpp_highres(svga_t *svga)
                 svga->firstline_draw = svga->displine;
             svga->lastline_draw = svga->displine;
 
-            if (!svga->remap_required) {
+            x = ((svga->hdisp + svga->scrollcache) & ~7) + 8;
+
+            if (svga_render_is_linear(svga, x << 1) && (svga->conv_16to32 == svga_conv_16to32)) {
+                svga_render_line(svga, p, 15, NULL, x);
+                svga->ma += x << 1;
+            } else if (!svga->remap_required) {
                 for (x = 0; x <= (svga->hdisp + svga->scrollcache); x += 8) {
                     dat  = *(uint32_t *) (&svga->vram[(svga->ma + (x << 1)) & svga->vram_display_mask]);
                     *p++ = svga->conv_16to32(svga, dat & 0xffff, 15);
@@ -1410,7 +1454,12 @@ svga_render_16bpp_highres(svga_t *svga)
                 svga->firstline_draw = svga->displine;
             svga->lastline_draw = svga->displine;
 
-            if (!svga->remap_required) {
+            x = ((svga->hdisp + svga->scrollcache) & ~7) + 8;
+
+            if (svga_render_is_linear(svga, x << 1) && (svga->conv_16to32 == svga_conv_16to32)) {
+                svga_render_line(svga, p, 16, NULL, x);
+                svga->ma += x << 1;
+            } else if (!svga->remap_required) {
                 for (x = 0; x <= (svga->hdisp + svga->scrollcache); x += 8) {
                     dat  = *(uint32_t *) (&svga->vram[(svga->ma + (x << 1)) & svga->vram_display_mask]);
                     *p++ = svga->conv_16to32(svga, dat & 0xffff, 16);
@@ -1571,7 +1620,12 @@ svga_render_24bpp_highres(svga_t *svga)
                 svga->firstline_draw = svga->displine;
             svga->lastline_draw = svga->displine;
 
-            if (!svga->remap_required) {
+            x = ((svga->hdisp + svga->scrollcache) & ~3) + 4;
+
+            if (svga_render_is_linear(svga, x * 3) && !svga->lut_map) {
+                svga_render_line(svga, p, 24, NULL, x);
+                svga->ma += x * 3;
+            } else if (!svga->remap_required) {
                 for (x = 0; x <= (svga->hdisp + svga->scrollcache); x += 4) {
                     dat0 = *(uint32_t *) (&svga->vram[svga->ma & svga->vram_display_mask]);
                     dat1 = *(uint32_t *) (&svga->vram[(svga->ma + 4) & svga->vram_display_mask]);
@@ -1699,7 +1753,12 @@ svga_render_32bpp_highres(svga_t *svga)
                 svga->firstline_draw = svga->displine;
             svga->lastline_draw = svga->displine;
 
-            if (!svga->remap_required) {
+            x = svga->hdisp + svga->scrollcache + 1;
+
+            if (svga_render_is_linear(svga, x << 2) && !svga->lut_map) {
+                svga_render_line(svga, p, 32, NULL, x);
+                svga->ma += x << 2;
+            } else if (!svga->remap_required) {
                 for (x = 0; x <= (svga->hdisp + svga->scrollcache); x++) {
                     dat  = *(uint32_t *) (&svga->vram[(svga->ma + (x << 2)) & svga->vram_display_mask]);
                     *p++ = lookup_lut(dat & 0xffffff);
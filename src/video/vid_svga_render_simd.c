@@ -0,0 +1,344 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Vectorised scanline converters for the packed-pixel SVGA
+ *          renderers.
+ *
+ *          These only handle the common case of a line that is laid
+ *          out linearly in video memory and does not wrap around the
+ *          end of it; the renderers fall back to their own loops for
+ *          everything else. The best implementation for the host CPU
+ *          is picked once, the first time an SVGA card is initialised.
+ *
+ *          The 15/16bpp converters compute the same values as the
+ *          video_15to32[] and video_16to32[] tables (floor(c * 255 /
+ *          31) and floor(c * 255 / 63)) through a fixed-point multiply,
+ *          which is exact for all 5 and 6-bit inputs.
+ *
+ *
+ *
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <wchar.h>
+#include <86box/86box.h>
+#include <86box/device.h>
+#include <86box/mem.h>
+#include <86box/timer.h>
+#include <86box/video.h>
+#include <86box/vid_svga.h>
+#include <86box/vid_svga_render.h>
+
+#if (defined __amd64__ || defined _M_X64 || defined __SSE2__ || (defined _M_IX86_FP && _M_IX86_FP >= 2))
+#    define USE_SSE2
+#    include <emmintrin.h>
+#    if defined __GNUC__
+#        define USE_AVX2
+#        include <immintrin.h>
+#    endif
+#elif (defined __aarch64__ || defined _M_ARM64)
+#    define USE_NEON
+#    include <arm_neon.h>
+#endif
+
+void (*svga_render_line_8bpp)(uint32_t *p, const uint8_t *src, const uint32_t *pal, int pixels);
+void (*svga_render_line_15bpp)(uint32_t *p, const uint8_t *src, int pixels);
+void (*svga_render_line_16bpp)(uint32_t *p, const uint8_t *src, int pixels);
+void (*svga_render_line_24bpp)(uint32_t *p, const uint8_t *src, int pixels);
+void (*svga_render_line_32bpp)(uint32_t *p, const uint8_t *src, int pixels);
+
+static uint16_t
+read_16(const uint8_t *src)
+{
+    uint16_t ret;
+
+    memcpy(&ret, src, 2);
+    return ret;
+}
+
+static uint32_t
+read_32(const uint8_t *src)
+{
+    uint32_t ret;
+
+    memcpy(&ret, src, 4);
+    return ret;
+}
+
+static void
+line_8bpp_c(uint32_t *p, const uint8_t *src, const uint32_t *pal, int pixels)
+{
+    for (int x = 0; x < pixels; x++)
+        p[x] = pal[src[x]];
+}
+
+static void
+line_15bpp_c(uint32_t *p, const uint8_t *src, int pixels)
+{
+    for (int x = 0; x < pixels; x++)
+        p[x] = video_15to32[read_16(&src[x << 1])];
+}
+
+static void
+line_16bpp_c(uint32_t *p, const uint8_t *src, int pixels)
+{
+    for (int x = 0; x < pixels; x++)
+        p[x] = video_16to32[read_16(&src[x << 1])];
+}
+
+static void
+line_24bpp_c(uint32_t *p, const uint8_t *src, int pixels)
+{
+    for (int x = 0; x < pixels; x++)
+        p[x] = src[x * 3] | (src[x * 3 + 1] << 8) | (src[x * 3 + 2] << 16);
+}
+
+static void
+line_32bpp_c(uint32_t *p, const uint8_t *src, int pixels)
+{
+    for (int x = 0; x < pixels; x++)
+        p[x] = read_32(&src[x << 2]) & 0xffffff;
+}
+
+#ifdef USE_SSE2
+/* Expand eight 15 or 16-bit pixels to 32 bits. */
+static inline void
+conv_16to32_sse2(uint32_t *p, __m128i c, int bpp)
+{
+    const __m128i m5 = _mm_set1_epi16(0x1f);
+    const __m128i k5 = _mm_set1_epi16((short) 33693);
+    __m128i       b;
+    __m128i       g;
+    __m128i       r;
+
+    b = _mm_mulhi_epu16(_mm_slli_epi16(_mm_and_si128(c, m5), 4), k5);
+    if (bpp == 15) {
+        g = _mm_mulhi_epu16(_mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(c, 5), m5), 4), k5);
+        r = _mm_mulhi_epu16(_mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(c, 10), m5), 4), k5);
+    } else {
+        g = _mm_mulhi_epu16(_mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(c, 5), _mm_set1_epi16(0x3f)), 3),
+                            _mm_set1_epi16((short) 33159));
+        r = _mm_mulhi_epu16(_mm_slli_epi16(_mm_srli_epi16(c, 11), 4), k5);
+    }
+    b = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+
+    _mm_storeu_si128((__m128i *) p, _mm_unpacklo_epi16(b, r));
+    _mm_storeu_si128((__m128i *) (p + 4), _mm_unpackhi_epi16(b, r));
+}
+
+static void
+line_15bpp_sse2(uint32_t *p, const uint8_t *src, int pixels)
+{
+    int x;
+
+    for (x = 0; x <= (pixels - 8); x += 8)
+        conv_16to32_sse2(&p[x], _mm_loadu_si128((const __m128i *) &src[x << 1]), 15);
+
+    line_15bpp_c(&p[x], &src[x << 1], pixels - x);
+}
+
+static void
+line_16bpp_sse2(uint32_t *p, const uint8_t *src, int pixels)
+{
+    int x;
+
+    for (x = 0; x <= (pixels - 8); x += 8)
+        conv_16to32_sse2(&p[x], _mm_loadu_si128((const __m128i *) &src[x << 1]), 16);
+
+    line_16bpp_c(&p[x], &src[x << 1], pixels - x);
+}
+
+static void
+line_32bpp_sse2(uint32_t *p, const uint8_t *src, int pixels)
+{
+    const __m128i mask = _mm_set1_epi32(0xffffff);
+    int           x;
+
+    for (x = 0; x <= (pixels - 4); x += 4)
+        _mm_storeu_si128((__m128i *) &p[x], _mm_and_si128(_mm_loadu_si128((const __m128i *) &src[x << 2]), mask));
+
+    line_32bpp_c(&p[x], &src[x << 2], pixels - x);
+}
+#endif
+
+#ifdef USE_AVX2
+static inline __attribute__((target("avx2"))) void
+conv_16to32_avx2(uint32_t *p, __m256i c, int bpp)
+{
+    const __m256i m5 = _mm256_set1_epi16(0x1f);
+    const __m256i k5 = _mm256_set1_epi16((short) 33693);
+    __m256i       b;
+    __m256i       g;
+    __m256i       r;
+    __m256i       lo;
+    __m256i       hi;
+
+    b = _mm256_mulhi_epu16(_mm256_slli_epi16(_mm256_and_si256(c, m5), 4), k5);
+    if (bpp == 15) {
+        g = _mm256_mulhi_epu16(_mm256_slli_epi16(_mm256_and_si256(_mm256_srli_epi16(c, 5), m5), 4), k5);
+        r = _mm256_mulhi_epu16(_mm256_slli_epi16(_mm256_and_si256(_mm256_srli_epi16(c, 10), m5), 4), k5);
+    } else {
+        g = _mm256_mulhi_epu16(_mm256_slli_epi16(_mm256_and_si256(_mm256_srli_epi16(c, 5), _mm256_set1_epi16(0x3f)), 3),
+                               _mm256_set1_epi16((short) 33159));
+        r = _mm256_mulhi_epu16(_mm256_slli_epi16(_mm256_srli_epi16(c, 11), 4), k5);
+    }
+    b = _mm256_or_si256(b, _mm256_slli_epi16(g, 8));
+
+    /* The unpacks work within 128-bit lanes, so put the halves back in order. */
+    lo = _mm256_unpacklo_epi16(b, r);
+    hi = _mm256_unpackhi_epi16(b, r);
+    _mm256_storeu_si256((__m256i *) p, _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256((__m256i *) (p + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+static __attribute__((target("avx2"))) void
+line_8bpp_avx2(uint32_t *p, const uint8_t *src, const uint32_t *pal, int pixels)
+{
+    int x;
+
+    for (x = 0; x <= (pixels - 8); x += 8) {
+        __m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) &src[x]));
+        _mm256_storeu_si256((__m256i *) &p[x], _mm256_i32gather_epi32((const int *) pal, idx, 4));
+    }
+
+    line_8bpp_c(&p[x], &src[x], pal, pixels - x);
+}
+
+static __attribute__((target("avx2"))) void
+line_15bpp_avx2(uint32_t *p, const uint8_t *src, int pixels)
+{
+    int x;
+
+    for (x = 0; x <= (pixels - 16); x += 16)
+        conv_16to32_avx2(&p[x], _mm256_loadu_si256((const __m256i *) &src[x << 1]), 15);
+
+    line_15bpp_sse2(&p[x], &src[x << 1], pixels - x);
+}
+
+static __attribute__((target("avx2"))) void
+line_16bpp_avx2(uint32_t *p, const uint8_t *src, int pixels)
+{
+    int x;
+
+    for (x = 0; x <= (pixels - 16); x += 16)
+        conv_16to32_avx2(&p[x], _mm256_loadu_si256((const __m256i *) &src[x << 1]), 16);
+
+    line_16bpp_sse2(&p[x], &src[x << 1], pixels - x);
+}
+
+static __attribute__((target("ssse3"))) void
+line_24bpp_ssse3(uint32_t *p, const uint8_t *src, int pixels)
+{
+    const __m128i shuf = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    int           x;
+
+    /* Each load covers 16 bytes but only uses 12, so stop while the last one stays in the line. */
+    for (x = 0; x <= (pixels - 6); x += 4)
+        _mm_storeu_si128((__m128i *) &p[x], _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) &src[x * 3]), shuf));
+
+    line_24bpp_c(&p[x], &src[x * 3], pixels - x);
+}
+
+static __attribute__((target("avx2"))) void
+line_24bpp_avx2(uint32_t *p, const uint8_t *src, int pixels)
+{
+    const __m256i shuf = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                          0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    int           x;
+
+    for (x = 0; x <= (pixels - 10); x += 8) {
+        __m256i dat = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *) &src[x * 3])),
+                                              _mm_loadu_si128((const __m128i *) &src[x * 3 + 12]), 1);
+        _mm256_storeu_si256((__m256i *) &p[x], _mm256_shuffle_epi8(dat, shuf));
+    }
+
+    line_24bpp_ssse3(&p[x], &src[x * 3], pixels - x);
+}
+
+static __attribute__((target("avx2"))) void
+line_32bpp_avx2(uint32_t *p, const uint8_t *src, int pixels)
+{
+    const __m256i mask = _mm256_set1_epi32(0xffffff);
+    int           x;
+
+    for (x = 0; x <= (pixels - 8); x += 8)
+        _mm256_storeu_si256((__m256i *) &p[x], _mm256_and_si256(_mm256_loadu_si256((const __m256i *) &src[x << 2]), mask));
+
+    line_32bpp_sse2(&p[x], &src[x << 2], pixels - x);
+}
+#endif
+
+#ifdef USE_NEON
+static void
+line_24bpp_neon(uint32_t *p, const uint8_t *src, int pixels)
+{
+    int x;
+
+    for (x = 0; x <= (pixels - 16); x += 16) {
+        uint8x16x3_t in = vld3q_u8(&src[x * 3]);
+        uint8x16x4_t out;
+
+        out.val[0] = in.val[0];
+        out.val[1] = in.val[1];
+        out.val[2] = in.val[2];
+        out.val[3] = vdupq_n_u8(0);
+        vst4q_u8((uint8_t *) &p[x], out);
+    }
+
+    line_24bpp_c(&p[x], &src[x * 3], pixels - x);
+}
+
+static void
+line_32bpp_neon(uint32_t *p, const uint8_t *src, int pixels)
+{
+    const uint32x4_t mask = vdupq_n_u32(0xffffff);
+    int              x;
+
+    for (x = 0; x <= (pixels - 4); x += 4)
+        vst1q_u32(&p[x], vandq_u32(vreinterpretq_u32_u8(vld1q_u8(&src[x << 2])), mask));
+
+    line_32bpp_c(&p[x], &src[x << 2], pixels - x);
+}
+#endif
+
+void
+svga_render_simd_init(void)
+{
+    if (svga_render_line_8bpp)
+        return;
+
+    svga_render_line_8bpp  = line_8bpp_c;
+    svga_render_line_15bpp = line_15bpp_c;
+    svga_render_line_16bpp = line_16bpp_c;
+    svga_render_line_24bpp = line_24bpp_c;
+    svga_render_line_32bpp = line_32bpp_c;
+
+#ifdef USE_SSE2
+    svga_render_line_15bpp = line_15bpp_sse2;
+    svga_render_line_16bpp = line_16bpp_sse2;
+    svga_render_line_32bpp = line_32bpp_sse2;
+#endif
+#ifdef USE_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("ssse3"))
+        svga_render_line_24bpp = line_24bpp_ssse3;
+    if (__builtin_cpu_supports("avx2")) {
+        svga_render_line_8bpp  = line_8bpp_avx2;
+        svga_render_line_15bpp = line_15bpp_avx2;
+        svga_render_line_16bpp = line_16bpp_avx2;
+        svga_render_line_24bpp = line_24bpp_avx2;
+        svga_render_line_32bpp = line_32bpp_avx2;
+    }
+#endif
+#ifdef USE_NEON
+    svga_render_line_24bpp = line_24bpp_neon;
+    svga_render_line_32bpp = line_32bpp_neon;
+#endif
+}
@@ -0,0 +1,255 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Optional worker thread for the packed-pixel SVGA renderers.
+ *
+ *          When enabled, the lines that go through the converters in
+ *          vid_svga_render_simd.c are queued instead of being drawn on
+ *          the emulation thread. Each queued line carries a copy of the
+ *          video memory it shows and of the palette it uses, so the CPU
+ *          is free to change either while the worker catches up. Lines
+ *          that get a cursor or overlay drawn on top are still drawn
+ *          straight away, and the queue is drained before the frame is
+ *          handed to the blitter. The overscan borders of a queued line
+ *          are queued behind it, as the line can spill over them.
+ *
+ *
+ *
+ */
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#include <86box/86box.h>
+#include <86box/device.h>
+#include <86box/mem.h>
+#include <86box/timer.h>
+#include <86box/thread.h>
+#include <86box/video.h>
+#include <86box/vid_svga.h>
+#include <86box/vid_svga_render.h>
+
+#define JOBS_NUM   64
+#define JOBS_BATCH 32
+#define JOB_BYTES  (2048 * 4)
+
+typedef struct render_job_t {
+    int       bpp; /* 0 fills the pixels with color instead. */
+    int       pixels;
+    uint32_t *p;
+    uint32_t  color;
+    uint8_t   src[JOB_BYTES];
+} render_job_t;
+
+typedef struct svga_render_worker_t {
+    render_job_t jobs[JOBS_NUM];
+    atomic_int   head; /* Jobs queued, only advanced by the emulation. */
+    atomic_int   tail; /* Jobs done, only advanced by the worker. */
+
+    uint32_t pal[256]; /* Palette of the queued 8bpp lines. */
+    int      pal_valid;
+
+    volatile int thread_run;
+    thread_t    *thread;
+    event_t     *wake;
+    event_t     *done;
+} svga_render_worker_t;
+
+static void
+svga_render_line_bpp(uint32_t *p, const uint8_t *src, int bpp, const uint32_t *pal, int pixels)
+{
+    switch (bpp) {
+        case 8:
+            svga_render_line_8bpp(p, src, pal, pixels);
+            break;
+        case 15:
+            svga_render_line_15bpp(p, src, pixels);
+            break;
+        case 16:
+            svga_render_line_16bpp(p, src, pixels);
+            break;
+        case 24:
+            svga_render_line_24bpp(p, src, pixels);
+            break;
+
+        default:
+            svga_render_line_32bpp(p, src, pixels);
+            break;
+    }
+}
+
+static void
+svga_render_worker_thread(void *priv)
+{
+    svga_render_worker_t *worker = (svga_render_worker_t *) priv;
+    const render_job_t   *job;
+    int                   tail;
+
+    while (worker->thread_run) {
+        thread_wait_event(worker->wake, -1);
+        thread_reset_event(worker->wake);
+
+        tail = atomic_load(&worker->tail);
+        while (tail != atomic_load(&worker->head)) {
+            job = &worker->jobs[tail % JOBS_NUM];
+            if (job->bpp == 0) {
+                for (int x = 0; x < job->pixels; x++)
+                    job->p[x] = job->color;
+            } else
+                svga_render_line_bpp(job->p, job->src, job->bpp, worker->pal, job->pixels);
+            atomic_store(&worker->tail, ++tail);
+        }
+
+        thread_set_event(worker->done);
+    }
+}
+
+/* Waits until every queued line has been drawn. */
+void
+svga_render_worker_sync(svga_t *svga)
+{
+    svga_render_worker_t *worker = (svga_render_worker_t *) svga->render_worker;
+
+    if (worker == NULL)
+        return;
+
+    while (atomic_load(&worker->tail) != atomic_load(&worker->head)) {
+        thread_reset_event(worker->done);
+        if (atomic_load(&worker->tail) == atomic_load(&worker->head))
+            break;
+        thread_set_event(worker->wake);
+        thread_wait_event(worker->done, -1);
+    }
+}
+
+static int
+svga_render_worker_bytes(int bpp, int pixels)
+{
+    switch (bpp) {
+        case 8:
+            return pixels;
+        case 15:
+        case 16:
+            return pixels << 1;
+        case 24:
+            return pixels * 3;
+
+        default:
+            return pixels << 2;
+    }
+}
+
+/*
+   Draws a linearly laid out line of the given depth from svga->ma, or
+   queues it for the worker. The palette is only looked at for 8bpp.
+ */
+void
+svga_render_line(svga_t *svga, uint32_t *p, int bpp, const uint32_t *pal, int pixels)
+{
+    svga_render_worker_t *worker = (svga_render_worker_t *) svga->render_worker;
+    render_job_t         *job;
+    int                   bytes = svga_render_worker_bytes(bpp, pixels);
+    int                   head;
+
+    /* Cursors and overlays are drawn over the line as soon as it is done. */
+    if ((worker == NULL) || (bytes > JOB_BYTES) || svga->hwcursor_on || svga->dac_hwcursor_on || svga->overlay_on) {
+        svga_render_line_bpp(p, &svga->vram[svga->ma], bpp, pal, pixels);
+        return;
+    }
+
+    /* A palette change halfway through the frame waits for the lines using the old one. */
+    if ((bpp == 8) && (!worker->pal_valid || memcmp(worker->pal, pal, sizeof(worker->pal)))) {
+        svga_render_worker_sync(svga);
+        memcpy(worker->pal, pal, sizeof(worker->pal));
+        worker->pal_valid = 1;
+    }
+
+    head = atomic_load(&worker->head);
+    if ((head - atomic_load(&worker->tail)) == JOBS_NUM)
+        svga_render_worker_sync(svga);
+
+    job         = &worker->jobs[head % JOBS_NUM];
+    job->bpp    = bpp;
+    job->pixels = pixels;
+    job->p      = p;
+    memcpy(job->src, &svga->vram[svga->ma], bytes);
+
+    atomic_store(&worker->head, ++head);
+    if (!(head % JOBS_BATCH))
+        thread_set_event(worker->wake);
+}
+
+/* Fills part of a line with one colour, behind any line still queued. */
+void
+svga_render_fill(svga_t *svga, uint32_t *p, uint32_t color, int pixels)
+{
+    svga_render_worker_t *worker = (svga_render_worker_t *) svga->render_worker;
+    render_job_t         *job;
+    int                   head;
+
+    if ((worker == NULL) || (atomic_load(&worker->tail) == atomic_load(&worker->head))) {
+        for (int x = 0; x < pixels; x++)
+            p[x] = color;
+        return;
+    }
+
+    head = atomic_load(&worker->head);
+    if ((head - atomic_load(&worker->tail)) == JOBS_NUM)
+        svga_render_worker_sync(svga);
+
+    job         = &worker->jobs[head % JOBS_NUM];
+    job->bpp    = 0;
+    job->pixels = pixels;
+    job->p      = p;
+    job->color  = color;
+
+    atomic_store(&worker->head, ++head);
+    if (!(head % JOBS_BATCH))
+        thread_set_event(worker->wake);
+}
+
+void
+svga_render_worker_init(svga_t *svga)
+{
+    svga_render_worker_t *worker;
+
+    if (!video_render_thread)
+        return;
+
+    worker             = (svga_render_worker_t *) calloc(1, sizeof(svga_render_worker_t));
+    worker->thread_run = 1;
+    worker->wake       = thread_create_event();
+    worker->done       = thread_create_event();
+    worker->thread     = thread_create(svga_render_worker_thread, worker);
+
+    svga->render_worker = worker;
+}
+
+void
+svga_render_worker_close(svga_t *svga)
+{
+    svga_render_worker_t *worker = (svga_render_worker_t *) svga->render_worker;
+
+    if (worker == NULL)
+        return;
+
+    svga_render_worker_sync(svga);
+
+    worker->thread_run = 0;
+    thread_set_event(worker->wake);
+    thread_wait(worker->thread);
+
+    thread_destroy_event(worker->done);
+    thread_destroy_event(worker->wake);
+    free(worker);
+
+    svga->render_worker = NULL;
+}
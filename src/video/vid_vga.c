@@ -27,6 +27,7 @@
 #include <86box/rom.h>
 #include <86box/device.h>
 #include <86box/timer.h>
+#include <86box/savestate.h>
 #include <86box/video.h>
 #include <86box/vid_svga.h>
 #include <86box/vid_vga.h>
@@ -185,6 +186,22 @@ vga_force_redraw(void *priv)
     vga->svga.fullchange = changeframecount;
 }
 
+static void
+vga_save(void *priv, savestate_t *state)
+{
+    vga_t *vga = (vga_t *) priv;
+
+    svga_save(&vga->svga, state);
+}
+
+static int
+vga_load(void *priv, savestate_t *state)
+{
+    vga_t *vga = (vga_t *) priv;
+
+    return svga_load(&vga->svga, state);
+}
+
 const device_t vga_device = {
     .name          = "IBM VGA",
     .internal_name = "vga",
@@ -196,7 +213,9 @@ const device_t vga_device = {
     { .available = vga_available },
     .speed_changed = vga_speed_changed,
     .force_redraw  = vga_force_redraw,
-    .config        = NULL
+    .config        = NULL,
+    .save          = vga_save,
+    .load          = vga_load
 };
 
 const device_t ps1vga_device = {
@@ -210,7 +229,9 @@ const device_t ps1vga_device = {
     { .available = vga_available },
     .speed_changed = vga_speed_changed,
     .force_redraw  = vga_force_redraw,
-    .config        = NULL
+    .config        = NULL,
+    .save          = vga_save,
+    .load          = vga_load
 };
 
 const device_t ps1vga_mca_device = {
@@ -224,5 +245,7 @@ const device_t ps1vga_mca_device = {
     { .available = vga_available },
     .speed_changed = vga_speed_changed,
     .force_redraw  = vga_force_redraw,
-    .config        = NULL
+    .config        = NULL,
+    .save          = vga_save,
+    .load          = vga_load
 };
@@ -42,6 +42,7 @@
 #include <86box/vid_voodoo_regs.h>
 #include <86box/vid_voodoo_render.h>
 #include <86box/vid_voodoo_texture.h>
+#include <minitrace/minitrace.h>
 
 #ifdef ENABLE_VOODOO_FIFO_LOG
 int voodoo_fifo_do_log = ENABLE_VOODOO_FIFO_LOG;
@@ -206,11 +207,13 @@ voodoo_fifo_thread(void *param)
 {
     voodoo_t *voodoo = (voodoo_t *) param;
 
+    MTR_META_THREAD_NAME("Voodoo FIFO");
     while (voodoo->fifo_thread_run) {
         thread_set_event(voodoo->fifo_not_full_event);
         thread_wait_event(voodoo->wake_fifo_thread, -1);
         thread_reset_event(voodoo->wake_fifo_thread);
         voodoo->voodoo_busy = 1;
+        MTR_BEGIN("voodoo", "fifo");
         while (!FIFO_EMPTY) {
             uint64_t      start_time = plat_timer_read();
             uint64_t      end_time;
@@ -545,6 +548,7 @@ voodoo_fifo_thread(void *param)
             end_time = plat_timer_read();
             voodoo->time += end_time - start_time;
         }
+        MTR_END("voodoo", "fifo");
         voodoo->voodoo_busy = 0;
     }
 }
@@ -39,6 +39,7 @@
 #include <86box/vid_voodoo_regs.h>
 #include <86box/vid_voodoo_render.h>
 #include <86box/vid_voodoo_texture.h>
+#include <minitrace/minitrace.h>
 
 typedef struct voodoo_state_t {
     int      xstart, xend, xdir;
@@ -1542,11 +1543,13 @@ render_thread(void *param, int odd_even)
 {
     voodoo_t *voodoo = (voodoo_t *) param;
 
+    MTR_META_THREAD_NAME("Voodoo render");
     while (voodoo->render_thread_run[odd_even]) {
         thread_set_event(voodoo->render_not_full_event[odd_even]);
         thread_wait_event(voodoo->wake_render_thread[odd_even], -1);
         thread_reset_event(voodoo->wake_render_thread[odd_even]);
         voodoo->render_voodoo_busy[odd_even] = 1;
+        MTR_BEGIN_I("voodoo", "render", "thread", odd_even);
 
         while (!PARAM_EMPTY(odd_even)) {
             uint64_t         start_time = plat_timer_read();
@@ -1564,6 +1567,7 @@ render_thread(void *param, int odd_even)
             voodoo->render_time[odd_even] += end_time - start_time;
         }
 
+        MTR_END("voodoo", "render");
         voodoo->render_voodoo_busy[odd_even] = 0;
     }
 }
@@ -49,8 +49,6 @@
  *          Copyright 2016-2019 Miran Grca.
  */
 #include <stdatomic.h>
-#define PNG_DEBUG 0
-#include <png.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdint.h>
@@ -74,6 +72,8 @@
 #include <86box/video.h>
 #include <86box/vid_svga.h>
 
+#include <86box/machine_counters.h>
+#include <86box/pacer.h>
 #include <minitrace/minitrace.h>
 
 volatile int screenshots = 0;
@@ -93,8 +93,13 @@ int          frames               = 0;
 int          fullchange           = 0;
 int          video_grayscale      = 0;
 int          video_graytype       = 0;
+int          video_dirty_lines    = 0; /* Only redraw and blit changed lines. */
+int          video_render_thread  = 0; /* Draw SVGA scanlines on a worker thread. */
+int          video_frameskip      = 0; /* Most frames in a row left undrawn when falling behind. */
 int          monitor_index_global = 0;
+uint64_t     video_blit_count     = 0;
 uint32_t    *video_6to8           = NULL;
+uint32_t     video_glyph_mask[256][8]; /* Each bit of a glyph row as an all or nothing pixel mask. */
 uint32_t    *video_8togs          = NULL;
 uint32_t    *video_8to32          = NULL;
 uint32_t    *video_15to32         = NULL;
@@ -234,19 +239,59 @@ const uint32_t shade[5][256] = {
     }
 };
 
+/* A finished frame, copied out of the target buffer. */
+typedef struct blit_frame_t {
+    bitmap_t    *buffer;
+    int          x, y, w, h;
+    uint32_t     seq;
+    int          rects_num;                           /* Changed since the last frame taken. */
+    video_rect_t rects[VIDEO_DIRTY_RECTS_MAX];
+    int          stale_num;                           /* Changed since this copy was filled. */
+    video_rect_t stale[VIDEO_DIRTY_RECTS_MAX];
+} blit_frame_t;
+
+#define BLIT_FRAMES    3
+#define BLIT_FRAME_NEW 0x100
+
 typedef struct blit_data_struct {
-    int x, y, w, h;
-    int busy;
-    int buffer_in_use;
     int thread_run;
     int monitor_index;
 
+    uint32_t   dirty[2048 / 32]; /* Lines drawn since the last blit. */
+    atomic_int refresh;
+
+    /*
+       Triple buffered hand-off: the emulation fills the back frame and
+       swaps it with the ready one, the blit thread swaps the ready one
+       with the front frame whenever it is marked new. Neither side ever
+       waits for the other.
+     */
+    blit_frame_t frames[BLIT_FRAMES];
+    int          back;                                /* Owned by the emulation. */
+    int          front;                               /* Owned by the blit thread. */
+    atomic_int   ready;
+    uint32_t     seq;                                 /* Last frame handed over. */
+    atomic_uint  taken_seq;                           /* Last frame taken by the blit thread. */
+    int          carry_num;                           /* Changes not yet seen by the blit thread. */
+    video_rect_t carry[VIDEO_DIRTY_RECTS_MAX];
+
     thread_t *blit_thread;
     event_t  *wake_blit_thread;
-    event_t  *blit_complete;
-    event_t  *buffer_not_in_use;
 } blit_data_t;
 
+static const video_rect_t video_rect_max = { 0, 0, 2048, 2048 };
+
+/* Added to by the blit thread of every monitor. */
+static atomic_ullong video_render_ns;
+
+/* Each bit of a 4-bit plane mask as an all or nothing byte, for working on all four planes at once. */
+const uint32_t video_plane_mask[16] = {
+    0x00000000, 0x000000ff, 0x0000ff00, 0x0000ffff,
+    0x00ff0000, 0x00ff00ff, 0x00ffff00, 0x00ffffff,
+    0xff000000, 0xff0000ff, 0xff00ff00, 0xff00ffff,
+    0xffff0000, 0xffff00ff, 0xffffff00, 0xffffffff
+};
+
 static uint32_t cga_2_table[16];
 
 static void (*blit_func)(int x, int y, int w, int h, int monitor_index);
@@ -275,119 +320,35 @@ video_setblit(void (*blit)(int, int, int, int, int))
     blit_func = blit;
 }
 
+/*
+   Blit functions call this once they are done with a frame. The frame
+   they were given stays theirs until the blit thread takes the next
+   one, so there is nothing left to release here.
+ */
 void
-video_blit_complete_monitor(int monitor_index)
-{
-    blit_data_t *blit_data_ptr   = monitors[monitor_index].mon_blit_data_ptr;
-    blit_data_ptr->buffer_in_use = 0;
-
-    thread_set_event(blit_data_ptr->buffer_not_in_use);
-}
-
-void
-video_wait_for_blit_monitor(int monitor_index)
+video_blit_complete_monitor(UNUSED(int monitor_index))
 {
-    blit_data_t *blit_data_ptr = monitors[monitor_index].mon_blit_data_ptr;
-
-    while (blit_data_ptr->busy)
-        thread_wait_event(blit_data_ptr->blit_complete, -1);
-    thread_reset_event(blit_data_ptr->blit_complete);
+    //
 }
 
+/*
+   Frames are copied out of the target buffer when they are handed to
+   the blit thread, so the video cards can draw the next one straight
+   away and never have to wait for the front end.
+ */
 void
-video_wait_for_buffer_monitor(int monitor_index)
+video_wait_for_buffer_monitor(UNUSED(int monitor_index))
 {
-    blit_data_t *blit_data_ptr = monitors[monitor_index].mon_blit_data_ptr;
-
-    while (blit_data_ptr->buffer_in_use)
-        thread_wait_event(blit_data_ptr->buffer_not_in_use, -1);
-    thread_reset_event(blit_data_ptr->buffer_not_in_use);
-}
-
-static png_structp png_ptr[MONITORS_NUM];
-static png_infop   info_ptr[MONITORS_NUM];
-
-static void
-video_take_screenshot_monitor(const char *fn, uint32_t *buf, int start_x, int start_y, int row_len, int monitor_index)
-{
-    png_bytep         *b_rgb         = NULL;
-    FILE              *fp            = NULL;
-    uint32_t           temp          = 0x00000000;
-    const blit_data_t *blit_data_ptr = monitors[monitor_index].mon_blit_data_ptr;
-
-    /* create file */
-    fp = plat_fopen(fn, (const char *) "wb");
-    if (!fp) {
-        video_log("[video_take_screenshot] File %s could not be opened for writing", fn);
-        return;
-    }
-
-    /* initialize stuff */
-    png_ptr[monitor_index] = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-
-    if (!png_ptr[monitor_index]) {
-        video_log("[video_take_screenshot] png_create_write_struct failed");
-        fclose(fp);
-        return;
-    }
-
-    info_ptr[monitor_index] = png_create_info_struct(png_ptr[monitor_index]);
-    if (!info_ptr[monitor_index]) {
-        video_log("[video_take_screenshot] png_create_info_struct failed");
-        fclose(fp);
-        return;
-    }
-
-    png_init_io(png_ptr[monitor_index], fp);
-
-    png_set_IHDR(png_ptr[monitor_index], info_ptr[monitor_index], blit_data_ptr->w, blit_data_ptr->h,
-                 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
-                 PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
-
-    b_rgb = (png_bytep *) malloc(sizeof(png_bytep) * blit_data_ptr->h);
-    if (b_rgb == NULL) {
-        video_log("[video_take_screenshot] Unable to Allocate RGB Bitmap Memory");
-        fclose(fp);
-        return;
-    }
-
-    for (int y = 0; y < blit_data_ptr->h; ++y) {
-        b_rgb[y] = (png_byte *) malloc(png_get_rowbytes(png_ptr[monitor_index], info_ptr[monitor_index]));
-        for (int x = 0; x < blit_data_ptr->w; ++x) {
-            if (buf == NULL)
-                memset(&(b_rgb[y][x * 3]), 0x00, 3);
-            else {
-                temp                  = buf[((start_y + y) * row_len) + start_x + x];
-                b_rgb[y][x * 3]       = (temp >> 16) & 0xff;
-                b_rgb[y][(x * 3) + 1] = (temp >> 8) & 0xff;
-                b_rgb[y][(x * 3) + 2] = temp & 0xff;
-            }
-        }
-    }
-
-    png_write_info(png_ptr[monitor_index], info_ptr[monitor_index]);
-
-    png_write_image(png_ptr[monitor_index], b_rgb);
-
-    png_write_end(png_ptr[monitor_index], NULL);
-
-    /* cleanup heap allocation */
-    for (int i = 0; i < blit_data_ptr->h; i++)
-        if (b_rgb[i])
-            free(b_rgb[i]);
-
-    if (b_rgb)
-        free(b_rgb);
-
-    if (fp)
-        fclose(fp);
+    //
 }
 
 void
 video_screenshot_monitor(uint32_t *buf, int start_x, int start_y, int row_len, int monitor_index)
 {
-    char path[1024];
-    char fn[256];
+    const blit_data_t  *blit_data_ptr = monitors[monitor_index].mon_blit_data_ptr;
+    const blit_frame_t *frame         = &blit_data_ptr->frames[blit_data_ptr->front];
+    char                path[1024];
+    char                fn[256];
 
     memset(fn, 0, sizeof(fn));
     memset(path, 0, sizeof(path));
@@ -406,8 +367,7 @@ video_screenshot_monitor(uint32_t *buf, int start_x, int start_y, int row_len, i
 
     video_log("taking screenshot to: %s\n", path);
 
-    video_take_screenshot_monitor((const char *) path, buf, start_x, start_y, row_len, monitor_index);
-    png_destroy_write_struct(&png_ptr[monitor_index], &info_ptr[monitor_index]);
+    video_capture_screenshot(path, buf, start_x, start_y, row_len, frame->w, frame->h);
 
     atomic_fetch_sub(&monitors[monitor_index].mon_screenshots, 1);
 }
@@ -444,43 +404,301 @@ video_transform_copy(void *__restrict _Dst, const void *__restrict _Src, size_t
 static void
 blit_thread(void *param)
 {
-    blit_data_t *data = param;
+    blit_data_t  *data = param;
+    blit_frame_t *frame;
+    uint64_t      start;
+
     while (data->thread_run) {
         thread_wait_event(data->wake_blit_thread, -1);
         thread_reset_event(data->wake_blit_thread);
+
+        /* Always go for the newest frame, any older one is skipped. */
+        if (!(atomic_load(&data->ready) & BLIT_FRAME_NEW))
+            continue;
+        data->front = atomic_exchange(&data->ready, data->front) & ~BLIT_FRAME_NEW;
+        frame       = &data->frames[data->front];
+        atomic_store(&data->taken_seq, frame->seq);
+
         MTR_BEGIN("video", "blit_thread");
+        start = plat_get_nano_ticks();
 
         if (blit_func)
-            blit_func(data->x, data->y, data->w, data->h, data->monitor_index);
+            blit_func(frame->x, frame->y, frame->w, frame->h, data->monitor_index);
 
-        data->busy = 0;
+        atomic_fetch_add(&video_render_ns, plat_get_nano_ticks() - start);
 
         MTR_END("video", "blit_thread");
-        thread_set_event(data->blit_complete);
     }
 }
 
+/* Host time spent in the blit threads of all monitors so far. */
+uint64_t
+video_get_render_ns(void)
+{
+    return atomic_load(&video_render_ns);
+}
+
+/*
+   Adds a rectangle to a list, clipped to the given area, unless an
+   entry already covers it. Once the list is full, the last entry grows
+   to cover everything that follows.
+ */
+static void
+video_rect_add(video_rect_t *list, int *num, int x, int y, int w, int h, const video_rect_t *clip)
+{
+    video_rect_t *r;
+    int           x2 = MIN(x + w, clip->x + clip->w);
+    int           y2 = MIN(y + h, clip->y + clip->h);
+
+    x = MAX(x, clip->x);
+    y = MAX(y, clip->y);
+    if ((x >= x2) || (y >= y2))
+        return;
+
+    for (int i = 0; i < *num; i++) {
+        if ((x >= list[i].x) && (y >= list[i].y) && (x2 <= (list[i].x + list[i].w)) && (y2 <= (list[i].y + list[i].h)))
+            return;
+    }
+
+    if (*num < VIDEO_DIRTY_RECTS_MAX) {
+        r    = &list[(*num)++];
+        r->x = x;
+        r->y = y;
+        r->w = x2 - x;
+        r->h = y2 - y;
+    } else {
+        r    = &list[VIDEO_DIRTY_RECTS_MAX - 1];
+        x2   = MAX(x2, r->x + r->w);
+        y2   = MAX(y2, r->y + r->h);
+        r->x = MIN(x, r->x);
+        r->y = MIN(y, r->y);
+        r->w = x2 - r->x;
+        r->h = y2 - r->y;
+    }
+}
+
+static void
+video_blit_copy_rect(bitmap_t *dst, const bitmap_t *src, const video_rect_t *rect)
+{
+    for (int line = rect->y; line < (rect->y + rect->h); line++)
+        video_copy(&dst->line[line][rect->x], &src->line[line][rect->x], rect->w * sizeof(uint32_t));
+}
+
+static int
+video_rect_covered(const video_rect_t *rect, const video_rect_t *list, int num)
+{
+    for (int i = 0; i < num; i++) {
+        if ((rect->x >= list[i].x) && (rect->y >= list[i].y) && ((rect->x + rect->w) <= (list[i].x + list[i].w)) && ((rect->y + rect->h) <= (list[i].y + list[i].h)))
+            return 1;
+    }
+
+    return 0;
+}
+
+/*
+   Copies the changed areas of the target buffer into the back frame
+   and hands it to the blit thread, without waiting for it.
+ */
+static void
+video_blit_submit(int x, int y, int w, int h, const video_rect_t *rects, int num, int monitor_index)
+{
+    blit_data_t  *blit_data_ptr = monitors[monitor_index].mon_blit_data_ptr;
+    blit_frame_t *frame         = &blit_data_ptr->frames[blit_data_ptr->back];
+    uint64_t      start         = plat_get_nano_ticks();
+
+    /* Bring the frame up to date with what changed since it was last filled. */
+    for (int i = 0; i < frame->stale_num; i++) {
+        if (!video_rect_covered(&frame->stale[i], rects, num))
+            video_blit_copy_rect(frame->buffer, monitors[monitor_index].target_buffer, &frame->stale[i]);
+    }
+    frame->stale_num = 0;
+
+    for (int i = 0; i < num; i++) {
+        video_blit_copy_rect(frame->buffer, monitors[monitor_index].target_buffer, &rects[i]);
+
+        for (int j = 0; j < BLIT_FRAMES; j++) {
+            if (j != blit_data_ptr->back)
+                video_rect_add(blit_data_ptr->frames[j].stale, &blit_data_ptr->frames[j].stale_num,
+                               rects[i].x, rects[i].y, rects[i].w, rects[i].h, &video_rect_max);
+        }
+    }
+
+    /* Changes in frames the blit thread skipped have to be passed on as well. */
+    if (atomic_load(&blit_data_ptr->taken_seq) == blit_data_ptr->seq)
+        blit_data_ptr->carry_num = 0;
+    for (int i = 0; i < num; i++)
+        video_rect_add(blit_data_ptr->carry, &blit_data_ptr->carry_num, rects[i].x, rects[i].y, rects[i].w, rects[i].h, &video_rect_max);
+
+    memcpy(frame->rects, blit_data_ptr->carry, blit_data_ptr->carry_num * sizeof(video_rect_t));
+    frame->rects_num = blit_data_ptr->carry_num;
+    frame->x         = x;
+    frame->y         = y;
+    frame->w         = w;
+    frame->h         = h;
+    frame->seq       = ++blit_data_ptr->seq;
+
+    blit_data_ptr->back = atomic_exchange(&blit_data_ptr->ready, blit_data_ptr->back | BLIT_FRAME_NEW) & ~BLIT_FRAME_NEW;
+    machine_counters.blit_wait_ns += plat_get_nano_ticks() - start;
+
+    thread_set_event(blit_data_ptr->wake_blit_thread);
+}
+
 void
 video_blit_memtoscreen_monitor(int x, int y, int w, int h, int monitor_index)
 {
+    blit_data_t *blit_data_ptr = monitors[monitor_index].mon_blit_data_ptr;
+    video_rect_t rect;
+    int          num = 0;
+
+    /* The whole area changed. */
+    video_rect_add(&rect, &num, x, y, w, h, &video_rect_max);
+    if (!num)
+        return;
+
+    /* Nothing was drawn, the last frame sent stays up. */
+    if (monitors[monitor_index].mon_skip_frame) {
+        monitors[monitor_index].mon_skip_frame = 0;
+        video_capture_frame(rect.x, rect.y, rect.w, rect.h, 0, monitor_index);
+        return;
+    }
+
     MTR_BEGIN("video", "video_blit_memtoscreen");
 
-    if ((w <= 0) || (h <= 0))
+    video_blit_count++;
+    memset(blit_data_ptr->dirty, 0x00, sizeof(blit_data_ptr->dirty));
+
+    video_capture_frame(rect.x, rect.y, rect.w, rect.h, 1, monitor_index);
+    video_blit_submit(x, y, w, h, &rect, num, monitor_index);
+
+    MTR_END("video", "video_blit_memtoscreen");
+}
+
+/*
+   Same as above, for cards that mark the lines they draw. The blitter
+   gets the changed lines as a list of rectangles, and the frame is not
+   handed over at all if nothing changed, unless the front end asked for
+   a refresh or a screenshot is pending.
+ */
+void
+video_blit_dirty_memtoscreen_monitor(int x, int y, int w, int h, int monitor_index)
+{
+    blit_data_t *blit_data_ptr = monitors[monitor_index].mon_blit_data_ptr;
+    video_rect_t clip;
+    video_rect_t rects[VIDEO_DIRTY_RECTS_MAX];
+    int          num = 0;
+    int          start;
+
+    video_rect_add(&clip, &num, x, y, w, h, &video_rect_max);
+    if (!num)
+        return;
+    num = 0;
+
+    /* Whatever got marked is kept for the next frame that is drawn. */
+    if (monitors[monitor_index].mon_skip_frame) {
+        monitors[monitor_index].mon_skip_frame = 0;
+        video_capture_frame(clip.x, clip.y, clip.w, clip.h, 0, monitor_index);
         return;
+    }
 
-    video_wait_for_blit_monitor(monitor_index);
+    video_blit_count++;
 
-    monitors[monitor_index].mon_blit_data_ptr->busy          = 1;
-    monitors[monitor_index].mon_blit_data_ptr->buffer_in_use = 1;
-    monitors[monitor_index].mon_blit_data_ptr->x             = x;
-    monitors[monitor_index].mon_blit_data_ptr->y             = y;
-    monitors[monitor_index].mon_blit_data_ptr->w             = w;
-    monitors[monitor_index].mon_blit_data_ptr->h             = h;
+    if (atomic_exchange(&blit_data_ptr->refresh, 0))
+        video_rect_add(rects, &num, x, y, w, h, &clip);
+    else {
+        /* Runs of changed lines become full width bands. */
+        for (int line = y; line < (y + h);) {
+            if (!(blit_data_ptr->dirty[(line & 0x7ff) >> 5] & (1U << (line & 31)))) {
+                line++;
+                continue;
+            }
+
+            start = line;
+            while ((line < (y + h)) && (blit_data_ptr->dirty[(line & 0x7ff) >> 5] & (1U << (line & 31))))
+                line++;
+            video_rect_add(rects, &num, x, start, w, line - start, &clip);
+        }
+    }
+
+    memset(blit_data_ptr->dirty, 0x00, sizeof(blit_data_ptr->dirty));
+
+    video_capture_frame(clip.x, clip.y, clip.w, clip.h, num, monitor_index);
+
+    if (!num && !monitors[monitor_index].mon_screenshots)
+        return;
+
+    MTR_BEGIN("video", "video_blit_memtoscreen");
+
+    video_blit_submit(x, y, w, h, rects, num, monitor_index);
 
-    thread_set_event(monitors[monitor_index].mon_blit_data_ptr->wake_blit_thread);
     MTR_END("video", "video_blit_memtoscreen");
 }
 
+void
+video_dirty_line_monitor(int y, int monitor_index)
+{
+    if (y >= 0)
+        monitors[monitor_index].mon_blit_data_ptr->dirty[(y & 0x7ff) >> 5] |= (1U << (y & 31));
+}
+
+void
+video_dirty_all_monitor(int monitor_index)
+{
+    memset(monitors[monitor_index].mon_blit_data_ptr->dirty, 0xff, sizeof(monitors[monitor_index].mon_blit_data_ptr->dirty));
+}
+
+/*
+   Called by the cards as they finish a frame, to find out whether to
+   draw the next one. When the emulation is running late, up to
+   video_frameskip frames in a row are left undrawn and unsent, so that
+   the time goes to catching up instead. Only the host side work is left
+   out, the emulated timings are the same either way.
+ */
+int
+video_frame_skip_monitor(int monitor_index)
+{
+    monitor_t *monitor = &monitors[monitor_index];
+
+    monitor->mon_skip_frame = (monitor->mon_skip_run < video_frameskip) && !monitor->mon_screenshots && (pacer_get_lag() > PACER_LATE_NS);
+    if (monitor->mon_skip_frame) {
+        monitor->mon_skip_run++;
+        machine_counters.frames_skipped++;
+    } else
+        monitor->mon_skip_run = 0;
+
+    return monitor->mon_skip_frame;
+}
+
+/* Can be called from any thread, to have the next frame sent in full. */
+void
+video_refresh_monitor(int monitor_index)
+{
+    if (monitors[monitor_index].mon_blit_data_ptr != NULL)
+        atomic_store(&monitors[monitor_index].mon_blit_data_ptr->refresh, 1);
+}
+
+/*
+   For blit functions: the parts of the blit area that changed since
+   the previous blit. This can be empty when only a screenshot is due.
+ */
+int
+video_blit_rects_monitor(const video_rect_t **rects, int monitor_index)
+{
+    const blit_data_t *blit_data_ptr = monitors[monitor_index].mon_blit_data_ptr;
+
+    *rects = blit_data_ptr->frames[blit_data_ptr->front].rects;
+
+    return blit_data_ptr->frames[blit_data_ptr->front].rects_num;
+}
+
+/* For blit functions: the frame to show, which stays put while they work on it. */
+bitmap_t *
+video_blit_buffer_monitor(int monitor_index)
+{
+    const blit_data_t *blit_data_ptr = monitors[monitor_index].mon_blit_data_ptr;
+
+    return blit_data_ptr->frames[blit_data_ptr->front].buffer;
+}
+
 uint8_t
 pixels8(uint32_t *pixels)
 {
@@ -842,6 +1060,73 @@ create_bitmap(int x, int y)
     return b;
 }
 
+glyph_cache_t *
+video_glyph_cache_init(void)
+{
+    glyph_cache_t *gc = (glyph_cache_t *) malloc(sizeof(glyph_cache_t));
+
+    gc->valid = 0;
+
+    return gc;
+}
+
+void
+video_glyph_cache_close(glyph_cache_t *gc)
+{
+    free(gc);
+}
+
+/*
+   Called at the start of each text line with what the rows drawn on it
+   depend on besides their key. Any of it changing, which is what palette
+   and attribute register writes come down to, drops the whole cache, as
+   does a write to the font since the last line.
+ */
+void
+video_glyph_cache_begin(glyph_cache_t *gc, const uint32_t *col, uint32_t charseta, uint32_t charsetb, int flags)
+{
+    if (gc->valid && (gc->flags == flags) && (gc->charset[0] == charseta) && (gc->charset[1] == charsetb) && !memcmp(gc->col, col, sizeof(gc->col)))
+        return;
+
+    /* No key has bits 22 and up set. */
+    memset(gc->key, 0xff, sizeof(gc->key));
+    memcpy(gc->col, col, sizeof(gc->col));
+    gc->charset[0] = charseta;
+    gc->charset[1] = charsetb;
+    gc->flags      = flags;
+    gc->valid      = 1;
+}
+
+void
+video_glyph_cache_fill(glyph_cache_t *gc, uint32_t idx, uint32_t key, const uint8_t *vram)
+{
+    const uint8_t chr      = key & 0xff;
+    const uint8_t attr     = (key >> 8) & 0xff;
+    const int     sc       = (key >> 16) & 0x1f;
+    uint32_t      charaddr = gc->charset[(attr & 8) ? 1 : 0] + (chr * 128);
+    uint32_t      fg       = gc->col[attr & 15];
+    uint32_t      bg       = gc->col[attr >> 4];
+    uint8_t       dat;
+    uint32_t     *row      = gc->row[idx];
+
+    if ((attr & 0x80) && (gc->flags & GLYPH_BLINK)) {
+        bg = gc->col[(attr >> 4) & 7];
+        if (key & (1 << 21))
+            fg = bg;
+    }
+
+    dat = vram[charaddr + (sc << 2)];
+    for (int xx = 0; xx < 8; xx++)
+        row[xx] = (dat & (0x80 >> xx)) ? fg : bg;
+
+    if (((chr & ~0x1f) == 0xc0) && (gc->flags & GLYPH_LINECHARS))
+        row[8] = (dat & 1) ? fg : bg;
+    else
+        row[8] = bg;
+
+    gc->key[idx] = key;
+}
+
 void
 video_monitor_init(int index)
 {
@@ -860,9 +1145,13 @@ video_monitor_init(int index)
     monitors[index].target_buffer                        = create_bitmap(2048, 2048);
     monitors[index].mon_blit_data_ptr                    = calloc(1, sizeof(blit_data_t));
     monitors[index].mon_blit_data_ptr->wake_blit_thread  = thread_create_event();
-    monitors[index].mon_blit_data_ptr->blit_complete     = thread_create_event();
-    monitors[index].mon_blit_data_ptr->buffer_not_in_use = thread_create_event();
     monitors[index].mon_blit_data_ptr->thread_run        = 1;
+    for (uint8_t i = 0; i < BLIT_FRAMES; i++)
+        monitors[index].mon_blit_data_ptr->frames[i].buffer = create_bitmap(2048, 2048);
+    monitors[index].mon_blit_data_ptr->back  = 0;
+    monitors[index].mon_blit_data_ptr->front = 1;
+    atomic_init(&monitors[index].mon_blit_data_ptr->ready, 2);
+    atomic_init(&monitors[index].mon_blit_data_ptr->taken_seq, 0);
     monitors[index].mon_blit_data_ptr->monitor_index     = index;
     monitors[index].mon_pal_lookup                       = calloc(sizeof(uint32_t), 256);
     monitors[index].mon_cga_palette                      = calloc(1, sizeof(int));
@@ -886,9 +1175,9 @@ video_monitor_close(int monitor_index)
     thread_wait(monitors[monitor_index].mon_blit_data_ptr->blit_thread);
     if (monitor_index >= 1)
         ui_deinit_monitor(monitor_index);
-    thread_destroy_event(monitors[monitor_index].mon_blit_data_ptr->buffer_not_in_use);
-    thread_destroy_event(monitors[monitor_index].mon_blit_data_ptr->blit_complete);
     thread_destroy_event(monitors[monitor_index].mon_blit_data_ptr->wake_blit_thread);
+    for (uint8_t i = 0; i < BLIT_FRAMES; i++)
+        destroy_bitmap(monitors[monitor_index].mon_blit_data_ptr->frames[i].buffer);
     free(monitors[monitor_index].mon_blit_data_ptr);
     if (!monitors[monitor_index].mon_pal_lookup_static)
         free(monitors[monitor_index].mon_pal_lookup);
@@ -947,6 +1236,11 @@ video_init(void)
             egaremap2bpp[c] |= 0x08;
     }
 
+    for (uint16_t c = 0; c < 256; c++) {
+        for (uint8_t x = 0; x < 8; x++)
+            video_glyph_mask[c][x] = (c & (0x80 >> x)) ? 0xffffffff : 0x00000000;
+    }
+
     video_6to8 = malloc(4 * 256);
     for (uint16_t c = 0; c < 256; c++)
         video_6to8[c] = calc_6to8(c);
@@ -969,11 +1263,14 @@ video_init(void)
 
     memset(monitors, 0, sizeof(monitors));
     video_monitor_init(0);
+
+    video_capture_init();
 }
 
 void
 video_close(void)
 {
+    video_capture_close();
     video_monitor_close(0);
 
     free(video_16to32);
@@ -0,0 +1,553 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Screenshots and frame capture.
+ *
+ *          Frames are copied into a buffer and then converted and
+ *          written out by a thread of their own, so neither the blit
+ *          threads nor the emulation ever wait for libpng or the disk.
+ *
+ *          A capture writes every frame the emulated card sends, either
+ *          as numbered PNG files or as raw 24-bit RGB frames back to
+ *          back. Frames that did not change are written again rather
+ *          than copied again. Once the writer falls behind, frames are
+ *          dropped: a raw capture repeats the previous frame in their
+ *          place so its timing stays right, a PNG capture skips their
+ *          numbers.
+ *
+ *
+ *
+ */
+#include <stdatomic.h>
+#define PNG_DEBUG 0
+#include <png.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <wchar.h>
+#define HAVE_STDARG_H
+#include <86box/86box.h>
+#include <86box/plat.h>
+#include <86box/thread.h>
+#include <86box/video.h>
+
+#define CAPTURE_JOBS  64 /* Queued frames, including repeats. */
+#define CAPTURE_SLOTS 4  /* Queued frames that carry their own pixels. */
+
+enum {
+    CAPTURE_JOB_SCREENSHOT = 0,
+    CAPTURE_JOB_START,
+    CAPTURE_JOB_FRAME,
+    CAPTURE_JOB_REPEAT,
+    CAPTURE_JOB_STOP
+};
+
+typedef struct capture_job_t {
+    int       type;
+    int       slot;   /* -1 if the pixels belong to the job. */
+    int       format;
+    int       w;
+    int       h;
+    uint32_t *pixels;
+    char     *fn;
+    FILE     *fp;
+} capture_job_t;
+
+typedef struct capture_slot_t {
+    uint32_t *pixels;
+    int       size;
+    int       busy;
+} capture_slot_t;
+
+static mutex_t       *capture_mutex = NULL;
+static event_t       *capture_wake;
+static thread_t      *capture_thread;
+static volatile int   capture_run;
+static capture_job_t  capture_jobs[CAPTURE_JOBS];
+static int            capture_head; /* Both only advanced with the mutex held. */
+static int            capture_tail;
+static capture_slot_t capture_slots[CAPTURE_SLOTS];
+
+/* Emulation side of the running capture. */
+static atomic_int    capture_monitor = -1;
+static atomic_int    capture_restart;
+static atomic_ullong capture_dropped; /* Also read by video_capture_stop(). */
+
+/* Writer side of the running capture. */
+static int      stream_format;
+static FILE    *stream_fp;
+static char    *stream_fn;
+static uint32_t stream_frame;
+static int      stream_w;
+static int      stream_h;
+static uint8_t *stream_rgb; /* Last raw frame, written again for repeats. */
+
+#ifdef ENABLE_VIDEO_CAPTURE_LOG
+int video_capture_do_log = ENABLE_VIDEO_CAPTURE_LOG;
+
+static void
+video_capture_log(const char *fmt, ...)
+{
+    va_list ap;
+
+    if (video_capture_do_log) {
+        va_start(ap, fmt);
+        pclog_ex(fmt, ap);
+        va_end(ap);
+    }
+}
+#else
+#    define video_capture_log(fmt, ...)
+#endif
+
+static void
+capture_rgb24(uint8_t *dst, const uint32_t *src, int w)
+{
+    for (int x = 0; x < w; x++) {
+        dst[x * 3]       = (src[x] >> 16) & 0xff;
+        dst[(x * 3) + 1] = (src[x] >> 8) & 0xff;
+        dst[(x * 3) + 2] = src[x] & 0xff;
+    }
+}
+
+static void
+capture_write_png(const char *fn, const uint32_t *pixels, int w, int h)
+{
+    png_structp png_ptr;
+    png_infop   info_ptr;
+    png_bytep   row;
+    FILE       *fp;
+
+    fp = plat_fopen(fn, "wb");
+    if (fp == NULL) {
+        video_capture_log("[capture_write_png] File %s could not be opened for writing\n", fn);
+        return;
+    }
+
+    png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    if (png_ptr == NULL) {
+        video_capture_log("[capture_write_png] png_create_write_struct failed\n");
+        fclose(fp);
+        return;
+    }
+
+    info_ptr = png_create_info_struct(png_ptr);
+    if (info_ptr == NULL) {
+        video_capture_log("[capture_write_png] png_create_info_struct failed\n");
+        png_destroy_write_struct(&png_ptr, NULL);
+        fclose(fp);
+        return;
+    }
+
+    row = (png_bytep) malloc(w * 3);
+    if (row == NULL) {
+        video_capture_log("[capture_write_png] Unable to allocate a row\n");
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        fclose(fp);
+        return;
+    }
+
+    png_init_io(png_ptr, fp);
+    png_set_IHDR(png_ptr, info_ptr, w, h,
+                 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
+                 PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+    png_write_info(png_ptr, info_ptr);
+
+    for (int y = 0; y < h; y++) {
+        if (pixels == NULL)
+            memset(row, 0x00, w * 3);
+        else
+            capture_rgb24(row, &pixels[y * w], w);
+        png_write_row(png_ptr, row);
+    }
+
+    png_write_end(png_ptr, NULL);
+
+    free(row);
+    png_destroy_write_struct(&png_ptr, &info_ptr);
+    fclose(fp);
+}
+
+static void
+capture_stream_close(void)
+{
+    if (stream_fp != NULL)
+        fclose(stream_fp);
+    stream_fp = NULL;
+
+    free(stream_fn);
+    stream_fn = NULL;
+
+    free(stream_rgb);
+    stream_rgb = NULL;
+}
+
+/* Raw frames keep the size of the first one, anything else is cropped or padded. */
+static void
+capture_stream_raw(const capture_job_t *job)
+{
+    int w;
+    int h;
+
+    if (stream_rgb == NULL) {
+        stream_w   = job->w;
+        stream_h   = job->h;
+        stream_rgb = (uint8_t *) calloc(stream_w * stream_h, 3);
+        if (stream_rgb == NULL)
+            return;
+        video_capture_log("Capturing %ix%i raw RGB frames\n", stream_w, stream_h);
+    }
+
+    if (job->type == CAPTURE_JOB_FRAME) {
+        w = MIN(job->w, stream_w);
+        h = MIN(job->h, stream_h);
+
+        if ((w != stream_w) || (h != stream_h))
+            memset(stream_rgb, 0x00, stream_w * stream_h * 3);
+        for (int y = 0; y < h; y++)
+            capture_rgb24(&stream_rgb[y * stream_w * 3], &job->pixels[y * job->w], w);
+    }
+
+    if (fwrite(stream_rgb, 3, stream_w * stream_h, stream_fp) != (size_t) (stream_w * stream_h)) {
+        video_capture_log("Capture write failed, stopping\n");
+        capture_stream_close();
+    }
+}
+
+static void
+capture_process(capture_job_t *job)
+{
+    char fn[1024];
+
+    switch (job->type) {
+        case CAPTURE_JOB_SCREENSHOT:
+            capture_write_png(job->fn, job->pixels, job->w, job->h);
+            break;
+
+        case CAPTURE_JOB_START:
+            capture_stream_close();
+            stream_format = job->format;
+            stream_fp     = job->fp;
+            stream_fn     = job->fn;
+            stream_frame  = 0;
+            job->fn       = NULL;
+            break;
+
+        case CAPTURE_JOB_FRAME:
+        case CAPTURE_JOB_REPEAT:
+            if (stream_fn == NULL)
+                break;
+
+            if (stream_format == VIDEO_CAPTURE_RAW) {
+                /* A repeat can only come first after a dropped frame. */
+                if ((job->type == CAPTURE_JOB_FRAME) || (stream_rgb != NULL))
+                    capture_stream_raw(job);
+            } else if (job->type == CAPTURE_JOB_FRAME) {
+                snprintf(fn, sizeof(fn), "%s_%08u.png", stream_fn, stream_frame);
+                capture_write_png(fn, job->pixels, job->w, job->h);
+            }
+            stream_frame++;
+            break;
+
+        case CAPTURE_JOB_STOP:
+            video_capture_log("Captured %u frames\n", stream_frame);
+            capture_stream_close();
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void
+capture_thread_func(UNUSED(void *priv))
+{
+    capture_job_t job;
+    int           pending;
+
+    while (1) {
+        thread_wait_event(capture_wake, -1);
+        thread_reset_event(capture_wake);
+
+        /* Whatever is queued gets written before the thread goes away. */
+        while (1) {
+            thread_wait_mutex(capture_mutex);
+            pending = (capture_tail != capture_head);
+            if (pending)
+                job = capture_jobs[capture_tail % CAPTURE_JOBS];
+            thread_release_mutex(capture_mutex);
+
+            if (!pending)
+                break;
+
+            capture_process(&job);
+
+            thread_wait_mutex(capture_mutex);
+            if (job.slot >= 0)
+                capture_slots[job.slot].busy = 0;
+            capture_tail++;
+            thread_release_mutex(capture_mutex);
+
+            if (job.slot < 0)
+                free(job.pixels);
+            free(job.fn);
+        }
+
+        if (!capture_run)
+            break;
+    }
+}
+
+/* Queues a job, the writer owns it from then on. Returns 0 if the queue is full. */
+static int
+capture_queue(const capture_job_t *job)
+{
+    int ret = 0;
+
+    thread_wait_mutex(capture_mutex);
+    if ((capture_head - capture_tail) < CAPTURE_JOBS) {
+        capture_jobs[capture_head % CAPTURE_JOBS] = *job;
+        capture_head++;
+        ret = 1;
+    }
+    thread_release_mutex(capture_mutex);
+
+    if (ret)
+        thread_set_event(capture_wake);
+
+    return ret;
+}
+
+static int
+capture_slot_get(int size)
+{
+    capture_slot_t *slot = NULL;
+    int             i;
+
+    thread_wait_mutex(capture_mutex);
+    for (i = 0; i < CAPTURE_SLOTS; i++) {
+        if (!capture_slots[i].busy) {
+            slot       = &capture_slots[i];
+            slot->busy = 1;
+            break;
+        }
+    }
+    thread_release_mutex(capture_mutex);
+
+    if (slot == NULL)
+        return -1;
+
+    if (slot->size < size) {
+        free(slot->pixels);
+        slot->pixels = (uint32_t *) malloc(size * sizeof(uint32_t));
+        slot->size   = (slot->pixels == NULL) ? 0 : size;
+    }
+
+    if (slot->pixels == NULL) {
+        thread_wait_mutex(capture_mutex);
+        slot->busy = 0;
+        thread_release_mutex(capture_mutex);
+        return -1;
+    }
+
+    return i;
+}
+
+static void
+capture_copy(uint32_t *dst, const uint32_t *buf, int start_x, int start_y, int row_len, int w, int h)
+{
+    for (int y = 0; y < h; y++) {
+        if (buf == NULL)
+            memset(&dst[y * w], 0x00, w * sizeof(uint32_t));
+        else
+            memcpy(&dst[y * w], &buf[((start_y + y) * row_len) + start_x], w * sizeof(uint32_t));
+    }
+}
+
+/* Saves a w by h area of buf to a PNG file, in the background. */
+void
+video_capture_screenshot(const char *fn, const uint32_t *buf, int start_x, int start_y, int row_len, int w, int h)
+{
+    capture_job_t job;
+
+    if ((capture_mutex == NULL) || (w <= 0) || (h <= 0))
+        return;
+
+    memset(&job, 0, sizeof(capture_job_t));
+    job.type   = CAPTURE_JOB_SCREENSHOT;
+    job.slot   = -1;
+    job.w      = w;
+    job.h      = h;
+    job.pixels = (uint32_t *) malloc(w * h * sizeof(uint32_t));
+    job.fn     = strdup(fn);
+    if ((job.pixels == NULL) || (job.fn == NULL)) {
+        video_capture_log("[video_capture_screenshot] Unable to allocate the screenshot\n");
+        free(job.pixels);
+        free(job.fn);
+        return;
+    }
+
+    capture_copy(job.pixels, buf, start_x, start_y, row_len, w, h);
+
+    if (!capture_queue(&job)) {
+        video_capture_log("[video_capture_screenshot] Queue full, screenshot dropped\n");
+        free(job.pixels);
+        free(job.fn);
+    }
+}
+
+/*
+   Called by the emulation for every frame a card sends, with the area
+   already clipped to the target buffer. Frames that did not change since
+   the last one are queued as repeats, without copying.
+ */
+void
+video_capture_frame(int x, int y, int w, int h, int changed, int monitor_index)
+{
+    const bitmap_t *target = monitors[monitor_index].target_buffer;
+    capture_job_t   job;
+
+    if (atomic_load(&capture_monitor) != monitor_index)
+        return;
+
+    if (atomic_exchange(&capture_restart, 0)) {
+        changed = 1;
+        atomic_store(&capture_dropped, 0);
+    }
+
+    memset(&job, 0, sizeof(capture_job_t));
+    job.type = CAPTURE_JOB_REPEAT;
+    job.slot = -1;
+
+    if (changed && (w > 0) && (h > 0)) {
+        job.slot = capture_slot_get(w * h);
+        if (job.slot >= 0) {
+            job.type   = CAPTURE_JOB_FRAME;
+            job.w      = w;
+            job.h      = h;
+            job.pixels = capture_slots[job.slot].pixels;
+            for (int line = 0; line < h; line++)
+                memcpy(&job.pixels[line * w], &target->line[y + line][x], w * sizeof(uint32_t));
+        } else
+            atomic_fetch_add(&capture_dropped, 1);
+    }
+
+    if (!capture_queue(&job)) {
+        atomic_fetch_add(&capture_dropped, 1);
+        if (job.slot >= 0) {
+            thread_wait_mutex(capture_mutex);
+            capture_slots[job.slot].busy = 0;
+            thread_release_mutex(capture_mutex);
+        }
+    }
+}
+
+/*
+   Starts capturing the frames of a monitor. For PNG files, fn is the
+   start of the file names, to which the frame number is added.
+ */
+int
+video_capture_start(const char *fn, int format, int monitor_index)
+{
+    capture_job_t job;
+
+    if (capture_mutex == NULL)
+        return 0;
+
+    video_capture_stop();
+
+    memset(&job, 0, sizeof(capture_job_t));
+    job.type   = CAPTURE_JOB_START;
+    job.slot   = -1;
+    job.format = format;
+    job.fn     = strdup(fn);
+    if (job.fn == NULL)
+        return 0;
+
+    if (format == VIDEO_CAPTURE_RAW) {
+        job.fp = plat_fopen(fn, "wb");
+        if (job.fp == NULL) {
+            free(job.fn);
+            return 0;
+        }
+    }
+
+    if (!capture_queue(&job)) {
+        if (job.fp != NULL)
+            fclose(job.fp);
+        free(job.fn);
+        return 0;
+    }
+
+    atomic_store(&capture_restart, 1);
+    atomic_store(&capture_monitor, monitor_index);
+
+    return 1;
+}
+
+void
+video_capture_stop(void)
+{
+    capture_job_t      job;
+    unsigned long long dropped;
+
+    if (atomic_exchange(&capture_monitor, -1) < 0)
+        return;
+
+    dropped = atomic_load(&capture_dropped);
+    if (dropped)
+        video_capture_log("Capture dropped %llu frames\n", dropped);
+
+    /* The stop can't be dropped, the queue only fills up while the writer is busy. */
+    memset(&job, 0, sizeof(capture_job_t));
+    job.type = CAPTURE_JOB_STOP;
+    job.slot = -1;
+    while (!capture_queue(&job))
+        plat_delay_ms(1);
+}
+
+void
+video_capture_init(void)
+{
+    if (capture_mutex != NULL)
+        return;
+
+    capture_head = capture_tail = 0;
+    memset(capture_slots, 0, sizeof(capture_slots));
+
+    capture_mutex  = thread_create_mutex();
+    capture_wake   = thread_create_event();
+    capture_run    = 1;
+    capture_thread = thread_create(capture_thread_func, NULL);
+}
+
+/* Waits for everything queued to be written. */
+void
+video_capture_close(void)
+{
+    if (capture_mutex == NULL)
+        return;
+
+    video_capture_stop();
+
+    capture_run = 0;
+    thread_set_event(capture_wake);
+    thread_wait(capture_thread);
+
+    capture_stream_close();
+
+    for (int i = 0; i < CAPTURE_SLOTS; i++)
+        free(capture_slots[i].pixels);
+    memset(capture_slots, 0, sizeof(capture_slots));
+
+    thread_destroy_event(capture_wake);
+    thread_close_mutex(capture_mutex);
+    capture_mutex = NULL;
+}
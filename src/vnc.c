@@ -172,27 +172,45 @@ vnc_display(rfbClientPtr cl)
 
         allowedX = rfb->width;
         allowedY = rfb->height;
+
+        video_refresh_monitor(0);
     }
 }
 
 static void
 vnc_blit(int x, int y, int w, int h, int monitor_index)
 {
+    const video_rect_t *rects;
+    const bitmap_t     *buf;
+    int                 num;
+
     if (monitor_index || (x < 0) || (y < 0) || (w < VNC_MIN_X) || (h < VNC_MIN_Y) || (w > VNC_MAX_X) || (h > VNC_MAX_Y) || (buffer32 == NULL)) {
         video_blit_complete_monitor(monitor_index);
         return;
     }
 
-    for (int row = 0; row < h; ++row)
-        video_copy(&(((uint8_t *) rfb->frameBuffer)[row * 2048 * sizeof(uint32_t)]), &(buffer32->line[y + row][x]), w * sizeof(uint32_t));
+    /* Only copy and send what changed since the last frame. */
+    buf = video_blit_buffer_monitor(monitor_index);
+    num = video_blit_rects_monitor(&rects, monitor_index);
+    for (int i = 0; i < num; i++) {
+        for (int row = rects[i].y; row < (rects[i].y + rects[i].h); ++row)
+            video_copy(&(((uint32_t *) rfb->frameBuffer)[((row - y) * 2048) + (rects[i].x - x)]), &(buf->line[row][rects[i].x]), rects[i].w * sizeof(uint32_t));
+    }
 
     if (screenshots)
         video_screenshot((uint32_t *) rfb->frameBuffer, 0, 0, VNC_MAX_X);
 
     video_blit_complete_monitor(monitor_index);
 
-    if (!updatingSize)
-        rfbMarkRectAsModified(rfb, 0, 0, allowedX, allowedY);
+    if (updatingSize)
+        return;
+
+    for (int i = 0; i < num; i++) {
+        if ((rects[i].w == w) && (rects[i].h == h))
+            rfbMarkRectAsModified(rfb, 0, 0, allowedX, allowedY);
+        else
+            rfbMarkRectAsModified(rfb, rects[i].x - x, rects[i].y - y, rects[i].x - x + rects[i].w, rects[i].y - y + rects[i].h);
+    }
 }
 
 /* Initialize VNC for operation. */
@@ -244,6 +262,7 @@ vnc_init(UNUSED(void *arg))
 
     /* Set up our BLIT handlers. */
     video_setblit(vnc_blit);
+    video_refresh_monitor(0);
 
     clients = 0;
 
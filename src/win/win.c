@@ -62,6 +62,9 @@
 #include <86box/win.h>
 #include <86box/version.h>
 #include <86box/gdbstub.h>
+#include <86box/replay.h>
+#include <86box/pacer.h>
+#include <86box/bench.h>
 #ifdef MTR_ENABLED
 #    include <minitrace/minitrace.h>
 #endif
@@ -517,32 +520,25 @@ WinMain(HINSTANCE hInst, HINSTANCE hPrev, LPSTR lpszArg, int nCmdShow)
 void
 main_thread(void *param)
 {
-    uint32_t old_time;
-    uint32_t new_time;
-    int      drawits;
-    int      frames;
+    int frames;
+    int free_run;
 
     framecountx  = 0;
     title_update = 1;
-    old_time     = GetTickCount();
-    drawits = frames = 0;
+    frames       = 0;
+    pacer_init(PACER_SLICE_NS);
     while (!is_quit && cpu_thread_run) {
-        /* See if it is time to run a frame of code. */
-        new_time = GetTickCount();
+        /* Fast-forward, replays and benchmarks run as fast as the host allows. */
+        free_run = fast_forward || bench_active || (replay_mode == REPLAY_PLAY);
 #ifdef USE_GDBSTUB
-        if (gdbstub_next_asap && (drawits <= 0))
-            drawits = 10;
-        else
+        free_run |= gdbstub_next_asap;
 #endif
-            drawits += (new_time - old_time);
-        old_time = new_time;
-        if (drawits > 0 && !dopause) {
-            /* Yes, so do one frame now. */
-            drawits -= 10;
-            if (drawits > 50)
-                drawits = 0;
-
-            /* Run a block of code. */
+        if (dopause) {
+            /* Just so we dont overload the host OS. */
+            pacer_reset();
+            Sleep(1);
+        } else if (pacer_wait(free_run)) {
+            /* It is time to run a frame of code. */
             pc_run();
 
             /* Every 200 frames we save the machine status. */
@@ -551,8 +547,7 @@ main_thread(void *param)
                 nvr_dosave = 0;
                 frames     = 0;
             }
-        } else /* Just so we dont overload the host OS. */
-            Sleep(1);
+        }
 
         /* If needed, handle a screen resize. */
         if (atomic_load(&doresize_monitors[0]) && !video_fullscreen && !is_quit) {
@@ -563,6 +558,7 @@ main_thread(void *param)
             atomic_store(&doresize_monitors[0], 0);
         }
     }
+    pacer_log_stats();
 
     is_quit = 1;
 }
@@ -1003,12 +999,58 @@ plat_get_micro_ticks(void)
     return (uint32_t) plat_get_ticks_common().QuadPart;
 }
 
+uint64_t
+plat_get_nano_ticks(void)
+{
+    LARGE_INTEGER EndingTime;
+    uint64_t      elapsed;
+    uint64_t      freq;
+
+    if (first_use) {
+        QueryPerformanceFrequency(&Frequency);
+        QueryPerformanceCounter(&StartingTime);
+        first_use = 0;
+    }
+
+    QueryPerformanceCounter(&EndingTime);
+    elapsed = EndingTime.QuadPart - StartingTime.QuadPart;
+    freq    = Frequency.QuadPart;
+
+    /* Split up so the multiplication cannot overflow. */
+    return ((elapsed / freq) * 1000000000ULL) + (((elapsed % freq) * 1000000000ULL) / freq);
+}
+
 void
 plat_delay_ms(uint32_t count)
 {
     Sleep(count);
 }
 
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#    define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+/* Only ever called from the emulation thread, so one timer will do. */
+void
+plat_delay_ns(uint64_t count)
+{
+    static HANDLE timer = NULL;
+    LARGE_INTEGER due;
+
+    /* Sleep() rounds up to the scheduler tick, high resolution waitable
+       timers (Windows 10 1803 and later) do not. */
+    if (timer == NULL)
+        timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (timer == NULL)
+        timer = CreateWaitableTimerExW(NULL, NULL, 0, TIMER_ALL_ACCESS);
+
+    due.QuadPart = -(LONGLONG) (count / 100);
+    if ((timer != NULL) && SetWaitableTimer(timer, &due, 0, NULL, NULL, FALSE))
+        WaitForSingleObject(timer, INFINITE);
+    else
+        Sleep((DWORD) (count / 1000000));
+}
+
 /* Return the VIDAPI number for the given name. */
 int
 plat_vidapi(char *name)
@@ -835,7 +835,7 @@ opengl_blit(int x, int y, int w, int h, int monitor_index)
     }
 
     for (int row = 0; row < h; ++row)
-        video_copy(&(((uint8_t *) blit_info[write_pos].buffer)[row * ROW_LENGTH * sizeof(uint32_t)]), &(buffer32->line[y + row][x]), w * sizeof(uint32_t));
+        video_copy(&(((uint8_t *) blit_info[write_pos].buffer)[row * ROW_LENGTH * sizeof(uint32_t)]), &(video_blit_buffer_monitor(0)->line[y + row][x]), w * sizeof(uint32_t));
 
     if (monitors[0].mon_screenshots)
         video_screenshot(blit_info[write_pos].buffer, 0, 0, ROW_LENGTH);
@@ -253,10 +253,10 @@ sdl_blit(int x, int y, int w, int h, int monitor_index)
     r_src.y = y;
     r_src.w = w;
     r_src.h = h;
-    SDL_UpdateTexture(sdl_tex, &r_src, &(buffer32->line[y][x]), 2048 * sizeof(uint32_t));
+    SDL_UpdateTexture(sdl_tex, &r_src, &(video_blit_buffer_monitor(0)->line[y][x]), 2048 * sizeof(uint32_t));
 
     if (monitors[0].mon_screenshots)
-        video_screenshot(buffer32->dat, x, y, 2048);
+        video_screenshot(video_blit_buffer_monitor(0)->dat, x, y, 2048);
 
     video_blit_complete();
 
@@ -293,7 +293,7 @@ sdl_blit_ex(int x, int y, int w, int h, UNUSED(int monitor_index))
     SDL_LockTexture(sdl_tex, 0, &pixeldata, &pitch);
 
     for (int row = 0; row < h; ++row)
-        video_copy(&(((uint8_t *) pixeldata)[row * 2048 * sizeof(uint32_t)]), &(buffer32->line[y + row][x]), w * sizeof(uint32_t));
+        video_copy(&(((uint8_t *) pixeldata)[row * 2048 * sizeof(uint32_t)]), &(video_blit_buffer_monitor(0)->line[y + row][x]), w * sizeof(uint32_t));
 
     if (monitors[0].mon_screenshots)
         video_screenshot((uint32_t *) pixeldata, 0, 0, 2048);